@@ -0,0 +1,160 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-RakNet-Bot.hpp
+	Header for scripted headless client that plays lockstep games.
+*/
+
+#ifndef _GPRO_NET_RAKNET_BOT_HPP_
+#define _GPRO_NET_RAKNET_BOT_HPP_
+#ifdef __cplusplus
+
+
+#include "gpro-net/gpro-net-client/gpro-net-RakNet-Client.hpp"
+#include "gpro-net/gpro-net/gpro-net-Metrics.hpp"
+
+
+namespace gproNet
+{
+	// eBotSettings
+	//	Enumeration of bot limits.
+	enum eBotSettings
+	{
+		BOT_MOVE_LIMIT = 400,		// moves before match is called a draw and left
+		BOT_STALL_TIMEOUT = 30000,	// milliseconds without progress before match is left
+		BOT_RETRY_INTERVAL = 1000,	// milliseconds between connection attempts
+		BOT_MOVE_CANDIDATES = 128,	// legal moves considered per turn
+	};
+
+
+	// sBotStats
+	//	Totals for one bot since it was made.
+	struct sBotStats
+	{
+		unsigned long long matchesFinished;		// played until game was over
+		unsigned long long matchesAbandoned;	// opponent left, stalled or move limit
+		unsigned long long moves;				// own moves relayed back by server
+		unsigned long long reconnects;			// connections made after the first
+		sMetricsHistogram moveTime;				// own move sent until relayed back (ns)
+	};
+
+
+	// cRakNetBot
+	//	Client that plays by itself for soak tests: queues for its game,
+	//	places a random fleet, makes legal moves until the game is over,
+	//	leaves and queues again; connects again whenever it drops.
+	class cRakNetBot : public cRakNetClient
+	{
+		// protected data
+	protected:
+		// stats
+		//	Totals since bot was made.
+		sBotStats stats;
+
+		// game
+		//	Game queued for.
+		eLockstepGame game;
+
+		// playing
+		//	Game of current match, none between matches.
+		eLockstepGame playing;
+
+		// random
+		//	Random state for choosing moves and placing fleets.
+		unsigned long long random;
+
+		// port
+		//	Port of server, for connecting again.
+		unsigned short port;
+
+		// connected, queued, ready
+		//	Connected at least once; waiting in lobby; every board placed.
+		bool connected, queued, ready;
+
+		// moveSequence, tMove
+		//	Sequence when own move was sent and when (microseconds), zero
+		//	time if no move is waiting to be relayed back.
+		unsigned int moveSequence;
+		RakNet::TimeUS tMove;
+
+		// tProgress, tConnect
+		//	Last time match or queue made progress; last connection attempt.
+		RakNet::Time tProgress, tConnect;
+
+		// public methods
+	public:
+		// cRakNetBot
+		//	Construct using RakNet transport and connect.
+		//		param game: game to play
+		//		param seed: random seed; bots with same seed play alike
+		//		param host: server address string
+		//		param port: server port
+		cRakNetBot(eLockstepGame const game, unsigned long long const seed, char const host[] = "127.0.0.1", unsigned short const port = SET_GPRO_SERVER_PORT);
+
+		// cRakNetBot
+		//	Construct using external transport (e.g. loopback) and connect.
+		//		param transport: transport to use; owned by caller
+		//		(other params as above)
+		cRakNetBot(cTransport* const transport, eLockstepGame const game, unsigned long long const seed, char const host[] = "127.0.0.1", unsigned short const port = SET_GPRO_SERVER_PORT);
+
+		// Update
+		//	Act on state after message loop: connect, queue, place, move or
+		//	leave, at most one of these per call.
+		void Update();
+
+		// GetStats
+		//	Get totals since bot was made.
+		//		return: totals
+		sBotStats const& GetStats() const;
+
+		// IsPlaying
+		//	Check if bot is in a match.
+		//		return: is match in progress
+		bool IsPlaying() const;
+
+		// protected methods
+	protected:
+		// ChooseMove
+		//	Pick move for own turn: density targeting in battleship, random
+		//	legal move otherwise (jumps first in checkers).
+		//		param move_out: move chosen
+		//		return: was legal move found
+		bool ChooseMove(sLockstepMove& move_out);
+
+		// LeaveMatch
+		//	Leave current match and count it; queued again on next update.
+		//		param finished: was game over
+		void LeaveMatch(bool const finished);
+
+		// ProcessMessage
+		//	Unpack and process packet message.
+		//		param bitstream: packet data in bitstream
+		//		param dtSendToReceive: locally-adjusted time difference from sender to receiver
+		//		param msgID: message identifier
+		//		return: was message processed
+		virtual bool ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_RAKNET_BOT_HPP_
\ No newline at end of file
@@ -28,6 +28,7 @@
 
 
 #include "gpro-net/gpro-net/gpro-net-RakNet.hpp"
+#include "gpro-net/gpro-net/gpro-net-Entity.hpp"
 
 
 namespace gproNet
@@ -44,22 +45,199 @@ namespace gproNet
 	};
 
 
+	// eClientSession
+	//	Enumeration of stages of battleship session task.
+	enum eClientSession
+	{
+		CLIENT_SESSION_IDLE,		// no session started
+		CLIENT_SESSION_CONNECTING,	// waiting for connection
+		CLIENT_SESSION_GREETING,	// waiting for server's greeting
+		CLIENT_SESSION_QUEUED,		// waiting to be paired
+		CLIENT_SESSION_PLACING,		// board sent, waiting for opponent's
+		CLIENT_SESSION_PLAYING,		// both boards placed, game started
+		CLIENT_SESSION_FAILED,		// server did not answer in time, or refused
+	};
+
+
 	// cRakNetClient
 	//	RakNet peer management for server.
 	class cRakNetClient : public cRakNetManager
 	{
+		// protected data
+	protected:
+		// entities
+		//	Mirror of server's replicated entities.
+		cEntityStore entities;
+
+		// hits
+		//	Shots involving own entity received and not yet taken.
+		std::vector<sEntityHit> hits;
+
+		// server
+		//	Address of server once connected.
+		RakNet::SystemAddress server;
+
+		// lockstep, lockstepPlayer
+		//	Local copy of lockstep game and own player index in it.
+		cLockstepSession lockstep;
+		unsigned char lockstepPlayer;
+
+		// lockstepResync
+		//	Full state was requested; moves are ignored until it arrives.
+		bool lockstepResync;
+
+		// lockstepRoom
+		//	Chat room of lockstep match.
+		unsigned int lockstepRoom;
+
+		// chat
+		//	Chat messages received and not yet taken.
+		std::vector<sChatMessage> chat;
+
+		// greeting
+		//	Test message sent on connecting, serialized once.
+		cSharedMessage greeting;
+
+		// host
+		//	Address string of server, or of router and its shards.
+		char host[64];
+
+		// session
+		//	Stage of battleship session task.
+		eClientSession session;
+
+		// placement
+		//	Board placed by battleship session task.
+		gpro_battleship placement;
+
+		// resumeToken, resumeServer
+		//	Token server issued for resuming match after a dropped
+		//	connection, and server that issued it.
+		unsigned long long resumeToken;
+		RakNet::SystemAddress resumeServer;
+
 		// public methods
 	public:
 		// cRakNetClient
-		//	Default constructor.
-		cRakNetClient();
+		//	Construct using RakNet transport and connect.
+		//		param host: server (or router) address string
+		//		param port: server (or router) port
+		cRakNetClient(char const host[] = "127.0.0.1", unsigned short const port = SET_GPRO_SERVER_PORT);
+
+		// cRakNetClient
+		//	Construct using external transport (e.g. loopback) and connect.
+		//		param transport: transport to use, owned by caller; null
+		//			for RakNet transport
+		//		param host: server (or router) address string
+		//		param port: server (or router) port
+		cRakNetClient(cTransport* const transport, char const host[] = "127.0.0.1", unsigned short const port = SET_GPRO_SERVER_PORT);
 
 		// ~cRakNetClient
 		//	Destructor.
 		virtual ~cRakNetClient();
 
+		// GetEntities
+		//	Get entities replicated from server; dirty bits mark what the
+		//	server changed since the caller last cleared them.
+		//		return: entity store
+		cEntityStore& GetEntities();
+
+		// TakeHits
+		//	Move hits received since last call to list, oldest first.
+		//		param hit_out: list to fill; previous contents are discarded
+		//			and its storage reused for the next hits
+		void TakeHits(std::vector<sEntityHit>& hit_out);
+
+		// IsConnected
+		//	Check if connected to server (or router).
+		//		return: is client connected
+		bool IsConnected() const;
+
+		// RequestRoute
+		//	Ask router which shard hosts match; on the answer, the client
+		//	leaves the router and connects to that shard.
+		//		param key: match key shared by all its players
+		//		return: was request sent
+		bool RequestRoute(unsigned int const key);
+
+		// JoinGame
+		//	Ask server to pair this client with another for lockstep game.
+		//		param game: game to join, or none to leave current game
+		//		return: was request sent
+		bool JoinGame(eLockstepGame const game);
+
+		// SetupGame
+		//	Place own battleship board and send placement to server.
+		//		param board: board with every ship placed
+		//		return: was placement valid and sent
+		bool SetupGame(gpro_battleship const board);
+
+		// SendMove
+		//	Send move to server; applied when server relays it back.
+		//		param move: move to send; player is set by server
+		//		return: was it own turn and move sent
+		bool SendMove(sLockstepMove const& move);
+
+		// GetGame
+		//	Get local copy of lockstep game.
+		//		return: lockstep session
+		cLockstepSession const& GetGame() const;
+
+		// GetGamePlayer
+		//	Get own player index in lockstep game.
+		//		return: player index
+		unsigned char GetGamePlayer() const;
+
+		// GetGameRoom
+		//	Get chat room of lockstep match; only open while in a game.
+		//		return: room identifier
+		unsigned int GetGameRoom() const;
+
+		// SendChat
+		//	Post message to chat room; delivered with the room's next batch,
+		//	including back to this client.
+		//		param room: room to post to (global, or game room)
+		//		param text: text to post
+		//		return: was message sent
+		bool SendChat(unsigned int const room, char const text[]);
+
+		// TakeChat
+		//	Move chat messages received since last call to list, oldest
+		//	first; history of newly joined rooms is included.
+		//		param message_out: list to fill; previous contents are
+		//			discarded and its storage reused for the next messages
+		void TakeChat(std::vector<sChatMessage>& message_out);
+
+		// StartBattleship
+		//	Start session task, run by the message loop: connect and greet
+		//	(unless connected), queue for battleship, place board and wait
+		//	for opponent's; back to the queue if opponent leaves first.
+		//		param board: board with every ship placed
+		//		param timeout: longest wait for each answer from server, and
+		//			how often a missing opponent is checked for, in milliseconds
+		//		return: was task started (not already running)
+		bool StartBattleship(gpro_battleship const board, RakNet::Time const timeout);
+
+		// GetSession
+		//	Get stage of battleship session task.
+		//		return: stage
+		eClientSession GetSession() const;
+
+		// Reconnect
+		//	Connect again to server whose connection dropped, presenting
+		//	its resume token; the match carries on from the local copy.
+		//	Called automatically when connection is lost during a game.
+		//		return: was connection attempt started
+		bool Reconnect();
+
 		// protected methods
 	protected:
+		// BattleshipSession
+		//	Battleship session task.
+		//		param timeout: longest wait for each answer from server
+		//		return: task
+		cTask BattleshipSession(RakNet::Time const timeout);
+
 		// ProcessMessage
 		//	Unpack and process packet message.
 		//		param bitstream: packet data in bitstream
@@ -0,0 +1,152 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-ChatRooms.hpp
+	Header for chat rooms with batched delivery and history.
+*/
+
+#ifndef _GPRO_NET_CHATROOMS_HPP_
+#define _GPRO_NET_CHATROOMS_HPP_
+#ifdef __cplusplus
+
+
+#include <map>
+#include <vector>
+
+#include "gpro-net/gpro-net/gpro-net-Chat.hpp"
+
+#include "RakNet/RakNetTypes.h"
+
+
+namespace gproNet
+{
+	// sChatRoom
+	//	Members, messages waiting for delivery and recent history of room.
+	struct sChatRoom
+	{
+		std::vector<RakNet::SystemAddress> member;	// clients in room
+		std::vector<sChatMessage> pending;			// posted since last flush
+		unsigned int pendingSent;					// pending already written
+		sChatMessage history[CHAT_HISTORY];			// ring of recent messages
+		unsigned int historyCount;					// messages ever posted
+	};
+
+
+	// cChatRooms
+	//	Chat rooms: posts are copied into the room and held, so handling a
+	//	post costs no sends; once per tick each room's posts are written
+	//	once, in batches, and the same batch goes to every member.
+	class cChatRooms
+	{
+		// protected data
+	protected:
+		// room
+		//	Open rooms by identifier.
+		std::map<unsigned int, sChatRoom> room;
+
+		// active
+		//	Rooms with pending messages.
+		std::vector<unsigned int> active;
+
+		// public methods
+	public:
+		// Open
+		//	Open empty room; does nothing if already open.
+		//		param id: room identifier
+		void Open(unsigned int const id);
+
+		// Close
+		//	Close room, dropping members and undelivered messages.
+		//		param id: room identifier
+		void Close(unsigned int const id);
+
+		// IsOpen
+		//	Check if room is open.
+		//		param id: room identifier
+		//		return: is room open
+		bool IsOpen(unsigned int const id) const;
+
+		// Join
+		//	Add client to open room.
+		//		param id: room identifier
+		//		param client: joining client
+		//		return: was client added (false if closed or already in room)
+		bool Join(unsigned int const id, RakNet::SystemAddress const client);
+
+		// Leave
+		//	Remove client from room.
+		//		param id: room identifier
+		//		param client: leaving client
+		//		return: was client in room
+		bool Leave(unsigned int const id, RakNet::SystemAddress const client);
+
+		// LeaveAll
+		//	Remove client from every room.
+		//		param client: leaving client
+		void LeaveAll(RakNet::SystemAddress const client);
+
+		// IsMember
+		//	Check if client is in room.
+		//		param id: room identifier
+		//		param client: client
+		//		return: is client in room
+		bool IsMember(unsigned int const id, RakNet::SystemAddress const client) const;
+
+		// GetMembers
+		//	Get clients in room.
+		//		param id: room identifier
+		//		return: members, or null if closed
+		std::vector<RakNet::SystemAddress> const* GetMembers(unsigned int const id) const;
+
+		// Post
+		//	Hold message for delivery with room's next batch and add it to
+		//	history.
+		//		param message: message; room must be open
+		//		return: was message posted
+		bool Post(sChatMessage const& message);
+
+		// WriteHistory
+		//	Write room's history as one batch, oldest first.
+		//		param id: room identifier
+		//		param bitstream: packet data in bitstream
+		//		return: number of messages written, or -1 if closed
+		int WriteHistory(unsigned int const id, RakNet::BitStream& bitstream) const;
+
+		// NextActive
+		//	Get next room with pending messages.
+		//		param id_out: room identifier
+		//		return: was there a room with pending messages
+		bool NextActive(unsigned int& id_out);
+
+		// WritePending
+		//	Write next batch of room's pending messages; once all have been
+		//	written, pending is cleared and nothing is written.
+		//		param id: room identifier
+		//		param bitstream: packet data in bitstream
+		//		return: number of messages written
+		unsigned int WritePending(unsigned int const id, RakNet::BitStream& bitstream);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_CHATROOMS_HPP_
\ No newline at end of file
@@ -0,0 +1,195 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Checkpoint.hpp
+	Header for memory-mapped match checkpoints.
+*/
+
+#ifndef _GPRO_NET_CHECKPOINT_HPP_
+#define _GPRO_NET_CHECKPOINT_HPP_
+#ifdef __cplusplus
+
+
+#include "gpro-net/gpro-net/gpro-net-Lockstep.hpp"
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-filemap.h"
+
+#include <vector>
+
+
+namespace gproNet
+{
+	// eCheckpointSettings
+	//	Enumeration of checkpoint store defaults.
+	enum eCheckpointSettings
+	{
+		CHECKPOINT_SLOTS = 1024,		// matches held
+	};
+
+
+	// sCheckpointHeader
+	//	Header at start of checkpoint file; followed by two copies of every
+	//	slot's record.
+	struct sCheckpointHeader
+	{
+		// magic, version: file identification
+		char magic[4];
+		unsigned int version;
+
+		// slots, recordSize: layout, checked on open
+		unsigned int slots, recordSize;
+	};
+
+
+	// sMatchCheckpoint
+	//	Live match record with fixed layout, used in place in the mapped
+	//	file; restoring is a copy, nothing is parsed.
+	struct sMatchCheckpoint
+	{
+		unsigned int generation;		// saves of slot, newer copy wins; 0 if unwritten
+		unsigned int checksum;			// of generation and everything after this
+		unsigned int live;				// slot holds a match in progress
+		unsigned int chatRoom;			// match's chat room
+		unsigned long long player[2];	// players' transport identifiers
+		sLockstepRecord session;		// game state
+	};
+
+
+	// cCheckpointStore
+	//	Fixed slots of match records in a memory-mapped file. Each slot has
+	//	two copies and a save overwrites the older one, publishing it last
+	//	by generation; a save cut short (crash mid-copy) fails its checksum,
+	//	so loading falls back to the other copy and a match is always either
+	//	before or after a save, never between. A crashed process loses
+	//	nothing written to the mapping; a crashed machine loses what was
+	//	saved since the last sync.
+	class cCheckpointStore
+	{
+		// protected data
+	protected:
+		// filemap
+		//	Mapped checkpoint file.
+		gpro_filemap filemap;
+
+		// generation
+		//	Newest valid generation of each slot.
+		std::vector<unsigned int> generation;
+
+		// freeSlot
+		//	Slots not holding a live match.
+		std::vector<unsigned int> freeSlot;
+
+		// protected methods
+	protected:
+		// GetRecord
+		//	Get copy of slot's record in mapping.
+		//		param slot: slot index
+		//		param copy: copy index (0 or 1)
+		//		return: record
+		sMatchCheckpoint* GetRecord(unsigned int const slot, unsigned int const copy) const;
+
+		// Write
+		//	Write record over slot's older copy: copy is unpublished, filled
+		//	in, then published with next generation.
+		//		param slot: slot index
+		//		param record: record to write; generation and checksum are set
+		void Write(unsigned int const slot, sMatchCheckpoint& record);
+
+		// IsValid
+		//	Check if record copy was completely written.
+		//		param record: record copy
+		//		return: is generation set and checksum correct
+		static bool IsValid(sMatchCheckpoint const& record);
+
+		// Checksum
+		//	Hash of record contents after checksum, seeded with generation.
+		//		param record: record copy
+		//		param generation: generation record is saved as
+		//		return: checksum
+		static unsigned int Checksum(sMatchCheckpoint const& record, unsigned int const generation);
+
+		// public methods
+	public:
+		// cCheckpointStore
+		//	Default constructor; not open.
+		cCheckpointStore();
+
+		// ~cCheckpointStore
+		//	Destructor; closes without releasing live slots.
+		~cCheckpointStore();
+
+		// Open
+		//	Open or create checkpoint file and find live slots.
+		//		param path: path to file
+		//		param slots: number of slots in new file; must match existing
+		//		return: was file opened; false if header is not blank and does
+		//			not identify a checkpoint file of this layout
+		bool Open(char const path[], unsigned int const slots = CHECKPOINT_SLOTS);
+
+		// Close
+		//	Sync and unmap file.
+		void Close();
+
+		// IsOpen
+		//	Check if file is open.
+		//		return: is file open
+		bool IsOpen() const;
+
+		// GetSlotCount
+		//	Get number of slots.
+		//		return: slot count, 0 if not open
+		unsigned int GetSlotCount() const;
+
+		// Allocate
+		//	Take slot for new match.
+		//		return: slot index, or -1 if none free
+		int Allocate();
+
+		// Save
+		//	Write record to slot as live, over the slot's older copy.
+		//		param slot: slot index
+		//		param record: record to save; generation and checksum are set
+		//		return: was record saved
+		bool Save(unsigned int const slot, sMatchCheckpoint& record);
+
+		// Release
+		//	Mark slot no longer live and free it.
+		//		param slot: slot index
+		//		return: was slot released
+		bool Release(unsigned int const slot);
+
+		// Load
+		//	Copy newest completely written record of slot.
+		//		param slot: slot index
+		//		param record_out: record read
+		//		return: does slot hold a live match
+		bool Load(unsigned int const slot, sMatchCheckpoint& record_out) const;
+
+		// Sync
+		//	Write mapping to disk.
+		//		param wait: block until data reaches storage
+		//		return: was mapping flushed
+		bool Sync(bool const wait) const;
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_CHECKPOINT_HPP_
\ No newline at end of file
@@ -0,0 +1,125 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-HashRing.hpp
+	Header for consistent hashing of keys onto shards.
+*/
+
+#ifndef _GPRO_NET_HASHRING_HPP_
+#define _GPRO_NET_HASHRING_HPP_
+#ifdef __cplusplus
+
+
+#include <vector>
+
+
+namespace gproNet
+{
+	// eHashRingSettings
+	//	Enumeration of hash ring settings.
+	enum eHashRingSettings
+	{
+		HASH_RING_POINTS = 128,			// points per shard; evens out arcs
+		HASH_RING_NONE = 0,				// no shard (shard identifiers are nonzero)
+	};
+
+
+	// sHashRingPoint
+	//	Position of one shard's point on the ring.
+	struct sHashRingPoint
+	{
+		unsigned int hash;
+		unsigned int shard;
+	};
+
+
+	// cHashRing
+	//	Consistent hash ring: each shard owns many points on a 32-bit circle
+	//	and a key belongs to the first point at or after its hash. Adding or
+	//	removing a shard only moves the keys on that shard's arcs, about one
+	//	shard's share, instead of reshuffling every key.
+	class cHashRing
+	{
+		// protected data
+	protected:
+		// point
+		//	Points of every shard, sorted by hash.
+		std::vector<sHashRingPoint> point;
+
+		// shards
+		//	Number of shards on ring.
+		unsigned int shards;
+
+		// public methods
+	public:
+		// cHashRing
+		//	Default constructor; empty ring.
+		cHashRing();
+
+		// Add
+		//	Place shard's points on ring.
+		//		param shard: shard identifier, nonzero
+		//		return: was shard added (false if invalid or already on ring)
+		bool Add(unsigned int const shard);
+
+		// Remove
+		//	Take shard's points off ring; its keys move to the next shards.
+		//		param shard: shard identifier
+		//		return: was shard on ring
+		bool Remove(unsigned int const shard);
+
+		// Contains
+		//	Check if shard is on ring.
+		//		param shard: shard identifier
+		//		return: is shard on ring
+		bool Contains(unsigned int const shard) const;
+
+		// GetCount
+		//	Get number of shards on ring.
+		//		return: shard count
+		unsigned int GetCount() const;
+
+		// Find
+		//	Get shard owning key.
+		//		param key: key to look up
+		//		return: shard identifier, or none if ring is empty
+		unsigned int Find(unsigned int const key) const;
+
+		// GetPreference
+		//	Get distinct shards in ring order starting from key's owner;
+		//	the order to try when the owner cannot take the key.
+		//		param key: key to look up
+		//		param shard_out: array to fill
+		//		param max: capacity of array
+		//		return: number of shards filled
+		unsigned int GetPreference(unsigned int const key, unsigned int shard_out[], unsigned int const max) const;
+
+		// Hash
+		//	Mix value into well-spread 32-bit hash.
+		//		param value: value to hash
+		//		return: hash
+		static unsigned int Hash(unsigned int const value);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_HASHRING_HPP_
\ No newline at end of file
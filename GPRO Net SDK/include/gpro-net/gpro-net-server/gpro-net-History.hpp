@@ -0,0 +1,164 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-History.hpp
+	Header for pose history and lag compensation.
+*/
+
+#ifndef _GPRO_NET_HISTORY_HPP_
+#define _GPRO_NET_HISTORY_HPP_
+#ifdef __cplusplus
+
+
+#include <vector>
+
+#include "gpro-net/gpro-net/gpro-net-Entity.hpp"
+
+#include "RakNet/RakNetTypes.h"
+
+
+namespace gproNet
+{
+	// eHistorySettings
+	//	Enumeration of history defaults.
+	enum eHistorySettings
+	{
+		HISTORY_FRAMES = 64,		// ticks kept per entity (about 1 s at 60 Hz)
+		HISTORY_ENTITIES = 4096,	// entity identifiers tracked
+	};
+
+
+	// cPoseHistory
+	//	Fixed-size ring buffer of past poses per entity, indexed by server
+	//	tick, for rewinding entities to the time a client saw them. Memory
+	//	is allocated once: entities x frames poses.
+	class cPoseHistory
+	{
+		// protected data
+	protected:
+		// pose
+		//	Pose of entity at frame, at [id * frames + tick % frames].
+		std::vector<sSpatialPose> pose;
+
+		// poseTick
+		//	Tick each pose was recorded at; stale entries do not match frame.
+		std::vector<unsigned int> poseTick;
+
+		// tickFirst
+		//	Earliest tick each identifier's poses are valid from; older ones
+		//	belong to a destroyed entity that had the identifier.
+		std::vector<unsigned int> tickFirst;
+
+		// frameTick, frameTime
+		//	Tick number and time of each frame in ring.
+		std::vector<unsigned int> frameTick;
+		std::vector<RakNet::Time> frameTime;
+
+		// frames, entities
+		//	Ring size and number of identifiers tracked.
+		unsigned int frames, entities;
+
+		// tickLatest
+		//	Most recent tick recorded, and one past highest identifier seen.
+		unsigned int tickLatest, idEnd;
+
+		// recorded
+		//	Has any frame been recorded.
+		bool recorded;
+
+		// protected methods
+	protected:
+		// FindFrames
+		//	Find recorded ticks bracketing time; clamped to history window.
+		//		param time: time to find
+		//		param tick0_out: tick at or before time
+		//		param tick1_out: tick after time (same as tick0 if clamped)
+		//		param blend_out: position of time between ticks (0-1)
+		//		return: is any history recorded
+		bool FindFrames(RakNet::Time const time, unsigned int& tick0_out, unsigned int& tick1_out, float& blend_out) const;
+
+		// SampleFrames
+		//	Blend entity's poses at two ticks; uses whichever was recorded if
+		//	entity is missing from one (or it did not exist yet).
+		//		param id: entity identifier
+		//		param tick0, tick1, blend: from FindFrames
+		//		param pose_out: blended pose
+		//		return: was entity recorded at either tick
+		bool SampleFrames(unsigned int const id, unsigned int const tick0, unsigned int const tick1, float const blend, sSpatialPose& pose_out) const;
+
+		// public methods
+	public:
+		// cPoseHistory
+		//	Construct with fixed capacity.
+		//		param entities: entity identifiers tracked (0 to entities - 1)
+		//		param frames: ticks kept per entity
+		cPoseHistory(unsigned int const entities = HISTORY_ENTITIES, unsigned int const frames = HISTORY_FRAMES);
+
+		// Record
+		//	Record every entity's pose for tick, overwriting oldest frame.
+		//		param tick: server tick, increasing
+		//		param time: time of tick
+		//		param store: entities
+		void Record(unsigned int const tick, RakNet::Time const time, cEntityStore const& store);
+
+		// Forget
+		//	Drop entity's recorded poses, e.g. when it is destroyed, so an
+		//	entity reusing the identifier is not rewound into them.
+		//		param id: entity identifier
+		void Forget(unsigned int const id);
+
+		// Sample
+		//	Rewind entity: blend recorded poses around time (clamped to the
+		//	oldest and newest recorded ticks).
+		//		param id: entity identifier
+		//		param time: time to rewind to
+		//		param pose_out: pose at time
+		//		return: was entity recorded around time
+		bool Sample(unsigned int const id, RakNet::Time const time, sSpatialPose& pose_out) const;
+
+		// Raycast
+		//	Find nearest entity hit by ray with all entities rewound to time;
+		//	entities are spheres scaled by their largest scale component.
+		//		param origin: ray start
+		//		param direction: unit ray direction
+		//		param maxDistance: ray length
+		//		param time: time to rewind to
+		//		param ignoreID: entity not to test (e.g. shooter)
+		//		param distance_out: distance to hit
+		//		return: entity hit, or invalid
+		unsigned int Raycast(float const origin[3], float const direction[3], float const maxDistance, RakNet::Time const time, unsigned int const ignoreID, float& distance_out) const;
+
+		// GetMemoryUsage
+		//	Get bytes allocated for history.
+		//		return: bytes
+		unsigned long long GetMemoryUsage() const;
+
+		// GetForward
+		//	Get facing direction of pose: +z turned by pitch (x) then yaw (y).
+		//		param pose: pose
+		//		param direction_out: unit direction
+		static void GetForward(sSpatialPose const& pose, float direction_out[3]);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_HISTORY_HPP_
\ No newline at end of file
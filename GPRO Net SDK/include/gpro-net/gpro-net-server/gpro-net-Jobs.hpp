@@ -0,0 +1,277 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Jobs.hpp
+	Header for work-stealing job system.
+*/
+
+#ifndef _GPRO_NET_JOBS_HPP_
+#define _GPRO_NET_JOBS_HPP_
+#ifdef __cplusplus
+
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace gproNet
+{
+	// eJobSettings
+	//	Enumeration of job system settings.
+	enum eJobSettings
+	{
+		JOB_RING_SIZE = 4096,	// jobs each thread may have in flight (power of two)
+		JOB_DEPENDENTS = 4,		// jobs that may wait for one job
+	};
+
+
+	// fJob
+	//	Job function.
+	//		param data: job data
+	typedef void (*fJob)(void* const data);
+
+	// fJobRange
+	//	Parallel-for function, called for consecutive slices of a range.
+	//		param data: job data
+	//		param begin: first index of slice
+	//		param end: one past last index of slice
+	typedef void (*fJobRange)(void* const data, unsigned int const begin, unsigned int const end);
+
+
+	// sJob
+	//	Unit of work; finishes when it and every child created under it
+	//	have run, then releases jobs that depend on it. Storage of a
+	//	finished job is reused by later jobs.
+	struct sJob
+	{
+		fJob func;
+		fJobRange range;					// parallel-for, if set (func unused)
+		void* data;
+		unsigned int begin, end, grain;		// parallel-for slice and split size
+		sJob* parent;
+		std::atomic<unsigned int> unfinished;	// self and children not yet done
+		std::atomic<unsigned int> blockers;		// prerequisites not yet done, and run
+		std::atomic<unsigned int> generation;	// times storage was given a job
+		unsigned int dependents;
+		sJob* dependent[JOB_DEPENDENTS];
+	};
+
+
+	// sJobHandle
+	//	Job and the generation it was created in; once the job finishes
+	//	and its storage is reused, the generation no longer matches, so
+	//	the handle still reads as finished.
+	struct sJobHandle
+	{
+		sJob* job;
+		unsigned int generation;
+	};
+
+
+	class cJobSystem;
+
+
+	// sJobWorker
+	//	Thread of job system: ring of jobs it creates and deque of jobs
+	//	ready to run; owner works at the back, thieves take the front.
+	struct sJobWorker
+	{
+		cJobSystem* system;
+		sJob* ring;
+		unsigned int ringNext;
+		std::vector<sJob*> spare;		// made when ring slot is still in flight
+		std::mutex lock;
+		std::vector<sJob*> deque;		// circular, JOB_RING_SIZE entries
+		unsigned int head, tail;		// front and one past back
+		unsigned int victim;			// next worker to steal from
+	};
+
+
+	// cJobSystem
+	//	Work-stealing job scheduler: one deque per thread, the constructing
+	//	thread included; idle threads take the oldest job of a busy one.
+	//	Jobs are created, run and waited for on the constructing thread or
+	//	inside jobs; more than JOB_RING_SIZE jobs in flight on one thread
+	//	spill into spare jobs on the heap.
+	class cJobSystem
+	{
+		// protected data
+	protected:
+		// worker
+		//	Constructing thread first, then each worker thread.
+		std::vector<sJobWorker*> worker;
+
+		// thread
+		//	Worker threads.
+		std::vector<std::thread> thread;
+
+		// owner
+		//	Constructing thread, the only one outside jobs that may use them.
+		std::thread::id owner;
+
+		// queued
+		//	Jobs ready in any deque.
+		std::atomic<unsigned int> queued;
+
+		// sleeping
+		//	Worker threads waiting for jobs.
+		std::atomic<unsigned int> sleeping;
+
+		// waiting
+		//	Threads in Wait with nothing to run, waiting for jobs or for
+		//	their job to finish.
+		std::atomic<unsigned int> waiting;
+
+		// running
+		//	Do worker threads continue.
+		std::atomic<bool> running;
+
+		// sleepLock, wake
+		//	Idle worker threads and waiting threads wait here.
+		std::mutex sleepLock;
+		std::condition_variable wake;
+
+		// protected methods
+	protected:
+		// GetWorker
+		//	Get calling thread's worker; constructing thread if not a worker.
+		//		return: worker
+		sJobWorker& GetWorker();
+
+		// Push
+		//	Add ready job to back of calling thread's deque.
+		//		param job: job
+		void Push(sJob* const job);
+
+		// Take
+		//	Take job from back of own deque, or steal from front of another.
+		//		param self: calling thread's worker
+		//		return: job, or null if none ready
+		sJob* Take(sJobWorker& self);
+
+		// Execute
+		//	Run job and finish it.
+		//		param job: job
+		void Execute(sJob* const job);
+
+		// Finish
+		//	Count job or child done; when all are, release dependents and
+		//	finish parent.
+		//		param job: job
+		void Finish(sJob* job);
+
+		// Split
+		//	Parallel-for body: hand upper halves of slice to children until
+		//	at most grain remain, then run the rest.
+		//		param job: job
+		void Split(sJob* const job);
+
+		// Make
+		//	Take storage for job from calling thread's ring (or a spare if
+		//	the ring slot is still in flight) and set it up, not yet run.
+		//		param func: job function
+		//		param data: job data
+		//		param parent: job that finishes only after this one, or null
+		//		return: job
+		sJob* Make(fJob const func, void* const data, sJob* const parent);
+
+		// Work
+		//	Worker thread loop.
+		//		param index: worker index
+		void Work(unsigned int const index);
+
+		// public methods
+	public:
+		// cJobSystem
+		//	Construct and start worker threads.
+		//		param threads: threads in total, calling thread included;
+		//			0 for one per hardware thread
+		cJobSystem(unsigned int threads = 0);
+
+		// ~cJobSystem
+		//	Destructor; stops worker threads (jobs should be finished).
+		~cJobSystem();
+
+		// Create
+		//	Create job, not yet run.
+		//		param func: job function
+		//		param data: job data
+		//		param parent: job that finishes only after this one, or none;
+		//			must not be run yet
+		//		return: job handle
+		sJobHandle Create(fJob const func, void* const data, sJobHandle const parent = sJobHandle());
+
+		// CreateParallelFor
+		//	Create job calling function for slices of range, not yet run.
+		//		param func: parallel-for function
+		//		param data: job data
+		//		param count: size of range
+		//		param grain: largest slice for one call
+		//		param parent: job that finishes only after this one, or none;
+		//			must not be run yet
+		//		return: job handle
+		sJobHandle CreateParallelFor(fJobRange const func, void* const data, unsigned int const count, unsigned int const grain, sJobHandle const parent = sJobHandle());
+
+		// AddDependency
+		//	Make job wait for prerequisite; call before either is run.
+		//		param job: job that waits
+		//		param prerequisite: job waited for
+		//		return: was dependency added (prerequisite has room)
+		bool AddDependency(sJobHandle const job, sJobHandle const prerequisite);
+
+		// Run
+		//	Queue job; it starts once its prerequisites have finished.
+		//		param job: job
+		void Run(sJobHandle const job);
+
+		// IsFinished
+		//	Check if job (and every child) has run.
+		//		param job: job
+		//		return: has job finished
+		static bool IsFinished(sJobHandle const job);
+
+		// Wait
+		//	Run other jobs until job has finished, sleeping while there are
+		//	none to run.
+		//		param job: job
+		void Wait(sJobHandle const job);
+
+		// ParallelFor
+		//	Run function for slices of range and wait for all of them.
+		//		param func: parallel-for function
+		//		param data: job data
+		//		param count: size of range
+		//		param grain: largest slice for one call
+		void ParallelFor(fJobRange const func, void* const data, unsigned int const count, unsigned int const grain);
+
+		// GetThreadCount
+		//	Get number of threads running jobs, calling thread included.
+		//		return: count
+		unsigned int GetThreadCount() const;
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_JOBS_HPP_
\ No newline at end of file
@@ -0,0 +1,160 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-RakNet-Relay.hpp
+	Header for spectator relay.
+*/
+
+#ifndef _GPRO_NET_RAKNET_RELAY_HPP_
+#define _GPRO_NET_RAKNET_RELAY_HPP_
+#ifdef __cplusplus
+
+
+#include "gpro-net/gpro-net/gpro-net-RakNet.hpp"
+#include "gpro-net/gpro-net/gpro-net-Entity.hpp"
+
+#include <deque>
+
+
+namespace gproNet
+{
+	// eRelaySettings
+	//	Enumeration of relay defaults.
+	enum eRelaySettings
+	{
+		RELAY_SPECTATORS = 256,		// downstream connections
+	};
+
+
+	// sRelayMessage
+	//	Upstream message waiting out the relay delay.
+	struct sRelayMessage
+	{
+		RakNet::Time tRelease;		// time to forward downstream
+		RakNet::MessageID msgID;	// message identifier
+		cSharedMessage message;		// message as received, stamped for release
+	};
+
+
+	// cRakNetRelay
+	//	Spectator relay: subscribes once to an upstream server (or relay) as
+	//	a spectator, then forwards its match state to every downstream
+	//	spectator after a fixed delay, restamped on the relay's clock. Downstream peers may be
+	//	relays themselves, forming a tree; upstream only ever sees its
+	//	direct children. A delayed mirror of upstream entities is kept so
+	//	spectators joining late start from a full snapshot.
+	class cRakNetRelay : public cRakNetManager
+	{
+		// protected data
+	protected:
+		// entities
+		//	Upstream entities as of the last forwarded message.
+		cEntityStore entities;
+
+		// queue
+		//	Upstream messages not yet forwarded, oldest first.
+		std::deque<sRelayMessage> queue;
+
+		// upstream
+		//	Address of upstream peer once connected.
+		RakNet::SystemAddress upstream;
+
+		// delay
+		//	How long upstream messages are held before forwarding.
+		RakNet::Time delay;
+
+		// spectators
+		//	Number of downstream peers connected.
+		unsigned int spectators;
+
+		// public methods
+	public:
+		// cRakNetRelay
+		//	Construct relay using RakNet transport and connect upstream.
+		//		param host: upstream address string
+		//		param hostPort: upstream port
+		//		param port: local port spectators connect to
+		//		param maxSpectators: downstream connections allowed
+		//		param delay: time to hold messages before forwarding (ms)
+		cRakNetRelay(char const host[], unsigned short const hostPort, unsigned short const port, unsigned short const maxSpectators = RELAY_SPECTATORS, RakNet::Time const delay = 0);
+
+		// cRakNetRelay
+		//	Construct relay using external transport (e.g. loopback) and
+		//	connect upstream.
+		//		param transport: transport to use, owned by caller; null
+		//			for RakNet transport
+		//		param host: upstream address string
+		//		param hostPort: upstream port
+		//		param port: local port spectators connect to
+		//		param maxSpectators: downstream connections allowed
+		//		param delay: time to hold messages before forwarding (ms)
+		cRakNetRelay(cTransport* const transport, char const host[], unsigned short const hostPort, unsigned short const port, unsigned short const maxSpectators = RELAY_SPECTATORS, RakNet::Time const delay = 0);
+
+		// ~cRakNetRelay
+		//	Destructor.
+		virtual ~cRakNetRelay();
+
+		// Update
+		//	Forward upstream messages whose delay has passed.
+		//		return: number of messages forwarded
+		unsigned int Update();
+
+		// SetDelay
+		//	Change delay for messages received from now on.
+		//		param delay: time to hold messages before forwarding (ms)
+		void SetDelay(RakNet::Time const delay);
+
+		// IsSubscribed
+		//	Check if connected upstream.
+		//		return: is relay receiving upstream state
+		bool IsSubscribed() const;
+
+		// GetSpectatorCount
+		//	Get number of downstream peers.
+		//		return: spectator count
+		unsigned int GetSpectatorCount() const;
+
+		// GetEntities
+		//	Get delayed mirror of upstream entities.
+		//		return: entity store
+		cEntityStore const& GetEntities() const;
+
+		// protected methods
+	protected:
+		// ProcessMessage
+		//	Unpack and process packet message.
+		//		param bitstream: packet data in bitstream
+		//		param dtSendToReceive: locally-adjusted time difference from sender to receiver
+		//		param msgID: message identifier
+		//		return: was message processed
+		virtual bool ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID);
+
+		// Apply
+		//	Apply forwarded message to entity mirror.
+		//		param relayed: message being forwarded
+		void Apply(sRelayMessage const& relayed);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_RAKNET_RELAY_HPP_
\ No newline at end of file
@@ -0,0 +1,163 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-RakNet-Router.hpp
+	Header for match router in front of sharded servers.
+*/
+
+#ifndef _GPRO_NET_RAKNET_ROUTER_HPP_
+#define _GPRO_NET_RAKNET_ROUTER_HPP_
+#ifdef __cplusplus
+
+
+#include "gpro-net/gpro-net/gpro-net-RakNet.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-HashRing.hpp"
+
+#include <map>
+
+
+namespace gproNet
+{
+	// eRouterSettings
+	//	Enumeration of router defaults.
+	enum eRouterSettings
+	{
+		ROUTER_CONNECTIONS = 1024,		// shards and clients waiting for a route
+		ROUTER_SHARDS = 64,				// most shards tried per route
+		ROUTER_MATCH_PLAYERS = 2,		// clients routed per match key
+		ROUTER_MATCH_TIMEOUT = 10000,	// ms a match waits for its other players
+	};
+
+
+	// sRouterShard
+	//	Backend server known to router.
+	struct sRouterShard
+	{
+		RakNet::SystemAddress address;	// shard's connection to router
+		unsigned short port;			// port clients connect to
+		unsigned int load;				// clients at last report
+		unsigned int capacity;			// clients allowed
+		unsigned int pending;			// clients routed since last report
+	};
+
+
+	// sRouterMatch
+	//	Match routed to a shard, remembered until all its players are.
+	struct sRouterMatch
+	{
+		unsigned short port;			// shard port
+		unsigned int routed;			// players routed so far
+		RakNet::Time tExpire;			// time to forget match
+	};
+
+
+	// cRakNetRouter
+	//	Lightweight front end for sharded servers: backend servers connect
+	//	and report their load; clients connect, name the match they want to
+	//	play, are told which shard hosts it, and move there. Matches map to
+	//	shards by consistent hashing, so adding a shard moves only a fair
+	//	share of new matches to it, with load bounded to a factor of the
+	//	average: a shard over its bound (or full) passes the match on to the
+	//	next shard on the ring. Every player of a match gets the same shard.
+	class cRakNetRouter : public cRakNetManager
+	{
+		// protected data
+	protected:
+		// ring
+		//	Consistent hash ring of shard ports.
+		cHashRing ring;
+
+		// shards
+		//	Connected shards by port.
+		std::map<unsigned short, sRouterShard> shards;
+
+		// matches
+		//	Matches with players still to route, by key.
+		std::map<unsigned int, sRouterMatch> matches;
+
+		// loadFactor
+		//	Load allowed on a shard relative to average before matches
+		//	spill to the next shard.
+		float loadFactor;
+
+		// public methods
+	public:
+		// cRakNetRouter
+		//	Construct router using RakNet transport.
+		//		param port: local port shards and clients connect to
+		//		param maxConnections: connections allowed
+		cRakNetRouter(unsigned short const port = SET_GPRO_ROUTER_PORT, unsigned short const maxConnections = ROUTER_CONNECTIONS);
+
+		// cRakNetRouter
+		//	Construct router using external transport (e.g. loopback).
+		//		param transport: transport to use, owned by caller; null
+		//			for RakNet transport
+		//		param port: local port shards and clients connect to
+		//		param maxConnections: connections allowed
+		cRakNetRouter(cTransport* const transport, unsigned short const port = SET_GPRO_ROUTER_PORT, unsigned short const maxConnections = ROUTER_CONNECTIONS);
+
+		// ~cRakNetRouter
+		//	Destructor.
+		virtual ~cRakNetRouter();
+
+		// Route
+		//	Choose shard for player of match.
+		//		param key: match key shared by its players
+		//		return: shard port, or 0 if every shard is full
+		unsigned short Route(unsigned int const key);
+
+		// SetLoadFactor
+		//	Change load allowed on a shard relative to average.
+		//		param loadFactor: factor, at least 1 (default 1.25)
+		void SetLoadFactor(float const loadFactor);
+
+		// GetShardCount
+		//	Get number of connected shards.
+		//		return: shard count
+		unsigned int GetShardCount() const;
+
+		// GetShard
+		//	Get shard by port.
+		//		param port: shard port
+		//		return: shard, or null if not connected
+		sRouterShard const* GetShard(unsigned short const port) const;
+
+		// protected methods
+	protected:
+		// ProcessMessage
+		//	Unpack and process packet message.
+		//		param bitstream: packet data in bitstream
+		//		param dtSendToReceive: locally-adjusted time difference from sender to receiver
+		//		param msgID: message identifier
+		//		return: was message processed
+		virtual bool ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID);
+
+		// RemoveShard
+		//	Forget shard and matches routed to it.
+		//		param address: shard's connection to router
+		//		return: was address a shard
+		bool RemoveShard(RakNet::SystemAddress const address);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_RAKNET_ROUTER_HPP_
\ No newline at end of file
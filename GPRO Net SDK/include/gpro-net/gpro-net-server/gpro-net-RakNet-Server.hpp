@@ -28,6 +28,17 @@
 
 
 #include "gpro-net/gpro-net/gpro-net-RakNet.hpp"
+#include "gpro-net/gpro-net/gpro-net-Entity.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-History.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-RateControl.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-Replication.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-ChatRooms.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-Checkpoint.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-Jobs.hpp"
+
+#include <map>
+#include <memory>
+#include <random>
 
 
 namespace gproNet
@@ -44,22 +55,305 @@ namespace gproNet
 	};
 
 
+	// eServerSettings
+	//	Enumeration of server defaults.
+	enum eServerSettings
+	{
+		SERVER_CLIENTS = 10,			// incoming connections
+		SERVER_LOAD_INTERVAL = 60,		// ticks between load reports to router
+		SERVER_SYNC_INTERVAL = 60,		// ticks between checkpoint syncs to disk
+		SERVER_SAVE_GRAIN = 16,			// matches checkpointed by one job
+		SERVER_MOVE_LOG = 128,			// recent moves kept per match for resuming
+		SERVER_RESUME_GRACE = 20000,	// milliseconds a dropped player's seat is held
+		SERVER_REPLICA_RANGE = 10,		// distance from client's entity halving priority
+	};
+
+
+	// sLockstepMatch
+	//	Two clients playing a lockstep game against the server's
+	//	authoritative copy.
+	struct sLockstepMatch
+	{
+		cLockstepSession session;
+		RakNet::SystemAddress address[2];
+		unsigned long long player[2];	// players' transport identifiers
+		unsigned int chatRoom;
+		int slot;						// checkpoint slot, or -1 if none
+		sLockstepMove log[SERVER_MOVE_LOG];			// recent moves by sequence
+		unsigned char logTurn[SERVER_MOVE_LOG];		// turn after each move
+		unsigned int logFirst;			// sequence of oldest logged move
+		unsigned long long heldToken[2];	// resume token of dropped player, or 0
+		bool unsaved;					// changed since last checkpointed
+	};
+
+
+	// sHeldSession
+	//	Seat in match kept for player whose connection dropped.
+	struct sHeldSession
+	{
+		std::shared_ptr<sLockstepMatch> match;
+		unsigned char player;
+		RakNet::Time deadline;			// when seat is given up
+	};
+
+
+	// sClientReplica
+	//	Entity replication state of one client.
+	struct sClientReplica
+	{
+		sRateState rate;						// snapshot rate and precision
+		unsigned int tickSent;					// tick of last snapshot
+		std::vector<unsigned int> pendingID;	// changed and not yet sent
+		std::vector<unsigned char> pendingMask;	// changed fields by identifier
+		cReplicationScheduler scheduler;		// chooses pending that fit budget
+		std::vector<unsigned int> size;			// entity bytes by identifier (scratch)
+		std::vector<unsigned int> selected;		// chosen identifiers in send order (scratch)
+		std::vector<unsigned char> mask;		// chosen masks in send order (scratch)
+		std::unique_ptr<RakNet::BitStream> encoded;	// snapshot of chosen (scratch)
+	};
+
+
 	// cRakNetServer
 	//	RakNet peer management for server.
 	class cRakNetServer : public cRakNetManager
 	{
+		// protected data
+	protected:
+		// entities
+		//	Authoritative replicated entities.
+		cEntityStore entities;
+
+		// history
+		//	Recent entity poses for lag-compensated hit tests.
+		cPoseHistory history;
+
+		// players
+		//	Entity controlled by each connected client.
+		std::map<RakNet::SystemAddress, unsigned int> players;
+
+		// tick
+		//	Server tick count.
+		unsigned int tick;
+
+		// interpolationDelay
+		//	How far behind the latest update clients display remote entities.
+		RakNet::Time interpolationDelay;
+
+		// replicas
+		//	Entity replication state of each connected client.
+		std::map<RakNet::SystemAddress, sClientReplica> replicas;
+
+		// rateControl
+		//	Chooses each client's snapshot rate from its link.
+		cRateController rateControl;
+
+		// dirtyID, dirtyMask
+		//	Entities changed this tick (scratch).
+		std::vector<unsigned int> dirtyID;
+		std::vector<unsigned char> dirtyMask;
+
+		// fullRate
+		//	Clients receiving this tick's shared update (scratch).
+		std::vector<RakNet::SystemAddress> fullRate;
+
+		// encoding
+		//	Clients due a snapshot of held changes this tick (scratch).
+		std::vector<std::pair<RakNet::SystemAddress const, sClientReplica>*> encoding;
+
+		// jobs
+		//	Job system encoding snapshots and checkpointing matches, if any.
+		cJobSystem* jobs;
+
+		// matches
+		//	Lockstep game of each client playing one.
+		std::map<RakNet::SystemAddress, std::shared_ptr<sLockstepMatch>> matches;
+
+		// lobby
+		//	Client waiting for an opponent in each lockstep game.
+		RakNet::SystemAddress lobby[LOCKSTEP_GAME_COUNT];
+
+		// chat
+		//	Global room and one room per lockstep match.
+		cChatRooms chat;
+
+		// chatRoomNext
+		//	Identifier to try for next match's room.
+		unsigned int chatRoomNext;
+
+		// greeting
+		//	Reply to test message, serialized once.
+		cSharedMessage greeting;
+
+		// port, maxClients
+		//	Port clients connect to and how many may.
+		unsigned short port, maxClients;
+
+		// router
+		//	Address of router this server is a shard of, if any.
+		RakNet::SystemAddress router;
+
+		// checkpoints
+		//	Mapped store of live matches, if open.
+		cCheckpointStore checkpoints;
+
+		// saving
+		//	Matches changed since last tick, checkpointed together at the
+		//	next one.
+		std::vector<std::shared_ptr<sLockstepMatch>> saving;
+
+		// restored
+		//	Matches resumed from checkpoints, by identifier of each player
+		//	not yet reconnected.
+		std::map<unsigned long long, std::shared_ptr<sLockstepMatch>> restored;
+
+		// tokens
+		//	Resume token issued to each connected client.
+		std::map<RakNet::SystemAddress, unsigned long long> tokens;
+
+		// held
+		//	Seats of dropped players, by resume token.
+		std::map<unsigned long long, sHeldSession> held;
+
+		// tokenSource
+		//	Random source of resume tokens.
+		std::mt19937_64 tokenSource;
+
+		// resumeGrace
+		//	How long a dropped player's seat is held.
+		RakNet::Time resumeGrace;
+
 		// public methods
 	public:
 		// cRakNetServer
-		//	Default constructor.
-		cRakNetServer();
+		//	Construct using RakNet transport.
+		//		param port: local port clients connect to
+		//		param maxClients: incoming connections allowed
+		cRakNetServer(unsigned short const port = SET_GPRO_SERVER_PORT, unsigned short const maxClients = SERVER_CLIENTS);
+
+		// cRakNetServer
+		//	Construct using external transport (e.g. loopback).
+		//		param transport: transport to use, owned by caller; null
+		//			for RakNet transport
+		//		param port: local port clients connect to
+		//		param maxClients: incoming connections allowed
+		cRakNetServer(cTransport* const transport, unsigned short const port = SET_GPRO_SERVER_PORT, unsigned short const maxClients = SERVER_CLIENTS);
 
 		// ~cRakNetServer
 		//	Destructor.
 		virtual ~cRakNetServer();
 
+		// GetEntities
+		//	Get replicated entities to create, move and destroy.
+		//		return: entity store
+		cEntityStore& GetEntities();
+
+		// ReplicateEntities
+		//	Send destroyed entities to all clients, and changed entities to
+		//	each client due a snapshot at its rate and precision; changes are
+		//	held for clients not yet due. With a job system, snapshots are
+		//	encoded in parallel and sent once all are done.
+		//		return: number of entities changed
+		unsigned int ReplicateEntities();
+
+		// UpdateRates
+		//	Sample links due for sampling and adjust clients' snapshot rates;
+		//	decisions are recorded in metrics.
+		//		param time: current time
+		void UpdateRates(RakNet::Time const time);
+
+		// Tick
+		//	Advance server tick: record pose history, adjust rates,
+		//	replicate entities and checkpoint changed matches, then deliver
+		//	chat and give up seats held too long; load is reported to router
+		//	periodically.
+		//		return: new tick
+		unsigned int Tick();
+
+		// ConnectRouter
+		//	Run as a shard behind router: connect to it and report load
+		//	whenever clients come or go, and periodically.
+		//		param host: router address string
+		//		param hostPort: router port
+		//		return: was connection attempt started
+		bool ConnectRouter(char const host[], unsigned short const hostPort);
+
+		// SendLoad
+		//	Report port, connected clients and capacity to router.
+		//		return: was report sent
+		bool SendLoad();
+
+		// OpenCheckpoints
+		//	Keep every lockstep match in a mapped checkpoint file, saved on
+		//	each change; matches already in the file are resumed, each
+		//	player rejoining it (with full state) on reconnecting.
+		//		param path: path to checkpoint file
+		//		param slots: matches held (must match existing file)
+		//		return: number of matches resumed, or -1 if file not opened
+		int OpenCheckpoints(char const path[], unsigned int const slots = CHECKPOINT_SLOTS);
+
+		// FlushChat
+		//	Send messages posted since last flush, one batch per room sent
+		//	to all its members.
+		//		return: number of messages sent
+		unsigned int FlushChat();
+
+		// PostChat
+		//	Post message to room from server.
+		//		param room: room to post to
+		//		param text: text to post
+		//		return: was room open
+		bool PostChat(unsigned int const room, char const text[]);
+
+		// GetRateController
+		//	Get rate controller to change congestion thresholds.
+		//		return: rate controller
+		cRateController& GetRateController();
+
+		// SetInterpolationDelay
+		//	Set how far behind clients display remote entities, so shots
+		//	rewind to what the shooter saw.
+		//		param delay: delay in milliseconds
+		void SetInterpolationDelay(RakNet::Time const delay);
+
+		// SetJobs
+		//	Set job system for tick work.
+		//		param jobs: job system, or null to work on tick thread only;
+		//			owned by caller, used from the thread that made it
+		void SetJobs(cJobSystem* const jobs);
+
+		// SetResumeGrace
+		//	Set how long a player whose connection dropped keeps its seat;
+		//	zero ends its match at once, as if it had left.
+		//		param grace: grace period in milliseconds
+		void SetResumeGrace(RakNet::Time const grace);
+
+		// GetSeatedCount
+		//	Get number of players seated in lockstep matches.
+		//		return: seated players
+		unsigned int GetSeatedCount() const;
+
+		// GetHeldCount
+		//	Get number of seats held for dropped players to resume.
+		//		return: held seats
+		unsigned int GetHeldCount() const;
+
 		// protected methods
 	protected:
+		// EncodeReplicas
+		//	Parallel-for body: encode held changes of due clients.
+		//		param data: server
+		//		param begin: first index in encoding list
+		//		param end: one past last index
+		static void EncodeReplicas(void* const data, unsigned int const begin, unsigned int const end);
+
+		// SaveMatches
+		//	Parallel-for body: checkpoint changed matches; each has its own
+		//	slot, so they are written independently.
+		//		param data: server
+		//		param begin: first index in saving list
+		//		param end: one past last index
+		static void SaveMatches(void* const data, unsigned int const begin, unsigned int const end);
+
 		// ProcessMessage
 		//	Unpack and process packet message.
 		//		param bitstream: packet data in bitstream
@@ -67,6 +361,128 @@ namespace gproNet
 		//		param msgID: message identifier
 		//		return: was message processed
 		virtual bool ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID);
+
+		// ProcessShot
+		//	Resolve shot from client's entity against targets rewound to the
+		//	time the client saw them.
+		//		param sender: shooting client
+		//		param dtSendToReceive: latency of input message
+		//		return: entity hit, or invalid
+		unsigned int ProcessShot(RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive);
+
+		// ProcessHit
+		//	Respond to resolved hit; by default, sends it to the shooter's
+		//	and target's clients.
+		//		param shooterID: shooting entity
+		//		param targetID: entity hit
+		//		param distance: distance to hit
+		virtual void ProcessHit(unsigned int const shooterID, unsigned int const targetID, float const distance);
+
+		// JoinGame
+		//	Queue client for lockstep game, starting a match if another
+		//	client is waiting.
+		//		param client: joining client
+		//		param game: game to join
+		//		return: was client queued or paired; false if every chat room
+		//			is in use, when the waiting client stays queued and the
+		//			joining client keeps its current game
+		bool JoinGame(RakNet::SystemAddress const client, eLockstepGame const game);
+
+		// LeaveGame
+		//	Remove client from lobby and end its match, if any.
+		//		param client: leaving client
+		void LeaveGame(RakNet::SystemAddress const client);
+
+		// EndMatch
+		//	Tell players still present the game is over, forget players
+		//	not back yet, and release the match's room and slot.
+		//		param match: lockstep match
+		void EndMatch(std::shared_ptr<sLockstepMatch> const match);
+
+		// LogMove
+		//	Keep applied move for players resuming later.
+		//		param match: lockstep match
+		//		param move: move just applied
+		void LogMove(sLockstepMatch& match, sLockstepMove const& move);
+
+		// WriteLoggedMove
+		//	Write logged move as relayed to players.
+		//		param bitstream: packet data in bitstream
+		//		param match: lockstep match
+		//		param sequence: sequence of move, still in log
+		//		return: bitstream
+		RakNet::BitStream& WriteLoggedMove(RakNet::BitStream& bitstream, sLockstepMatch const& match, unsigned int const sequence);
+
+		// IssueToken
+		//	Send new client the token it presents to resume its match if
+		//	its connection drops.
+		//		param client: connecting client
+		void IssueToken(RakNet::SystemAddress const client);
+
+		// HoldSession
+		//	Keep dropped client's seat in its match until the grace period
+		//	ends.
+		//		param client: dropped client
+		//		return: was seat held
+		bool HoldSession(RakNet::SystemAddress const client);
+
+		// ResumeSession
+		//	Put reconnected client back in its held seat, sending only the
+		//	moves after the last one it applied, or full state if those are
+		//	no longer logged.
+		//		param client: reconnected client
+		//		param token: token issued before the drop
+		//		param game: game client was playing
+		//		param sequence: last sequence client applied
+		//		return: was seat still held
+		bool ResumeSession(RakNet::SystemAddress const client, unsigned long long const token, eLockstepGame const game, unsigned int const sequence);
+
+		// ExpireSessions
+		//	End matches of players not back within the grace period.
+		//		param time: current time
+		//		return: number of seats given up
+		unsigned int ExpireSessions(RakNet::Time const time);
+
+		// SendGameStart
+		//	Send game and player index to player of match.
+		//		param match: lockstep match
+		//		param player: player index
+		void SendGameStart(sLockstepMatch const& match, unsigned char const player);
+
+		// SendNoGame
+		//	Tell client it is not in a game (seat gone or join failed).
+		//		param client: client
+		void SendNoGame(RakNet::SystemAddress const client);
+
+		// SendGameState
+		//	Send full authoritative state to player of match.
+		//		param match: lockstep match
+		//		param player: player index
+		void SendGameState(sLockstepMatch const& match, unsigned char const player);
+
+		// SaveMatch
+		//	Write match to its checkpoint slot, if it has one.
+		//		param match: lockstep match
+		void SaveMatch(sLockstepMatch const& match);
+
+		// QueueSave
+		//	Checkpoint match at next tick, with every other changed match.
+		//		param match: lockstep match
+		void QueueSave(std::shared_ptr<sLockstepMatch> const& match);
+
+		// ResumeMatch
+		//	Put reconnected client back in its restored match and send it
+		//	the match's full state.
+		//		param client: connecting client
+		//		return: was client in a restored match
+		bool ResumeMatch(RakNet::SystemAddress const client);
+
+		// JoinChat
+		//	Add client to chat room and send it the room's history.
+		//		param client: joining client
+		//		param room: room to join
+		//		return: was client added
+		bool JoinChat(RakNet::SystemAddress const client, unsigned int const room);
 	};
 
 }
@@ -0,0 +1,139 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-RateControl.hpp
+	Header for congestion-aware per-connection update rate control.
+*/
+
+#ifndef _GPRO_NET_RATECONTROL_HPP_
+#define _GPRO_NET_RATECONTROL_HPP_
+#ifdef __cplusplus
+
+
+#include "gpro-net/gpro-net/gpro-net-Transport.hpp"
+#include "gpro-net/gpro-net/gpro-net-Entity.hpp"
+
+
+namespace gproNet
+{
+	// eRateSettings
+	//	Enumeration of rate control settings.
+	enum eRateSettings
+	{
+		RATE_LEVEL_COUNT = 5,			// full rate and four degraded levels
+		RATE_SAMPLE_INTERVAL = 250,		// ms between link samples
+		RATE_DECREASE_HOLD = 500,		// ms after change before slowing further
+		RATE_INCREASE_HOLD = 3000,		// ms without congestion before speeding up
+		RATE_BASE_WINDOW = 10000,		// ms each window's lowest round trip counts as base
+	};
+
+
+	// sRateLevel
+	//	Snapshot interval, pose precision and size at one rate level.
+	struct sRateLevel
+	{
+		unsigned int interval;			// ticks between snapshots
+		eEntityPrecision precision;		// pose precision
+		unsigned int budget;			// entity bytes per snapshot
+	};
+
+
+	// sRateState
+	//	Rate control state of one connection.
+	struct sRateState
+	{
+		unsigned int level;				// current rate level (0 is full rate)
+		unsigned int pingBase;			// round trip without queuing (ms), -1 if none
+		unsigned int pingWindow[2];		// lowest round trip in current and previous window, -1 if none
+		RakNet::Time tWindow;			// time current window began
+		RakNet::Time tChange;			// time of last level change
+		RakNet::Time tCongested;		// time congestion was last seen
+		RakNet::Time tSample;			// time link was last sampled
+	};
+
+
+	// cRateController
+	//	Chooses each connection's snapshot rate and precision from link
+	//	statistics: any sign of congestion (loss, send buffer growth or round
+	//	trip rising above its base, the lowest of the last one or two
+	//	windows) slows the connection one level at a time, quickly; a long
+	//	congestion-free period speeds it up again one level at a time, slowly.
+	class cRateController
+	{
+		// protected data
+	protected:
+		// pingMargin
+		//	Round trip above base treated as queuing (ms).
+		unsigned int pingMargin;
+
+		// lossLimit
+		//	Packet loss fraction treated as congestion.
+		float lossLimit;
+
+		// bufferLimit
+		//	Bytes waiting to send treated as congestion.
+		unsigned int bufferLimit;
+
+		// public methods
+	public:
+		// cRateController
+		//	Default constructor; 80 ms margin, 2% loss, 16 KiB buffered.
+		cRateController();
+
+		// SetLimits
+		//	Change congestion thresholds.
+		//		param pingMargin: round trip above base treated as queuing (ms)
+		//		param lossLimit: packet loss fraction treated as congestion
+		//		param bufferLimit: bytes waiting to send treated as congestion
+		void SetLimits(unsigned int const pingMargin, float const lossLimit, unsigned int const bufferLimit);
+
+		// Reset
+		//	Start connection at full rate.
+		//		param state: connection state
+		//		param time: current time
+		void Reset(sRateState& state, RakNet::Time const time) const;
+
+		// IsSampleDue
+		//	Check if link should be sampled.
+		//		param state: connection state
+		//		param time: current time
+		//		return: has sample interval passed
+		bool IsSampleDue(sRateState const& state, RakNet::Time const time) const;
+
+		// Update
+		//	Adjust rate level from link sample.
+		//		param state: connection state
+		//		param link: link statistics
+		//		param time: current time
+		//		return: change in level; positive if slower, negative if faster
+		int Update(sRateState& state, sLinkStatistics const& link, RakNet::Time const time) const;
+
+		// GetLevel
+		//	Get snapshot interval and precision of rate level.
+		//		param level: rate level
+		//		return: level description
+		static sRateLevel const& GetLevel(unsigned int const level);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_RATECONTROL_HPP_
\ No newline at end of file
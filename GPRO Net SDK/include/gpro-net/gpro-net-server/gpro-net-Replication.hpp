@@ -0,0 +1,128 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Replication.hpp
+	Header for bandwidth-limited replication scheduling.
+*/
+
+#ifndef _GPRO_NET_REPLICATION_HPP_
+#define _GPRO_NET_REPLICATION_HPP_
+#ifdef __cplusplus
+
+
+#include <vector>
+
+
+namespace gproNet
+{
+	// cReplicationScheduler
+	//	Per-client priority accumulator scheduler: every object gains
+	//	priority each tick it is not sent, and each tick the client's byte
+	//	budget is filled with the highest accumulated priorities first.
+	class cReplicationScheduler
+	{
+		// protected data
+	protected:
+		// accumulator
+		//	Priority accumulated by each object since it was last sent.
+		std::vector<float> accumulator;
+
+		// order
+		//	Object indices sorted by accumulated priority (scratch).
+		std::vector<unsigned int> order;
+
+		// budget
+		//	Bytes that may be sent to client per tick.
+		unsigned int budget;
+
+		// bytesUsed
+		//	Bytes selected by most recent schedule.
+		unsigned int bytesUsed;
+
+		// public methods
+	public:
+		// cReplicationScheduler
+		//	Construct with budget.
+		//		param budget: bytes per tick
+		cReplicationScheduler(unsigned int const budget = 0);
+
+		// SetBudget
+		//	Change bytes per tick, e.g. when client's link changes.
+		//		param budget: bytes per tick
+		void SetBudget(unsigned int const budget);
+
+		// GetBudget
+		//	Get bytes per tick.
+		//		return: budget
+		unsigned int GetBudget() const;
+
+		// GetBytesUsed
+		//	Get bytes selected by most recent schedule.
+		//		return: bytes used
+		unsigned int GetBytesUsed() const;
+
+		// SetObjectCount
+		//	Resize for number of replicated objects; new objects start with
+		//	no accumulated priority.
+		//		param count: number of objects
+		void SetObjectCount(unsigned int const count);
+
+		// GetObjectCount
+		//	Get number of replicated objects.
+		//		return: count
+		unsigned int GetObjectCount() const;
+
+		// Accumulate
+		//	Add this tick's priority to object; staleness grows implicitly
+		//	as priority accumulates over ticks the object is not sent.
+		//		param index: object index
+		//		param priority: priority gained this tick
+		void Accumulate(unsigned int const index, float const priority);
+
+		// Reset
+		//	Clear object's accumulated priority (e.g. sent reliably elsewhere).
+		//		param index: object index
+		void Reset(unsigned int const index);
+
+		// Schedule
+		//	Select objects to send this tick, highest accumulated priority
+		//	first, skipping any that no longer fit in the budget; selected
+		//	objects' priority is reset.
+		//		param size: encoded size in bytes of each object's update
+		//		param selected_out: selected object indices, highest first;
+		//			must hold object count entries
+		//		return: number of objects selected
+		unsigned int Schedule(unsigned int const size[], unsigned int selected_out[]);
+
+		// GetPriority
+		//	Priority gained per tick by object of given type and distance
+		//	from client's point of interest.
+		//		param typeWeight: importance of object type
+		//		param distance: distance from client's point of interest
+		//		param falloff: relative weight lost per unit of distance
+		//		return: priority
+		static float GetPriority(float const typeWeight, float const distance, float const falloff);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_REPLICATION_HPP_
\ No newline at end of file
@@ -29,6 +29,8 @@
 #include "gpro-net/gpro-net-util/gpro-net-lib.h"
 #include "gpro-net/gpro-net-util/gpro-net-console.h"
 #include "gpro-net/gpro-net-util/gpro-net-gamestate.h"
+#include "gpro-net/gpro-net-util/gpro-net-gamerules.h"
+#include "gpro-net/gpro-net-util/gpro-net-zobrist.h"
 
 
 #endif	// !_GPRO_NET_H_
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-BattleshipAI.hpp
+	Header for battleship targeting and random fleet placement.
+*/
+
+#ifndef _GPRO_NET_BATTLESHIPAI_HPP_
+#define _GPRO_NET_BATTLESHIPAI_HPP_
+#ifdef __cplusplus
+
+
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-gamerules.h"
+
+
+namespace gproNet
+{
+	// eBattleshipSettings
+	//	Enumeration of targeting constants.
+	enum eBattleshipSettings
+	{
+		BATTLESHIP_SIZE = 10,			// rows and columns of board
+		BATTLESHIP_LANES = 16,			// columns stored per row (rest unused)
+		BATTLESHIP_HIT_WEIGHT = 40,		// extra weight of placement per known hit it covers
+	};
+
+
+	// sBattleshipDensity
+	//	Weight of every cell: number of placements of ships still afloat
+	//	that cover it and agree with attack records, each placement counting
+	//	1 plus BATTLESHIP_HIT_WEIGHT for every known hit it covers, so
+	//	cells next to hits dominate until those ships are finished.
+	//	Attacked cells are 0.
+	struct alignas(16) sBattleshipDensity
+	{
+		unsigned short cell[BATTLESHIP_SIZE][BATTLESHIP_LANES];
+	};
+
+
+	// BattleshipDensity
+	//	Compute density from attack records, one row per vector (SSE2 on
+	//	x86, otherwise same as BattleshipDensityScalar).
+	//		param board: own board (attack records are read)
+	//		param afloat: ship flags of opponent ships not yet sunk; all
+	//			ships if sinking is not announced
+	//		param density_out: weight of every cell
+	void BattleshipDensity(gpro_battleship const board, unsigned char const afloat, sBattleshipDensity& density_out);
+
+	// BattleshipDensityScalar
+	//	Compute density one placement at a time (reference).
+	//		(params as BattleshipDensity)
+	void BattleshipDensityScalar(gpro_battleship const board, unsigned char const afloat, sBattleshipDensity& density_out);
+
+	// BattleshipTarget
+	//	Choose open cell of highest density; ties are broken at random.
+	//		param board: own board (attack records are read)
+	//		param afloat: ship flags of opponent ships not yet sunk
+	//		param random: random state, advanced
+	//		param row_out, col_out: cell to attack
+	//		return: 0 if cell chosen, -2 if every cell was attacked
+	int BattleshipTarget(gpro_battleship const board, unsigned char const afloat, unsigned long long& random, unsigned char& row_out, unsigned char& col_out);
+
+	// BattleshipPlaceRandom
+	//	Place all five ships, largest first, each uniformly among the
+	//	placements the ships before it leave; never retries.
+	//		param board: own board with no ships placed
+	//		param random: random state, advanced
+	//		return: 0 if fleet placed, -2 if a ship was already placed
+	int BattleshipPlaceRandom(gpro_battleship board, unsigned long long& random);
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_BATTLESHIPAI_HPP_
\ No newline at end of file
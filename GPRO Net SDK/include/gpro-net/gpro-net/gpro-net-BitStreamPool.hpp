@@ -0,0 +1,177 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-BitStreamPool.hpp
+	Header for pooled, reusable write streams.
+*/
+
+#ifndef _GPRO_NET_BITSTREAMPOOL_HPP_
+#define _GPRO_NET_BITSTREAMPOOL_HPP_
+#ifdef __cplusplus
+
+
+#include <atomic>
+#include <vector>
+
+#include "RakNet/BitStream.h"
+
+
+namespace gproNet
+{
+	// eBitStreamPoolSettings
+	//	Enumeration of pooled stream size classes.
+	enum eBitStreamPoolSettings
+	{
+		BITSTREAM_POOL_CLASS_MIN = 256,		// smallest class (RakNet's inline buffer)
+		BITSTREAM_POOL_CLASS_COUNT = 10,	// each class doubles, up to 128 KiB
+	};
+
+
+	// cBitStreamPool
+	//	Free lists of write streams by power-of-two size class, one pool per
+	//	thread; acquire and release are a pop and a push, and released
+	//	streams keep their buffers, so once every class in use holds enough
+	//	streams, writing and sending messages allocates nothing.
+	class cBitStreamPool
+	{
+		// protected data
+	protected:
+		// freeList
+		//	Streams ready for reuse in each size class.
+		std::vector<RakNet::BitStream*> freeList[BITSTREAM_POOL_CLASS_COUNT];
+
+		// acquired
+		//	Streams handed out by this pool.
+		unsigned long long acquired;
+
+		// allocations
+		//	Streams created by this pool, or grown past their size by users.
+		unsigned long long allocations;
+
+		// totalAllocations
+		//	Allocations of every thread's pool.
+		static std::atomic<unsigned long long> totalAllocations;
+
+		// protected methods
+	protected:
+		// cBitStreamPool
+		//	Default constructor; pools are only made per thread by GetLocal.
+		cBitStreamPool();
+
+		// GetClass
+		//	Get smallest size class holding size, or the largest class.
+		//		param bytes: size in bytes
+		//		return: size class index
+		static unsigned int GetClass(unsigned int const bytes);
+
+		// public methods
+	public:
+		// ~cBitStreamPool
+		//	Destructor; releases pooled streams.
+		~cBitStreamPool();
+
+		// Acquire
+		//	Take empty stream with at least requested size from free list,
+		//	creating one only if list is empty.
+		//		param bytes: largest size message written is expected to need
+		//		return: stream; give back with Release
+		RakNet::BitStream* Acquire(unsigned int const bytes);
+
+		// Release
+		//	Reset stream and return it to free list of the size it now has.
+		//		param bitstream: stream from Acquire of this pool
+		//		param grew: stream was reallocated while in use
+		void Release(RakNet::BitStream* const bitstream, bool const grew);
+
+		// GetAcquireCount
+		//	Get number of streams handed out by this pool.
+		//		return: count
+		unsigned long long GetAcquireCount() const;
+
+		// GetAllocationCount
+		//	Get number of streams created or grown by this pool's users.
+		//		return: count
+		unsigned long long GetAllocationCount() const;
+
+		// GetLocal
+		//	Get calling thread's pool.
+		//		return: pool
+		static cBitStreamPool& GetLocal();
+
+		// GetTotalAllocationCount
+		//	Get allocations of every thread's pool; constant once sending
+		//	has reached a steady state.
+		//		return: count
+		static unsigned long long GetTotalAllocationCount();
+	};
+
+
+	// cPooledBitStream
+	//	Write stream borrowed from calling thread's pool for the lifetime of
+	//	this object; use in place of a local RakNet::BitStream, sized for the
+	//	largest message it will hold.
+	class cPooledBitStream
+	{
+		// protected data
+	protected:
+		// pool
+		//	Pool stream is returned to.
+		cBitStreamPool& pool;
+
+		// bitstream
+		//	Borrowed stream.
+		RakNet::BitStream* const bitstream;
+
+		// allocated
+		//	Size of stream when borrowed, in bits; changes if stream grows.
+		RakNet::BitSize_t const allocated;
+
+		// public methods
+	public:
+		// cPooledBitStream
+		//	Borrow stream from calling thread's pool.
+		//		param bytes: largest size message written is expected to need
+		explicit cPooledBitStream(unsigned int const bytes);
+
+		// ~cPooledBitStream
+		//	Return stream to pool.
+		~cPooledBitStream();
+
+		// not copyable: only one owner returns the stream
+		cPooledBitStream(cPooledBitStream const&) = delete;
+		cPooledBitStream& operator=(cPooledBitStream const&) = delete;
+
+		// operator *
+		//	Access borrowed stream.
+		//		return: stream
+		RakNet::BitStream& operator*() const;
+
+		// operator ->
+		//	Access borrowed stream.
+		//		return: stream
+		RakNet::BitStream* operator->() const;
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_BITSTREAMPOOL_HPP_
\ No newline at end of file
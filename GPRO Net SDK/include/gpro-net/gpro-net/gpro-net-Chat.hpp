@@ -0,0 +1,122 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Chat.hpp
+	Header for chat messages and their compressed encoding.
+*/
+
+#ifndef _GPRO_NET_CHAT_HPP_
+#define _GPRO_NET_CHAT_HPP_
+#ifdef __cplusplus
+
+
+#include <vector>
+
+#include "gpro-net/gpro-net/gpro-net-Entity.hpp"
+
+#include "RakNet/BitStream.h"
+
+
+namespace gproNet
+{
+	// eChatSettings
+	//	Enumeration of chat settings.
+	enum eChatSettings
+	{
+		CHAT_TEXT_MAX = 127,						// characters per message
+		CHAT_ROOM_BITS = 16,
+		CHAT_ROOM_MAX = (1 << CHAT_ROOM_BITS) - 1,
+		CHAT_ROOM_GLOBAL = 0,						// room every client is in
+		CHAT_HISTORY = 32,							// messages kept per room for late joiners
+		CHAT_BATCH_BITS = 6,
+		CHAT_BATCH_MAX = (1 << CHAT_BATCH_BITS) - 1,	// messages per packet
+		CHAT_SENDER_SERVER = ENTITY_ID_MAX,			// sender without entity
+		CHAT_BATCH_HEADER_BYTES = 3,				// room, history flag and count (23 bits)
+		CHAT_ENTRY_BYTES = 8 + CHAT_TEXT_MAX,		// sender and full text (compressed text rarely exceeds a byte per character)
+	};
+
+
+	// sChatMessage
+	//	Text posted to room; sender is the posting client's entity.
+	struct sChatMessage
+	{
+		unsigned int room;
+		unsigned int sender;
+		char text[CHAT_TEXT_MAX + 1];
+	};
+
+
+	// WriteChatText
+	//	Write text compressed with RakNet's string compressor (Huffman coded
+	//	by English character frequency); longer text is truncated.
+	//		param bitstream: packet data in bitstream
+	//		param text: text to write
+	void WriteChatText(RakNet::BitStream& bitstream, char const text[]);
+
+	// ReadChatText
+	//	Read text written with WriteChatText.
+	//		param bitstream: packet data in bitstream
+	//		param text_out: text read; holds CHAT_TEXT_MAX + 1 characters
+	//		return: was text read
+	bool ReadChatText(RakNet::BitStream& bitstream, char text_out[]);
+
+	// WriteChatPost
+	//	Write client's post to room.
+	//		param bitstream: packet data in bitstream
+	//		param room: room to post to
+	//		param text: text to post
+	void WriteChatPost(RakNet::BitStream& bitstream, unsigned int const room, char const text[]);
+
+	// ReadChatPost
+	//	Read client's post; sender is left for the server to fill in.
+	//		param bitstream: packet data in bitstream
+	//		param message_out: room and text posted
+	//		return: was post read
+	bool ReadChatPost(RakNet::BitStream& bitstream, sChatMessage& message_out);
+
+	// WriteChatBatch
+	//	Write header of batch of messages from one room; follow with count
+	//	calls to WriteChatEntry.
+	//		param bitstream: packet data in bitstream
+	//		param room: room messages were posted to
+	//		param history: are messages history sent on joining room
+	//		param count: number of messages (at most CHAT_BATCH_MAX)
+	void WriteChatBatch(RakNet::BitStream& bitstream, unsigned int const room, bool const history, unsigned int const count);
+
+	// WriteChatEntry
+	//	Write sender and text of message in batch.
+	//		param bitstream: packet data in bitstream
+	//		param message: message to write
+	void WriteChatEntry(RakNet::BitStream& bitstream, sChatMessage const& message);
+
+	// ReadChatBatch
+	//	Read batch of messages, appending them to list.
+	//		param bitstream: packet data in bitstream
+	//		param message_out: list to append messages to
+	//		param history_out: are messages history sent on joining room
+	//		return: number of messages read, or -1 if malformed
+	int ReadChatBatch(RakNet::BitStream& bitstream, std::vector<sChatMessage>& message_out, bool& history_out);
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_CHAT_HPP_
\ No newline at end of file
@@ -0,0 +1,312 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Entity.hpp
+	Header for replicated entity storage.
+*/
+
+#ifndef _GPRO_NET_ENTITY_HPP_
+#define _GPRO_NET_ENTITY_HPP_
+#ifdef __cplusplus
+
+
+#include <vector>
+
+#include "gpro-net/gpro-net/gpro-net-Message.hpp"
+
+
+namespace gproNet
+{
+	// eEntitySettings
+	//	Enumeration of entity limits.
+	enum eEntitySettings
+	{
+		ENTITY_ID_BITS = 20,						// up to about a million entities
+		ENTITY_ID_MAX = (1 << ENTITY_ID_BITS) - 1,	// also count limit per update
+		ENTITY_INVALID = -1,
+	};
+
+	// eEntityField
+	//	Enumeration of separately tracked pose fields, in sSpatialPose order.
+	enum eEntityField
+	{
+		ENTITY_FIELD_SCALE,
+		ENTITY_FIELD_ROTATE,
+		ENTITY_FIELD_TRANSLATE,
+
+		ENTITY_FIELD_COUNT
+	};
+
+	// eEntityPrecision
+	//	Enumeration of pose precision levels; each level drops two more low
+	//	bits from every quantized value.
+	enum eEntityPrecision
+	{
+		ENTITY_PRECISION_FULL,
+		ENTITY_PRECISION_HIGH,
+		ENTITY_PRECISION_MEDIUM,
+		ENTITY_PRECISION_LOW,
+
+		ENTITY_PRECISION_COUNT
+	};
+
+
+	// cEntityStore
+	//	Entities with stable identifiers and structure-of-arrays pose
+	//	storage: every axis of every field is one contiguous array indexed
+	//	by dense slot. Per-field dirty bitsets record what changed since the
+	//	last update was written, so updates only visit changed entities.
+	class cEntityStore
+	{
+		// protected data
+	protected:
+		// component
+		//	Pose values by field and axis, indexed by slot.
+		std::vector<float> component[ENTITY_FIELD_COUNT][3];
+
+		// dirty
+		//	Bit per slot for each field; union of all fields in last entry.
+		std::vector<unsigned long long> dirty[ENTITY_FIELD_COUNT + 1];
+
+		// slotID
+		//	Entity identifier in each slot.
+		std::vector<unsigned int> slotID;
+
+		// idSlot
+		//	Slot of each identifier, or invalid if not in use.
+		std::vector<unsigned int> idSlot;
+
+		// freeID
+		//	Released identifiers available for reuse.
+		std::vector<unsigned int> freeID;
+
+		// destroyed
+		//	Identifiers destroyed since destroyed list was last written.
+		std::vector<unsigned int> destroyed;
+
+		// protected methods
+	protected:
+		// AddSlot
+		//	Append slot for identifier with pose, all fields dirty.
+		//		param id: entity identifier
+		//		param pose: initial pose
+		void AddSlot(unsigned int const id, sSpatialPose const& pose);
+
+		// RemoveSlot
+		//	Remove entity in slot, moving last slot into its place.
+		//		param slot: slot index
+		void RemoveSlot(unsigned int const slot);
+
+		// WriteSlot
+		//	Write identifier, field mask and masked fields of entity in slot.
+		//		param bitstream: packet data in bitstream
+		//		param slot: slot index
+		//		param mask: bit per field to write
+		//		param precision: precision of written fields
+		void WriteSlot(RakNet::BitStream& bitstream, unsigned int const slot, unsigned int const mask, eEntityPrecision const precision) const;
+
+		// public methods
+	public:
+		// Create
+		//	Add entity; all fields start dirty.
+		//		param pose: initial pose
+		//		return: entity identifier, or invalid if full
+		unsigned int Create(sSpatialPose const& pose);
+
+		// Destroy
+		//	Remove entity; last slot moves into its place.
+		//		param id: entity identifier
+		//		return: was entity removed
+		bool Destroy(unsigned int const id);
+
+		// Clear
+		//	Remove all entities without recording them as destroyed.
+		void Clear();
+
+		// GetCount
+		//	Get number of entities (also number of slots in use).
+		//		return: count
+		unsigned int GetCount() const;
+
+		// GetSlot
+		//	Get current slot of entity; slots change when entities are destroyed.
+		//		param id: entity identifier
+		//		return: slot, or invalid if no such entity
+		unsigned int GetSlot(unsigned int const id) const;
+
+		// GetID
+		//	Get identifier of entity in slot.
+		//		param slot: slot index
+		//		return: entity identifier
+		unsigned int GetID(unsigned int const slot) const;
+
+		// GetPose
+		//	Gather pose of entity.
+		//		param id: entity identifier
+		//		param pose_out: pose
+		//		return: does entity exist
+		bool GetPose(unsigned int const id, sSpatialPose& pose_out) const;
+
+		// SetPose
+		//	Scatter pose of entity, marking fields that changed.
+		//		param id: entity identifier
+		//		param pose: pose
+		//		return: does entity exist
+		bool SetPose(unsigned int const id, sSpatialPose const& pose);
+
+		// SetField
+		//	Set one field of entity, marking it if changed.
+		//		param id: entity identifier
+		//		param field: field to set
+		//		param value: three values for field
+		//		return: does entity exist
+		bool SetField(unsigned int const id, eEntityField const field, float const value[3]);
+
+		// GetComponent
+		//	Direct access to one axis of one field for batch updates; call
+		//	MarkDirty for every slot written.
+		//		param field: pose field
+		//		param axis: axis index (0-2)
+		//		return: array of count values indexed by slot
+		float* GetComponent(eEntityField const field, unsigned int const axis);
+		float const* GetComponent(eEntityField const field, unsigned int const axis) const;
+
+		// MarkDirty
+		//	Mark field of entity in slot as changed.
+		//		param slot: slot index
+		//		param field: pose field
+		void MarkDirty(unsigned int const slot, eEntityField const field);
+
+		// IsDirty
+		//	Check if any field of entity in slot changed.
+		//		param slot: slot index
+		//		return: is dirty
+		bool IsDirty(unsigned int const slot) const;
+
+		// ClearDirty
+		//	Mark every entity unchanged.
+		void ClearDirty();
+
+		// GetDirtyCount
+		//	Count entities with any changed field.
+		//		return: count
+		unsigned int GetDirtyCount() const;
+
+		// WriteDirty
+		//	Write count and precision, then identifier, field mask and
+		//	changed fields of each dirty entity (quantized as sSpatialPose,
+		//	less dropped bits); clears dirty bits.
+		//		param bitstream: packet data in bitstream
+		//		param precision: precision of written fields
+		//		return: number of entities written
+		unsigned int WriteDirty(RakNet::BitStream& bitstream, eEntityPrecision const precision = ENTITY_PRECISION_FULL);
+
+		// WriteAll
+		//	Write every entity in WriteDirty format (e.g. for new peer);
+		//	dirty bits are unchanged.
+		//		param bitstream: packet data in bitstream
+		//		param precision: precision of written fields
+		//		return: number of entities written
+		unsigned int WriteAll(RakNet::BitStream& bitstream, eEntityPrecision const precision = ENTITY_PRECISION_FULL) const;
+
+		// CollectDirty
+		//	Append identifier and changed field mask of each dirty entity,
+		//	for peers updated less often than every change; clears dirty bits.
+		//		param id_out: identifiers
+		//		param mask_out: field masks
+		//		return: number of entities appended
+		unsigned int CollectDirty(std::vector<unsigned int>& id_out, std::vector<unsigned char>& mask_out);
+
+		// WriteMasked
+		//	Write listed entities in WriteDirty format; identifiers no longer
+		//	in use are skipped.
+		//		param bitstream: packet data in bitstream
+		//		param id: identifiers
+		//		param mask: field mask of each identifier
+		//		param count: number of identifiers
+		//		param precision: precision of written fields
+		//		return: number of entities written
+		unsigned int WriteMasked(RakNet::BitStream& bitstream, unsigned int const id[], unsigned char const mask[], unsigned int const count, eEntityPrecision const precision) const;
+
+		// ReadDirty
+		//	Apply update written by WriteDirty or WriteAll, creating entities
+		//	not yet seen.
+		//		param bitstream: packet data in bitstream
+		//		return: number of entities read, or -1 if malformed
+		int ReadDirty(RakNet::BitStream& bitstream);
+
+		// GetDestroyedCount
+		//	Count identifiers destroyed since destroyed list was last written.
+		//		return: count
+		unsigned int GetDestroyedCount() const;
+
+		// WriteDestroyed
+		//	Write count and identifiers destroyed since last call; clears list.
+		//		param bitstream: packet data in bitstream
+		//		return: number of identifiers written
+		unsigned int WriteDestroyed(RakNet::BitStream& bitstream);
+
+		// ReadDestroyed
+		//	Apply destroyed list written by WriteDestroyed.
+		//		param bitstream: packet data in bitstream
+		//		return: number of identifiers read, or -1 if malformed
+		int ReadDestroyed(RakNet::BitStream& bitstream);
+
+		// GetUpdateMaxBytes
+		//	Get largest size of update of entities in WriteDirty format.
+		//		param count: number of entities
+		//		return: size in bytes
+		static unsigned int GetUpdateMaxBytes(unsigned int const count);
+
+		// GetEntityBytes
+		//	Get size of one entity in an update, rounded up to whole bytes.
+		//		param mask: bit per field written
+		//		param precision: precision of written fields
+		//		return: size in bytes
+		static unsigned int GetEntityBytes(unsigned int const mask, eEntityPrecision const precision);
+
+		// GetDestroyedMaxBytes
+		//	Get size of destroyed list of identifiers.
+		//		param count: number of identifiers
+		//		return: size in bytes
+		static unsigned int GetDestroyedMaxBytes(unsigned int const count);
+	};
+
+
+	// sEntityHit
+	//	Shot resolved by server, sent to shooter and target.
+	struct sEntityHit
+	{
+		unsigned int shooter;
+		unsigned int target;
+		float distance;
+	};
+
+	typedef sSchema<
+		sField<&sEntityHit::shooter, sBitsCodec<ENTITY_ID_BITS>>,
+		sField<&sEntityHit::target, sBitsCodec<ENTITY_ID_BITS>>,
+		sField<&sEntityHit::distance, sQuantizedCodec<0, 1024, 1, 16>>
+	> sEntityHitSchema;
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_ENTITY_HPP_
\ No newline at end of file
@@ -0,0 +1,281 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Lockstep.hpp
+	Header for deterministic lockstep sessions of turn-based games.
+*/
+
+#ifndef _GPRO_NET_LOCKSTEP_HPP_
+#define _GPRO_NET_LOCKSTEP_HPP_
+#ifdef __cplusplus
+
+
+#include "gpro-net/gpro-net/gpro-net-Schema.hpp"
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-gamestate.h"
+
+
+namespace gproNet
+{
+	// eLockstepGame
+	//	Enumeration of games playable in lockstep.
+	enum eLockstepGame
+	{
+		LOCKSTEP_NONE,
+		LOCKSTEP_CHECKERS,
+		LOCKSTEP_MANCALA,
+		LOCKSTEP_BATTLESHIP,
+
+		LOCKSTEP_GAME_COUNT
+	};
+
+	// eLockstepSettings
+	//	Enumeration of lockstep settings.
+	enum eLockstepSettings
+	{
+		LOCKSTEP_HASH_INTERVAL = 8,		// moves between state hash checks
+		LOCKSTEP_HASH_HISTORY = 16,		// checks kept for late comparison
+		LOCKSTEP_MOVE_BYTES = 2,		// largest move with player (11 bits)
+		LOCKSTEP_BOARD_BYTES = 63,		// placed board (100 cells of 5 bits)
+		LOCKSTEP_STATE_BYTES = 6 + sizeof(gpro_battleship),	// header (41 bits) and largest board
+	};
+
+
+	// sLockstepMove
+	//	One move; meaning of parameters depends on game:
+	//		checkers: row and column of piece (a, b) and destination (c, d)
+	//		mancala: cup (a)
+	//		battleship: row and column attacked (a, b), hit or miss (c)
+	struct sLockstepMove
+	{
+		unsigned char player;
+		unsigned char a, b, c, d;
+	};
+
+
+	// sLockstepRecord
+	//	Plain copy of session state with fixed layout, for storing outside
+	//	the process (e.g. mapped checkpoint files); hashes are rebuilt on
+	//	load, not stored.
+	struct sLockstepRecord
+	{
+		unsigned int sequence;
+		unsigned char game, turn, chain, chainRow, chainCol;
+		unsigned char hasBoard[2];
+		unsigned char reserved;
+		gpro_checkers checkers;
+		gpro_mancala mancala;
+		gpro_battleship battleship[2];
+	};
+
+
+	// cLockstepSession
+	//	Deterministic turn-based game state: every peer applies the same
+	//	validated moves in the same order to its own copy, so only moves are
+	//	sent. Hashes of each player's view are kept every few moves so
+	//	copies can be compared and resynchronized when they differ.
+	//	Battleship boards are private; each peer holds only its own, and the
+	//	authority holds both.
+	class cLockstepSession
+	{
+		// protected data
+	protected:
+		// game
+		//	Game being played.
+		eLockstepGame game;
+
+		// sequence
+		//	Number of moves applied.
+		unsigned int sequence;
+
+		// turn
+		//	Index of player to move.
+		unsigned char turn;
+
+		// chain, chainRow, chainCol
+		//	Checkers piece that must continue jumping, if any.
+		bool chain;
+		unsigned char chainRow, chainCol;
+
+		// checkers, mancala, battleship
+		//	Boards; battleship board for each player.
+		gpro_checkers checkers;
+		gpro_mancala mancala;
+		gpro_battleship battleship[2];
+
+		// hasBoard
+		//	Battleship board of each player is held.
+		bool hasBoard[2];
+
+		// boardHash
+		//	Zobrist hash of shared board (first), or battleship board of each
+		//	player; updated from the cells each move changes.
+		unsigned long long boardHash[2];
+
+		// checkpoint, checkpointSequence
+		//	Hash of each player's view at recent check sequences.
+		unsigned long long checkpoint[LOCKSTEP_HASH_HISTORY][2];
+		unsigned int checkpointSequence[LOCKSTEP_HASH_HISTORY];
+
+		// protected methods
+	protected:
+		// Checkpoint
+		//	Record hashes at current sequence.
+		void Checkpoint();
+
+		// HashBoards
+		//	Recompute board hashes from every cell.
+		void HashBoards();
+
+		// public methods
+	public:
+		// cLockstepSession
+		//	Default constructor; no game.
+		cLockstepSession();
+
+		// Start
+		//	Reset boards and begin game; player 0 moves first.
+		//		param game: game to play
+		void Start(eLockstepGame const game);
+
+		// SetBoard
+		//	Validate and hold battleship board of player; only ship
+		//	placement is kept.
+		//		param player: player index
+		//		param board: board with ships placed
+		//		return SUCCESS: 0 if board accepted
+		//		return FAILURE: -2 if board is not a valid placement
+		//		return FAILURE: -1 if invalid parameters or not battleship
+		int SetBoard(unsigned char const player, gpro_battleship const board);
+
+		// Apply
+		//	Validate and apply move of player whose turn it is. Battleship
+		//	result is filled in when defender's board is held.
+		//		param move: move to apply
+		//		return SUCCESS: 0 if move applied
+		//		return FAILURE: -2 if move is not legal
+		//		return FAILURE: -1 if invalid parameters or no game
+		int Apply(sLockstepMove& move);
+
+		// Hash
+		//	Hash of game state as seen by player (battleship: own board).
+		//		param player: player index
+		//		return: hash
+		unsigned long long Hash(unsigned char const player) const;
+
+		// VerifyBoards
+		//	Compare incremental board hashes against full recompute; done
+		//	after every move in debug builds.
+		//		return SUCCESS: 0 if hashes match
+		//		return FAILURE: -2 if any hash differs
+		int VerifyBoards() const;
+
+		// VerifyHash
+		//	Compare player's hash against recorded hash at sequence.
+		//		param sequence: sequence hash was taken at
+		//		param player: player index
+		//		param hash: player's hash
+		//		return SUCCESS: 0 if hashes match
+		//		return WARNING: +1 if no hash is recorded for sequence
+		//		return FAILURE: -2 if hashes differ
+		int VerifyHash(unsigned int const sequence, unsigned char const player, unsigned long long const hash) const;
+
+		// IsOver
+		//	Check if game has ended.
+		//		return: has game ended
+		bool IsOver() const;
+
+		// IsCheck
+		//	Check if hashes should be compared at current sequence.
+		//		return: is sequence a check sequence
+		bool IsCheck() const;
+
+		// GetGame, GetSequence, GetTurn, HasBoard
+		//	Get session state.
+		eLockstepGame GetGame() const;
+		unsigned int GetSequence() const;
+		unsigned char GetTurn() const;
+		bool HasBoard(unsigned char const player) const;
+
+		// GetCheckers, GetMancala, GetBattleship
+		//	Get boards.
+		gpro_checkers const& GetCheckers() const;
+		gpro_mancala const& GetMancala() const;
+		gpro_battleship const& GetBattleship(unsigned char const player) const;
+
+		// WriteMove
+		//	Write move in minimum bits for game.
+		//		param bitstream: packet data in bitstream
+		//		param move: move to write
+		//		return: bitstream
+		RakNet::BitStream& WriteMove(RakNet::BitStream& bitstream, sLockstepMove const& move) const;
+
+		// ReadMove
+		//	Read move written with WriteMove.
+		//		param bitstream: packet data in bitstream
+		//		param move_out: move read
+		//		return: was move read
+		bool ReadMove(RakNet::BitStream& bitstream, sLockstepMove& move_out) const;
+
+		// WriteState
+		//	Write full state as seen by player, for resynchronization.
+		//		param bitstream: packet data in bitstream
+		//		param player: player index
+		//		return: bitstream
+		RakNet::BitStream& WriteState(RakNet::BitStream& bitstream, unsigned char const player) const;
+
+		// ReadState
+		//	Replace state with state written with WriteState; recorded
+		//	hashes are discarded.
+		//		param bitstream: packet data in bitstream
+		//		param player: player index state was written for
+		//		return: was state read
+		bool ReadState(RakNet::BitStream& bitstream, unsigned char const player);
+
+		// Save
+		//	Copy full state, including both battleship boards held.
+		//		param record_out: record to fill
+		void Save(sLockstepRecord& record_out) const;
+
+		// Load
+		//	Replace state with saved state; recorded hashes are discarded.
+		//		param record: record written with Save
+		//		return: was record valid
+		bool Load(sLockstepRecord const& record);
+
+		// WriteBoard
+		//	Write ship placement of battleship board.
+		//		param bitstream: packet data in bitstream
+		//		param board: board to write
+		//		return: bitstream
+		static RakNet::BitStream& WriteBoard(RakNet::BitStream& bitstream, gpro_battleship const board);
+
+		// ReadBoard
+		//	Read ship placement written with WriteBoard.
+		//		param bitstream: packet data in bitstream
+		//		param board_out: board read
+		//		return: was board read
+		static bool ReadBoard(RakNet::BitStream& bitstream, gpro_battleship board_out);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_LOCKSTEP_HPP_
\ No newline at end of file
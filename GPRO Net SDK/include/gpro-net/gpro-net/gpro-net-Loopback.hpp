@@ -0,0 +1,263 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Loopback.hpp
+	Header for in-process loopback transport.
+*/
+
+#ifndef _GPRO_NET_LOOPBACK_HPP_
+#define _GPRO_NET_LOOPBACK_HPP_
+#ifdef __cplusplus
+
+
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "gpro-net/gpro-net/gpro-net-Transport.hpp"
+#include "RakNet/GetTime.h"
+
+
+namespace gproNet
+{
+	class cTransportLoopback;
+
+
+	// cLoopbackNetwork
+	//	Shared in-memory network connecting loopback transports in the same
+	//	process; peers are addressed by port on 127.0.0.1.
+	class cLoopbackNetwork
+	{
+		friend class cTransportLoopback;
+
+		// protected data
+	protected:
+		// mutex
+		//	Guards all endpoints and queues on this network.
+		std::mutex mutex;
+
+		// endpoints
+		//	Started transports on this network.
+		std::vector<cTransportLoopback*> endpoints;
+
+		// time
+		//	Current time if clock is manual.
+		RakNet::Time time;
+
+		// manualClock
+		//	Time only moves when advanced; makes delivery deterministic.
+		bool manualClock;
+
+		// sequence
+		//	Counter for message numbers and stable delivery order.
+		unsigned int sequence;
+
+		// nextPort
+		//	Next port to assign to transports started on port 0.
+		unsigned short nextPort;
+
+		// protected methods
+	protected:
+		// FindEndpoint
+		//	Get transport bound to port; assumes locked.
+		//		param port: port to search for
+		//		return: transport, or null if not found
+		cTransportLoopback* FindEndpoint(unsigned short const port) const;
+
+		// public methods
+	public:
+		// cLoopbackNetwork
+		//	Default constructor.
+		//		param manualClock: only advance time when requested
+		cLoopbackNetwork(bool const manualClock = false);
+
+		// GetTime
+		//	Get current network time.
+		//		return: manual time or RakNet time
+		RakNet::Time GetTime();
+
+		// Advance
+		//	Move manual clock forward.
+		//		param dt: time to advance
+		void Advance(RakNet::Time const dt);
+	};
+
+
+	// cTransportLoopback
+	//	Transport that moves packets through a loopback network in memory,
+	//	with optional artificial latency and loss; reliable packets stay in
+	//	order behind any earlier one that was resent.
+	class cTransportLoopback : public cTransport
+	{
+		friend class cLoopbackNetwork;
+
+		// sQueuedPacket
+		//	Packet waiting for delivery.
+		struct sQueuedPacket
+		{
+			RakNet::Time tDeliver;
+			unsigned int sequence;
+			RakNet::Packet* packet;
+
+			bool operator >(sQueuedPacket const& rh) const;
+		};
+
+		// protected data
+	protected:
+		// network
+		//	Network this transport is attached to.
+		cLoopbackNetwork& network;
+
+		// inbox
+		//	Packets received, ordered by delivery time.
+		std::priority_queue<sQueuedPacket, std::vector<sQueuedPacket>, std::greater<sQueuedPacket>> inbox;
+
+		// connections
+		//	Ports of connected peers.
+		std::vector<unsigned short> connections;
+
+		// incoming
+		//	Whether each connection was made by the peer; only those count
+		//	against incoming connections allowed.
+		std::vector<bool> incoming;
+
+		// latency
+		//	Artificial one-way delay applied to outgoing packets.
+		RakNet::Time latency;
+
+		// loss, resend
+		//	Chance each outgoing packet is lost, and delay each loss adds to
+		//	reliable packets (resent until they arrive).
+		float loss;
+		RakNet::Time resend;
+
+		// lossRandom
+		//	Source of losses; seeded by port, so runs repeat.
+		std::minstd_rand lossRandom;
+
+		// tReliable
+		//	Delivery time of latest reliable packet sent.
+		RakNet::Time tReliable;
+
+		// port, maxConnections, maxIncoming
+		//	Startup settings; port is 0 if not started.
+		unsigned short port, maxConnections, maxIncoming;
+
+		// protected methods
+	protected:
+		// Deliver
+		//	Copy data into packet and queue on a transport; assumes locked.
+		//		param target: receiving transport
+		//		param sender: port packet appears to come from
+		//		param data: packet data
+		//		param length: packet length in bytes
+		//		param delay: delay on top of latency
+		void Deliver(cTransportLoopback* const target, unsigned short const sender, unsigned char const* const data, unsigned int const length, RakNet::Time const delay = 0);
+
+		// DeliverID
+		//	Queue single-byte message identifier from this transport; assumes locked.
+		//		param target: receiving transport
+		//		param msgID: message identifier
+		//		param delay: delay on top of latency
+		void DeliverID(cTransportLoopback* const target, RakNet::MessageID const msgID, RakNet::Time const delay = 0);
+
+		// Lose
+		//	Roll losses for outgoing packet; assumes locked.
+		//		param reliable: is packet resent until it arrives
+		//		param delay_out: delay added by resends
+		//		return: was packet dropped (unreliable only)
+		bool Lose(bool const reliable, RakNet::Time& delay_out);
+
+		// IsConnected
+		//	Check if port is a connected peer.
+		//		param port: peer port
+		//		return: index in connections, or -1 if not connected
+		int IsConnected(unsigned short const port) const;
+
+		// GetIncomingCount
+		//	Get number of connections made by peers.
+		//		return: incoming connection count
+		unsigned int GetIncomingCount() const;
+
+		// RemoveConnection
+		//	Forget connection; assumes locked.
+		//		param index: index in connections
+		void RemoveConnection(int const index);
+
+		// public methods
+	public:
+		// cTransportLoopback
+		//	Construct on network.
+		//		param network: network to attach to
+		//		param latency: artificial one-way delay
+		cTransportLoopback(cLoopbackNetwork& network, RakNet::Time const latency = 0);
+
+		// ~cTransportLoopback
+		//	Destructor.
+		virtual ~cTransportLoopback();
+
+		// SetLatency
+		//	Change artificial one-way delay.
+		//		param latency: delay for subsequent sends
+		void SetLatency(RakNet::Time const latency);
+
+		// SetLoss
+		//	Lose share of outgoing packets: unreliable ones are dropped,
+		//	reliable ones (and connection handshakes) arrive one resend
+		//	interval later for each time they are lost.
+		//		param loss: chance each send is lost, in [0, 1)
+		//		param resend: delay added to reliable packet per loss
+		void SetLoss(float const loss, RakNet::Time const resend = 100);
+
+		// Cut
+		//	Lose everything to and from peer from now on, as a link going
+		//	dark: both sides hear the connection was lost once the timeout
+		//	passes, and may then connect again.
+		//		param address: peer
+		//		param timeout: time until loss is noticed
+		//		return: was peer connected
+		bool Cut(RakNet::SystemAddress const address, RakNet::Time const timeout);
+
+		// GetPort
+		//	Get bound port.
+		//		return: port, or 0 if not started
+		unsigned short GetPort() const;
+
+		// cTransport interface
+		virtual bool Startup(unsigned short const maxConnections, unsigned short const maxIncoming, unsigned short const port);
+		virtual bool Connect(char const host[], unsigned short const port);
+		virtual void Disconnect(RakNet::SystemAddress const address);
+		virtual void Shutdown();
+		virtual RakNet::Packet* Receive();
+		virtual void DeallocatePacket(RakNet::Packet* packet);
+		virtual unsigned int Send(RakNet::BitStream const* bitstream, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::AddressOrGUID const recipient, bool const broadcast);
+		virtual unsigned int Send(unsigned char const data[], unsigned int const length, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::AddressOrGUID const recipient, bool const broadcast);
+		virtual unsigned short GetConnections(RakNet::SystemAddress list_out[], unsigned short const max);
+		virtual unsigned long long GetGUID(RakNet::SystemAddress const address);
+		virtual bool GetStatistics(RakNet::SystemAddress const address, sLinkStatistics& stats_out);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_LOOPBACK_HPP_
\ No newline at end of file
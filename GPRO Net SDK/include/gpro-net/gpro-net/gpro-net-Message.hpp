@@ -0,0 +1,130 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Message.hpp
+	Header for common message types and their schemas.
+*/
+
+#ifndef _GPRO_NET_MESSAGE_HPP_
+#define _GPRO_NET_MESSAGE_HPP_
+#ifdef __cplusplus
+
+
+#include "gpro-net/gpro-net/gpro-net-Schema.hpp"
+
+#include "RakNet/RakNetTypes.h"
+
+
+namespace gproNet
+{
+	// eMessageSize
+	//	Enumeration of fixed message header sizes.
+	enum eMessageSize
+	{
+		// compact timestamp ID, low bits of send time and message ID
+		MESSAGE_HEADER_BYTES = sizeof(RakNet::MessageID) + sizeof(unsigned short) + sizeof(RakNet::MessageID),
+
+		// RakNet timestamp ID, full time and message ID (still read)
+		MESSAGE_HEADER_FULL_BYTES = sizeof(RakNet::MessageID) + sizeof(RakNet::Time) + sizeof(RakNet::MessageID),
+
+		// trace ID, trace and sender's span, before timestamp if traced
+		MESSAGE_TRACE_BYTES = sizeof(RakNet::MessageID) + sizeof(unsigned int) + sizeof(unsigned int),
+	};
+
+
+	// sSpatialPose
+	//	Description of spatial pose.
+	struct sSpatialPose
+	{
+		float scale[3];     // non-uniform scale
+		float rotate[3];    // orientation as Euler angles (radians)
+		float translate[3]; // translation
+
+		// read from stream
+		RakNet::BitStream& Read(RakNet::BitStream& bitstream);
+
+		// write to stream
+		RakNet::BitStream& Write(RakNet::BitStream& bitstream) const;
+	};
+
+	// sSpatialPose quantization
+	//	scale: [-8, 8] in 12 bits (0.004)
+	//	rotate: [-pi, pi] in 12 bits (0.0015 rad)
+	//	translate: [-512, 512] in 20 bits (0.001)
+	typedef sQuantizedCodec<-8, 8, 1, 12> sSpatialPoseScaleCodec;
+	typedef sQuantizedCodec<-31416, 31416, 10000, 12> sSpatialPoseRotateCodec;
+	typedef sQuantizedCodec<-512, 512, 1, 20> sSpatialPoseTranslateCodec;
+	typedef sSchema<
+		sField<&sSpatialPose::scale, sSpatialPoseScaleCodec>,
+		sField<&sSpatialPose::rotate, sSpatialPoseRotateCodec>,
+		sField<&sSpatialPose::translate, sSpatialPoseTranslateCodec>
+	> sSpatialPoseSchema;
+
+	inline RakNet::BitStream& sSpatialPose::Read(RakNet::BitStream& bitstream)
+	{
+		sSpatialPoseSchema::Read(bitstream, *this);
+		return bitstream;
+	}
+
+	inline RakNet::BitStream& sSpatialPose::Write(RakNet::BitStream& bitstream) const
+	{
+		return sSpatialPoseSchema::Write(bitstream, *this);
+	}
+
+
+	// sInputs
+	//	Player input state; much smaller than a pose, but every peer must
+	//	simulate movement from it.
+	struct sInputs
+	{
+		bool w;
+		bool a;
+		bool s;
+		bool d;
+		bool space;
+		bool shoot;
+	};
+
+	typedef sSchema<
+		sField<&sInputs::w, sBoolCodec>,
+		sField<&sInputs::a, sBoolCodec>,
+		sField<&sInputs::s, sBoolCodec>,
+		sField<&sInputs::d, sBoolCodec>,
+		sField<&sInputs::space, sBoolCodec>,
+		sField<&sInputs::shoot, sBoolCodec>
+	> sInputsSchema;
+
+
+	// sTestMessage
+	//	Test greeting message.
+	struct sTestMessage
+	{
+		char text[128];
+	};
+
+	typedef sSchema<
+		sField<&sTestMessage::text, sStringCodec<sizeof(sTestMessage::text) - 1>>
+	> sTestMessageSchema;
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_MESSAGE_HPP_
\ No newline at end of file
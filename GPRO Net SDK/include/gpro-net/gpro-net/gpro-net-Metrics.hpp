@@ -0,0 +1,219 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Metrics.hpp
+	Header for per-message and per-connection metrics.
+*/
+
+#ifndef _GPRO_NET_METRICS_HPP_
+#define _GPRO_NET_METRICS_HPP_
+#ifdef __cplusplus
+
+
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "RakNet/RakNetTypes.h"
+
+
+namespace gproNet
+{
+	// eMetricsSettings
+	//	Enumeration of metrics sizes.
+	enum eMetricsSettings
+	{
+		METRICS_MESSAGE_IDS = 256,			// one slot per possible message ID
+		METRICS_CONNECTIONS = 64,			// connections tracked per thread
+		METRICS_THREADS = 64,				// live threads found without locking
+		METRICS_HISTOGRAM_SUB_BITS = 3,		// 8 sub-buckets per power of 2 (12.5% precision)
+		METRICS_HISTOGRAM_RANGE_BITS = 36,	// values up to 2^36 ns (about 68 s)
+		METRICS_HISTOGRAM_BUCKETS = (METRICS_HISTOGRAM_RANGE_BITS - METRICS_HISTOGRAM_SUB_BITS + 1) << METRICS_HISTOGRAM_SUB_BITS,
+	};
+
+
+	// sMetricsHistogram
+	//	Log-linear (HDR-style) histogram of durations in nanoseconds.
+	struct sMetricsHistogram
+	{
+		// count
+		//	Number of samples in each bucket.
+		unsigned long long count[METRICS_HISTOGRAM_BUCKETS];
+
+		// GetBucket
+		//	Get bucket index for value.
+		//		param value: sample value
+		//		return: bucket index
+		static unsigned int GetBucket(unsigned long long const value);
+
+		// GetBucketValue
+		//	Get lowest value that falls in bucket.
+		//		param bucket: bucket index
+		//		return: bucket lower bound
+		static unsigned long long GetBucketValue(unsigned int const bucket);
+
+		// GetTotal
+		//	Get number of samples.
+		//		return: sum of all buckets
+		unsigned long long GetTotal() const;
+
+		// GetPercentile
+		//	Get approximate value at percentile.
+		//		param percentile: percentile in [0, 100]
+		//		return: lower bound of bucket containing percentile
+		unsigned long long GetPercentile(double const percentile) const;
+	};
+
+
+	// sMessageMetrics
+	//	Totals for one message identifier; bytes saved are header bytes a
+	//	full timestamp would have added to messages sent.
+	struct sMessageMetrics
+	{
+		unsigned long long packetsIn, bytesIn;
+		unsigned long long packetsOut, bytesOut, bytesSaved;
+		sMetricsHistogram handlerTime;
+	};
+
+
+	// sConnectionMetrics
+	//	Totals for one remote peer, and latest send rate decision.
+	struct sConnectionMetrics
+	{
+		RakNet::SystemAddress address;
+		unsigned long long packetsIn, bytesIn;
+		unsigned long long packetsOut, bytesOut;
+		unsigned long long rateDecreases, rateIncreases;
+		unsigned int rateLevel, ping;
+	};
+
+
+	// sMetricsSnapshot
+	//	Merged copy of all metrics at one point in time; large, allocate on heap.
+	struct sMetricsSnapshot
+	{
+		sMessageMetrics message[METRICS_MESSAGE_IDS];
+		sConnectionMetrics connection[METRICS_CONNECTIONS];
+		unsigned int connectionCount;
+
+		// Print
+		//	Print non-empty message and connection rows.
+		//		param file: output stream
+		void Print(FILE* const file) const;
+	};
+
+
+	struct sMetricsBlock;
+
+
+	// cMetrics
+	//	Metrics recorded into per-thread, cache-line aligned counter blocks;
+	//	recording never locks, snapshots may be taken from any thread. Each
+	//	recording thread costs one block of about 300 KB (mostly a handler
+	//	time histogram per message ID), allocated on its first record and
+	//	kept until the metrics are destroyed.
+	class cMetrics
+	{
+		// protected data
+	protected:
+		// mutex
+		//	Guards block list.
+		mutable std::mutex mutex;
+
+		// blocks
+		//	One counter block per recording thread.
+		std::vector<sMetricsBlock*> blocks;
+
+		// threadBlock
+		//	Block of each recording thread by thread slot; threads beyond
+		//	the table share the locked block list.
+		std::atomic<sMetricsBlock*> threadBlock[METRICS_THREADS];
+
+		// protected methods
+	protected:
+		// GetBlock
+		//	Get calling thread's counter block, registering it if new.
+		//		return: thread's block
+		sMetricsBlock& GetBlock();
+
+		// public methods
+	public:
+		// cMetrics
+		//	Default constructor.
+		cMetrics();
+
+		// ~cMetrics
+		//	Destructor.
+		~cMetrics();
+
+		// RecordReceive
+		//	Count received message.
+		//		param msgID: message identifier
+		//		param sender: packet sender
+		//		param bytes: packet size in bytes
+		//		param handlerTime: time spent processing in nanoseconds
+		void RecordReceive(RakNet::MessageID const msgID, RakNet::SystemAddress const& sender, unsigned int const bytes, unsigned long long const handlerTime);
+
+		// RecordSend
+		//	Count sent message.
+		//		param msgID: message identifier
+		//		param recipient: packet recipient; unassigned if broadcast
+		//		param bytes: packet size in bytes
+		//		param saved: header bytes saved by compact timestamp
+		void RecordSend(RakNet::MessageID const msgID, RakNet::SystemAddress const& recipient, unsigned int const bytes, unsigned int const saved = 0);
+
+		// RecordRate
+		//	Record send rate decision for connection.
+		//		param address: remote peer
+		//		param level: current rate level (0 is full rate)
+		//		param change: change in level this decision (positive if slower)
+		//		param ping: round trip time decision was based on
+		void RecordRate(RakNet::SystemAddress const& address, unsigned int const level, int const change, unsigned int const ping);
+
+		// ForgetConnection
+		//	Release connection slots of disconnected peer in all blocks;
+		//	owning threads reuse them for new peers.
+		//		param address: remote peer
+		void ForgetConnection(RakNet::SystemAddress const& address);
+
+		// Snapshot
+		//	Merge all thread blocks without stopping recording.
+		//		param snapshot_out: merged totals
+		void Snapshot(sMetricsSnapshot& snapshot_out) const;
+	};
+
+
+	// GetThreadSlot
+	//	Get small index of calling thread, unique among live threads; index
+	//	of an exited thread is given to the next new thread.
+	//		return: thread slot
+	unsigned int GetThreadSlot();
+
+	// GetProcessMemory
+	//	Get memory the process holds resident (working set).
+	//		return: bytes, or 0 if not available on platform
+	unsigned long long GetProcessMemory();
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_METRICS_HPP_
\ No newline at end of file
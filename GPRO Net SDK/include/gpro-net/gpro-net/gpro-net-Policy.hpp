@@ -0,0 +1,97 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Policy.hpp
+	Header for per-message send policies.
+*/
+
+#ifndef _GPRO_NET_POLICY_HPP_
+#define _GPRO_NET_POLICY_HPP_
+#ifdef __cplusplus
+
+
+#include "RakNet/PacketPriority.h"
+#include "RakNet/RakNetTypes.h"
+
+
+namespace gproNet
+{
+	// eChannel
+	//	Enumeration of ordering channels; each channel orders and sequences
+	//	independently, so streams on one never block another.
+	enum eChannel
+	{
+		CHANNEL_DEFAULT,	// connection and test messages
+		CHANNEL_GAME,		// reliable game moves and state
+		CHANNEL_STREAM,		// high-rate replicated state (poses)
+		CHANNEL_INPUT,		// player inputs
+		CHANNEL_CHAT,		// text
+	};
+
+
+	// sMessagePolicy
+	//	How a message type is sent.
+	struct sMessagePolicy
+	{
+		RakNet::MessageID msgID;
+		PacketPriority priority;
+		PacketReliability reliability;
+		char orderingChannel;
+	};
+
+
+	// cMessagePolicyTable
+	//	Lookup of send policy by message identifier, built from declarative
+	//	lists of policies; unlisted messages use the default.
+	class cMessagePolicyTable
+	{
+		// protected data
+	protected:
+		// policy
+		//	Policy for every possible message identifier.
+		sMessagePolicy policy[256];
+
+		// public methods
+	public:
+		// cMessagePolicyTable
+		//	Construct with default for every message.
+		//		param priority: default priority
+		//		param reliability: default reliability
+		//		param orderingChannel: default ordering channel
+		cMessagePolicyTable(PacketPriority const priority, PacketReliability const reliability, char const orderingChannel);
+
+		// Set
+		//	Apply list of policies, replacing existing entries.
+		//		param list: policies to apply
+		//		param count: number of policies in list
+		void Set(sMessagePolicy const list[], unsigned int const count);
+
+		// Get
+		//	Get policy for message.
+		//		param msgID: message identifier
+		//		return: policy
+		sMessagePolicy const& Get(RakNet::MessageID const msgID) const;
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_POLICY_HPP_
\ No newline at end of file
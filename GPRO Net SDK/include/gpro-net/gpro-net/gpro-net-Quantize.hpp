@@ -0,0 +1,144 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Quantize.hpp
+	Header for batch pose quantization kernels.
+*/
+
+#ifndef _GPRO_NET_QUANTIZE_HPP_
+#define _GPRO_NET_QUANTIZE_HPP_
+#ifdef __cplusplus
+
+
+#include "gpro-net/gpro-net/gpro-net-Message.hpp"
+
+
+namespace gproNet
+{
+	// eQuantizeMode
+	//	Enumeration of batch kernel implementations.
+	enum eQuantizeMode
+	{
+		QUANTIZE_AUTO,		// best supported by processor
+		QUANTIZE_SCALAR,	// portable
+		QUANTIZE_SSE2,		// 4 values per instruction
+		QUANTIZE_AVX2,		// 8 values per instruction
+	};
+
+
+	// sQuantizeRange
+	//	Runtime description of sQuantizedCodec.
+	struct sQuantizeRange
+	{
+		float lower, upper;
+		float toSteps, fromSteps;
+		unsigned int bits;
+	};
+
+	// QuantizeRangeOf
+	//	Get range of codec.
+	//		return: range
+	template<typename codec>
+	constexpr sQuantizeRange QuantizeRangeOf()
+	{
+		return sQuantizeRange{ codec::lower, codec::upper, codec::toSteps, codec::fromSteps, codec::bits };
+	}
+
+
+	// SetQuantizeMode
+	//	Select batch kernels; unsupported modes fall back to the best
+	//	supported one.
+	//		param mode: kernel implementation
+	//		return: mode in use
+	eQuantizeMode SetQuantizeMode(eQuantizeMode const mode);
+
+	// GetQuantizeMode
+	//	Get batch kernels in use.
+	//		return: mode in use
+	eQuantizeMode GetQuantizeMode();
+
+	// QuantizeBatch
+	//	Clamp and convert values to step indices exactly as
+	//	sQuantizedCodec::Quantize does.
+	//		param values: input values
+	//		param count: number of values
+	//		param range: codec range
+	//		param steps_out: step index of each value
+	void QuantizeBatch(float const values[], unsigned int const count, sQuantizeRange const& range, unsigned int steps_out[]);
+
+	// DequantizeBatch
+	//	Convert step indices back to values exactly as
+	//	sQuantizedCodec::Dequantize does.
+	//		param steps: input step indices
+	//		param count: number of values
+	//		param range: codec range
+	//		param values_out: value of each step index
+	void DequantizeBatch(unsigned int const steps[], unsigned int const count, sQuantizeRange const& range, float values_out[]);
+
+
+	// GetPoseBatchBytes
+	//	Get packed size of poses.
+	//		param count: number of poses
+	//		return: size in bytes
+	inline unsigned int GetPoseBatchBytes(unsigned int const count)
+	{
+		return (count * sSpatialPoseSchema::maxBits + 7) / 8;
+	}
+
+	// EncodePoseBatch
+	//	Quantize and pack structure-of-arrays poses; the bits are identical
+	//	to writing each pose in turn with sSpatialPose::Write.
+	//		param scale: three arrays (x, y, z) of count values
+	//		param rotate: three arrays (x, y, z) of count values
+	//		param translate: three arrays (x, y, z) of count values
+	//		param count: number of poses
+	//		param data_out: packed data; must hold GetPoseBatchBytes(count)
+	//		return: number of bits written
+	unsigned int EncodePoseBatch(float const* const scale[3], float const* const rotate[3], float const* const translate[3], unsigned int const count, unsigned char data_out[]);
+
+	// DecodePoseBatch
+	//	Unpack and dequantize poses written by EncodePoseBatch (or by
+	//	sSpatialPose::Write) into structure-of-arrays poses.
+	//		param data: packed data of GetPoseBatchBytes(count)
+	//		param count: number of poses
+	//		param scale_out: three arrays (x, y, z) of count values
+	//		param rotate_out: three arrays (x, y, z) of count values
+	//		param translate_out: three arrays (x, y, z) of count values
+	void DecodePoseBatch(unsigned char const data[], unsigned int const count, float* const scale_out[3], float* const rotate_out[3], float* const translate_out[3]);
+
+	// WritePoseBatch
+	//	Encode poses into bitstream at its current position.
+	//		param bitstream: packet data in bitstream
+	//		(other params as EncodePoseBatch)
+	//		return: bitstream
+	RakNet::BitStream& WritePoseBatch(RakNet::BitStream& bitstream, float const* const scale[3], float const* const rotate[3], float const* const translate[3], unsigned int const count);
+
+	// ReadPoseBatch
+	//	Decode poses from bitstream at its current position.
+	//		param bitstream: packet data in bitstream
+	//		(other params as DecodePoseBatch)
+	//		return: were there enough bits
+	bool ReadPoseBatch(RakNet::BitStream& bitstream, unsigned int const count, float* const scale_out[3], float* const rotate_out[3], float* const translate_out[3]);
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_QUANTIZE_HPP_
\ No newline at end of file
@@ -37,6 +37,18 @@
 #include "RakNet/RakNetTypes.h"
 #include "RakNet/GetTime.h"
 
+#include "gpro-net/gpro-net/gpro-net-Transport.hpp"
+#include "gpro-net/gpro-net/gpro-net-Trace.hpp"
+#include "gpro-net/gpro-net/gpro-net-Metrics.hpp"
+#include "gpro-net/gpro-net/gpro-net-Span.hpp"
+#include "gpro-net/gpro-net/gpro-net-Message.hpp"
+#include "gpro-net/gpro-net/gpro-net-Policy.hpp"
+#include "gpro-net/gpro-net/gpro-net-Lockstep.hpp"
+#include "gpro-net/gpro-net/gpro-net-Chat.hpp"
+#include "gpro-net/gpro-net/gpro-net-SharedMessage.hpp"
+#include "gpro-net/gpro-net/gpro-net-BitStreamPool.hpp"
+#include "gpro-net/gpro-net/gpro-net-Task.hpp"
+
 
 namespace gproNet
 {
@@ -44,7 +56,9 @@ namespace gproNet
 	//	Enumeration of common settings.
 	enum eSettings
 	{
+		SET_GPRO_ROUTER_PORT = 7700,
 		SET_GPRO_SERVER_PORT = 7777,
+		SET_GPRO_RELAY_PORT = 7800,
 	};
 
 
@@ -54,12 +68,36 @@ namespace gproNet
 	{
 		ID_GPRO_MESSAGE_COMMON_BEGIN = ID_USER_PACKET_ENUM,
 
-
+		ID_GPRO_MESSAGE_SPATIAL_POSE,	// sSpatialPose stream
+		ID_GPRO_MESSAGE_INPUTS,			// sInputs stream
+		ID_GPRO_MESSAGE_GAME_MOVE,		// turn-based game move
+		ID_GPRO_MESSAGE_ENTITY_UPDATE,	// changed entity poses
+		ID_GPRO_MESSAGE_ENTITY_DESTROY,	// destroyed entity identifiers
+		ID_GPRO_MESSAGE_ENTITY_HIT,		// sEntityHit, to shooter and target
+		ID_GPRO_MESSAGE_GAME_JOIN,		// request to play turn-based game
+		ID_GPRO_MESSAGE_GAME_START,		// turn-based game and player index
+		ID_GPRO_MESSAGE_GAME_SETUP,		// private board placement, or every board placed
+		ID_GPRO_MESSAGE_GAME_HASH,		// lockstep state hash
+		ID_GPRO_MESSAGE_GAME_RESYNC,	// full lockstep state, or request for it
+		ID_GPRO_MESSAGE_CHAT,			// chat post, or batch of room's messages
+		ID_GPRO_MESSAGE_SPECTATE,		// request to watch instead of play
+		ID_GPRO_MESSAGE_ROUTE,			// match key to route, or shard to move to
+		ID_GPRO_MESSAGE_SHARD_LOAD,		// shard's port, load and capacity
+		ID_GPRO_MESSAGE_RESUME,			// resume token issued, or presented on reconnecting
+		ID_GPRO_MESSAGE_TIMESTAMP,		// compact timestamp header (low 16 bits of send time)
+		ID_GPRO_MESSAGE_TRACE,			// trace header (trace and sender's span) before timestamp
 
 		ID_GPRO_MESSAGE_COMMON_END
 	};
 
 
+	// commonMessagePolicy
+	//	Send policy of common messages; unlisted messages are sent with
+	//	medium priority, unreliable sequenced, on the default channel.
+	extern sMessagePolicy const commonMessagePolicy[];
+	extern unsigned int const commonMessagePolicyCount;
+
+
 	// cRakNetManager
 	//	Base class for RakNet peer management.
 	class cRakNetManager abstract
@@ -67,15 +105,68 @@ namespace gproNet
 		// protected data
 	protected:
 		// peer
-		//	Pointer to RakNet peer instance.
-		RakNet::RakPeerInterface* peer;
+		//	Pointer to transport instance (RakNet peer by default).
+		cTransport* peer;
+
+		// ownsPeer
+		//	Transport was created by and is released with this manager.
+		bool ownsPeer;
+
+		// capture
+		//	Optional trace receiving a copy of every packet received.
+		cTraceWriter* capture;
+
+		// metrics
+		//	Per-message and per-connection traffic and handler timing.
+		cMetrics metrics;
+
+		// spans
+		//	Optional span recorder; null if not recording.
+		cSpanRecorder* spans;
+
+		// spansTracedOnly
+		//	Record only spans belonging to a trace.
+		bool spansTracedOnly;
+
+		// traceContext
+		//	Trace that messages written now belong to: the interaction begun
+		//	here, or the one of the message being handled.
+		sSpanContext traceContext;
+
+		// traceStart
+		//	Start time of interaction begun here.
+		unsigned long long traceStart;
+
+		// tracedCount
+		//	Number of traced messages handled.
+		unsigned int tracedCount;
+
+		// policy
+		//	Send priority, reliability and channel of each message type;
+		//	derived managers add their own messages on construction.
+		cMessagePolicyTable policy;
+
+		// connectionList
+		//	Addresses of connected peers (scratch for sends with exclusions).
+		std::vector<RakNet::SystemAddress> connectionList;
+
+		// tasks
+		//	Session tasks; each message is seen by tasks waiting for it after
+		//	its handler, and each pass of the message loop is one tick.
+		cTaskScheduler tasks;
 
 		// protected methods
 	protected:
 		// cRakNetManager
-		//	Default constructor.
+		//	Default constructor; uses RakNet transport.
 		cRakNetManager();
 
+		// cRakNetManager
+		//	Construct using external transport (e.g. loopback).
+		//		param transport: transport to use, owned by caller; null
+		//			for RakNet transport owned by manager
+		cRakNetManager(cTransport* const transport);
+
 		// ~cRakNetManager
 		//	Destructor.
 		virtual ~cRakNetManager();
@@ -89,23 +180,140 @@ namespace gproNet
 		virtual bool ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID);
 
 		// WriteTimestamp
-		//	Write timestamp ID and current time.
+		//	Write compact timestamp ID and low 16 bits of current time,
+		//	preceded by trace header if writing within a trace.
 		//		param bitstream: packet data in bitstream
 		//		return: bitstream
 		RakNet::BitStream& WriteTimestamp(RakNet::BitStream& bitstream);
 
 		// ReadTimestamp
-		//	Read timestamp ID and current time.
+		//	Read timestamp ID and send time.
 		//		param bitstream: packet data in bitstream
+		//		param sender: packet sender
 		//		return: bitstream
-		RakNet::BitStream& ReadTimestamp(RakNet::BitStream& bitstream, RakNet::Time& dtSendToReceive_out, RakNet::MessageID& msgID_out);
+		RakNet::BitStream& ReadTimestamp(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time& dtSendToReceive_out, RakNet::MessageID& msgID_out);
+
+		// ReadTimestamp
+		//	Read timestamp ID relative to known receive time; compact send
+		//	time is taken as the full time nearest the sender's clock at
+		//	receive time, so it comes out whole within 32767 ms either side
+		//	of it (delays from -32767 to 32768 ms). Longer delays alias by
+		//	multiples of 65536 ms, and error in the clock differential moves
+		//	the window with it. Full RakNet timestamps are read as before.
+		//		param bitstream: packet data in bitstream
+		//		param sender: packet sender
+		//		param tReceive: local time packet was received
+		//		return: bitstream
+		RakNet::BitStream& ReadTimestamp(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const tReceive, RakNet::Time& dtSendToReceive_out, RakNet::MessageID& msgID_out);
+
+		// Send
+		//	Send bitstream through transport and record outgoing metrics.
+		//		param bitstream: packet data in bitstream
+		//		param priority: send priority
+		//		param reliability: send reliability
+		//		param orderingChannel: ordering channel index
+		//		param recipient: receiving peer; excluded peer if broadcasting
+		//		param broadcast: send to all connected peers
+		//		return: message number, or 0 if not sent
+		unsigned int Send(RakNet::BitStream const& bitstream, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::SystemAddress const recipient, bool const broadcast);
+
+		// Send
+		//	Send serialized data through transport and record outgoing metrics.
+		//		param data: packet data
+		//		param length: packet length in bytes
+		//		param priority: send priority
+		//		param reliability: send reliability
+		//		param orderingChannel: ordering channel index
+		//		param recipient: receiving peer; excluded peer if broadcasting
+		//		param broadcast: send to all connected peers
+		//		return: message number, or 0 if not sent
+		unsigned int Send(unsigned char const data[], unsigned int const length, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::SystemAddress const recipient, bool const broadcast);
+
+		// Send
+		//	Send bitstream using policy of its message type.
+		//		param bitstream: packet data in bitstream
+		//		param recipient: receiving peer; excluded peer if broadcasting
+		//		param broadcast: send to all connected peers
+		//		return: message number, or 0 if not sent
+		unsigned int Send(RakNet::BitStream const& bitstream, RakNet::SystemAddress const recipient, bool const broadcast);
+
+		// Send
+		//	Send shared message using policy of its message type.
+		//		param message: serialized message
+		//		param recipient: receiving peer; excluded peer if broadcasting
+		//		param broadcast: send to all connected peers
+		//		return: message number, or 0 if not sent
+		unsigned int Send(cSharedMessage const& message, RakNet::SystemAddress const recipient, bool const broadcast);
+
+		// SendToList
+		//	Send shared message to each listed peer; nothing is encoded again
+		//	however many peers there are.
+		//		param message: serialized message
+		//		param recipient: receiving peers
+		//		param count: number of receiving peers
+		//		return: number of peers sent to
+		unsigned int SendToList(cSharedMessage const& message, RakNet::SystemAddress const recipient[], unsigned int const count);
+
+		// SendToList
+		//	Send bitstream to each listed peer; for messages written and sent
+		//	at once, where a shared copy would only cost an allocation.
+		//		param bitstream: packet data in bitstream
+		//		param recipient: receiving peers
+		//		param count: number of receiving peers
+		//		return: number of peers sent to
+		unsigned int SendToList(RakNet::BitStream const& bitstream, RakNet::SystemAddress const recipient[], unsigned int const count);
+
+		// SendToAll
+		//	Send shared message to every connected peer except those listed;
+		//	one broadcast if at most one is excluded.
+		//		param message: serialized message
+		//		param exclude: peers not to send to
+		//		param excludeCount: number of peers not to send to
+		//		return: number of sends made (a broadcast counts once)
+		unsigned int SendToAll(cSharedMessage const& message, RakNet::SystemAddress const exclude[], unsigned int const excludeCount);
+
+		// PeekHeaderBytes
+		//	Get size of packet's trace header, timestamp (either form) and
+		//	message ID.
+		//		param data: packet data
+		//		param length: packet length in bytes
+		//		return: header size in bytes
+		static unsigned int PeekHeaderBytes(unsigned char const* const data, unsigned int const length);
+
+		// PeekMessageID
+		//	Get message identifier of packet data, skipping trace header and
+		//	timestamp.
+		//		param data: packet data
+		//		param length: packet length in bytes
+		//		return: message identifier
+		static RakNet::MessageID PeekMessageID(unsigned char const* const data, unsigned int const length);
+
+		// Restamp
+		//	Rewrite packet's timestamp (either form) in place as local send
+		//	time, for forwarding on this peer's clock.
+		//		param data: packet data
+		//		param length: packet length in bytes
+		//		param tSend: local time to stamp
+		//		return: was timestamp found and rewritten
+		static bool Restamp(unsigned char data[], unsigned int const length, RakNet::Time const tSend);
+
+		// ProcessPacket
+		//	Unpack packet header and process message; messages sent while
+		//	processing carry the packet's trace.
+		//		param data: packet data
+		//		param length: packet length in bytes
+		//		param sender: packet sender
+		//		param tReceive: local time packet was received
+		//		return: was message processed
+		bool ProcessPacket(unsigned char* const data, unsigned int const length, RakNet::SystemAddress const sender, RakNet::Time const tReceive);
 
 		// WriteTest
 		//	Write test greeting message.
 		//		param bitstream: packet data in bitstream
 		//		param message: message string
+		//		param timestamp: write timestamp (not for cached messages)
 		//		return: bitstream
-		RakNet::BitStream& WriteTest(RakNet::BitStream& bitstream, char const message[]);
+		RakNet::BitStream& WriteTest(RakNet::BitStream& bitstream, char const message[], bool const timestamp = true);
 
 		// ReadTest
 		//	Read test greeting message.
@@ -119,6 +327,52 @@ namespace gproNet
 		//	Unpack and process packets.
 		//		return: number of messages processed
 		int MessageLoop();
+
+		// SetCapture
+		//	Capture every received packet to trace.
+		//		param trace: open trace writer, or null to stop capturing
+		void SetCapture(cTraceWriter* const trace);
+
+		// SetSpans
+		//	Record spans of message loop passes, message transit and
+		//	handling, and sends.
+		//		param recorder: span recorder, or null to stop recording
+		//		param tracedOnly: record only spans belonging to a trace
+		void SetSpans(cSpanRecorder* const recorder, bool const tracedOnly = true);
+
+		// BeginTrace
+		//	Begin traced interaction: messages written until EndTrace carry
+		//	its trace, and so do messages sent by peers while handling them.
+		//		return: trace identifier, or 0 if not recording spans
+		unsigned int BeginTrace();
+
+		// EndTrace
+		//	End traced interaction and record its span.
+		void EndTrace();
+
+		// Replay
+		//	Feed captured packets back through message processing.
+		//		param trace: open trace reader
+		//		param realTime: pace packets as captured (1x), or run as fast
+		//			as possible if false
+		//		return: number of messages processed
+		int Replay(cTraceReader& trace, bool const realTime);
+
+		// GetTasks
+		//	Get session tasks resumed by message loop.
+		//		return: task scheduler
+		cTaskScheduler& GetTasks();
+
+		// GetMetrics
+		//	Get metrics; safe to snapshot while message loop runs.
+		//		return: metrics
+		cMetrics const& GetMetrics() const;
+
+		// GetMessagePolicy
+		//	Get send policy of message type.
+		//		param msgID: message identifier
+		//		return: policy
+		sMessagePolicy const& GetMessagePolicy(RakNet::MessageID const msgID) const;
 	};
 
 }
@@ -0,0 +1,300 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Schema.hpp
+	Header for compile-time message schemas and bit-packed serialization.
+*/
+
+#ifndef _GPRO_NET_SCHEMA_HPP_
+#define _GPRO_NET_SCHEMA_HPP_
+#ifdef __cplusplus
+
+
+#include <string.h>
+#include <type_traits>
+
+#include "RakNet/BitStream.h"
+
+
+namespace gproNet
+{
+	// BitsFor
+	//	Number of bits needed to store all values from 0 to maximum.
+	//		param maximum: largest value
+	//		return: bit count
+	constexpr unsigned int BitsFor(unsigned long long const maximum)
+	{
+		return maximum ? (1 + BitsFor(maximum >> 1)) : 0;
+	}
+
+	// WriteBitsValue
+	//	Write low bits of unsigned value (little-endian, as RakNet ranges).
+	//		param bitstream: packet data in bitstream
+	//		param value: value to write
+	//		param bits: number of low bits to write
+	inline void WriteBitsValue(RakNet::BitStream& bitstream, unsigned int const value, unsigned int const bits)
+	{
+		if (bits)
+			bitstream.WriteBits((unsigned char const*)&value, bits, true);
+	}
+
+	// ReadBitsValue
+	//	Read unsigned value written with WriteBitsValue.
+	//		param bitstream: packet data in bitstream
+	//		param value_out: value read
+	//		param bits: number of bits to read
+	//		return: were there enough bits
+	inline bool ReadBitsValue(RakNet::BitStream& bitstream, unsigned int& value_out, unsigned int const bits)
+	{
+		value_out = 0;
+		return !bits || bitstream.ReadBits((unsigned char*)&value_out, bits, true);
+	}
+
+
+	// sBitsCodec
+	//	Unsigned integer stored in fixed number of bits.
+	template<unsigned int count>
+	struct sBitsCodec
+	{
+		static_assert(count > 0 && count <= 32, "bit count must be 1 to 32");
+		static constexpr unsigned int bits = count;
+
+		template<typename type>
+		static void Write(RakNet::BitStream& bitstream, type const value)
+		{
+			WriteBitsValue(bitstream, (unsigned int)value, bits);
+		}
+		template<typename type>
+		static bool Read(RakNet::BitStream& bitstream, type& value_out)
+		{
+			unsigned int value;
+			bool const result = ReadBitsValue(bitstream, value, bits);
+			value_out = (type)value;
+			return result;
+		}
+	};
+
+	// sBoolCodec
+	//	Flag stored in one bit.
+	struct sBoolCodec
+	{
+		static constexpr unsigned int bits = 1;
+
+		static void Write(RakNet::BitStream& bitstream, bool const value)
+		{
+			WriteBitsValue(bitstream, value ? 1 : 0, bits);
+		}
+		static bool Read(RakNet::BitStream& bitstream, bool& value_out)
+		{
+			unsigned int value;
+			bool const result = ReadBitsValue(bitstream, value, bits);
+			value_out = (value != 0);
+			return result;
+		}
+	};
+
+	// sRangeCodec
+	//	Integer in closed range stored as offset in minimum bits; values
+	//	outside range are clamped.
+	template<long long minimum, long long maximum>
+	struct sRangeCodec
+	{
+		static_assert(minimum <= maximum && BitsFor((unsigned long long)(maximum - minimum)) <= 32, "range must fit in 32 bits");
+		static constexpr unsigned int bits = BitsFor((unsigned long long)(maximum - minimum));
+
+		template<typename type>
+		static void Write(RakNet::BitStream& bitstream, type const value)
+		{
+			long long const v = (long long)value;
+			WriteBitsValue(bitstream, (unsigned int)((v < minimum ? minimum : v > maximum ? maximum : v) - minimum), bits);
+		}
+		template<typename type>
+		static bool Read(RakNet::BitStream& bitstream, type& value_out)
+		{
+			unsigned int value;
+			bool const result = ReadBitsValue(bitstream, value, bits) && value <= (unsigned long long)(maximum - minimum);
+			value_out = (type)((long long)value + minimum);
+			return result;
+		}
+	};
+
+	// sQuantizedCodec
+	//	Float in range [minimum / denominator, maximum / denominator]
+	//	quantized to evenly spaced steps; values outside range are clamped.
+	template<long long minimum, long long maximum, unsigned int denominator, unsigned int count>
+	struct sQuantizedCodec
+	{
+		static_assert(minimum < maximum && denominator > 0, "range must not be empty");
+		static_assert(count > 0 && count <= 24, "bit count must be 1 to 24 to stay exact in float");
+		static constexpr unsigned int bits = count;
+		static constexpr unsigned int steps = (1u << count) - 1;
+		static constexpr float lower = (float)minimum / (float)denominator;
+		static constexpr float upper = (float)maximum / (float)denominator;
+		static constexpr float toSteps = (float)steps / (upper - lower);
+		static constexpr float fromSteps = (upper - lower) / (float)steps;
+
+		// Quantize
+		//	Clamp and convert to step index; NaN maps to lower bound.
+		static unsigned int Quantize(float value)
+		{
+			value = value > lower ? value : lower;
+			value = value < upper ? value : upper;
+			return (unsigned int)((value - lower) * toSteps + 0.5f);
+		}
+		// Dequantize
+		//	Convert step index back to value.
+		static float Dequantize(unsigned int const value)
+		{
+			return (float)value * fromSteps + lower;
+		}
+
+		static void Write(RakNet::BitStream& bitstream, float const value)
+		{
+			WriteBitsValue(bitstream, Quantize(value), bits);
+		}
+		static bool Read(RakNet::BitStream& bitstream, float& value_out)
+		{
+			unsigned int value;
+			bool const result = ReadBitsValue(bitstream, value, bits);
+			value_out = Dequantize(value);
+			return result;
+		}
+	};
+
+	// sStringCodec
+	//	Bounded string stored as length and raw characters; longer strings
+	//	are truncated. Read buffer must hold capacity + 1 characters.
+	template<unsigned int capacity>
+	struct sStringCodec
+	{
+		static constexpr unsigned int lengthBits = BitsFor(capacity);
+		static constexpr unsigned int bits = lengthBits + capacity * 8;
+
+		static void Write(RakNet::BitStream& bitstream, char const* const value)
+		{
+			unsigned int length = 0;
+			while (length < capacity && value[length])
+				++length;
+			WriteBitsValue(bitstream, length, lengthBits);
+			if (length)
+				bitstream.WriteBits((unsigned char const*)value, length * 8, true);
+		}
+		static bool Read(RakNet::BitStream& bitstream, char* const value_out)
+		{
+			unsigned int length;
+			if (ReadBitsValue(bitstream, length, lengthBits) && length <= capacity &&
+				(!length || bitstream.ReadBits((unsigned char*)value_out, length * 8, true)))
+			{
+				value_out[length] = 0;
+				return true;
+			}
+			value_out[0] = 0;
+			return false;
+		}
+	};
+
+
+	// sMemberTraits
+	//	Owner and value type of pointer to data member.
+	template<typename member>
+	struct sMemberTraits;
+	template<typename owner_t, typename value_t>
+	struct sMemberTraits<value_t owner_t::*>
+	{
+		typedef owner_t owner;
+		typedef value_t value;
+	};
+
+	// sField
+	//	Schema entry binding data member to codec; array members of scalars
+	//	encode every element with the same codec (character arrays are passed
+	//	whole, for string codecs).
+	template<auto member, typename codec>
+	struct sField
+	{
+		typedef typename sMemberTraits<decltype(member)>::owner owner;
+		typedef typename sMemberTraits<decltype(member)>::value value;
+		static constexpr bool elementwise = std::is_array<value>::value &&
+			!std::is_same<typename std::remove_extent<value>::type, char>::value;
+		static constexpr unsigned int count = elementwise ? (unsigned int)std::extent<value>::value : 1;
+		static constexpr unsigned int bits = codec::bits * count;
+
+		static void Write(RakNet::BitStream& bitstream, owner const& message)
+		{
+			if constexpr (elementwise)
+			{
+				for (unsigned int i = 0; i < count; ++i)
+					codec::Write(bitstream, (message.*member)[i]);
+			}
+			else
+				codec::Write(bitstream, message.*member);
+		}
+		static bool Read(RakNet::BitStream& bitstream, owner& message)
+		{
+			if constexpr (elementwise)
+			{
+				bool result = true;
+				for (unsigned int i = 0; i < count; ++i)
+					result = codec::Read(bitstream, (message.*member)[i]) && result;
+				return result;
+			}
+			else
+				return codec::Read(bitstream, message.*member);
+		}
+	};
+
+	// sSchema
+	//	Ordered list of fields describing a message once; generates matching
+	//	inlined writer and reader and the worst-case encoded size.
+	template<typename... fields>
+	struct sSchema
+	{
+		static constexpr unsigned int maxBits = (0 + ... + fields::bits);
+		static constexpr unsigned int maxBytes = (maxBits + 7) / 8;
+
+		// Write
+		//	Write all fields in order.
+		//		param bitstream: packet data in bitstream
+		//		param message: message to write
+		//		return: bitstream
+		template<typename message_t>
+		static RakNet::BitStream& Write(RakNet::BitStream& bitstream, message_t const& message)
+		{
+			(fields::Write(bitstream, message), ...);
+			return bitstream;
+		}
+
+		// Read
+		//	Read all fields in order.
+		//		param bitstream: packet data in bitstream
+		//		param message: message to read into
+		//		return: were all fields read and in range
+		template<typename message_t>
+		static bool Read(RakNet::BitStream& bitstream, message_t& message)
+		{
+			return (true && ... && fields::Read(bitstream, message));
+		}
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_SCHEMA_HPP_
\ No newline at end of file
@@ -0,0 +1,88 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-SharedMessage.hpp
+	Header for immutable serialized messages shared between sends.
+*/
+
+#ifndef _GPRO_NET_SHAREDMESSAGE_HPP_
+#define _GPRO_NET_SHAREDMESSAGE_HPP_
+#ifdef __cplusplus
+
+
+#include <memory>
+#include <vector>
+
+#include "RakNet/BitStream.h"
+
+
+namespace gproNet
+{
+	// cSharedMessage
+	//	Message serialized once into an immutable, reference-counted
+	//	buffer; copies share the buffer, so one message can be sent to any
+	//	number of peers, cached, or queued without encoding it again.
+	class cSharedMessage
+	{
+		// protected data
+	protected:
+		// data
+		//	Serialized bytes shared by every copy; null if empty.
+		std::shared_ptr<std::vector<unsigned char> const> data;
+
+		// public methods
+	public:
+		// cSharedMessage
+		//	Default constructor; empty message.
+		cSharedMessage();
+
+		// cSharedMessage
+		//	Copy bytes written to bitstream into new shared buffer.
+		//		param bitstream: packet data in bitstream
+		explicit cSharedMessage(RakNet::BitStream const& bitstream);
+
+		// cSharedMessage
+		//	Copy bytes into new shared buffer.
+		//		param data: packet data
+		//		param length: packet length in bytes
+		cSharedMessage(unsigned char const data[], unsigned int const length);
+
+		// IsEmpty
+		//	Check if message has no data.
+		//		return: is message empty
+		bool IsEmpty() const;
+
+		// GetData
+		//	Get serialized bytes.
+		//		return: packet data, or null if empty
+		unsigned char const* GetData() const;
+
+		// GetLength
+		//	Get serialized length.
+		//		return: packet length in bytes
+		unsigned int GetLength() const;
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_SHAREDMESSAGE_HPP_
\ No newline at end of file
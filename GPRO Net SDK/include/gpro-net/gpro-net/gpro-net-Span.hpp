@@ -0,0 +1,188 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Span.hpp
+	Header for trace spans and Chrome trace export.
+*/
+
+#ifndef _GPRO_NET_SPAN_HPP_
+#define _GPRO_NET_SPAN_HPP_
+#ifdef __cplusplus
+
+
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+
+namespace gproNet
+{
+	// eSpanSettings
+	//	Enumeration of span recording sizes.
+	enum eSpanSettings
+	{
+		SPAN_RING = 4096,		// spans kept per thread (power of 2); oldest overwritten
+		SPAN_NAME = 32,			// characters in process name, including terminator
+		SPAN_THREADS = 64,		// live threads found without locking
+	};
+
+
+	// eSpanKind
+	//	Enumeration of what a span measures.
+	enum eSpanKind
+	{
+		SPAN_LOOP,			// message loop pass that handled messages
+		SPAN_TRANSIT,		// send to start of handling (wire and queueing, from timestamp)
+		SPAN_HANDLE,		// message handler and tasks waiting for message
+		SPAN_SEND,			// send helper handing message to transport
+		SPAN_INTERACTION,	// local action begun and ended by the application
+	};
+
+
+	// sSpanContext
+	//	Trace and span that messages written now belong to; carried in
+	//	message headers so the receiver's spans join the same trace.
+	struct sSpanContext
+	{
+		unsigned int trace;	// trace identifier, 0 if untraced
+		unsigned int span;	// span messages are sent from
+	};
+
+
+	// sSpan
+	//	One timed span; times are microseconds on the machine-wide steady
+	//	clock, so spans of processes on one machine share a timeline.
+	struct sSpan
+	{
+		unsigned long long tStart;	// start time
+		unsigned int duration;		// length in microseconds
+		unsigned int trace;			// trace identifier, 0 if untraced
+		unsigned int id;			// span identifier, 0 if nothing follows from it
+		unsigned int parent;		// span this follows from, local or remote
+		unsigned char kind;			// eSpanKind
+		unsigned char msgID;		// message identifier, if any
+		unsigned short thread;		// recording thread's index, set when recorded
+		unsigned int bytes;			// message size in bytes, if any
+	};
+
+
+	struct sSpanRing;
+
+
+	// cSpanRecorder
+	//	Spans recorded into per-thread rings; recording never locks and
+	//	only the newest spans of each thread are kept. Exports Chrome trace
+	//	event JSON (also read by Perfetto) with one process per recorder.
+	class cSpanRecorder
+	{
+		// protected data
+	protected:
+		// mutex
+		//	Guards ring list.
+		mutable std::mutex mutex;
+
+		// rings
+		//	One span ring per recording thread.
+		std::vector<sSpanRing*> rings;
+
+		// threadRing
+		//	Ring of each recording thread by thread slot; threads beyond
+		//	the table are found in the locked ring list.
+		std::atomic<sSpanRing*> threadRing[SPAN_THREADS];
+
+		// process
+		//	Process identifier in exported trace.
+		unsigned int const process;
+
+		// name
+		//	Process name in exported trace.
+		char name[SPAN_NAME];
+
+		// salt
+		//	Random high bits of span identifiers, so processes differ.
+		unsigned int const salt;
+
+		// nextID
+		//	Counter for span and trace identifiers.
+		std::atomic<unsigned int> nextID;
+
+		// protected methods
+	protected:
+		// GetRing
+		//	Get calling thread's ring, registering it if new.
+		//		return: thread's ring
+		sSpanRing& GetRing();
+
+		// public methods
+	public:
+		// cSpanRecorder
+		//	Construct with identity in exported trace.
+		//		param name: process name
+		//		param process: process identifier
+		cSpanRecorder(char const name[], unsigned int const process);
+
+		// ~cSpanRecorder
+		//	Destructor.
+		~cSpanRecorder();
+
+		// GetTime
+		//	Get current span time.
+		//		return: microseconds on steady clock
+		static unsigned long long GetTime();
+
+		// NewID
+		//	Get new span or trace identifier.
+		//		return: non-zero identifier
+		unsigned int NewID();
+
+		// Record
+		//	Record span into calling thread's ring.
+		//		param span: span to record
+		void Record(sSpan const& span);
+
+		// Snapshot
+		//	Copy spans of all threads without stopping recording; spans
+		//	overwritten while copying are left out.
+		//		param spans_out: spans, oldest first per thread
+		//		return: number of spans
+		unsigned int Snapshot(std::vector<sSpan>& spans_out) const;
+
+		// WriteChrome
+		//	Write process's spans as Chrome trace events (continuing list).
+		//		param file: output stream
+		//		param first: no event written to list yet; cleared once written
+		//		return: number of spans written
+		unsigned int WriteChrome(FILE* const file, bool& first) const;
+
+		// ExportChrome
+		//	Export spans of recorders as one Chrome trace JSON file.
+		//		param path: file path
+		//		param recorders: recorders to export (e.g. client and server)
+		//		param count: number of recorders
+		//		return: number of spans written, or -1 if file not opened
+		static int ExportChrome(char const path[], cSpanRecorder const* const recorders[], unsigned int const count);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_SPAN_HPP_
\ No newline at end of file
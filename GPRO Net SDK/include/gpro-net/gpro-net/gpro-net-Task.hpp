@@ -0,0 +1,331 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Task.hpp
+	Header for coroutine session tasks resumed by the message loop.
+*/
+
+#ifndef _GPRO_NET_TASK_HPP_
+#define _GPRO_NET_TASK_HPP_
+#ifdef __cplusplus
+
+
+#include <atomic>
+#include <coroutine>
+#include <vector>
+
+#include "RakNet/BitStream.h"
+#include "RakNet/RakNetTypes.h"
+
+
+namespace gproNet
+{
+	// eTaskSettings
+	//	Enumeration of task settings.
+	enum eTaskSettings
+	{
+		TASK_FRAME_CLASS_MIN = 64,		// smallest pooled frame size
+		TASK_FRAME_CLASS_COUNT = 8,		// each class doubles, up to 8 KiB
+		TASK_WAIT_BUCKETS = 256,		// message waits hashed by sender and message
+	};
+
+	// eTaskWait
+	//	Enumeration of things a task can wait for.
+	enum eTaskWait
+	{
+		TASK_WAIT_MESSAGE,	// message, optionally from one sender, with optional timeout
+		TASK_WAIT_TIME,		// time to pass
+		TASK_WAIT_TICK,		// next pass of the message loop
+	};
+
+
+	// cTaskFramePool
+	//	Free lists of coroutine frames by power-of-two size class, one pool
+	//	per thread; tasks started over and over reuse the same frames.
+	class cTaskFramePool
+	{
+		// protected data
+	protected:
+		// freeList
+		//	Frames ready for reuse in each size class.
+		std::vector<void*> freeList[TASK_FRAME_CLASS_COUNT];
+
+		// allocations
+		//	Frames created by this pool (or too large to pool).
+		unsigned long long allocations;
+
+		// totalAllocations
+		//	Allocations of every thread's pool.
+		static std::atomic<unsigned long long> totalAllocations;
+
+		// protected methods
+	protected:
+		// cTaskFramePool
+		//	Default constructor; pools are only made per thread by GetLocal.
+		cTaskFramePool();
+
+		// GetClass
+		//	Get smallest size class holding size.
+		//		param bytes: size in bytes
+		//		return: size class index, or class count if too large
+		static unsigned int GetClass(size_t const bytes);
+
+		// public methods
+	public:
+		// ~cTaskFramePool
+		//	Destructor; releases pooled frames.
+		~cTaskFramePool();
+
+		// Allocate
+		//	Take frame from free list, creating one only if list is empty.
+		//		param bytes: frame size
+		//		return: frame memory
+		void* Allocate(size_t const bytes);
+
+		// Release
+		//	Return frame to free list.
+		//		param frame: frame from Allocate of any thread's pool
+		//		param bytes: frame size
+		void Release(void* const frame, size_t const bytes);
+
+		// GetAllocationCount
+		//	Get number of frames created by this pool.
+		//		return: count
+		unsigned long long GetAllocationCount() const;
+
+		// GetLocal
+		//	Get calling thread's pool.
+		//		return: pool
+		static cTaskFramePool& GetLocal();
+
+		// GetTotalAllocationCount
+		//	Get allocations of every thread's pool.
+		//		return: count
+		static unsigned long long GetTotalAllocationCount();
+	};
+
+
+	// cTask
+	//	Coroutine run by a task scheduler: a multi-step exchange written as
+	//	one function that waits (co_await) for messages, timeouts and ticks
+	//	of the scheduler. Starts suspended; frame comes from the pool.
+	class cTask
+	{
+		// public types
+	public:
+		struct promise_type
+		{
+			cTask get_return_object();
+			std::suspend_always initial_suspend() noexcept;
+			std::suspend_always final_suspend() noexcept;
+			void return_void();
+			void unhandled_exception();
+
+			static void* operator new(size_t const bytes);
+			static void operator delete(void* const frame, size_t const bytes);
+		};
+
+		// protected data
+	protected:
+		// handle
+		//	Coroutine, until taken by a scheduler.
+		std::coroutine_handle<promise_type> handle;
+
+		// public methods
+	public:
+		// cTask
+		//	Construct owning coroutine.
+		//		param handle: coroutine
+		explicit cTask(std::coroutine_handle<promise_type> const handle);
+
+		// cTask
+		//	Move constructor.
+		//		param task: task to take coroutine from
+		cTask(cTask&& task);
+
+		// ~cTask
+		//	Destructor; destroys coroutine if never started.
+		~cTask();
+
+		// not copyable: only one owner destroys the coroutine
+		cTask(cTask const&) = delete;
+		cTask& operator=(cTask const&) = delete;
+
+		// Release
+		//	Give up ownership of coroutine.
+		//		return: coroutine
+		std::coroutine_handle<> Release();
+	};
+
+
+	// sTaskMessage
+	//	Result of waiting for message: bitstream is positioned after the
+	//	message identifier (and is only valid until the task waits again),
+	//	or null if the wait timed out.
+	struct sTaskMessage
+	{
+		RakNet::BitStream* bitstream;
+		RakNet::SystemAddress sender;
+		RakNet::Time dtSendToReceive;
+	};
+
+
+	class cTaskScheduler;
+
+
+	// sTaskWait
+	//	What a suspended task waits for; awaited directly, so it lives in
+	//	the task's frame and waiting allocates nothing.
+	struct sTaskWait
+	{
+		cTaskScheduler* scheduler;
+		std::coroutine_handle<> task;
+		eTaskWait kind;
+		RakNet::MessageID msgID;
+		RakNet::SystemAddress sender;	// unassigned for any sender
+		RakNet::Time deadline;			// 0 for no timeout
+		sTaskWait* next[2];				// links in message bucket and timer list
+		sTaskWait* prev[2];
+		sTaskMessage result;
+
+		bool await_ready() const noexcept;
+		void await_suspend(std::coroutine_handle<> const handle);
+		sTaskMessage await_resume() const noexcept;
+	};
+
+
+	// cTaskScheduler
+	//	Suspended tasks and what they wait for; the message loop resumes
+	//	them on its own thread as messages arrive and time passes.
+	class cTaskScheduler
+	{
+		// protected data
+	protected:
+		// bucket
+		//	Message waits hashed by sender and message identifier.
+		sTaskWait* bucket[TASK_WAIT_BUCKETS];
+
+		// timed
+		//	Waits with a deadline.
+		sTaskWait* timed;
+
+		// ticking
+		//	Waits for next update.
+		sTaskWait* ticking;
+
+		// waiting
+		//	Number of suspended tasks.
+		unsigned int waiting;
+
+		// protected methods
+	protected:
+		// GetBucket
+		//	Get bucket of message waits.
+		//		param sender: sender waited for, or unassigned for any
+		//		param msgID: message identifier
+		//		return: bucket index
+		static unsigned int GetBucket(RakNet::SystemAddress const& sender, RakNet::MessageID const msgID);
+
+		// Link
+		//	Add suspended task's wait to lists it belongs in.
+		//		param wait: wait
+		void Link(sTaskWait& wait);
+
+		// Unlink
+		//	Remove wait from every list it is in.
+		//		param wait: wait
+		void Unlink(sTaskWait& wait);
+
+		// ResumeList
+		//	Resume every task in chain of unlinked waits, destroying tasks
+		//	that finish.
+		//		param chain: first wait, linked by first link
+		//		return: number resumed
+		unsigned int ResumeList(sTaskWait* chain);
+
+		// Resume
+		//	Resume task, destroying it if it finishes.
+		//		param task: coroutine
+		static void Resume(std::coroutine_handle<> const task);
+
+		// public methods
+	public:
+		// cTaskScheduler
+		//	Default constructor.
+		cTaskScheduler();
+
+		// ~cTaskScheduler
+		//	Destructor; destroys suspended tasks.
+		~cTaskScheduler();
+
+		// Start
+		//	Run task until it first waits.
+		//		param task: task to run; scheduler owns it from here on
+		//		return: is task still running
+		bool Start(cTask task);
+
+		// Receive
+		//	Wait for message (co_await the result).
+		//		param msgID: message identifier
+		//		param sender: sender, or unassigned for any sender
+		//		param timeout: longest wait in milliseconds, or 0 for no limit
+		//		return: awaitable wait
+		sTaskWait Receive(RakNet::MessageID const msgID, RakNet::SystemAddress const sender, RakNet::Time const timeout = 0);
+
+		// Delay
+		//	Wait for time to pass (co_await the result).
+		//		param duration: wait in milliseconds
+		//		return: awaitable wait
+		sTaskWait Delay(RakNet::Time const duration);
+
+		// NextTick
+		//	Wait for next update (co_await the result).
+		//		return: awaitable wait
+		sTaskWait NextTick();
+
+		// Dispatch
+		//	Resume every task waiting for message.
+		//		param bitstream: packet data in bitstream, read up to content
+		//		param sender: packet sender
+		//		param dtSendToReceive: locally-adjusted time difference from sender to receiver
+		//		param msgID: message identifier
+		//		return: number of tasks resumed
+		unsigned int Dispatch(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID);
+
+		// Update
+		//	Resume tasks waiting for next tick and tasks whose time is up.
+		//		param time: current time
+		//		return: number of tasks resumed
+		unsigned int Update(RakNet::Time const time);
+
+		// GetWaitingCount
+		//	Get number of suspended tasks.
+		//		return: count
+		unsigned int GetWaitingCount() const;
+
+		friend struct sTaskWait;
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_TASK_HPP_
\ No newline at end of file
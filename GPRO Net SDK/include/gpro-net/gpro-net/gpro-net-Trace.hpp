@@ -0,0 +1,169 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Trace.hpp
+	Header for packet capture and replay trace files.
+*/
+
+#ifndef _GPRO_NET_TRACE_HPP_
+#define _GPRO_NET_TRACE_HPP_
+#ifdef __cplusplus
+
+
+#include "RakNet/RakNetTypes.h"
+
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-filemap.h"
+
+
+namespace gproNet
+{
+	// sTraceHeader
+	//	Header at start of trace file.
+	struct sTraceHeader
+	{
+		// magic, version: file identification
+		char magic[4];
+		unsigned int version;
+
+		// used: bytes of committed records following header
+		// count: number of committed records
+		unsigned long long used, count;
+	};
+
+
+	// sTraceRecord
+	//	Captured packet; followed by packet data, padded to 8 bytes.
+	struct sTraceRecord
+	{
+		// tReceive: local time packet was received
+		RakNet::Time tReceive;
+
+		// host, port: sender IPv4 address (network order) and port
+		unsigned int host;
+		unsigned short port, reserved;
+
+		// length: packet data length in bytes
+		unsigned int length, reserved2;
+	};
+
+
+	// cTraceWriter
+	//	Append-only packet capture to memory-mapped trace file.
+	class cTraceWriter
+	{
+		// protected data
+	protected:
+		// filemap
+		//	Mapped trace file.
+		gpro_filemap filemap;
+
+		// public methods
+	public:
+		// cTraceWriter
+		//	Default constructor.
+		cTraceWriter();
+
+		// ~cTraceWriter
+		//	Destructor.
+		~cTraceWriter();
+
+		// Open
+		//	Create or continue trace file.
+		//		param path: path to trace file
+		//		param capacity: initial file size in bytes
+		//		return: was file opened; existing files that are not valid
+		//			traces are refused and left unchanged
+		bool Open(char const path[], unsigned long long const capacity = 1 << 24);
+
+		// Close
+		//	Flush and close trace file.
+		void Close();
+
+		// Append
+		//	Add packet to trace; record is committed once fully written.
+		//		param packet: received packet
+		//		param tReceive: local time packet was received
+		//		return: was packet captured
+		bool Append(RakNet::Packet const* const packet, RakNet::Time const tReceive);
+	};
+
+
+	// cTraceReader
+	//	Sequential reader over committed records of trace file.
+	class cTraceReader
+	{
+		// protected data
+	protected:
+		// filemap
+		//	Mapped trace file.
+		gpro_filemap filemap;
+
+		// cursor
+		//	Offset of next record after header.
+		unsigned long long cursor;
+
+		// public methods
+	public:
+		// cTraceReader
+		//	Default constructor.
+		cTraceReader();
+
+		// ~cTraceReader
+		//	Destructor.
+		~cTraceReader();
+
+		// Open
+		//	Open trace file for reading.
+		//		param path: path to trace file
+		//		return: was file opened and valid
+		bool Open(char const path[]);
+
+		// Close
+		//	Close trace file.
+		void Close();
+
+		// Rewind
+		//	Go back to first record.
+		void Rewind();
+
+		// GetCount
+		//	Get number of committed records.
+		//		return: record count
+		unsigned long long GetCount() const;
+
+		// Next
+		//	Get next record and advance.
+		//		param record_out: record header
+		//		param data_out: packet data
+		//		return: was there another record
+		bool Next(sTraceRecord const*& record_out, unsigned char const*& data_out);
+
+		// GetSender
+		//	Rebuild sender address from record.
+		//		param record: record header
+		//		return: sender address
+		static RakNet::SystemAddress GetSender(sTraceRecord const& record);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_TRACE_HPP_
\ No newline at end of file
@@ -0,0 +1,185 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Transport.hpp
+	Header for packet transport interface and RakNet implementation.
+*/
+
+#ifndef _GPRO_NET_TRANSPORT_HPP_
+#define _GPRO_NET_TRANSPORT_HPP_
+#ifdef __cplusplus
+
+
+#include "RakNet/RakPeerInterface.h"
+#include "RakNet/BitStream.h"
+#include "RakNet/RakNetTypes.h"
+
+
+namespace gproNet
+{
+	// sLinkStatistics
+	//	Recent quality of link to one peer.
+	struct sLinkStatistics
+	{
+		unsigned int ping;				// average round trip time (ms)
+		float packetLoss;				// fraction of packets lost over last second
+		unsigned int bytesInSendBuffer;	// queued or awaiting resend
+		unsigned int bytesPerSecond;	// actually sent over last second
+	};
+
+
+	// cTransport
+	//	Interface for moving packets between peers; mirrors the subset of
+	//	RakNet peer functionality used by the framework.
+	class cTransport abstract
+	{
+		// public methods
+	public:
+		// ~cTransport
+		//	Destructor.
+		virtual ~cTransport();
+
+		// Startup
+		//	Start transport and listen for connections.
+		//		param maxConnections: total connections allowed
+		//		param maxIncoming: incoming connections allowed
+		//		param port: local port to bind; 0 to pick any
+		//		return: was transport started
+		virtual bool Startup(unsigned short const maxConnections, unsigned short const maxIncoming, unsigned short const port) = 0;
+
+		// Connect
+		//	Begin connecting to a remote peer.
+		//		param host: remote address string
+		//		param port: remote port
+		//		return: was connection attempt started
+		virtual bool Connect(char const host[], unsigned short const port) = 0;
+
+		// Disconnect
+		//	Close connection to peer, notifying it.
+		//		param address: connected peer
+		virtual void Disconnect(RakNet::SystemAddress const address) = 0;
+
+		// Shutdown
+		//	Stop transport, notifying connected peers.
+		virtual void Shutdown() = 0;
+
+		// Receive
+		//	Get next received packet.
+		//		return: packet to deallocate when done, or null if none
+		virtual RakNet::Packet* Receive() = 0;
+
+		// DeallocatePacket
+		//	Release packet returned by receive.
+		//		param packet: packet to release
+		virtual void DeallocatePacket(RakNet::Packet* packet) = 0;
+
+		// Send
+		//	Send bitstream to peer or broadcast to all peers.
+		//		param bitstream: packet data in bitstream
+		//		param priority: send priority
+		//		param reliability: send reliability
+		//		param orderingChannel: ordering channel index
+		//		param recipient: receiving peer; excluded peer if broadcasting
+		//		param broadcast: send to all connected peers
+		//		return: message number, or 0 if not sent
+		virtual unsigned int Send(RakNet::BitStream const* bitstream, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::AddressOrGUID const recipient, bool const broadcast) = 0;
+
+		// Send
+		//	Send serialized data to peer or broadcast to all peers.
+		//		param data: packet data
+		//		param length: packet length in bytes
+		//		param priority: send priority
+		//		param reliability: send reliability
+		//		param orderingChannel: ordering channel index
+		//		param recipient: receiving peer; excluded peer if broadcasting
+		//		param broadcast: send to all connected peers
+		//		return: message number, or 0 if not sent
+		virtual unsigned int Send(unsigned char const data[], unsigned int const length, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::AddressOrGUID const recipient, bool const broadcast) = 0;
+
+		// GetConnections
+		//	Get addresses of connected peers.
+		//		param list_out: array to fill
+		//		param max: capacity of array
+		//		return: number of addresses filled
+		virtual unsigned short GetConnections(RakNet::SystemAddress list_out[], unsigned short const max) = 0;
+
+		// GetGUID
+		//	Get identifier of connected peer; unlike its address, stays the
+		//	same when the peer reconnects.
+		//		param address: peer address
+		//		return: identifier, or 0 if not connected
+		virtual unsigned long long GetGUID(RakNet::SystemAddress const address) = 0;
+
+		// GetStatistics
+		//	Get link quality to connected peer; not available by default.
+		//		param address: peer address
+		//		param stats_out: link statistics
+		//		return: were statistics available
+		virtual bool GetStatistics(RakNet::SystemAddress const address, sLinkStatistics& stats_out);
+
+		// GetClockDifferential
+		//	Get estimate of how far connected peer's clock is ahead of the
+		//	local clock; zero (shared clock) by default.
+		//		param address: peer address
+		//		return: peer's time minus local time (wrapping)
+		virtual RakNet::Time GetClockDifferential(RakNet::SystemAddress const address);
+	};
+
+
+	// cTransportRakNet
+	//	Transport using RakNet peer (UDP sockets).
+	class cTransportRakNet : public cTransport
+	{
+		// protected data
+	protected:
+		// peer
+		//	Pointer to RakNet peer instance.
+		RakNet::RakPeerInterface* peer;
+
+		// public methods
+	public:
+		// cTransportRakNet
+		//	Default constructor.
+		cTransportRakNet();
+
+		// ~cTransportRakNet
+		//	Destructor.
+		virtual ~cTransportRakNet();
+
+		// cTransport interface
+		virtual bool Startup(unsigned short const maxConnections, unsigned short const maxIncoming, unsigned short const port);
+		virtual bool Connect(char const host[], unsigned short const port);
+		virtual void Disconnect(RakNet::SystemAddress const address);
+		virtual void Shutdown();
+		virtual RakNet::Packet* Receive();
+		virtual void DeallocatePacket(RakNet::Packet* packet);
+		virtual unsigned int Send(RakNet::BitStream const* bitstream, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::AddressOrGUID const recipient, bool const broadcast);
+		virtual unsigned int Send(unsigned char const data[], unsigned int const length, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::AddressOrGUID const recipient, bool const broadcast);
+		virtual unsigned short GetConnections(RakNet::SystemAddress list_out[], unsigned short const max);
+		virtual unsigned long long GetGUID(RakNet::SystemAddress const address);
+		virtual bool GetStatistics(RakNet::SystemAddress const address, sLinkStatistics& stats_out);
+		virtual RakNet::Time GetClockDifferential(RakNet::SystemAddress const address);
+	};
+
+}
+
+
+#endif	// __cplusplus
+#endif	// !_GPRO_NET_TRANSPORT_HPP_
\ No newline at end of file
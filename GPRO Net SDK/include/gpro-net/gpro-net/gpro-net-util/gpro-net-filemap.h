@@ -0,0 +1,111 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-filemap.h
+	Memory-mapped file interface.
+*/
+
+#ifndef _GPRO_NET_FILEMAP_H_
+#define _GPRO_NET_FILEMAP_H_
+
+
+#ifdef __cplusplus
+extern "C" {
+#else	// !__cplusplus
+typedef struct gpro_filemap		gpro_filemap;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// gpro_filemap
+//	Descriptor for memory-mapped file.
+//		member handle: internal handle data
+//		member data: pointer to start of mapped view
+//		member size: size of mapped view in bytes
+//		member readOnly: view is read-only
+struct gpro_filemap
+{
+	void* handle[2];
+	void* data;
+	unsigned long long size;
+	int readOnly;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// gpro_filemapOpen
+//	Open or create file and map it into memory.
+//		param filemap: pointer to descriptor that stores mapping info
+//			valid: non-null, not open
+//		param path: path to file
+//			valid: non-null c-string
+//		param size: minimum size of mapping; file is extended to fit; 0 maps
+//			the existing file as-is
+//		param readOnly: open existing file for reading only
+//		return SUCCESS: 0 if file successfully mapped
+//		return WARNING: +1 if descriptor already open
+//		return FAILURE: -2 if file not mapped
+//		return FAILURE: -1 if invalid parameters
+int gpro_filemapOpen(gpro_filemap* const filemap, char const* const path, unsigned long long const size, int const readOnly);
+
+// gpro_filemapResize
+//	Grow file and remap; pointers into the old view are invalidated.
+//		param filemap: pointer to descriptor that stores mapping info
+//			valid: non-null, open, not read-only
+//		param size: new size of mapping in bytes
+//			valid: greater than current size
+//		return SUCCESS: 0 if file successfully remapped
+//		return FAILURE: -2 if file not remapped (descriptor is closed)
+//		return FAILURE: -1 if invalid parameters
+int gpro_filemapResize(gpro_filemap* const filemap, unsigned long long const size);
+
+// gpro_filemapFlush
+//	Write range of mapped view to disk.
+//		param filemap: pointer to descriptor that stores mapping info
+//			valid: non-null, open
+//		param offset: start of range in bytes
+//		param size: size of range in bytes; 0 flushes to end of view
+//		param wait: block until data reaches storage
+//		return SUCCESS: 0 if range successfully flushed
+//		return FAILURE: -2 if range not flushed
+//		return FAILURE: -1 if invalid parameters
+int gpro_filemapFlush(gpro_filemap const* const filemap, unsigned long long const offset, unsigned long long const size, int const wait);
+
+// gpro_filemapClose
+//	Unmap view and close file.
+//		param filemap: pointer to descriptor that stores mapping info
+//			valid: non-null
+//		return SUCCESS: 0 if file successfully closed
+//		return WARNING: +1 if descriptor not open
+//		return FAILURE: -1 if invalid parameters
+int gpro_filemapClose(gpro_filemap* const filemap);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !_GPRO_NET_FILEMAP_H_
\ No newline at end of file
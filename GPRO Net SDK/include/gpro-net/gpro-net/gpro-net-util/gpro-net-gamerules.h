@@ -0,0 +1,174 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-gamerules.h
+	Deterministic move rules for mini-game states.
+*/
+
+#ifndef _GPRO_NET_GAMERULES_H_
+#define _GPRO_NET_GAMERULES_H_
+
+
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-gamestate.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// gpro_checkers_move
+//	Validate and apply one step or jump; jumped piece is removed and pieces
+//	reaching the far row are stacked. Player 1 moves toward row 7, player 2
+//	toward row 0, stacks either way.
+//		param gs: checkerboard
+//			valid: non-null
+//		param player: moving player flag
+//			valid: gpro_checkers_player1 or gpro_checkers_player2
+//		param row0, col0: cell of piece to move
+//			valid: row < 8, col < 4
+//		param row1, col1: destination cell
+//			valid: row < 8, col < 4
+//		return SUCCESS: 0 if move applied and turn passes
+//		return WARNING: +1 if jump applied and same piece can jump again
+//		return FAILURE: -2 if move is not legal
+//		return FAILURE: -1 if invalid parameters
+int gpro_checkers_move(gpro_checkers gs, unsigned char const player, unsigned char const row0, unsigned char const col0, unsigned char const row1, unsigned char const col1);
+
+// gpro_checkers_canJump
+//	Check if piece can jump from cell.
+//		param gs: checkerboard
+//			valid: non-null
+//		param row, col: cell of piece
+//			valid: row < 8, col < 4
+//		return SUCCESS: 1 if a jump is available, 0 if not
+//		return FAILURE: -1 if invalid parameters
+int gpro_checkers_canJump(gpro_checkers const gs, unsigned char const row, unsigned char const col);
+
+// gpro_checkers_canMove
+//	Check if piece can step or jump from cell.
+//		param gs: checkerboard
+//			valid: non-null
+//		param row, col: cell of piece
+//			valid: row < 8, col < 4
+//		return SUCCESS: 1 if a step or jump is available, 0 if not
+//		return FAILURE: -1 if invalid parameters
+int gpro_checkers_canMove(gpro_checkers const gs, unsigned char const row, unsigned char const col);
+
+
+//-----------------------------------------------------------------------------
+
+// gpro_mancala_move
+//	Validate and apply sowing from cup: stones are dropped one per cup
+//	toward own score, skipping opponent's score; last stone in own empty
+//	cup captures opposite cup. Game ends when either side is empty, when
+//	remaining stones go to their side's score.
+//		param gs: mancala board
+//			valid: non-null
+//		param player: moving player index
+//			valid: 0 or 1
+//		param cup: cup to sow from
+//			valid: gpro_mancala_cup1 to gpro_mancala_cup6
+//		return SUCCESS: 0 if move applied and turn passes
+//		return WARNING: +1 if last stone landed in own score (extra turn)
+//		return FAILURE: -2 if cup is empty
+//		return FAILURE: -1 if invalid parameters
+int gpro_mancala_move(gpro_mancala gs, unsigned char const player, unsigned char const cup);
+
+// gpro_mancala_over
+//	Check if game is over.
+//		param gs: mancala board
+//			valid: non-null
+//		return SUCCESS: 1 if either side has no stones in cups, 0 if not
+//		return FAILURE: -1 if invalid parameters
+int gpro_mancala_over(gpro_mancala const gs);
+
+
+//-----------------------------------------------------------------------------
+
+// gpro_battleship_place
+//	Place ship on own board.
+//		param gs: battleship board
+//			valid: non-null
+//		param ship: ship flag
+//			valid: one of gpro_battleship_ship_p2 ... gpro_battleship_ship_c5
+//		param row, col: first cell of ship
+//			valid: row < 10, col < 10
+//		param horizontal: ship extends along row (else along column)
+//		return SUCCESS: 0 if ship placed
+//		return FAILURE: -2 if ship does not fit, overlaps or is already placed
+//		return FAILURE: -1 if invalid parameters
+int gpro_battleship_place(gpro_battleship gs, unsigned char const ship, unsigned char const row, unsigned char const col, int const horizontal);
+
+// gpro_battleship_validate
+//	Check that own board has every ship placed once, in a straight line.
+//		param gs: battleship board
+//			valid: non-null
+//		return SUCCESS: 0 if board is valid
+//		return FAILURE: -2 if any ship is missing or malformed
+//		return FAILURE: -1 if invalid parameters
+int gpro_battleship_validate(gpro_battleship const gs);
+
+// gpro_battleship_defend
+//	Apply opponent's attack to own board.
+//		param gs: battleship board
+//			valid: non-null
+//		param row, col: attacked cell
+//			valid: row < 10, col < 10
+//		param result_out: pointer to store gpro_battleship_hit or
+//			gpro_battleship_miss
+//			valid: non-null
+//		return SUCCESS: 0 if attack applied
+//		return FAILURE: -2 if cell was already damaged
+//		return FAILURE: -1 if invalid parameters
+int gpro_battleship_defend(gpro_battleship gs, unsigned char const row, unsigned char const col, unsigned char* const result_out);
+
+// gpro_battleship_record
+//	Record result of own attack.
+//		param gs: battleship board
+//			valid: non-null
+//		param row, col: attacked cell
+//			valid: row < 10, col < 10
+//		param result: gpro_battleship_hit or gpro_battleship_miss
+//		return SUCCESS: 0 if result recorded
+//		return FAILURE: -2 if cell was already attacked
+//		return FAILURE: -1 if invalid parameters
+int gpro_battleship_record(gpro_battleship gs, unsigned char const row, unsigned char const col, unsigned char const result);
+
+// gpro_battleship_lost
+//	Check if every own ship cell is damaged.
+//		param gs: battleship board
+//			valid: non-null
+//		return SUCCESS: 1 if all ships sunk, 0 if not
+//		return FAILURE: -1 if invalid parameters
+int gpro_battleship_lost(gpro_battleship const gs);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !_GPRO_NET_GAMERULES_H_
\ No newline at end of file
@@ -0,0 +1,105 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-zobrist.h
+	Zobrist hashing of mini-game states.
+*/
+
+#ifndef _GPRO_NET_ZOBRIST_H_
+#define _GPRO_NET_ZOBRIST_H_
+
+
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-gamestate.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif	// __cplusplus
+
+
+/*
+	Boards are hashed by cell index (byte offset into board array) and
+	bit: hash is the exclusive-or of the key of every raised bit. Any two
+	different boards collide with chance 2^-64, as with per-value keys,
+	and changing one cell only touches the keys of its changed bits.
+*/
+
+// gpro_zobrist_cells
+//	Number of keyed cells; enough for the largest board.
+#define gpro_zobrist_cells	sizeof(gpro_battleship)
+
+
+// gpro_zobrist_board
+//	Full hash of board cells.
+//		param cells: first cell of board (e.g. gpro_checkers)
+//		param count: number of cells (e.g. sizeof(gpro_checkers))
+//			valid: count <= gpro_zobrist_cells
+//		param hash_out: pointer to store hash
+//			valid: non-null
+//		return SUCCESS: 0 if hash computed
+//		return FAILURE: -1 if invalid parameters
+int gpro_zobrist_board(void const* const cells, unsigned int const count, unsigned long long* const hash_out);
+
+// gpro_zobrist_cell
+//	Update hash for one cell changing value.
+//		param hash: pointer to hash to update
+//			valid: non-null
+//		param cell: cell index
+//			valid: cell < gpro_zobrist_cells
+//		param before: previous value of cell
+//		param after: new value of cell
+//		return SUCCESS: 0 if hash updated
+//		return FAILURE: -1 if invalid parameters
+int gpro_zobrist_cell(unsigned long long* const hash, unsigned int const cell, unsigned char const before, unsigned char const after);
+
+// gpro_zobrist_range
+//	Update hash for consecutive cells changing value; unchanged cells cost
+//	one comparison each.
+//		param hash: pointer to hash to update
+//			valid: non-null
+//		param cell: index of first cell
+//		param before: previous values of cells
+//			valid: non-null
+//		param after: new values of cells
+//			valid: non-null
+//		param count: number of cells
+//			valid: cell + count <= gpro_zobrist_cells
+//		return SUCCESS: 0 if hash updated
+//		return FAILURE: -1 if invalid parameters
+int gpro_zobrist_range(unsigned long long* const hash, unsigned int const cell, unsigned char const* const before, unsigned char const* const after, unsigned int const count);
+
+// gpro_zobrist_verify
+//	Compare hash against full recompute of board.
+//		param cells: first cell of board
+//		param count: number of cells
+//			valid: count <= gpro_zobrist_cells
+//		param hash: hash to verify
+//		return SUCCESS: 0 if hash matches
+//		return FAILURE: -2 if hash does not match
+//		return FAILURE: -1 if invalid parameters
+int gpro_zobrist_verify(void const* const cells, unsigned int const count, unsigned long long const hash);
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !_GPRO_NET_ZOBRIST_H_
\ No newline at end of file
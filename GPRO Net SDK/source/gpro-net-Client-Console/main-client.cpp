@@ -23,6 +23,13 @@
 */
 
 #include "gpro-net/gpro-net-client/gpro-net-RakNet-Client.hpp"
+#include "gpro-net/gpro-net-client/gpro-net-RakNet-Bot.hpp"
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
 
 #include "gpro-net/gpro-net.h"
 
@@ -74,13 +81,122 @@ int testUtility()
 }
 
 
+// soak test: many bots play matches against each other through a server
+//	until the duration passes (forever if zero); every report interval
+//	prints throughput, latency of own moves, loop time and memory, so
+//	server slowdowns and leaks show as drift across hours of lines
+int runBots(char const host[], unsigned short const port, unsigned int const count, gproNet::eLockstepGame const game, unsigned int const minutes, unsigned int const interval)
+{
+	std::vector<std::unique_ptr<gproNet::cRakNetBot>> bots;
+	std::unique_ptr<gproNet::sMetricsHistogram> tick(new gproNet::sMetricsHistogram), moveTime(new gproNet::sMetricsHistogram), movePrevious(new gproNet::sMetricsHistogram);
+	unsigned long long const seed = std::random_device()();
+	unsigned long long const memoryStart = gproNet::GetProcessMemory();
+	unsigned long long finished = 0, abandoned = 0, moves = 0, reconnects = 0;
+	unsigned long long finishedPrevious = 0, movesPrevious = 0;
+	RakNet::Time const tStart = RakNet::GetTime();
+	RakNet::Time tReport = tStart, now = tStart;
+	RakNet::TimeUS tPass;
+	unsigned int connected, playing, i, k;
+
+	// mixed games go to pairs of bots so every queue fills
+	for (i = 0; i < count; ++i)
+		bots.push_back(std::make_unique<gproNet::cRakNetBot>(game != gproNet::LOCKSTEP_NONE ? game :
+			(gproNet::eLockstepGame)(gproNet::LOCKSTEP_CHECKERS + i / 2 % 3), seed + i, host, port));
+	memset(tick.get(), 0, sizeof(*tick));
+	memset(movePrevious.get(), 0, sizeof(*movePrevious));
+	printf("%u bots on %s:%hu, report every %u s \n", count, host, port, interval);
+
+	while (!minutes || now - tStart < minutes * 60000ull)
+	{
+		tPass = RakNet::GetTimeUS();
+		for (i = 0; i < count; ++i)
+		{
+			bots[i]->MessageLoop();
+			bots[i]->Update();
+		}
+		tPass = RakNet::GetTimeUS() - tPass;
+		tick->count[gproNet::sMetricsHistogram::GetBucket(tPass * 1000)]++;
+		if (tPass < 1000)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		now = RakNet::GetTime();
+		if (now - tReport < interval * 1000ull)
+			continue;
+
+		// totals, and move latency of this interval only
+		finished = abandoned = moves = reconnects = 0;
+		connected = playing = 0;
+		memset(moveTime.get(), 0, sizeof(*moveTime));
+		for (i = 0; i < count; ++i)
+		{
+			gproNet::sBotStats const& stats = bots[i]->GetStats();
+			finished += stats.matchesFinished;
+			abandoned += stats.matchesAbandoned;
+			moves += stats.moves;
+			reconnects += stats.reconnects;
+			connected += (unsigned int)bots[i]->IsConnected();
+			playing += (unsigned int)bots[i]->IsPlaying();
+			for (k = 0; k < gproNet::METRICS_HISTOGRAM_BUCKETS; ++k)
+				moveTime->count[k] += stats.moveTime.count[k];
+		}
+		for (k = 0; k < gproNet::METRICS_HISTOGRAM_BUCKETS; ++k)
+		{
+			unsigned long long const total = moveTime->count[k];
+			moveTime->count[k] -= movePrevious->count[k];
+			movePrevious->count[k] = total;
+		}
+
+		printf("[%6.1f min] bots %u/%u playing %u | matches %llu (+%.1f/min) abandoned %llu | moves %llu (+%.1f/s) move p50 %.2f p99 %.2f ms | loop p50 %.0f p99 %.0f us | reconnects %llu | memory %.1f MB (start %.1f) \n",
+			(double)(now - tStart) / 60000.0, connected, count, playing,
+			finished, (double)(finished - finishedPrevious) * 60000.0 / (double)(now - tReport), abandoned,
+			moves, (double)(moves - movesPrevious) * 1000.0 / (double)(now - tReport),
+			(double)moveTime->GetPercentile(50.0) / 1000000.0, (double)moveTime->GetPercentile(99.0) / 1000000.0,
+			(double)tick->GetPercentile(50.0) / 1000.0, (double)tick->GetPercentile(99.0) / 1000.0,
+			reconnects, (double)gproNet::GetProcessMemory() / 1048576.0, (double)memoryStart / 1048576.0);
+		fflush(stdout);
+		memset(tick.get(), 0, sizeof(*tick));
+		finishedPrevious = finished;
+		movesPrevious = moves;
+		tReport = now;
+	}
+	return 0;
+}
+
+
 int main(int const argc, char const* const argv[])
 {
+	char const* host = "127.0.0.1";
+	unsigned short port = gproNet::SET_GPRO_SERVER_PORT;
+	unsigned int bots = 0, minutes = 0, interval = 60;
+	gproNet::eLockstepGame game = gproNet::LOCKSTEP_NONE;
+	int i;
+
+	// bot soak test: -bots <count> [-host <address>] [-port <port>]
+	//	[-game <1 checkers, 2 mancala, 3 battleship; 0 mixed>]
+	//	[-minutes <duration, 0 forever>] [-report <seconds>]
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-bots") && i + 1 < argc)
+			bots = (unsigned int)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-host") && i + 1 < argc)
+			host = argv[++i];
+		else if (!strcmp(argv[i], "-port") && i + 1 < argc)
+			port = (unsigned short)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-game") && i + 1 < argc)
+			game = (gproNet::eLockstepGame)(atoi(argv[++i]) % gproNet::LOCKSTEP_GAME_COUNT);
+		else if (!strcmp(argv[i], "-minutes") && i + 1 < argc)
+			minutes = (unsigned int)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-report") && i + 1 < argc)
+			interval = (unsigned int)atoi(argv[++i]);
+	}
+	if (bots)
+		return runBots(host, port, bots, game, minutes, interval ? interval : 1);
+
 	testUtility();
 
 	testPlugin();
 
-	gproNet::cRakNetClient client;
+	gproNet::cRakNetClient client(host, port);
 
 	while (1)
 	{
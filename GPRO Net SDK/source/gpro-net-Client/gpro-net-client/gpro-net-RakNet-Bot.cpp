@@ -0,0 +1,295 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-RakNet-Bot.cpp
+	Source for scripted headless client that plays lockstep games.
+*/
+
+#include "gpro-net/gpro-net-client/gpro-net-RakNet-Bot.hpp"
+#include "gpro-net/gpro-net/gpro-net-BattleshipAI.hpp"
+
+#include <string.h>
+
+
+namespace gproNet
+{
+	// splitmix64 step
+	static unsigned long long BotRandom(unsigned long long& state)
+	{
+		unsigned long long z = (state += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+
+	cRakNetBot::cRakNetBot(eLockstepGame const game, unsigned long long const seed, char const host[], unsigned short const port)
+		: cRakNetBot((cTransport*)0, game, seed, host, port)
+	{
+	}
+
+	cRakNetBot::cRakNetBot(cTransport* const transport, eLockstepGame const game, unsigned long long const seed, char const host[], unsigned short const port)
+		: cRakNetClient(transport, host, port)
+		, game(game), playing(LOCKSTEP_NONE), random(seed), port(port), connected(false), queued(false), ready(false)
+		, moveSequence(0), tMove(0), tProgress(RakNet::GetTime()), tConnect(RakNet::GetTime())
+	{
+		memset(&stats, 0, sizeof(stats));
+	}
+
+	sBotStats const& cRakNetBot::GetStats() const
+	{
+		return stats;
+	}
+
+	bool cRakNetBot::IsPlaying() const
+	{
+		return (lockstep.GetGame() != LOCKSTEP_NONE);
+	}
+
+	void cRakNetBot::Update()
+	{
+		RakNet::Time const now = RakNet::GetTime();
+		sLockstepMove move;
+
+		// going nowhere, connected or not (seat may be gone for good)
+		if (lockstep.GetGame() != LOCKSTEP_NONE && now - tProgress >= BOT_STALL_TIMEOUT)
+		{
+			LeaveMatch(false);
+			return;
+		}
+
+		// dropped: during a match the client goes back with its token by
+		//	itself, but the attempt may fail while the server is away
+		if (server == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+		{
+			queued = false;
+			if (now - tConnect >= BOT_RETRY_INTERVAL)
+			{
+				tConnect = now;
+				if (resumeToken && lockstep.GetGame() != LOCKSTEP_NONE)
+					Reconnect();
+				else
+					peer->Connect(host, port);
+			}
+			return;
+		}
+
+		// between matches, queue once
+		if (lockstep.GetGame() == LOCKSTEP_NONE)
+		{
+			if (!queued && JoinGame(game))
+			{
+				queued = true;
+				tProgress = now;
+			}
+			return;
+		}
+
+		// done, or called a draw
+		if (lockstep.IsOver())
+		{
+			LeaveMatch(true);
+			return;
+		}
+		if (lockstep.GetSequence() >= BOT_MOVE_LIMIT)
+		{
+			LeaveMatch(false);
+			return;
+		}
+
+		// random fleet first in battleship; moves wait for opponent's
+		if (lockstep.GetGame() == LOCKSTEP_BATTLESHIP && !lockstep.HasBoard(lockstepPlayer))
+		{
+			gpro_battleship board;
+			gpro_battleship_reset(board);
+			if (BattleshipPlaceRandom(board, random) == 0)
+				SetupGame(board);
+			return;
+		}
+		if (lockstep.GetGame() == LOCKSTEP_BATTLESHIP && !ready && !lockstep.GetSequence())
+			return;
+
+		// own turn and nothing waiting to be relayed
+		if (lockstep.GetTurn() != lockstepPlayer || lockstepResync || tMove)
+			return;
+		if (!ChooseMove(move))
+		{
+			LeaveMatch(false);
+			return;
+		}
+		if (SendMove(move))
+		{
+			moveSequence = lockstep.GetSequence();
+			tMove = RakNet::GetTimeUS();
+		}
+	}
+
+	bool cRakNetBot::ChooseMove(sLockstepMove& move_out)
+	{
+		sLockstepMove candidate[BOT_MOVE_CANDIDATES];
+		unsigned int count = 0, jumps = 0;
+		sLockstepMove move = { lockstepPlayer, 0, 0, 0, 0 };
+		cLockstepSession trial = lockstep;
+
+		switch (lockstep.GetGame())
+		{
+		case LOCKSTEP_CHECKERS:
+		{
+			// try every step and jump of own pieces on a copy, restored
+			//	after each legal one (refused moves change nothing); jumps
+			//	are kept at the front so they are picked whenever there is one
+			gpro_checkers const& board = lockstep.GetCheckers();
+			unsigned char const own = lockstepPlayer ? gpro_checkers_player2 : gpro_checkers_player1;
+			int dr;
+			for (move.a = 0; move.a < 8; ++move.a)
+				for (move.b = 0; move.b < 4; ++move.b)
+				{
+					if (!gpro_flag_check(board[move.a][move.b], own))
+						continue;
+					for (dr = -2; dr <= 2; ++dr)
+					{
+						if (!dr || move.a + dr < 0 || move.a + dr >= 8)
+							continue;
+						move.c = (unsigned char)(move.a + dr);
+						for (move.d = 0; move.d < 4; ++move.d)
+						{
+							if (count >= BOT_MOVE_CANDIDATES || trial.Apply(move) < 0)
+								continue;
+							trial = lockstep;
+							candidate[count] = move;
+							if (dr == -2 || dr == 2)
+							{
+								candidate[count] = candidate[jumps];
+								candidate[jumps++] = move;
+							}
+							++count;
+						}
+					}
+				}
+			if (jumps)
+				count = jumps;
+		}	break;
+		case LOCKSTEP_MANCALA:
+		{
+			for (move.a = gpro_mancala_cup1; move.a <= gpro_mancala_cup6; ++move.a)
+			{
+				if (trial.Apply(move) >= 0)
+				{
+					candidate[count++] = move;
+					trial = lockstep;
+				}
+			}
+		}	break;
+		case LOCKSTEP_BATTLESHIP:
+		{
+			// sinking is not announced, so every ship counts as afloat
+			if (BattleshipTarget(lockstep.GetBattleship(lockstepPlayer), gpro_battleship_ship, random, move.a, move.b) < 0)
+				return false;
+			move_out = move;
+		}	return true;
+		default:
+			return false;
+		}
+
+		if (!count)
+			return false;
+		move_out = candidate[BotRandom(random) % count];
+		return true;
+	}
+
+	void cRakNetBot::LeaveMatch(bool const finished)
+	{
+		// server ends match for opponent, who then queues too
+		JoinGame(LOCKSTEP_NONE);
+		lockstep.Start(LOCKSTEP_NONE);
+		if (finished)
+			++stats.matchesFinished;
+		else
+			++stats.matchesAbandoned;
+		playing = LOCKSTEP_NONE;
+		queued = ready = false;
+		tMove = 0;
+	}
+
+	bool cRakNetBot::ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID)
+	{
+		// state before client applies message
+		unsigned int const sequence = lockstep.GetSequence();
+		bool const over = (lockstep.GetGame() != LOCKSTEP_NONE && lockstep.IsOver());
+		bool const result = cRakNetClient::ProcessMessage(bitstream, sender, dtSendToReceive, msgID);
+
+		switch (msgID)
+		{
+		case ID_CONNECTION_REQUEST_ACCEPTED:
+			if (connected)
+				++stats.reconnects;
+			connected = true;
+			tProgress = RakNet::GetTime();
+			break;
+		case ID_GPRO_MESSAGE_GAME_START:
+		{
+			// end of a match this bot already left arrives after it queued
+			//	again; joining once more would leave the next match
+			if (playing == LOCKSTEP_NONE && lockstep.GetGame() == LOCKSTEP_NONE)
+				break;
+
+			// server ended match (opponent left), or started one; a
+			//	restart of the same match after resuming is neither
+			if (playing != LOCKSTEP_NONE && lockstep.GetGame() == LOCKSTEP_NONE)
+			{
+				if (over)
+					++stats.matchesFinished;
+				else
+					++stats.matchesAbandoned;
+			}
+			if (playing == LOCKSTEP_NONE || lockstep.GetGame() == LOCKSTEP_NONE)
+				ready = false;
+			playing = lockstep.GetGame();
+			queued = false;
+			tMove = 0;
+			tProgress = RakNet::GetTime();
+		}	break;
+		case ID_GPRO_MESSAGE_GAME_SETUP:
+			ready = true;
+			tProgress = RakNet::GetTime();
+			break;
+		case ID_GPRO_MESSAGE_GAME_MOVE:
+			if (lockstep.GetSequence() != sequence)
+			{
+				// own move back from server
+				if (tMove && sequence == moveSequence)
+				{
+					stats.moveTime.count[sMetricsHistogram::GetBucket((RakNet::GetTimeUS() - tMove) * 1000)]++;
+					++stats.moves;
+					tMove = 0;
+				}
+				tProgress = RakNet::GetTime();
+			}
+			break;
+		case ID_GPRO_MESSAGE_GAME_RESYNC:
+			// move was refused, or state replaced; choose again
+			tMove = 0;
+			tProgress = RakNet::GetTime();
+			break;
+		}
+		return result;
+	}
+}
\ No newline at end of file
@@ -27,19 +27,194 @@
 
 namespace gproNet
 {
-	cRakNetClient::cRakNetClient()
+	cRakNetClient::cRakNetClient(char const host[], unsigned short const port)
+		: cRakNetClient((cTransport*)0, host, port)
 	{
-		RakNet::SocketDescriptor sd;
-		char SERVER_IP[16] = "127.0.0.1";
+	}
+
+	cRakNetClient::cRakNetClient(cTransport* const transport, char const host[], unsigned short const port)
+		: cRakNetManager(transport)
+		, server(RakNet::UNASSIGNED_SYSTEM_ADDRESS), lockstepPlayer(0), lockstepResync(false), lockstepRoom(CHAT_ROOM_GLOBAL)
+		, session(CLIENT_SESSION_IDLE), resumeToken(0), resumeServer(RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+	{
+		RakNet::BitStream bitstream_w(MESSAGE_HEADER_BYTES + sTestMessageSchema::maxBytes);
 
-		peer->Startup(1, &sd, 1);
-		peer->SetMaximumIncomingConnections(0);
-		peer->Connect(SERVER_IP, SET_GPRO_SERVER_PORT, 0, 0);
+		strncpy(this->host, host, sizeof(this->host) - 1);
+		this->host[sizeof(this->host) - 1] = 0;
+		greeting = cSharedMessage(WriteTest(bitstream_w, "Hello server from client", false));
+
+		// room for a second connection while leaving router for shard
+		peer->Startup(2, 0, 0);
+		peer->Connect(host, port);
 	}
 
 	cRakNetClient::~cRakNetClient()
 	{
-		peer->Shutdown(0);
+		peer->Shutdown();
+	}
+
+	cEntityStore& cRakNetClient::GetEntities()
+	{
+		return entities;
+	}
+
+	void cRakNetClient::TakeHits(std::vector<sEntityHit>& hit_out)
+	{
+		hit_out.clear();
+		hit_out.swap(hits);
+	}
+
+	bool cRakNetClient::IsConnected() const
+	{
+		return (server != RakNet::UNASSIGNED_SYSTEM_ADDRESS);
+	}
+
+	bool cRakNetClient::RequestRoute(unsigned int const key)
+	{
+		cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + sizeof(unsigned int));
+		if (server == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+			return false;
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_ROUTE);
+		bitstream_w->Write(key);
+		return (Send(*bitstream_w, server, false) != 0);
+	}
+
+	bool cRakNetClient::JoinGame(eLockstepGame const game)
+	{
+		cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + 1);
+		if (server == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+			return false;
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_JOIN);
+		WriteBitsValue(*bitstream_w, game, 2);
+		return (Send(*bitstream_w, server, false) != 0);
+	}
+
+	bool cRakNetClient::SetupGame(gpro_battleship const board)
+	{
+		cPooledBitStream bitstream_w((unsigned int)MESSAGE_HEADER_BYTES + LOCKSTEP_BOARD_BYTES);
+		if (server == RakNet::UNASSIGNED_SYSTEM_ADDRESS || lockstep.SetBoard(lockstepPlayer, board) < 0)
+			return false;
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_SETUP);
+		cLockstepSession::WriteBoard(*bitstream_w, lockstep.GetBattleship(lockstepPlayer));
+		return (Send(*bitstream_w, server, false) != 0);
+	}
+
+	bool cRakNetClient::SendMove(sLockstepMove const& move)
+	{
+		cPooledBitStream bitstream_w((unsigned int)MESSAGE_HEADER_BYTES + LOCKSTEP_MOVE_BYTES);
+		if (server == RakNet::UNASSIGNED_SYSTEM_ADDRESS || lockstep.GetGame() == LOCKSTEP_NONE || lockstep.GetTurn() != lockstepPlayer)
+			return false;
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_MOVE);
+		lockstep.WriteMove(*bitstream_w, move);
+		return (Send(*bitstream_w, server, false) != 0);
+	}
+
+	cLockstepSession const& cRakNetClient::GetGame() const
+	{
+		return lockstep;
+	}
+
+	unsigned char cRakNetClient::GetGamePlayer() const
+	{
+		return lockstepPlayer;
+	}
+
+	unsigned int cRakNetClient::GetGameRoom() const
+	{
+		return lockstepRoom;
+	}
+
+	bool cRakNetClient::SendChat(unsigned int const room, char const text[])
+	{
+		cPooledBitStream bitstream_w((unsigned int)MESSAGE_HEADER_BYTES + CHAT_ENTRY_BYTES);
+		if (server == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+			return false;
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_CHAT);
+		WriteChatPost(*bitstream_w, room, text);
+		return (Send(*bitstream_w, server, false) != 0);
+	}
+
+	void cRakNetClient::TakeChat(std::vector<sChatMessage>& message_out)
+	{
+		message_out.clear();
+		message_out.swap(chat);
+	}
+
+	bool cRakNetClient::StartBattleship(gpro_battleship const board, RakNet::Time const timeout)
+	{
+		if (session != CLIENT_SESSION_IDLE && session != CLIENT_SESSION_PLAYING && session != CLIENT_SESSION_FAILED)
+			return false;
+		memcpy(placement, board, sizeof(placement));
+		return tasks.Start(BattleshipSession(timeout));
+	}
+
+	eClientSession cRakNetClient::GetSession() const
+	{
+		return session;
+	}
+
+	bool cRakNetClient::Reconnect()
+	{
+		if (server != RakNet::UNASSIGNED_SYSTEM_ADDRESS || !resumeToken)
+			return false;
+		return peer->Connect(host, resumeServer.GetPort());
+	}
+
+	cTask cRakNetClient::BattleshipSession(RakNet::Time const timeout)
+	{
+		sTaskMessage message;
+
+		// connect; server answers greeting sent on connecting
+		if (server == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+		{
+			session = CLIENT_SESSION_CONNECTING;
+			message = co_await tasks.Receive(ID_CONNECTION_REQUEST_ACCEPTED, RakNet::UNASSIGNED_SYSTEM_ADDRESS, timeout);
+			if (!message.bitstream)
+			{
+				session = CLIENT_SESSION_FAILED;
+				co_return;
+			}
+			session = CLIENT_SESSION_GREETING;
+			message = co_await tasks.Receive(ID_GPRO_MESSAGE_COMMON_BEGIN, server, timeout);
+			if (!message.bitstream)
+			{
+				session = CLIENT_SESSION_FAILED;
+				co_return;
+			}
+		}
+
+		while (session != CLIENT_SESSION_PLAYING)
+		{
+			// queue for as long as it takes to be paired
+			session = CLIENT_SESSION_QUEUED;
+			if (!JoinGame(LOCKSTEP_BATTLESHIP))
+			{
+				session = CLIENT_SESSION_FAILED;
+				co_return;
+			}
+			do
+				message = co_await tasks.Receive(ID_GPRO_MESSAGE_GAME_START, server);
+			while (lockstep.GetGame() != LOCKSTEP_BATTLESHIP);
+
+			// place board; opponent may take any time to place theirs, so
+			//	each timeout only checks they have not left
+			session = CLIENT_SESSION_PLACING;
+			if (!SetupGame(placement))
+			{
+				session = CLIENT_SESSION_FAILED;
+				co_return;
+			}
+			do
+				message = co_await tasks.Receive(ID_GPRO_MESSAGE_GAME_SETUP, server, timeout);
+			while (!message.bitstream && lockstep.GetGame() == LOCKSTEP_BATTLESHIP);
+			if (message.bitstream)
+				session = CLIENT_SESSION_PLAYING;
+		}
 	}
 
 	bool cRakNetClient::ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID)
@@ -64,17 +239,62 @@ namespace gproNet
 			return true;
 		case ID_DISCONNECTION_NOTIFICATION:
 			//printf("We have been disconnected.\n");
+			if (sender == server)
+				server = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+			if (sender == resumeServer)
+				resumeToken = 0;
 			return true;
 		case ID_CONNECTION_LOST:
 			//printf("Connection lost.\n");
-			return true;
+		{
+			// server is holding our seat, go back and take it
+			if (sender == server)
+				server = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+			if (sender == resumeServer && lockstep.GetGame() != LOCKSTEP_NONE)
+				Reconnect();
+		}	return true;
 
 		case ID_CONNECTION_REQUEST_ACCEPTED:
 		{
 			// client connects to server, send greeting
-			RakNet::BitStream bitstream_w;
-			WriteTest(bitstream_w, "Hello server from client");
-			peer->Send(&bitstream_w, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 0, sender, false);
+			server = sender;
+			Send(greeting, sender, false);
+
+			// back after dropping: present token and last move applied
+			if (resumeToken && sender == resumeServer)
+			{
+				cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + sizeof(unsigned long long) + 1 + sizeof(unsigned int));
+				WriteTimestamp(*bitstream_w);
+				bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_RESUME);
+				bitstream_w->Write(resumeToken);
+				WriteBitsValue(*bitstream_w, lockstep.GetGame(), 2);
+				bitstream_w->Write(lockstep.GetSequence());
+				Send(*bitstream_w, sender, false);
+				resumeToken = 0;
+				lockstepResync = false;
+			}
+		}	return true;
+
+			// token for resuming after dropping
+		case ID_GPRO_MESSAGE_RESUME:
+		{
+			if (!bitstream.Read(resumeToken))
+				return false;
+			resumeServer = sender;
+		}	return true;
+
+			// router's answer: move to shard hosting match, if any
+		case ID_GPRO_MESSAGE_ROUTE:
+		{
+			unsigned short port;
+			if (!bitstream.Read(port))
+				return false;
+			if (port)
+			{
+				peer->Disconnect(sender);
+				server = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+				peer->Connect(host, port);
+			}
 		}	return true;
 
 			// test message
@@ -84,6 +304,77 @@ namespace gproNet
 			ReadTest(bitstream);
 		}	return true;
 
+			// entity replication
+		case ID_GPRO_MESSAGE_ENTITY_UPDATE:
+			return (entities.ReadDirty(bitstream) >= 0);
+		case ID_GPRO_MESSAGE_ENTITY_DESTROY:
+			return (entities.ReadDestroyed(bitstream) >= 0);
+		case ID_GPRO_MESSAGE_ENTITY_HIT:
+		{
+			sEntityHit hit;
+			if (!sEntityHitSchema::Read(bitstream, hit))
+				return false;
+			hits.push_back(hit);
+		}	return true;
+
+			// chat
+		case ID_GPRO_MESSAGE_CHAT:
+		{
+			bool history;
+			if (ReadChatBatch(bitstream, chat, history) < 0)
+				return false;
+		}	return true;
+
+			// lockstep games
+		case ID_GPRO_MESSAGE_GAME_START:
+		{
+			unsigned int game, player, room;
+			if (!ReadBitsValue(bitstream, game, 2) || !ReadBitsValue(bitstream, player, 1) || !ReadBitsValue(bitstream, room, CHAT_ROOM_BITS))
+				return false;
+			lockstep.Start((eLockstepGame)game);
+			lockstepPlayer = (unsigned char)player;
+			lockstepRoom = room;
+			lockstepResync = false;
+		}	return true;
+		case ID_GPRO_MESSAGE_GAME_SETUP:
+			// every board placed, battleship begins
+			return true;
+		case ID_GPRO_MESSAGE_GAME_MOVE:
+		{
+			sLockstepMove move;
+			unsigned int sequence, turn;
+			if (!bitstream.Read(sequence) || !ReadBitsValue(bitstream, turn, 1) || !lockstep.ReadMove(bitstream, move))
+				return false;
+			if (lockstepResync)
+				return true;
+
+			// apply same move as everyone else; any disagreement means
+			//	this copy has diverged, so ask for the real state (a wrong
+			//	turn would otherwise stall both players before next check)
+			if (sequence != lockstep.GetSequence() + 1 || lockstep.Apply(move) < 0 || lockstep.GetTurn() != turn)
+			{
+				cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES);
+				WriteTimestamp(*bitstream_w);
+				bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_RESYNC);
+				Send(*bitstream_w, sender, false);
+				lockstepResync = true;
+			}
+			else if (lockstep.IsCheck())
+			{
+				// periodic check catches divergence that moves alone do not
+				cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + sizeof(unsigned int) + sizeof(unsigned long long));
+				unsigned long long const hash = lockstep.Hash(lockstepPlayer);
+				WriteTimestamp(*bitstream_w);
+				bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_HASH);
+				bitstream_w->Write(sequence);
+				bitstream_w->Write(hash);
+				Send(*bitstream_w, sender, false);
+			}
+		}	return true;
+		case ID_GPRO_MESSAGE_GAME_RESYNC:
+			lockstepResync = false;
+			return lockstep.ReadState(bitstream, lockstepPlayer);
+
 		}
 		return false;
 	}
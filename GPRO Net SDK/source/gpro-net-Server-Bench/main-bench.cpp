@@ -0,0 +1,2563 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	main-bench.cpp
+	Main source for console benchmark application: server benchmarks over
+	loopback, and load generators for multi-process tests.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-RakNet-Server.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-RakNet-Relay.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-RakNet-Router.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-Replication.hpp"
+#include "gpro-net/gpro-net/gpro-net-Loopback.hpp"
+#include "gpro-net/gpro-net/gpro-net-Quantize.hpp"
+#include "gpro-net/gpro-net/gpro-net-BattleshipAI.hpp"
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-gamerules.h"
+
+#include <math.h>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+
+
+// one channel benchmark pass: client streams poses as fast as the link
+//	takes them while sending a move every 20 ms; server echoes moves back
+static void benchChannelsPass(char const name[], gproNet::cMessagePolicyTable const& policy, unsigned short const port)
+{
+	gproNet::cTransportRakNet server, client;
+	gproNet::sMetricsHistogram* const latency = new gproNet::sMetricsHistogram();
+	gproNet::sSpatialPose pose = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+	RakNet::Packet* packet = 0;
+	RakNet::SystemAddress serverAddress = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+	RakNet::TimeUS tStart = 0, tMove = 0, tNow = 0;
+	unsigned int movesSent = 0, movesReturned = 0, posesSent = 0, i;
+
+	server.Startup(1, 1, port);
+	client.Startup(1, 0, 0);
+	client.Connect("127.0.0.1", port);
+
+	// run for 5 seconds once connected
+	tStart = RakNet::GetTimeUS();
+	while ((tNow = RakNet::GetTimeUS()) - tStart < 5000000)
+	{
+		while ((packet = server.Receive()) != 0)
+		{
+			// echo moves unchanged
+			if (packet->data[0] == gproNet::ID_GPRO_MESSAGE_GAME_MOVE)
+			{
+				RakNet::BitStream bitstream(packet->data, packet->length, false);
+				gproNet::sMessagePolicy const& send = policy.Get(gproNet::ID_GPRO_MESSAGE_GAME_MOVE);
+				server.Send(&bitstream, send.priority, send.reliability, send.orderingChannel, packet->systemAddress, false);
+			}
+			server.DeallocatePacket(packet);
+		}
+		while ((packet = client.Receive()) != 0)
+		{
+			if (packet->data[0] == ID_CONNECTION_REQUEST_ACCEPTED)
+			{
+				serverAddress = packet->systemAddress;
+				tStart = tMove = tNow;
+			}
+			else if (packet->data[0] == gproNet::ID_GPRO_MESSAGE_GAME_MOVE)
+			{
+				RakNet::BitStream bitstream(packet->data, packet->length, false);
+				RakNet::TimeUS tSend = 0;
+				bitstream.IgnoreBytes(sizeof(RakNet::MessageID));
+				bitstream.Read(tSend);
+				++latency->count[gproNet::sMetricsHistogram::GetBucket(RakNet::GetTimeUS() - tSend)];
+				++movesReturned;
+			}
+			client.DeallocatePacket(packet);
+		}
+		if (serverAddress == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+			continue;
+
+		// saturate with poses
+		for (i = 0; i < 64; ++i)
+		{
+			RakNet::BitStream bitstream(sizeof(RakNet::MessageID) + gproNet::sSpatialPoseSchema::maxBytes + 256);
+			gproNet::sMessagePolicy const& send = policy.Get(gproNet::ID_GPRO_MESSAGE_SPATIAL_POSE);
+			bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_SPATIAL_POSE);
+			pose.translate[0] = (float)(posesSent % 1000);
+			pose.Write(bitstream);
+			bitstream.PadWithZeroToByteLength(sizeof(RakNet::MessageID) + gproNet::sSpatialPoseSchema::maxBytes + 256);
+			if (client.Send(&bitstream, send.priority, send.reliability, send.orderingChannel, serverAddress, false))
+				++posesSent;
+		}
+
+		// periodic move stamped with send time
+		if (tNow - tMove >= 20000)
+		{
+			RakNet::BitStream bitstream;
+			gproNet::sMessagePolicy const& send = policy.Get(gproNet::ID_GPRO_MESSAGE_GAME_MOVE);
+			tMove = tNow;
+			bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_GAME_MOVE);
+			bitstream.Write(tNow);
+			if (client.Send(&bitstream, send.priority, send.reliability, send.orderingChannel, serverAddress, false))
+				++movesSent;
+		}
+	}
+
+	printf("%-10s poses %8u | moves %4u sent %4u returned | rtt p50 %8llu us  p99 %8llu us \n", name,
+		posesSent, movesSent, movesReturned, latency->GetPercentile(50.0), latency->GetPercentile(99.0));
+	client.Shutdown();
+	server.Shutdown();
+	delete latency;
+}
+
+// move round trip while pose traffic saturates the link, with everything
+//	sharing one reliable ordered channel and then with the policy table
+//	usage: -bench-channels
+int benchChannels()
+{
+	gproNet::cMessagePolicyTable shared(HIGH_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_DEFAULT);
+	gproNet::cMessagePolicyTable separate(MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, gproNet::CHANNEL_DEFAULT);
+	separate.Set(gproNet::commonMessagePolicy, gproNet::commonMessagePolicyCount);
+
+	benchChannelsPass("shared", shared, gproNet::SET_GPRO_SERVER_PORT + 1);
+	benchChannelsPass("policy", separate, gproNet::SET_GPRO_SERVER_PORT + 2);
+	return 0;
+}
+
+
+// simulated scene: 500 moving entities replicated to clients with
+//	different budgets; checks every tick's update stays within budget
+//	usage: -bench-replication
+int benchReplication()
+{
+	enum { ENTITIES = 500, CLIENTS = 4, TICKS = 600 };
+	unsigned int const budget[CLIENTS] = { 4000, 1500, 600, 200 };
+	float const typeWeight[3] = { 4.0f, 2.0f, 1.0f };	// player, projectile, prop
+	gproNet::cReplicationScheduler* scheduler[CLIENTS];
+	gproNet::sSpatialPose* const pose = new gproNet::sSpatialPose[ENTITIES];
+	unsigned int* const size = new unsigned int[ENTITIES];
+	unsigned int* const selected = new unsigned int[ENTITIES];
+	unsigned int* const lastSent = new unsigned int[ENTITIES * CLIENTS];
+	unsigned char type[ENTITIES];
+	unsigned long long total[CLIENTS] = { 0 }, stale[CLIENTS][2] = { { 0 } }, samples[CLIENTS][2] = { { 0 } };
+	unsigned int maxBytes[CLIENTS] = { 0 };
+	unsigned int c, e, i, tick, count;
+	int result = 0;
+
+	srand(1);
+	for (e = 0; e < ENTITIES; ++e)
+	{
+		gproNet::sSpatialPose const start = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f },
+			{ (float)(rand() % 512 - 256), 0.0f, (float)(rand() % 512 - 256) } };
+		pose[e] = start;
+		type[e] = (unsigned char)(e < 16 ? 0 : e < 100 ? 1 : 2);
+		size[e] = sizeof(unsigned short) + gproNet::sSpatialPoseSchema::maxBytes;
+	}
+	memset(lastSent, 0, sizeof(unsigned int) * ENTITIES * CLIENTS);
+	for (c = 0; c < CLIENTS; ++c)
+	{
+		scheduler[c] = new gproNet::cReplicationScheduler(budget[c] - gproNet::MESSAGE_HEADER_BYTES);
+		scheduler[c]->SetObjectCount(ENTITIES);
+	}
+
+	for (tick = 1; tick <= TICKS; ++tick)
+	{
+		// move everything a little
+		for (e = 0; e < ENTITIES; ++e)
+		{
+			pose[e].translate[0] += (float)(rand() % 9 - 4) * 0.25f;
+			pose[e].translate[2] += (float)(rand() % 9 - 4) * 0.25f;
+			pose[e].rotate[1] = (float)(rand() % 628 - 314) * 0.01f;
+		}
+
+		// each client follows one of the players
+		for (c = 0; c < CLIENTS; ++c)
+		{
+			RakNet::BitStream bitstream(budget[c]);
+			float const* const view = pose[c].translate;
+
+			// accumulate by type and distance from client
+			for (e = 0; e < ENTITIES; ++e)
+			{
+				float const dx = pose[e].translate[0] - view[0], dz = pose[e].translate[2] - view[2];
+				scheduler[c]->Accumulate(e, gproNet::cReplicationScheduler::GetPriority(typeWeight[type[e]], sqrtf(dx * dx + dz * dz), 0.05f));
+			}
+
+			// fill budget and encode
+			count = scheduler[c]->Schedule(size, selected);
+			bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_TIMESTAMP);
+			bitstream.Write((unsigned short)tick);
+			bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_SPATIAL_POSE);
+			for (i = 0; i < count; ++i)
+			{
+				bitstream.Write((unsigned short)selected[i]);
+				pose[selected[i]].Write(bitstream);
+				lastSent[c * ENTITIES + selected[i]] = tick;
+			}
+			total[c] += bitstream.GetNumberOfBytesUsed();
+			if (bitstream.GetNumberOfBytesUsed() > maxBytes[c])
+				maxBytes[c] = bitstream.GetNumberOfBytesUsed();
+
+			// staleness near and far from client
+			for (e = 0; e < ENTITIES; ++e)
+			{
+				float const dx = pose[e].translate[0] - view[0], dz = pose[e].translate[2] - view[2];
+				i = (dx * dx + dz * dz < 64.0f * 64.0f) ? 0 : 1;
+				stale[c][i] += tick - lastSent[c * ENTITIES + e];
+				++samples[c][i];
+			}
+		}
+	}
+
+	for (c = 0; c < CLIENTS; ++c)
+	{
+		printf("budget %5u B/tick | avg %7.1f B  max %5u B %s | stale ticks near %6.2f  far %6.2f \n",
+			budget[c], (double)total[c] / (double)TICKS, maxBytes[c], maxBytes[c] <= budget[c] ? "ok  " : "OVER",
+			samples[c][0] ? (double)stale[c][0] / samples[c][0] : 0.0,
+			samples[c][1] ? (double)stale[c][1] / samples[c][1] : 0.0);
+		if (maxBytes[c] > budget[c])
+			result = 1;
+		delete scheduler[c];
+	}
+
+	delete[] lastSent;
+	delete[] selected;
+	delete[] size;
+	delete[] pose;
+	return result;
+}
+
+
+// entity store replication cost: move every entity each tick and time
+//	writing the update, checking a mirror store decodes the same poses
+//	usage: -bench-entities
+int benchEntities()
+{
+	enum { ENTITIES = 50000, TICKS = 100 };
+	gproNet::cEntityStore* const store = new gproNet::cEntityStore;
+	gproNet::cEntityStore* const mirror = new gproNet::cEntityStore;
+	gproNet::sSpatialPose pose = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } }, check;
+	RakNet::BitStream bitstream(ENTITIES * 24);
+	RakNet::TimeUS tWrite = 0, tRead = 0, tStart;
+	unsigned long long bytes = 0;
+	unsigned int e, tick, count, errors = 0;
+	float* x;
+	float* z;
+	float* yaw;
+
+	srand(1);
+	for (e = 0; e < ENTITIES; ++e)
+	{
+		pose.translate[0] = (float)(rand() % 512 - 256);
+		pose.translate[2] = (float)(rand() % 512 - 256);
+		store->Create(pose);
+	}
+	store->WriteAll(bitstream);
+	mirror->ReadDirty(bitstream);
+	store->ClearDirty();
+
+	for (tick = 0; tick < TICKS; ++tick)
+	{
+		// everything moves, a tenth also turns
+		count = store->GetCount();
+		x = store->GetComponent(gproNet::ENTITY_FIELD_TRANSLATE, 0);
+		z = store->GetComponent(gproNet::ENTITY_FIELD_TRANSLATE, 2);
+		yaw = store->GetComponent(gproNet::ENTITY_FIELD_ROTATE, 1);
+		for (e = 0; e < count; ++e)
+		{
+			x[e] += 0.125f;
+			z[e] -= 0.0625f;
+			store->MarkDirty(e, gproNet::ENTITY_FIELD_TRANSLATE);
+		}
+		for (e = tick % 10; e < count; e += 10)
+		{
+			yaw[e] = (float)((int)((e + tick) % 628) - 314) * 0.01f;
+			store->MarkDirty(e, gproNet::ENTITY_FIELD_ROTATE);
+		}
+
+		bitstream.Reset();
+		tStart = RakNet::GetTimeUS();
+		store->WriteDirty(bitstream);
+		tWrite += RakNet::GetTimeUS() - tStart;
+		bytes += bitstream.GetNumberOfBytesUsed();
+
+		tStart = RakNet::GetTimeUS();
+		mirror->ReadDirty(bitstream);
+		tRead += RakNet::GetTimeUS() - tStart;
+	}
+
+	// decoded poses within quantization error
+	for (e = 0; e < store->GetCount(); ++e)
+	{
+		store->GetPose(store->GetID(e), pose);
+		if (!mirror->GetPose(store->GetID(e), check) ||
+			fabsf(pose.translate[0] - check.translate[0]) > 0.001f ||
+			fabsf(pose.translate[2] - check.translate[2]) > 0.001f ||
+			fabsf(pose.rotate[1] - check.rotate[1]) > 0.002f)
+			++errors;
+	}
+
+	printf("%u entities | write %.3f ms/tick | read %.3f ms/tick | %.0f bytes/tick | %u mismatched \n",
+		(unsigned int)ENTITIES, (double)tWrite / (double)TICKS / 1000.0, (double)tRead / (double)TICKS / 1000.0,
+		(double)bytes / (double)TICKS, errors);
+	delete mirror;
+	delete store;
+	return (errors ? 1 : 0);
+}
+
+// batch pose quantization throughput of each kernel against one pose at
+//	a time through the schema, checking all produce the same bits
+//	usage: -bench-quantize
+int benchQuantize()
+{
+	enum { POSES = 100000, REPEAT = 20 };
+	gproNet::eQuantizeMode const mode[3] = { gproNet::QUANTIZE_SCALAR, gproNet::QUANTIZE_SSE2, gproNet::QUANTIZE_AVX2 };
+	char const* const name[3] = { "scalar", "sse2", "avx2" };
+	unsigned int const bytes = gproNet::GetPoseBatchBytes(POSES);
+	float* const source = new float[POSES * 9];
+	float* const decoded = new float[POSES * 9];
+	float* const reference = new float[POSES * 9];
+	unsigned char* const data = new unsigned char[bytes];
+	gproNet::sSpatialPose pose;
+	RakNet::BitStream bitstream(bytes);
+	RakNet::TimeUS tStart, dt;
+	unsigned int i, k, r, m;
+	int result = 0;
+
+	// component k of pose i at source[k * POSES + i]; a few values out of range
+	srand(1);
+	for (i = 0; i < POSES * 9; ++i)
+		source[i] = (float)(rand() % 2048 - 1024) * 0.6f / (float)(1 + rand() % 64);
+	{
+		float* const scale[3] = { source, source + POSES, source + POSES * 2 };
+		float* const rotate[3] = { source + POSES * 3, source + POSES * 4, source + POSES * 5 };
+		float* const translate[3] = { source + POSES * 6, source + POSES * 7, source + POSES * 8 };
+
+		// one at a time through schema
+		tStart = RakNet::GetTimeUS();
+		for (r = 0; r < REPEAT; ++r)
+		{
+			bitstream.Reset();
+			for (i = 0; i < POSES; ++i)
+			{
+				for (k = 0; k < 3; ++k)
+				{
+					pose.scale[k] = scale[k][i];
+					pose.rotate[k] = rotate[k][i];
+					pose.translate[k] = translate[k][i];
+				}
+				pose.Write(bitstream);
+			}
+		}
+		dt = RakNet::GetTimeUS() - tStart;
+		printf("%-8s encode %8.2f poses/us \n", "schema", dt ? (double)POSES * (double)REPEAT / (double)dt : 0.0);
+		for (i = 0; i < POSES; ++i)
+		{
+			pose.Read(bitstream);
+			for (k = 0; k < 3; ++k)
+			{
+				reference[k * POSES + i] = pose.scale[k];
+				reference[(k + 3) * POSES + i] = pose.rotate[k];
+				reference[(k + 6) * POSES + i] = pose.translate[k];
+			}
+		}
+
+		for (m = 0; m < 3; ++m)
+		{
+			float* const scale_out[3] = { decoded, decoded + POSES, decoded + POSES * 2 };
+			float* const rotate_out[3] = { decoded + POSES * 3, decoded + POSES * 4, decoded + POSES * 5 };
+			float* const translate_out[3] = { decoded + POSES * 6, decoded + POSES * 7, decoded + POSES * 8 };
+			RakNet::TimeUS dtDecode;
+			bool same;
+			if (gproNet::SetQuantizeMode(mode[m]) != mode[m])
+			{
+				printf("%-8s not supported \n", name[m]);
+				continue;
+			}
+
+			tStart = RakNet::GetTimeUS();
+			for (r = 0; r < REPEAT; ++r)
+				gproNet::EncodePoseBatch(scale, rotate, translate, POSES, data);
+			dt = RakNet::GetTimeUS() - tStart;
+
+			tStart = RakNet::GetTimeUS();
+			for (r = 0; r < REPEAT; ++r)
+				gproNet::DecodePoseBatch(data, POSES, scale_out, rotate_out, translate_out);
+			dtDecode = RakNet::GetTimeUS() - tStart;
+
+			same = !memcmp(data, bitstream.GetData(), bytes) && !memcmp(decoded, reference, sizeof(float) * POSES * 9);
+			printf("%-8s encode %8.2f poses/us | decode %8.2f poses/us | %s \n", name[m],
+				dt ? (double)POSES * (double)REPEAT / (double)dt : 0.0,
+				dtDecode ? (double)POSES * (double)REPEAT / (double)dtDecode : 0.0,
+				same ? "identical" : "MISMATCH");
+			if (!same)
+				result = 1;
+		}
+	}
+	gproNet::SetQuantizeMode(gproNet::QUANTIZE_AUTO);
+
+	delete[] data;
+	delete[] reference;
+	delete[] decoded;
+	delete[] source;
+	return result;
+}
+
+// lag compensation cost: rewind queries and rewound raycasts per second
+//	against a full history of moving entities
+//	usage: -bench-rewind
+int benchRewind()
+{
+	enum { ENTITIES = 1000, TICKS = 200, QUERIES = 1000000, RAYS = 2000 };
+	gproNet::cEntityStore* const store = new gproNet::cEntityStore;
+	gproNet::cPoseHistory* const history = new gproNet::cPoseHistory;
+	gproNet::sSpatialPose pose = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } }, sample;
+	RakNet::Time const tFirst = 1000, dtTick = 16;
+	RakNet::TimeUS tStart, dt;
+	float const direction[3] = { 0.0f, 0.0f, 1.0f };
+	float origin[3] = { 0.0f, 0.0f, -300.0f }, distance, checksum = 0.0f;
+	unsigned int e, tick, i, hits = 0, errors = 0;
+	float* x;
+
+	srand(1);
+	for (e = 0; e < ENTITIES; ++e)
+	{
+		pose.translate[0] = (float)(rand() % 512 - 256);
+		pose.translate[1] = (float)(rand() % 8 - 4);
+		pose.translate[2] = (float)(rand() % 512 - 256);
+		store->Create(pose);
+	}
+	for (tick = 1; tick <= TICKS; ++tick)
+	{
+		x = store->GetComponent(gproNet::ENTITY_FIELD_TRANSLATE, 0);
+		for (e = 0; e < ENTITIES; ++e)
+			x[e] += (e % 2) ? 0.25f : -0.25f;
+		history->Record(tick, tFirst + tick * dtTick, *store);
+
+		// recorded tick must come back exactly
+		if (tick == TICKS && (!history->Sample(7, tFirst + tick * dtTick, sample) || sample.translate[0] != x[store->GetSlot(7)]))
+			++errors;
+	}
+
+	tStart = RakNet::GetTimeUS();
+	for (i = 0; i < QUERIES; ++i)
+		if (history->Sample(i % ENTITIES, tFirst + ((unsigned int)TICKS - gproNet::HISTORY_FRAMES) * dtTick + (RakNet::Time)(i % (gproNet::HISTORY_FRAMES * dtTick)), sample))
+			checksum += sample.translate[0];
+	dt = RakNet::GetTimeUS() - tStart;
+	printf("rewind  %10.0f queries/s \n", dt ? (double)QUERIES * 1000000.0 / (double)dt : 0.0);
+
+	tStart = RakNet::GetTimeUS();
+	for (i = 0; i < RAYS; ++i)
+	{
+		origin[0] = (float)(i % 512) - 256.0f;
+		if (history->Raycast(origin, direction, 1024.0f, tFirst + (TICKS - (i % 32)) * dtTick, (unsigned int)gproNet::ENTITY_INVALID, distance) != (unsigned int)gproNet::ENTITY_INVALID)
+			++hits;
+	}
+	dt = RakNet::GetTimeUS() - tStart;
+	printf("raycast %10.0f shots/s against %u entities (%u hits) \n", dt ? (double)RAYS * 1000000.0 / (double)dt : 0.0, (unsigned int)ENTITIES, hits);
+	printf("history %llu bytes (%u entities x %u frames) | checksum %f | %u errors \n",
+		history->GetMemoryUsage(), (unsigned int)gproNet::HISTORY_ENTITIES, (unsigned int)gproNet::HISTORY_FRAMES, checksum, errors);
+
+	delete history;
+	delete store;
+	return (errors ? 1 : 0);
+}
+
+// receive everything waiting for bench client, counting chat messages
+//	and taking match room from game start
+static unsigned long long benchChatReceive(gproNet::cTransport& client, RakNet::SystemAddress& server_out, unsigned int& room_out, std::vector<gproNet::sChatMessage>& scratch)
+{
+	RakNet::Packet* packet = 0;
+	RakNet::MessageID msgID;
+	unsigned long long count = 0;
+	unsigned int game, player;
+	bool history;
+	while ((packet = client.Receive()) != 0)
+	{
+		RakNet::BitStream bitstream(packet->data, packet->length, false);
+		if (packet->data[0] == gproNet::ID_GPRO_MESSAGE_TIMESTAMP)
+			bitstream.IgnoreBytes(sizeof(RakNet::MessageID) + sizeof(unsigned short));
+		bitstream.Read(msgID);
+		if (msgID == ID_CONNECTION_REQUEST_ACCEPTED)
+			server_out = packet->systemAddress;
+		else if (msgID == gproNet::ID_GPRO_MESSAGE_GAME_START)
+		{
+			gproNet::ReadBitsValue(bitstream, game, 2);
+			gproNet::ReadBitsValue(bitstream, player, 1);
+			gproNet::ReadBitsValue(bitstream, room_out, gproNet::CHAT_ROOM_BITS);
+		}
+		else if (msgID == gproNet::ID_GPRO_MESSAGE_CHAT)
+		{
+			scratch.clear();
+			if (gproNet::ReadChatBatch(bitstream, scratch, history) > 0 && !history)
+				count += scratch.size();
+		}
+		client.DeallocatePacket(packet);
+	}
+	return count;
+}
+
+// chat throughput: paired clients post every tick, mostly to their match
+//	room and some to the global room; checks every post reaches every
+//	member and reports server cost per post and per tick
+//	usage: -bench-chat
+int benchChat()
+{
+	enum { CLIENTS = 8, POSTS = 256, TICKS = 300, GLOBAL_EVERY = 16 };
+	gproNet::cLoopbackNetwork network;
+	gproNet::cTransportLoopback serverTransport(network);
+	gproNet::cRakNetServer server(&serverTransport);
+	gproNet::cTransportLoopback* client[CLIENTS];
+	RakNet::SystemAddress serverAddress[CLIENTS];
+	unsigned int room[CLIENTS];
+	gproNet::sMetricsHistogram* const tickTime = new gproNet::sMetricsHistogram();
+	gproNet::sMessagePolicy const& send = server.GetMessagePolicy(gproNet::ID_GPRO_MESSAGE_CHAT);
+	std::vector<gproNet::sChatMessage> scratch;
+	RakNet::TimeUS tStart, dtServer = 0;
+	unsigned long long posts = 0, expected = 0, delivered = 0;
+	unsigned int c, tick, i, target;
+	char text[gproNet::CHAT_TEXT_MAX + 1];
+
+	// connect and pair up for matches, one at a time so pairs are known
+	for (c = 0; c < CLIENTS; ++c)
+	{
+		client[c] = new gproNet::cTransportLoopback(network);
+		client[c]->Startup(1, 0, 0);
+		client[c]->Connect("127.0.0.1", gproNet::SET_GPRO_SERVER_PORT);
+		room[c] = gproNet::CHAT_ROOM_GLOBAL;
+		server.MessageLoop();
+		benchChatReceive(*client[c], serverAddress[c], room[c], scratch);
+	}
+	for (c = 0; c < CLIENTS; ++c)
+	{
+		RakNet::BitStream bitstream;
+		bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_GAME_JOIN);
+		gproNet::WriteBitsValue(bitstream, gproNet::LOCKSTEP_MANCALA, 2);
+		client[c]->Send(&bitstream, HIGH_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_GAME, serverAddress[c], false);
+		server.MessageLoop();
+	}
+	for (c = 0; c < CLIENTS; ++c)
+		benchChatReceive(*client[c], serverAddress[c], room[c], scratch);
+
+	for (tick = 0; tick < TICKS; ++tick)
+	{
+		for (c = 0; c < CLIENTS; ++c)
+			for (i = 0; i < POSTS; ++i)
+			{
+				RakNet::BitStream bitstream;
+				target = (i % GLOBAL_EVERY) ? room[c] : (unsigned int)gproNet::CHAT_ROOM_GLOBAL;
+				sprintf(text, "player %u says hello for the %u time this tick", c, i);
+				bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_CHAT);
+				gproNet::WriteChatPost(bitstream, target, text);
+				if (client[c]->Send(&bitstream, send.priority, send.reliability, send.orderingChannel, serverAddress[c], false))
+				{
+					++posts;
+					expected += (target == gproNet::CHAT_ROOM_GLOBAL) ? CLIENTS : 2;
+				}
+			}
+
+		tStart = RakNet::GetTimeUS();
+		server.MessageLoop();
+		dtServer += RakNet::GetTimeUS() - tStart;
+		tStart = RakNet::GetTimeUS();
+		server.Tick();
+		tStart = RakNet::GetTimeUS() - tStart;
+		dtServer += tStart;
+		++tickTime->count[gproNet::sMetricsHistogram::GetBucket(tStart * 1000)];
+
+		for (c = 0; c < CLIENTS; ++c)
+			delivered += benchChatReceive(*client[c], serverAddress[c], room[c], scratch);
+	}
+
+	printf("chat %10.0f posts/s handled and fanned out by server (%llu posts) \n", dtServer ? (double)posts * 1000000.0 / (double)dtServer : 0.0, posts);
+	printf("tick p50 %8llu ns  p99 %8llu ns | delivered %llu of %llu \n",
+		tickTime->GetPercentile(50.0), tickTime->GetPercentile(99.0), delivered, expected);
+
+	for (c = 0; c < CLIENTS; ++c)
+	{
+		client[c]->Shutdown();
+		delete client[c];
+	}
+	delete tickTime;
+	return (delivered == expected ? 0 : 1);
+}
+
+// broadcast cost: full entity update sent to many loopback peers, encoded
+//	again for every peer and then encoded once into a shared message;
+//	checks every peer receives identical bytes
+//	usage: -bench-broadcast
+int benchBroadcast()
+{
+	enum { ENTITIES = 2000, PEERS = 32, REPEAT = 50 };
+	gproNet::cLoopbackNetwork network;
+	gproNet::cTransportLoopback server(network);
+	gproNet::cTransportLoopback* peer[PEERS];
+	RakNet::SystemAddress address[PEERS];
+	gproNet::cEntityStore* const store = new gproNet::cEntityStore;
+	gproNet::sSpatialPose pose = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+	RakNet::Packet* packet = 0;
+	RakNet::TimeUS tStart, dtEach = 0, dtOnce = 0;
+	unsigned long long received = 0, mismatched = 0;
+	unsigned int e, p, r, length = 0;
+
+	srand(1);
+	for (e = 0; e < ENTITIES; ++e)
+	{
+		pose.translate[0] = (float)(rand() % 512 - 256);
+		pose.translate[2] = (float)(rand() % 512 - 256);
+		store->Create(pose);
+	}
+	server.Startup(PEERS, PEERS, gproNet::SET_GPRO_SERVER_PORT + 3);
+	for (p = 0; p < PEERS; ++p)
+	{
+		peer[p] = new gproNet::cTransportLoopback(network);
+		peer[p]->Startup(1, 0, 0);
+		peer[p]->Connect("127.0.0.1", gproNet::SET_GPRO_SERVER_PORT + 3);
+		while ((packet = peer[p]->Receive()) != 0)
+			peer[p]->DeallocatePacket(packet);
+		address[p] = RakNet::SystemAddress("127.0.0.1", peer[p]->GetPort());
+	}
+	while ((packet = server.Receive()) != 0)
+		server.DeallocatePacket(packet);
+
+	for (r = 0; r < REPEAT; ++r)
+	{
+		// encode for every peer
+		tStart = RakNet::GetTimeUS();
+		for (p = 0; p < PEERS; ++p)
+		{
+			RakNet::BitStream bitstream;
+			bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_ENTITY_UPDATE);
+			store->WriteAll(bitstream);
+			server.Send(&bitstream, MEDIUM_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_STREAM, address[p], false);
+		}
+		dtEach += RakNet::GetTimeUS() - tStart;
+
+		// encode once, share buffer
+		tStart = RakNet::GetTimeUS();
+		{
+			RakNet::BitStream bitstream;
+			bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_ENTITY_UPDATE);
+			store->WriteAll(bitstream);
+			gproNet::cSharedMessage const message(bitstream);
+			for (p = 0; p < PEERS; ++p)
+				server.Send(message.GetData(), message.GetLength(), MEDIUM_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_STREAM, address[p], false);
+			length = message.GetLength();
+		}
+		dtOnce += RakNet::GetTimeUS() - tStart;
+
+		// both sends of each peer must match
+		for (p = 0; p < PEERS; ++p)
+		{
+			RakNet::Packet* const first = peer[p]->Receive();
+			RakNet::Packet* const second = peer[p]->Receive();
+			if (!first || !second || first->length != second->length || memcmp(first->data, second->data, first->length))
+				++mismatched;
+			received += (first ? 1 : 0) + (second ? 1 : 0);
+			peer[p]->DeallocatePacket(first);
+			peer[p]->DeallocatePacket(second);
+		}
+	}
+
+	printf("broadcast %u bytes to %u peers | encode each %8.1f us | encode once %8.1f us | %llu received, %llu mismatched \n",
+		length, (unsigned int)PEERS, (double)dtEach / (double)REPEAT, (double)dtOnce / (double)REPEAT, received, mismatched);
+
+	for (p = 0; p < PEERS; ++p)
+	{
+		peer[p]->Shutdown();
+		delete peer[p];
+	}
+	server.Shutdown();
+	delete store;
+	return (mismatched ? 1 : 0);
+}
+
+// spectator: bare transport mirroring the entity stream it is sent
+struct sSpectator
+{
+	gproNet::cTransport* transport;
+	gproNet::cEntityStore* entities;
+	unsigned long long messages;
+	bool connected;
+};
+
+// receive everything waiting for spectator
+static void spectatorReceive(sSpectator& spectator)
+{
+	RakNet::Packet* packet = 0;
+	RakNet::MessageID msgID;
+	while ((packet = spectator.transport->Receive()) != 0)
+	{
+		RakNet::BitStream bitstream(packet->data, packet->length, false);
+		if (packet->data[0] == gproNet::ID_GPRO_MESSAGE_TIMESTAMP)
+			bitstream.IgnoreBytes(sizeof(RakNet::MessageID) + sizeof(unsigned short));
+		bitstream.Read(msgID);
+		if (msgID == ID_CONNECTION_REQUEST_ACCEPTED)
+			spectator.connected = true;
+		else if (msgID == gproNet::ID_GPRO_MESSAGE_ENTITY_UPDATE && spectator.entities->ReadDirty(bitstream) >= 0)
+			++spectator.messages;
+		else if (msgID == gproNet::ID_GPRO_MESSAGE_ENTITY_DESTROY && spectator.entities->ReadDestroyed(bitstream) >= 0)
+			++spectator.messages;
+		spectator.transport->DeallocatePacket(packet);
+	}
+}
+
+// one relay tree pass: server feeds two relays, each feeding two leaf
+//	relays that spectators spread over
+//	return: number of spectators not matching server
+static unsigned int benchRelayPass(unsigned int const count, unsigned long long& serverBytes_out, unsigned long long& delivered_out)
+{
+	enum { ENTITIES = 200, MIDDLE = 2, LEAVES = 4, TICKS = 120, DELAY = 40 };
+	gproNet::cLoopbackNetwork network;
+	gproNet::cTransportLoopback serverTransport(network);
+	gproNet::cRakNetServer server(&serverTransport);
+	gproNet::cTransportLoopback* relayTransport[MIDDLE + LEAVES];
+	gproNet::cRakNetRelay* relay[MIDDLE + LEAVES];
+	sSpectator* const spectator = new sSpectator[count];
+	gproNet::sMetricsSnapshot* const snapshot = new gproNet::sMetricsSnapshot;
+	gproNet::sSpatialPose pose = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } }, check;
+	gproNet::cEntityStore& entities = server.GetEntities();
+	unsigned int i, tick, e, id, mismatched = 0;
+
+	// tree: middle relays under server, leaves under middle, all delayed
+	for (i = 0; i < MIDDLE + LEAVES; ++i)
+	{
+		relayTransport[i] = new gproNet::cTransportLoopback(network);
+		relay[i] = (i < MIDDLE) ?
+			new gproNet::cRakNetRelay(relayTransport[i], "127.0.0.1", gproNet::SET_GPRO_SERVER_PORT, (unsigned short)(gproNet::SET_GPRO_RELAY_PORT + i), 4, DELAY / 2) :
+			new gproNet::cRakNetRelay(relayTransport[i], "127.0.0.1", (unsigned short)(gproNet::SET_GPRO_RELAY_PORT + i % MIDDLE), (unsigned short)(gproNet::SET_GPRO_RELAY_PORT + i), (unsigned short)count, DELAY / 2);
+	}
+	srand(1);
+	for (e = 0; e < ENTITIES; ++e)
+	{
+		pose.translate[0] = (float)(rand() % 512 - 256);
+		entities.Create(pose);
+	}
+	for (i = 0; i < count; ++i)
+	{
+		gproNet::cTransportLoopback* const transport = new gproNet::cTransportLoopback(network);
+		spectator[i].transport = transport;
+		spectator[i].entities = new gproNet::cEntityStore;
+		spectator[i].messages = 0;
+		spectator[i].connected = false;
+		transport->Startup(1, 0, 0);
+		transport->Connect("127.0.0.1", (unsigned short)((unsigned int)gproNet::SET_GPRO_RELAY_PORT + MIDDLE + i % LEAVES));
+	}
+
+	// run, creating and destroying a few entities along the way
+	for (tick = 0; tick < TICKS + DELAY; ++tick)
+	{
+		if (tick < TICKS)
+		{
+			for (e = tick % 4; e < entities.GetCount(); e += 4)
+			{
+				id = entities.GetID(e);
+				entities.GetPose(id, pose);
+				pose.translate[2] += 0.5f;
+				entities.SetPose(id, pose);
+			}
+			if (tick % 10 == 5)
+			{
+				entities.Destroy(entities.GetID(tick % entities.GetCount()));
+				entities.Create(pose);
+			}
+		}
+		server.Tick();
+		server.MessageLoop();
+		for (i = 0; i < MIDDLE + LEAVES; ++i)
+		{
+			relay[i]->MessageLoop();
+			relay[i]->Update();
+		}
+		for (i = 0; i < count; ++i)
+			spectatorReceive(spectator[i]);
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+
+	// every spectator ends with server's entities
+	delivered_out = 0;
+	for (i = 0; i < count; ++i)
+	{
+		bool match = spectator[i].connected && spectator[i].entities->GetCount() == entities.GetCount();
+		for (e = 0; match && e < entities.GetCount(); ++e)
+		{
+			entities.GetPose(entities.GetID(e), pose);
+			match = spectator[i].entities->GetPose(entities.GetID(e), check) && fabsf(pose.translate[2] - check.translate[2]) < 0.01f;
+		}
+		mismatched += match ? 0 : 1;
+		delivered_out += spectator[i].messages;
+	}
+	server.GetMetrics().Snapshot(*snapshot);
+	serverBytes_out = 0;
+	for (i = 0; i < gproNet::METRICS_MESSAGE_IDS; ++i)
+		serverBytes_out += snapshot->message[i].bytesOut;
+
+	for (i = 0; i < count; ++i)
+	{
+		spectator[i].transport->Shutdown();
+		delete spectator[i].transport;
+		delete spectator[i].entities;
+	}
+	for (i = 0; i < MIDDLE + LEAVES; ++i)
+	{
+		delete relay[i];
+		delete relayTransport[i];
+	}
+	delete[] spectator;
+	delete snapshot;
+	return mismatched;
+}
+
+// spectator relay tree with growing audience: every spectator must end
+//	with the server's entities while server traffic stays the same
+//	usage: -bench-relay
+int benchRelay()
+{
+	unsigned int const count[3] = { 8, 80, 400 };
+	unsigned long long serverBytes, delivered;
+	unsigned int i, mismatched, result = 0;
+	for (i = 0; i < 3; ++i)
+	{
+		mismatched = benchRelayPass(count[i], serverBytes, delivered);
+		printf("%4u spectators | server sent %8llu bytes | %9llu messages delivered | %u mismatched \n",
+			count[i], serverBytes, delivered, mismatched);
+		result += mismatched;
+	}
+	return (result ? 1 : 0);
+}
+
+// run many spectators in one process against a relay, for multi-process
+//	tests (server, relays and spectators each in their own process)
+//	usage: -spectate <host> <port> <count>
+int runSpectators(char const host[], unsigned short const port, unsigned int const count)
+{
+	sSpectator* const spectator = new sSpectator[count];
+	RakNet::Time tReport = 0;
+	unsigned long long messages;
+	unsigned int i, connected, fewest, most;
+	for (i = 0; i < count; ++i)
+	{
+		spectator[i].transport = new gproNet::cTransportRakNet;
+		spectator[i].entities = new gproNet::cEntityStore;
+		spectator[i].messages = 0;
+		spectator[i].connected = false;
+		spectator[i].transport->Startup(1, 0, 0);
+		spectator[i].transport->Connect(host, port);
+	}
+	while (1)
+	{
+		for (i = 0; i < count; ++i)
+			spectatorReceive(spectator[i]);
+		if (RakNet::GetTime() - tReport >= 5000)
+		{
+			tReport = RakNet::GetTime();
+			messages = 0;
+			connected = most = 0;
+			fewest = (unsigned int)-1;
+			for (i = 0; i < count; ++i)
+			{
+				connected += spectator[i].connected ? 1 : 0;
+				messages += spectator[i].messages;
+				fewest = spectator[i].entities->GetCount() < fewest ? spectator[i].entities->GetCount() : fewest;
+				most = spectator[i].entities->GetCount() > most ? spectator[i].entities->GetCount() : most;
+			}
+			printf("%u of %u spectators connected | %llu messages | %u to %u entities \n", connected, count, messages, fewest, most);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return 0;
+}
+
+// routed player: bare client that asks router for its match's shard,
+//	moves there and plays mancala against whoever shares its match key
+struct sRoutedPlayer
+{
+	gproNet::cTransport* transport;
+	gproNet::cLockstepSession game;
+	RakNet::SystemAddress server;	// router, then shard
+	unsigned int key;				// match key
+	unsigned short shard;			// shard port once routed
+	unsigned char player;			// index in current game
+	bool refused;					// every shard was full
+	bool resuming;					// rejoining match after server restart
+	unsigned int resumed;			// sequence of full state last received
+	unsigned long long moves;		// moves applied
+};
+
+// send move if it is player's turn, trying cups from a random one
+static void routedPlayerMove(sRoutedPlayer& player)
+{
+	gproNet::sLockstepMove move = { player.player, 0, 0, 0, 0 };
+	unsigned int i, start = (unsigned int)rand();
+	if (player.game.GetGame() != gproNet::LOCKSTEP_MANCALA || player.game.IsOver() || player.game.GetTurn() != player.player)
+		return;
+	for (i = 0; i < 6; ++i)
+	{
+		gproNet::cLockstepSession trial = player.game;
+		move.a = (unsigned char)(gpro_mancala_cup1 + (start + i) % 6);
+		if (trial.Apply(move) == 0)
+		{
+			RakNet::BitStream bitstream;
+			bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_GAME_MOVE);
+			player.game.WriteMove(bitstream, move);
+			player.transport->Send(&bitstream, HIGH_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_GAME, player.server, false);
+			return;
+		}
+	}
+}
+
+// ask shard for a game (again)
+static void routedPlayerJoin(sRoutedPlayer& player)
+{
+	RakNet::BitStream bitstream;
+	bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_GAME_JOIN);
+	gproNet::WriteBitsValue(bitstream, gproNet::LOCKSTEP_MANCALA, 2);
+	player.transport->Send(&bitstream, HIGH_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_GAME, player.server, false);
+}
+
+// receive everything waiting for routed player and respond
+static void routedPlayerReceive(sRoutedPlayer& player, char const host[])
+{
+	RakNet::Packet* packet = 0;
+	RakNet::MessageID msgID;
+	while ((packet = player.transport->Receive()) != 0)
+	{
+		RakNet::BitStream bitstream(packet->data, packet->length, false);
+		if (packet->data[0] == gproNet::ID_GPRO_MESSAGE_TIMESTAMP)
+			bitstream.IgnoreBytes(sizeof(RakNet::MessageID) + sizeof(unsigned short));
+		bitstream.Read(msgID);
+		switch (msgID)
+		{
+		case ID_CONNECTION_REQUEST_ACCEPTED:
+		{
+			// router first, then shard; server puts player resuming a
+			//	match back in it
+			player.server = packet->systemAddress;
+			if (player.shard && !player.resuming)
+				routedPlayerJoin(player);
+			else
+			{
+				RakNet::BitStream bitstream_w;
+				bitstream_w.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_ROUTE);
+				bitstream_w.Write(player.key);
+				player.transport->Send(&bitstream_w, HIGH_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_DEFAULT, player.server, false);
+			}
+		}	break;
+		case gproNet::ID_GPRO_MESSAGE_ROUTE:
+		{
+			bitstream.Read(player.shard);
+			player.refused = !player.shard;
+			player.transport->Disconnect(player.server);
+			player.server = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+			if (player.shard)
+				player.transport->Connect(host, player.shard);
+		}	break;
+		case gproNet::ID_GPRO_MESSAGE_GAME_START:
+		{
+			unsigned int game, index;
+			gproNet::ReadBitsValue(bitstream, game, 2);
+			gproNet::ReadBitsValue(bitstream, index, 1);
+			if (game != gproNet::LOCKSTEP_NONE)
+			{
+				player.game.Start((gproNet::eLockstepGame)game);
+				player.player = (unsigned char)index;
+				if (!player.resuming)
+					routedPlayerMove(player);
+			}
+			else if (!player.game.IsOver())
+			{
+				// opponent left mid-game; after a finished game the
+				//	player has already asked for the next one
+				player.game.Start(gproNet::LOCKSTEP_NONE);
+				routedPlayerJoin(player);
+			}
+		}	break;
+		case gproNet::ID_GPRO_MESSAGE_GAME_RESYNC:
+		{
+			player.resuming = false;
+			if (player.game.ReadState(bitstream, player.player))
+			{
+				player.resumed = player.game.GetSequence();
+				routedPlayerMove(player);
+			}
+		}	break;
+		case gproNet::ID_GPRO_MESSAGE_GAME_MOVE:
+		{
+			gproNet::sLockstepMove move;
+			unsigned int sequence, turn;
+			if (bitstream.Read(sequence) && gproNet::ReadBitsValue(bitstream, turn, 1) && player.game.ReadMove(bitstream, move) &&
+				player.game.Apply(move) == 0)
+			{
+				++player.moves;
+				if (player.game.IsOver())
+					routedPlayerJoin(player);
+				else
+					routedPlayerMove(player);
+			}
+		}	break;
+		}
+		player.transport->DeallocatePacket(packet);
+	}
+}
+
+// shard loop for benchmark thread: messages as they come, 60 Hz ticks
+static void benchShardRun(gproNet::cRakNetServer* const server, std::atomic<bool> const* const running)
+{
+	RakNet::Time tTick = 0;
+	while (*running)
+	{
+		server->MessageLoop();
+		if (RakNet::GetTime() - tTick >= 16)
+		{
+			tTick = RakNet::GetTime();
+			server->Tick();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+// one sharded pass: shards on their own threads behind a router, with
+//	more players than one shard can hold
+//	return: number of matches split across shards
+static unsigned int benchShardsPass(unsigned int const shards, unsigned int const players,
+	unsigned int& hosted_out, unsigned int& refused_out, double& movesPerSecond_out)
+{
+	enum { SHARDS_MAX = 8, CAPACITY = 16, SETTLE = 500, DURATION = 2000 };
+	gproNet::cLoopbackNetwork network;
+	gproNet::cTransportLoopback routerTransport(network);
+	gproNet::cRakNetRouter router(&routerTransport);
+	gproNet::cTransportLoopback* shardTransport[SHARDS_MAX];
+	gproNet::cRakNetServer* shard[SHARDS_MAX];
+	std::thread* thread[SHARDS_MAX];
+	std::atomic<bool> running(true);
+	sRoutedPlayer* const player = new sRoutedPlayer[players];
+	RakNet::Time tStart;
+	unsigned long long moves;
+	unsigned int i, split = 0;
+
+	// shards report in before players arrive
+	for (i = 0; i < shards && i < SHARDS_MAX; ++i)
+	{
+		shardTransport[i] = new gproNet::cTransportLoopback(network);
+		shard[i] = new gproNet::cRakNetServer(shardTransport[i], (unsigned short)(gproNet::SET_GPRO_SERVER_PORT + i), CAPACITY);
+		shard[i]->ConnectRouter("127.0.0.1", gproNet::SET_GPRO_ROUTER_PORT);
+		shard[i]->MessageLoop();
+	}
+	router.MessageLoop();
+	for (i = 0; i < shards && i < SHARDS_MAX; ++i)
+		thread[i] = new std::thread(benchShardRun, shard[i], &running);
+
+	// pairs of players share a match key
+	srand(1);
+	for (i = 0; i < players; ++i)
+	{
+		player[i].transport = new gproNet::cTransportLoopback(network);
+		player[i].server = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+		player[i].key = 1000 + i / 2;
+		player[i].shard = 0;
+		player[i].player = 0;
+		player[i].refused = false;
+		player[i].resuming = false;
+		player[i].resumed = 0;
+		player[i].moves = 0;
+		player[i].transport->Startup(2, 0, 0);
+		player[i].transport->Connect("127.0.0.1", gproNet::SET_GPRO_ROUTER_PORT);
+	}
+
+	// settle routing, then count moves
+	tStart = RakNet::GetTime();
+	moves = 0;
+	while (RakNet::GetTime() - tStart < SETTLE + DURATION)
+	{
+		router.MessageLoop();
+		for (i = 0; i < players; ++i)
+		{
+			if (RakNet::GetTime() - tStart < SETTLE)
+				player[i].moves = 0;
+			routedPlayerReceive(player[i], "127.0.0.1");
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	running = false;
+
+	hosted_out = refused_out = 0;
+	for (i = 0; i < players; ++i)
+	{
+		hosted_out += (player[i].server != RakNet::UNASSIGNED_SYSTEM_ADDRESS) ? 1 : 0;
+		refused_out += player[i].refused ? 1 : 0;
+		moves += player[i].moves;
+		if (i % 2 && player[i].shard != player[i - 1].shard)
+			++split;
+	}
+	// each move is applied by both players
+	movesPerSecond_out = (double)moves / 2.0 * 1000.0 / (double)DURATION;
+
+	for (i = 0; i < shards && i < SHARDS_MAX; ++i)
+	{
+		thread[i]->join();
+		delete thread[i];
+	}
+	for (i = 0; i < players; ++i)
+	{
+		player[i].transport->Shutdown();
+		delete player[i].transport;
+	}
+	for (i = 0; i < shards && i < SHARDS_MAX; ++i)
+	{
+		delete shard[i];
+		delete shardTransport[i];
+	}
+	delete[] player;
+	return split;
+}
+
+// sharded servers behind router: consistent hashing moves only a fair
+//	share of keys per shard added, and capacity grows with shard count
+//	usage: -bench-shards
+int benchShards()
+{
+	enum { KEYS = 100000, PLAYERS = 64 };
+	gproNet::cHashRing ring;
+	std::vector<unsigned int> owner(KEYS), count;
+	unsigned int const passes[3] = { 1, 2, 4 };
+	unsigned int shards, key, moved, most, hosted, refused, split, i, result = 0;
+	double movesPerSecond;
+
+	// keys moved when adding each shard, and balance after
+	for (shards = 1; shards <= 8; ++shards)
+	{
+		ring.Add(shards);
+		count.assign(shards + 1, 0);
+		for (key = moved = 0; key < KEYS; ++key)
+		{
+			i = ring.Find(key);
+			moved += (shards > 1 && i != owner[key]) ? 1 : 0;
+			owner[key] = i;
+			++count[i];
+		}
+		for (i = 1, most = 0; i <= shards; ++i)
+			most = count[i] > most ? count[i] : most;
+		printf("%u shards | %5.1f%% of keys moved (ideal %5.1f%%) | busiest shard %.2fx average \n", shards,
+			100.0 * moved / (double)KEYS, shards > 1 ? 100.0 / shards : 0.0, (double)most * shards / (double)KEYS);
+	}
+
+	// same audience, more shards
+	for (i = 0; i < 3; ++i)
+	{
+		split = benchShardsPass(passes[i], PLAYERS, hosted, refused, movesPerSecond);
+		printf("%u shards | %2u of %u players hosted, %2u refused | %8.0f moves/s | %u matches split \n",
+			passes[i], hosted, PLAYERS, refused, movesPerSecond, split);
+		result += split;
+	}
+	return (result ? 1 : 0);
+}
+
+// run many routed players in one process, for multi-process shard tests
+//	(router, each shard and the players in their own process)
+//	usage: -route-players <host> <router port> <count>
+int runRoutedPlayers(char const host[], unsigned short const port, unsigned int const count)
+{
+	sRoutedPlayer* const player = new sRoutedPlayer[count];
+	RakNet::Time tReport = RakNet::GetTime();
+	unsigned long long moves, movesLast = 0;
+	unsigned int i, hosted, refused;
+	for (i = 0; i < count; ++i)
+	{
+		player[i].transport = new gproNet::cTransportRakNet;
+		player[i].server = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+		player[i].key = 1000 + i / 2;
+		player[i].shard = 0;
+		player[i].player = 0;
+		player[i].refused = false;
+		player[i].resuming = false;
+		player[i].resumed = 0;
+		player[i].moves = 0;
+		player[i].transport->Startup(2, 0, 0);
+		player[i].transport->Connect(host, port);
+	}
+	while (1)
+	{
+		for (i = 0; i < count; ++i)
+			routedPlayerReceive(player[i], host);
+		if (RakNet::GetTime() - tReport >= 5000)
+		{
+			moves = 0;
+			hosted = refused = 0;
+			for (i = 0; i < count; ++i)
+			{
+				hosted += (player[i].shard && player[i].server != RakNet::UNASSIGNED_SYSTEM_ADDRESS) ? 1 : 0;
+				refused += player[i].refused ? 1 : 0;
+				moves += player[i].moves;
+			}
+			printf("%u of %u players hosted, %u refused | %.0f moves/s \n", hosted, count, refused,
+				(double)(moves - movesLast) / 2.0 * 1000.0 / (double)(RakNet::GetTime() - tReport));
+			movesLast = moves;
+			tReport = RakNet::GetTime();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return 0;
+}
+
+// checkpoint store survives saves cut short: each slot must load as it
+//	was before or after the interrupted save
+//	return: number of slots loading neither
+static unsigned int benchCheckpointTorn(char const path[])
+{
+	enum { SLOTS = 8 };
+	gproNet::cCheckpointStore store;
+	gproNet::sMatchCheckpoint record;
+	gpro_filemap filemap = { { 0, 0 }, 0, 0, 0 };
+	unsigned int slot, copy, failed = 0;
+
+	// two good saves of every slot
+	remove(path);
+	if (!store.Open(path, SLOTS))
+		return SLOTS;
+	memset(&record, 0, sizeof(record));
+	for (slot = 0; slot < SLOTS; ++slot)
+	{
+		store.Allocate();
+		for (record.session.sequence = 1; record.session.sequence <= 2; ++record.session.sequence)
+			store.Save(slot, record);
+	}
+	store.Close();
+
+	// interrupt third save of each: copy being written is the older one
+	//	(first save, copy 1); even slots die before publishing, odd slots
+	//	publish over a half-written copy (writes reordered by a crash)
+	if (gpro_filemapOpen(&filemap, path, 0, 0) == 0)
+	{
+		for (slot = 0; slot < SLOTS; ++slot)
+		{
+			gproNet::sMatchCheckpoint* const target = (gproNet::sMatchCheckpoint*)((char*)filemap.data + sizeof(gproNet::sCheckpointHeader)) + (slot * 2 + 1);
+			unsigned char* const body = (unsigned char*)&target->session;
+			target->generation = (slot % 2) ? 3 : 0;
+			target->session.sequence = 3;
+			memset(body + sizeof(target->session) / 2, 0xcd, sizeof(target->session) / 2);
+		}
+		gpro_filemapClose(&filemap);
+	}
+
+	if (!store.Open(path, SLOTS))
+		return SLOTS;
+	for (slot = 0; slot < SLOTS; ++slot)
+		if (!store.Load(slot, record) || record.session.sequence != 2)
+			++failed;
+
+	// next save goes over the damaged copy
+	for (slot = copy = 0; slot < SLOTS; ++slot)
+	{
+		record.session.sequence = 4;
+		store.Save(slot, record);
+		if (store.Load(slot, record) && record.session.sequence == 4)
+			++copy;
+	}
+	store.Close();
+	remove(path);
+	return failed + (SLOTS - copy);
+}
+
+// server restart: matches in progress resume from the mapped checkpoint
+//	file when a new server process opens it and players reconnect
+//	usage: -bench-checkpoint
+int benchCheckpoint()
+{
+	enum { MATCHES = 200, PLAYERS = MATCHES * 2, PLAY = 300, RESUME = 300 };
+	char const path[] = "gpro-net-bench.gpck";
+	gproNet::cLoopbackNetwork network;
+	gproNet::cTransportLoopback* serverTransport = new gproNet::cTransportLoopback(network);
+	gproNet::cRakNetServer* server = new gproNet::cRakNetServer(serverTransport, gproNet::SET_GPRO_SERVER_PORT, PLAYERS);
+	sRoutedPlayer* const player = new sRoutedPlayer[PLAYERS];
+	unsigned int* const sequence = new unsigned int[PLAYERS];
+	bool* const inGame = new bool[PLAYERS];
+	RakNet::TimeUS tStart, dtRestore;
+	RakNet::Time tPlay;
+	unsigned long long moves;
+	unsigned int i, torn, playing = 0, behind = 0, stalled = 0, resumed;
+	int restored;
+
+	torn = benchCheckpointTorn(path);
+	printf("torn saves: %u slots not recovered \n", torn);
+
+	// play until server dies
+	remove(path);
+	server->OpenCheckpoints(path);
+	for (i = 0; i < PLAYERS; ++i)
+	{
+		player[i].transport = new gproNet::cTransportLoopback(network);
+		player[i].server = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+		player[i].key = 0;
+		player[i].shard = gproNet::SET_GPRO_SERVER_PORT;
+		player[i].player = 0;
+		player[i].refused = false;
+		player[i].resuming = false;
+		player[i].resumed = 0;
+		player[i].moves = 0;
+		player[i].transport->Startup(1, 0, 0);
+		player[i].transport->Connect("127.0.0.1", gproNet::SET_GPRO_SERVER_PORT);
+	}
+	srand(1);
+	for (tPlay = RakNet::GetTime(); RakNet::GetTime() - tPlay < PLAY;)
+	{
+		server->MessageLoop();
+		for (i = 0; i < PLAYERS; ++i)
+			routedPlayerReceive(player[i], "127.0.0.1");
+	}
+	delete server;
+	delete serverTransport;
+
+	// players in a game expect to resume it where they left off
+	for (i = 0; i < PLAYERS; ++i)
+	{
+		routedPlayerReceive(player[i], "127.0.0.1");
+		player[i].resuming = inGame[i] = (player[i].game.GetGame() != gproNet::LOCKSTEP_NONE && !player[i].game.IsOver());
+		sequence[i] = player[i].game.GetSequence();
+		playing += inGame[i] ? 1 : 0;
+		player[i].moves = 0;
+	}
+
+	// new server picks up file
+	serverTransport = new gproNet::cTransportLoopback(network);
+	server = new gproNet::cRakNetServer(serverTransport, gproNet::SET_GPRO_SERVER_PORT, PLAYERS);
+	tStart = RakNet::GetTimeUS();
+	restored = server->OpenCheckpoints(path);
+	dtRestore = RakNet::GetTimeUS() - tStart;
+	for (i = 0; i < PLAYERS; ++i)
+		player[i].transport->Connect("127.0.0.1", gproNet::SET_GPRO_SERVER_PORT);
+	for (tPlay = RakNet::GetTime(); RakNet::GetTime() - tPlay < RESUME;)
+	{
+		server->MessageLoop();
+		for (i = 0; i < PLAYERS; ++i)
+			routedPlayerReceive(player[i], "127.0.0.1");
+	}
+
+	// every resumed player got its game back no earlier than it last saw
+	//	it, and games went on
+	for (i = 0, moves = 0, resumed = 0; i < PLAYERS; ++i)
+	{
+		if (inGame[i] && !player[i].resuming)
+		{
+			++resumed;
+			behind += (player[i].resumed < sequence[i]) ? 1 : 0;
+		}
+		stalled += player[i].moves ? 0 : 1;
+		moves += player[i].moves;
+	}
+	printf("%d matches restored in %llu us | %u of %u players resumed, %u behind | %u players idle | %llu moves after restart \n",
+		restored, (unsigned long long)dtRestore, resumed, playing, behind, stalled, moves / 2);
+
+	for (i = 0; i < PLAYERS; ++i)
+	{
+		player[i].transport->Shutdown();
+		delete player[i].transport;
+	}
+	delete server;
+	delete serverTransport;
+	delete[] player;
+	delete[] sequence;
+	delete[] inGame;
+	remove(path);
+	return ((torn || behind || resumed < playing || stalled) ? 1 : 0);
+}
+
+// send path allocations: clients chat and play while every entity moves;
+//	once warm, writing every message must take streams from the pool
+//	without allocating, and an update written into a fresh stream is timed
+//	against the same update in a pooled one
+//	usage: -bench-pool
+int benchPool()
+{
+	enum { CLIENTS = 16, ENTITIES = 500, POSTS = 4, WARMUP = 60, TICKS = 600, REPEAT = 1000 };
+	gproNet::cLoopbackNetwork network;
+	gproNet::cTransportLoopback serverTransport(network);
+	gproNet::cRakNetServer server(&serverTransport);
+	gproNet::cTransportLoopback* client[CLIENTS];
+	RakNet::SystemAddress serverAddress[CLIENTS];
+	gproNet::cEntityStore& entities = server.GetEntities();
+	gproNet::cBitStreamPool& pool = gproNet::cBitStreamPool::GetLocal();
+	gproNet::sMessagePolicy const& send = server.GetMessagePolicy(gproNet::ID_GPRO_MESSAGE_CHAT);
+	gproNet::sSpatialPose pose = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+	std::vector<unsigned int> id;
+	RakNet::Packet* packet = 0;
+	RakNet::TimeUS tStart, dtFresh = 0, dtPooled = 0;
+	unsigned long long allocated = 0, acquired = 0, packets = 0;
+	unsigned int c, e, tick, i, length = 0;
+	char text[gproNet::CHAT_TEXT_MAX + 1];
+
+	// connect and pair up for matches (each match opens a chat room)
+	srand(1);
+	for (c = 0; c < CLIENTS; ++c)
+	{
+		client[c] = new gproNet::cTransportLoopback(network);
+		client[c]->Startup(1, 0, 0);
+		client[c]->Connect("127.0.0.1", gproNet::SET_GPRO_SERVER_PORT);
+		server.MessageLoop();
+		while ((packet = client[c]->Receive()) != 0)
+		{
+			serverAddress[c] = packet->systemAddress;
+			client[c]->DeallocatePacket(packet);
+		}
+	}
+	for (c = 0; c < CLIENTS; ++c)
+	{
+		RakNet::BitStream bitstream;
+		bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_GAME_JOIN);
+		gproNet::WriteBitsValue(bitstream, gproNet::LOCKSTEP_MANCALA, 2);
+		client[c]->Send(&bitstream, HIGH_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_GAME, serverAddress[c], false);
+		server.MessageLoop();
+	}
+	for (e = 0; e < ENTITIES; ++e)
+		id.push_back(entities.Create(pose));
+
+	for (tick = 0; tick < WARMUP + TICKS; ++tick)
+	{
+		if (tick == WARMUP)
+		{
+			allocated = gproNet::cBitStreamPool::GetTotalAllocationCount();
+			acquired = pool.GetAcquireCount();
+		}
+		for (e = 0; e < ENTITIES; ++e)
+		{
+			pose.translate[0] = (float)(rand() % 512 - 256);
+			pose.translate[2] = (float)(rand() % 512 - 256);
+			entities.SetPose(id[e], pose);
+		}
+		for (c = 0; c < CLIENTS; ++c)
+			for (i = 0; i < POSTS; ++i)
+			{
+				RakNet::BitStream bitstream;
+				sprintf(text, "player %u posts message %u of tick %u", c, i, tick);
+				bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_CHAT);
+				gproNet::WriteChatPost(bitstream, gproNet::CHAT_ROOM_GLOBAL, text);
+				client[c]->Send(&bitstream, send.priority, send.reliability, send.orderingChannel, serverAddress[c], false);
+			}
+		server.MessageLoop();
+		server.Tick();
+		for (c = 0; c < CLIENTS; ++c)
+			while ((packet = client[c]->Receive()) != 0)
+			{
+				++packets;
+				client[c]->DeallocatePacket(packet);
+			}
+	}
+	allocated = gproNet::cBitStreamPool::GetTotalAllocationCount() - allocated;
+	acquired = pool.GetAcquireCount() - acquired;
+
+	// full update, larger than a stream's inline buffer
+	for (i = 0; i < REPEAT; ++i)
+	{
+		tStart = RakNet::GetTimeUS();
+		{
+			RakNet::BitStream bitstream;
+			bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_ENTITY_UPDATE);
+			entities.WriteAll(bitstream);
+			length = bitstream.GetNumberOfBytesUsed();
+		}
+		dtFresh += RakNet::GetTimeUS() - tStart;
+		tStart = RakNet::GetTimeUS();
+		{
+			gproNet::cPooledBitStream bitstream(1 + gproNet::cEntityStore::GetUpdateMaxBytes(entities.GetCount()));
+			bitstream->Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_ENTITY_UPDATE);
+			entities.WriteAll(*bitstream);
+			length = bitstream->GetNumberOfBytesUsed();
+		}
+		dtPooled += RakNet::GetTimeUS() - tStart;
+	}
+
+	printf("send path %llu streams taken over %u ticks (%llu packets delivered), %llu allocated \n",
+		acquired, (unsigned int)TICKS, packets, allocated);
+	printf("update %u bytes | fresh stream %8.2f us | pooled stream %8.2f us \n",
+		length, (double)dtFresh / (double)REPEAT, (double)dtPooled / (double)REPEAT);
+
+	for (c = 0; c < CLIENTS; ++c)
+	{
+		client[c]->Shutdown();
+		delete client[c];
+	}
+	return (allocated ? 1 : 0);
+}
+
+// session task for tasks benchmark: greeting, queue, start and setup
+static gproNet::cTask benchTaskSession(gproNet::cTaskScheduler& tasks, RakNet::SystemAddress const sender, unsigned int& steps)
+{
+	static RakNet::MessageID const step[] = {
+		gproNet::ID_GPRO_MESSAGE_COMMON_BEGIN, gproNet::ID_GPRO_MESSAGE_GAME_JOIN,
+		gproNet::ID_GPRO_MESSAGE_GAME_START, gproNet::ID_GPRO_MESSAGE_GAME_SETUP,
+	};
+	gproNet::sTaskMessage message;
+	unsigned int i;
+	for (i = 0; i < sizeof(step) / sizeof(*step); ++i)
+	{
+		message = co_await tasks.Receive(step[i], sender, 60000);
+		if (!message.bitstream)
+			co_return;
+		++steps;
+	}
+}
+
+// same session as a handler: switch on message and per-session stage
+static void benchTaskSwitch(unsigned char stage[], unsigned int const session, RakNet::MessageID const msgID, unsigned int& steps)
+{
+	switch (msgID)
+	{
+	case gproNet::ID_GPRO_MESSAGE_COMMON_BEGIN:
+		if (stage[session] != 0)
+			return;
+		break;
+	case gproNet::ID_GPRO_MESSAGE_GAME_JOIN:
+		if (stage[session] != 1)
+			return;
+		break;
+	case gproNet::ID_GPRO_MESSAGE_GAME_START:
+		if (stage[session] != 2)
+			return;
+		break;
+	case gproNet::ID_GPRO_MESSAGE_GAME_SETUP:
+		if (stage[session] != 3)
+			return;
+		break;
+	default:
+		return;
+	}
+	++stage[session];
+	++steps;
+}
+
+// multi-step sessions as tasks: every session's task is resumed by the
+//	message it waits for, timed against a switch with a stage per session
+//	(indexed directly, the cheapest a handler could find its session);
+//	tasks restart each round, so frames must come back from the pool
+//	usage: -bench-tasks
+int benchTasks()
+{
+	enum { SESSIONS = 1024, STEPS = 4, ROUNDS = 50, PORT = 20000 };
+	static RakNet::MessageID const step[STEPS] = {
+		gproNet::ID_GPRO_MESSAGE_COMMON_BEGIN, gproNet::ID_GPRO_MESSAGE_GAME_JOIN,
+		gproNet::ID_GPRO_MESSAGE_GAME_START, gproNet::ID_GPRO_MESSAGE_GAME_SETUP,
+	};
+	gproNet::cTaskScheduler tasks;
+	RakNet::SystemAddress* const address = new RakNet::SystemAddress[SESSIONS];
+	unsigned char* const stage = new unsigned char[SESSIONS];
+	RakNet::BitStream bitstream;
+	RakNet::TimeUS tStart, dtStart = 0, dtTask = 0, dtSwitch = 0;
+	unsigned long long allocated = 0;
+	unsigned int round, s, i, taskSteps = 0, switchSteps = 0, finished = 0;
+
+	for (s = 0; s < SESSIONS; ++s)
+		address[s] = RakNet::SystemAddress("10.0.0.1", (unsigned short)(PORT + s));
+	bitstream.Write((RakNet::MessageID)0);
+
+	for (round = 0; round < ROUNDS; ++round)
+	{
+		// first round creates frames, the rest reuse them
+		if (round == 1)
+			allocated = gproNet::cTaskFramePool::GetTotalAllocationCount();
+
+		tStart = RakNet::GetTimeUS();
+		for (s = 0; s < SESSIONS; ++s)
+			tasks.Start(benchTaskSession(tasks, address[s], taskSteps));
+		dtStart += RakNet::GetTimeUS() - tStart;
+
+		tStart = RakNet::GetTimeUS();
+		for (i = 0; i < STEPS; ++i)
+			for (s = 0; s < SESSIONS; ++s)
+				tasks.Dispatch(bitstream, address[s], 0, step[i]);
+		dtTask += RakNet::GetTimeUS() - tStart;
+		if (!tasks.GetWaitingCount())
+			++finished;
+
+		memset(stage, 0, SESSIONS);
+		tStart = RakNet::GetTimeUS();
+		for (i = 0; i < STEPS; ++i)
+			for (s = 0; s < SESSIONS; ++s)
+				benchTaskSwitch(stage, address[s].GetPort() - PORT, step[i], switchSteps);
+		dtSwitch += RakNet::GetTimeUS() - tStart;
+	}
+	allocated = gproNet::cTaskFramePool::GetTotalAllocationCount() - allocated;
+
+	printf("%u sessions x %u steps x %u rounds | %u of %u rounds finished every task \n",
+		(unsigned int)SESSIONS, (unsigned int)STEPS, (unsigned int)ROUNDS, finished, (unsigned int)ROUNDS);
+	printf("start %8.1f ns/task | resume %8.1f ns/message | switch %8.1f ns/message \n",
+		1000.0 * (double)dtStart / ((double)SESSIONS * (double)ROUNDS),
+		1000.0 * (double)dtTask / ((double)SESSIONS * (double)STEPS * (double)ROUNDS),
+		1000.0 * (double)dtSwitch / ((double)SESSIONS * (double)STEPS * (double)ROUNDS));
+	printf("steps: %u by tasks, %u by switch | %llu frames allocated after first round \n",
+		taskSteps, switchSteps, allocated);
+
+	delete[] address;
+	delete[] stage;
+	return ((taskSteps != switchSteps || finished != ROUNDS || allocated) ? 1 : 0);
+}
+
+// search workload for jobs benchmark: negamax over mancala moves to
+//	fixed depth, as a bot choosing its move would
+static int benchJobsSearch(gpro_mancala const gs, unsigned char const player, unsigned int const depth)
+{
+	gpro_mancala next;
+	int best = -1000, value, result;
+	unsigned char cup;
+	if (!depth || gpro_mancala_over(gs) == 1)
+		return (int)gs[player][gpro_mancala_score] - (int)gs[1 - player][gpro_mancala_score];
+	for (cup = gpro_mancala_cup1; cup <= gpro_mancala_cup6; ++cup)
+	{
+		memcpy(next, gs, sizeof(next));
+		result = gpro_mancala_move(next, player, cup);
+		if (result < 0)
+			continue;
+		value = result ? benchJobsSearch(next, player, depth - 1) : -benchJobsSearch(next, 1 - player, depth - 1);
+		if (value > best)
+			best = value;
+	}
+	return best;
+}
+
+struct sBenchJobsSearch
+{
+	gpro_mancala* position;
+	int* value;
+	unsigned int depth;
+};
+
+static void benchJobsSearchRange(void* const data, unsigned int const begin, unsigned int const end)
+{
+	sBenchJobsSearch const* const search = (sBenchJobsSearch const*)data;
+	unsigned int i;
+	for (i = begin; i < end; ++i)
+		search->value[i] = benchJobsSearch(search->position[i], 0, search->depth);
+}
+
+// encoding workload for jobs benchmark: each client's view of the scene
+//	is prioritized, scheduled into its budget and encoded
+struct sBenchJobsEncode
+{
+	gproNet::sSpatialPose const* pose;
+	unsigned int const* size;
+	unsigned int count;
+	gproNet::cReplicationScheduler** scheduler;
+	unsigned int* selected;				// count per client
+	RakNet::BitStream** bitstream;
+	unsigned long long* bytes;
+};
+
+static void benchJobsEncodeRange(void* const data, unsigned int const begin, unsigned int const end)
+{
+	sBenchJobsEncode const* const encode = (sBenchJobsEncode const*)data;
+	unsigned int c, e, i, count;
+	for (c = begin; c < end; ++c)
+	{
+		float const* const view = encode->pose[c].translate;
+		unsigned int* const selected = encode->selected + c * encode->count;
+		RakNet::BitStream& bitstream = *encode->bitstream[c];
+		for (e = 0; e < encode->count; ++e)
+		{
+			float const dx = encode->pose[e].translate[0] - view[0], dz = encode->pose[e].translate[2] - view[2];
+			encode->scheduler[c]->Accumulate(e, gproNet::cReplicationScheduler::GetPriority(1.0f, sqrtf(dx * dx + dz * dz), 0.05f));
+		}
+		count = encode->scheduler[c]->Schedule(encode->size, selected);
+		bitstream.Reset();
+		bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_SPATIAL_POSE);
+		for (i = 0; i < count; ++i)
+		{
+			bitstream.Write((unsigned short)selected[i]);
+			encode->pose[selected[i]].Write(bitstream);
+		}
+		encode->bytes[c] += bitstream.GetNumberOfBytesUsed();
+	}
+}
+
+// job system speedup: bot searches over many positions, and per-client
+//	replication encoding each tick, split over 1, 2, 4 and every hardware
+//	thread; results must match the single-thread run
+//	usage: -bench-jobs
+int benchJobs()
+{
+	enum { POSITIONS = 32, DEPTH = 7, CLIENTS = 64, ENTITIES = 500, TICKS = 60, BUDGET = 1200 };
+	unsigned int const hardware = std::thread::hardware_concurrency();
+	unsigned int threads[4] = { 1, 2, 4, hardware };
+	unsigned int const runs = (hardware > 4) ? 4 : 3;
+	gpro_mancala* const position = new gpro_mancala[POSITIONS];
+	int* const value = new int[POSITIONS];
+	gproNet::sSpatialPose* const pose = new gproNet::sSpatialPose[ENTITIES];
+	unsigned int* const size = new unsigned int[ENTITIES];
+	unsigned int* const selected = new unsigned int[CLIENTS * ENTITIES];
+	gproNet::cReplicationScheduler* scheduler[CLIENTS];
+	RakNet::BitStream* bitstream[CLIENTS];
+	unsigned long long bytes[CLIENTS];
+	sBenchJobsSearch search = { position, value, DEPTH };
+	sBenchJobsEncode encode = { pose, size, ENTITIES, scheduler, selected, bitstream, bytes };
+	RakNet::TimeUS tStart, dtSearch, dtEncode, dtSearch1 = 0, dtEncode1 = 0;
+	long long valueSum, valueSum1 = 0;
+	unsigned long long bytesSum, bytesSum1 = 0;
+	unsigned int r, i, c, e, tick, moves;
+	unsigned char player;
+	int result = 0;
+
+	// positions a few random moves into a game
+	srand(1);
+	for (i = 0; i < POSITIONS; ++i)
+	{
+		gpro_mancala_reset(position[i]);
+		for (moves = 0, player = 0; moves < 6; ++moves)
+			if (gpro_mancala_move(position[i], player, (unsigned char)(gpro_mancala_cup1 + rand() % 6)) == 0)
+				player = 1 - player;
+	}
+	for (e = 0; e < ENTITIES; ++e)
+	{
+		gproNet::sSpatialPose const start = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f },
+			{ (float)(rand() % 512 - 256), 0.0f, (float)(rand() % 512 - 256) } };
+		pose[e] = start;
+		size[e] = sizeof(unsigned short) + gproNet::sSpatialPoseSchema::maxBytes;
+	}
+	for (c = 0; c < CLIENTS; ++c)
+		bitstream[c] = new RakNet::BitStream(BUDGET);
+
+	printf("%u hardware threads | search %u positions to depth %u | encode %u clients x %u entities x %u ticks \n",
+		hardware, (unsigned int)POSITIONS, (unsigned int)DEPTH, (unsigned int)CLIENTS, (unsigned int)ENTITIES, (unsigned int)TICKS);
+	for (r = 0; r < runs; ++r)
+	{
+		gproNet::cJobSystem jobs(threads[r]);
+
+		tStart = RakNet::GetTimeUS();
+		jobs.ParallelFor(benchJobsSearchRange, &search, POSITIONS, 1);
+		dtSearch = RakNet::GetTimeUS() - tStart;
+		for (i = 0, valueSum = 0; i < POSITIONS; ++i)
+			valueSum += value[i] * (long long)(i + 1);
+
+		for (c = 0; c < CLIENTS; ++c)
+		{
+			scheduler[c] = new gproNet::cReplicationScheduler((unsigned int)BUDGET - gproNet::MESSAGE_HEADER_BYTES);
+			scheduler[c]->SetObjectCount(ENTITIES);
+			bytes[c] = 0;
+		}
+		tStart = RakNet::GetTimeUS();
+		for (tick = 0; tick < TICKS; ++tick)
+			jobs.ParallelFor(benchJobsEncodeRange, &encode, CLIENTS, 1);
+		dtEncode = RakNet::GetTimeUS() - tStart;
+		for (c = 0, bytesSum = 0; c < CLIENTS; ++c)
+		{
+			bytesSum += bytes[c];
+			delete scheduler[c];
+		}
+
+		if (!r)
+		{
+			dtSearch1 = dtSearch;
+			dtEncode1 = dtEncode;
+			valueSum1 = valueSum;
+			bytesSum1 = bytesSum;
+		}
+		else if (valueSum != valueSum1 || bytesSum != bytesSum1)
+			result = 1;
+		printf("%2u threads | search %8.2f ms (x%5.2f) | encode %8.2f ms (x%5.2f) | %s \n", jobs.GetThreadCount(),
+			(double)dtSearch * 0.001, (double)dtSearch1 / (double)dtSearch,
+			(double)dtEncode * 0.001, (double)dtEncode1 / (double)dtEncode,
+			(valueSum == valueSum1 && bytesSum == bytesSum1) ? "match" : "MISMATCH");
+	}
+
+	for (c = 0; c < CLIENTS; ++c)
+		delete bitstream[c];
+	delete[] selected;
+	delete[] size;
+	delete[] pose;
+	delete[] value;
+	delete[] position;
+	return result;
+}
+
+// resuming player: bare client playing one mancala game over a lossy
+//	link, reconnecting with its resume token when the link drops
+struct sResumePlayer
+{
+	gproNet::cTransportLoopback* transport;
+	gproNet::cLockstepSession game;
+	RakNet::SystemAddress server;
+	unsigned long long token;		// latest resume token issued
+	unsigned char player;			// index in game
+	unsigned int cutAt;				// sequence at which link is cut
+	bool cut;						// link was cut
+	bool resuming;					// reconnecting, not back in play yet
+	bool ended;						// match was lost with the link
+	RakNet::Time tLost;				// when drop was noticed
+	RakNet::Time dtResume;			// drop noticed to back in play
+	unsigned int resumeBytes;		// game bytes received while resuming
+	bool full;						// resumed with full state
+};
+
+// send move if it is player's turn: first legal cup, so runs repeat
+static void resumePlayerMove(sResumePlayer& player)
+{
+	gproNet::sLockstepMove move = { player.player, 0, 0, 0, 0 };
+	unsigned char cup;
+	if (player.game.GetGame() != gproNet::LOCKSTEP_MANCALA || player.game.IsOver() || player.game.GetTurn() != player.player ||
+		player.server == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+		return;
+	for (cup = gpro_mancala_cup1; cup <= gpro_mancala_cup6; ++cup)
+	{
+		gproNet::cLockstepSession trial = player.game;
+		move.a = cup;
+		if (trial.Apply(move) == 0)
+		{
+			RakNet::BitStream bitstream;
+			bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_GAME_MOVE);
+			player.game.WriteMove(bitstream, move);
+			player.transport->Send(&bitstream, HIGH_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_GAME, player.server, false);
+			return;
+		}
+	}
+}
+
+// back in play once every missed move is applied and it is own turn
+static void resumePlayerCheck(sResumePlayer& player)
+{
+	if (player.resuming && (player.game.GetTurn() == player.player || player.game.IsOver()))
+	{
+		player.resuming = false;
+		player.dtResume = RakNet::GetTime() - player.tLost;
+	}
+}
+
+// receive everything waiting for resuming player and respond
+static void resumePlayerReceive(sResumePlayer& player)
+{
+	RakNet::Packet* packet = 0;
+	RakNet::MessageID msgID;
+	while ((packet = player.transport->Receive()) != 0)
+	{
+		RakNet::BitStream bitstream(packet->data, packet->length, false);
+		if (packet->data[0] == gproNet::ID_GPRO_MESSAGE_TIMESTAMP)
+			bitstream.IgnoreBytes(sizeof(RakNet::MessageID) + sizeof(unsigned short));
+		bitstream.Read(msgID);
+		switch (msgID)
+		{
+		case ID_CONNECTION_REQUEST_ACCEPTED:
+		{
+			// first time join, after a drop present token and last move
+			RakNet::BitStream bitstream_w;
+			player.server = packet->systemAddress;
+			if (player.resuming)
+			{
+				bitstream_w.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_RESUME);
+				bitstream_w.Write(player.token);
+				gproNet::WriteBitsValue(bitstream_w, player.game.GetGame(), 2);
+				bitstream_w.Write(player.game.GetSequence());
+			}
+			else
+			{
+				bitstream_w.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_GAME_JOIN);
+				gproNet::WriteBitsValue(bitstream_w, gproNet::LOCKSTEP_MANCALA, 2);
+			}
+			player.transport->Send(&bitstream_w, HIGH_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_GAME, player.server, false);
+
+			// a move sent into the dead link never arrived; if it is still
+			//	own turn nothing was missed, so send it again
+			resumePlayerCheck(player);
+			resumePlayerMove(player);
+		}	break;
+		case ID_CONNECTION_LOST:
+		{
+			player.server = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+			player.resuming = true;
+			player.tLost = RakNet::GetTime();
+			player.transport->Connect("127.0.0.1", packet->systemAddress.GetPort());
+		}	break;
+		case gproNet::ID_GPRO_MESSAGE_RESUME:
+			// token for next drop; on reconnecting, the old one was
+			//	already presented
+			bitstream.Read(player.token);
+			break;
+		case gproNet::ID_GPRO_MESSAGE_GAME_START:
+		{
+			unsigned int game, index;
+			gproNet::ReadBitsValue(bitstream, game, 2);
+			gproNet::ReadBitsValue(bitstream, index, 1);
+			player.resumeBytes += player.resuming ? packet->length : 0;
+			if (game != gproNet::LOCKSTEP_NONE)
+			{
+				player.game.Start((gproNet::eLockstepGame)game);
+				player.player = (unsigned char)index;
+				resumePlayerMove(player);
+			}
+			else if (!player.game.IsOver())
+			{
+				// match ended with the link, or opponent's
+				player.game.Start(gproNet::LOCKSTEP_NONE);
+				player.resuming = false;
+				player.ended = true;
+			}
+		}	break;
+		case gproNet::ID_GPRO_MESSAGE_GAME_RESYNC:
+		{
+			player.resumeBytes += player.resuming ? packet->length : 0;
+			player.full = player.full || player.resuming;
+			if (player.game.ReadState(bitstream, player.player))
+			{
+				resumePlayerCheck(player);
+				resumePlayerMove(player);
+			}
+		}	break;
+		case gproNet::ID_GPRO_MESSAGE_GAME_MOVE:
+		{
+			gproNet::sLockstepMove move;
+			unsigned int sequence, turn;
+			player.resumeBytes += player.resuming ? packet->length : 0;
+			if (bitstream.Read(sequence) && gproNet::ReadBitsValue(bitstream, turn, 1) && player.game.ReadMove(bitstream, move) &&
+				sequence == player.game.GetSequence() + 1 && player.game.Apply(move) == 0)
+			{
+				resumePlayerCheck(player);
+				resumePlayerMove(player);
+			}
+		}	break;
+		}
+		player.transport->DeallocatePacket(packet);
+	}
+}
+
+// one lossy pass: every player's link is cut once mid-game, while it
+//	waits for its opponent, and comes back with its token
+//	return: number of players that fell out of step with opponent
+static unsigned int benchResumePass(float const loss, RakNet::Time const grace, unsigned int& cut_out, unsigned int& resumed_out,
+	unsigned int& full_out, unsigned int& ended_out, double& msResume_out, double& bytesResume_out, RakNet::Time& msWorst_out)
+{
+	enum { MATCHES = 16, PLAYERS = MATCHES * 2, LATENCY = 20, RESEND = 60, TIMEOUT = 250, DURATION = 20000 };
+	gproNet::cLoopbackNetwork network;
+	gproNet::cTransportLoopback serverTransport(network, LATENCY);
+	gproNet::cRakNetServer server(&serverTransport, gproNet::SET_GPRO_SERVER_PORT, PLAYERS);
+	sResumePlayer* const player = new sResumePlayer[PLAYERS];
+	RakNet::Time tStart, tTick = 0;
+	unsigned long long dtResume = 0, bytes = 0;
+	unsigned int i, playing, diverged = 0;
+
+	server.SetResumeGrace(grace);
+	serverTransport.SetLoss(loss, RESEND);
+	for (i = 0; i < PLAYERS; ++i)
+	{
+		player[i].transport = new gproNet::cTransportLoopback(network, LATENCY);
+		player[i].server = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+		player[i].token = 0;
+		player[i].player = 0;
+		player[i].cutAt = 4 + i % 9;
+		player[i].cut = player[i].resuming = player[i].ended = player[i].full = false;
+		player[i].tLost = player[i].dtResume = 0;
+		player[i].resumeBytes = 0;
+		player[i].transport->Startup(1, 0, 0);
+		player[i].transport->SetLoss(loss, RESEND);
+		player[i].transport->Connect("127.0.0.1", gproNet::SET_GPRO_SERVER_PORT);
+	}
+
+	// play until every game is over or lost
+	tStart = RakNet::GetTime();
+	do
+	{
+		server.MessageLoop();
+		if (RakNet::GetTime() - tTick >= 16)
+		{
+			tTick = RakNet::GetTime();
+			server.Tick();
+		}
+		for (i = 0, playing = 0; i < PLAYERS; ++i)
+		{
+			sResumePlayer& p = player[i];
+			resumePlayerReceive(p);
+			if (!p.cut && p.server != RakNet::UNASSIGNED_SYSTEM_ADDRESS && p.game.GetGame() != gproNet::LOCKSTEP_NONE &&
+				!p.game.IsOver() && p.game.GetSequence() >= p.cutAt && p.game.GetTurn() != p.player)
+				p.cut = p.transport->Cut(p.server, TIMEOUT);
+			playing += (!p.ended && (p.resuming || p.game.GetGame() == gproNet::LOCKSTEP_NONE || !p.game.IsOver())) ? 1 : 0;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	} while (playing && RakNet::GetTime() - tStart < DURATION);
+
+	// resumed players finish the same game as their opponents
+	cut_out = resumed_out = full_out = ended_out = 0;
+	msWorst_out = 0;
+	for (i = 0; i < PLAYERS; ++i)
+	{
+		sResumePlayer const& p = player[i];
+		sResumePlayer const& opponent = player[i ^ 1];
+		cut_out += p.cut ? 1 : 0;
+		ended_out += p.ended ? 1 : 0;
+		if (p.cut && !p.ended && !p.resuming)
+		{
+			++resumed_out;
+			full_out += p.full ? 1 : 0;
+			dtResume += p.dtResume;
+			bytes += p.resumeBytes;
+			msWorst_out = p.dtResume > msWorst_out ? p.dtResume : msWorst_out;
+		}
+		if (!p.ended && !opponent.ended && (p.game.GetSequence() != opponent.game.GetSequence() ||
+			p.game.Hash(0) != opponent.game.Hash(0) || !p.game.IsOver()))
+			++diverged;
+	}
+	msResume_out = resumed_out ? (double)dtResume / (double)resumed_out : 0.0;
+	bytesResume_out = resumed_out ? (double)bytes / (double)resumed_out : 0.0;
+
+	for (i = 0; i < PLAYERS; ++i)
+	{
+		player[i].transport->Shutdown();
+		delete player[i].transport;
+	}
+	delete[] player;
+	return diverged;
+}
+
+// dropped connections: each player's link goes dark once mid-game under
+//	increasing loss, and resumes from the moves it missed rather than
+//	losing the match; without a grace period every cut match ends
+//	usage: -bench-resume
+int benchResume()
+{
+	float const loss[3] = { 0.0f, 0.05f, 0.2f };
+	unsigned int const stateBytes = (unsigned int)gproNet::MESSAGE_HEADER_BYTES + gproNet::LOCKSTEP_STATE_BYTES;
+	unsigned int cut, resumed, full, ended, diverged, i, result = 0;
+	double msResume, bytesResume;
+	RakNet::Time msWorst;
+
+	printf("full state resync is %u bytes \n", stateBytes);
+	for (i = 0; i < 3; ++i)
+	{
+		diverged = benchResumePass(loss[i], gproNet::SERVER_RESUME_GRACE, cut, resumed, full, ended, msResume, bytesResume, msWorst);
+		printf("%4.0f%% loss | %2u cut, %2u resumed (%u full state), %2u matches lost | back in play %6.1f ms avg, %4u ms worst | %5.1f bytes per resume | %u out of step \n",
+			loss[i] * 100.0f, cut, resumed, full, ended, msResume, (unsigned int)msWorst, bytesResume, diverged);
+		result += diverged + (cut - resumed) + ended;
+	}
+	diverged = benchResumePass(loss[1], 0, cut, resumed, full, ended, msResume, bytesResume, msWorst);
+	printf("no grace   | %2u cut, %2u resumed, %2u players lost their match \n", cut, resumed, ended);
+	result += resumed ? 1 : 0;
+	return (result ? 1 : 0);
+}
+
+// server with its timestamp writer and reader open to the benchmark
+class cBenchTimestampServer : public gproNet::cRakNetServer
+{
+public:
+	cBenchTimestampServer(gproNet::cTransport* const transport)
+		: gproNet::cRakNetServer(transport, gproNet::SET_GPRO_SERVER_PORT, 16)
+	{
+	}
+
+	// stamp message now, read it as received after delay
+	//	return: delay read back
+	RakNet::Time Probe(bool const full, RakNet::Time const delay, RakNet::MessageID& msgID_out)
+	{
+		RakNet::BitStream bitstream;
+		RakNet::Time const tBefore = RakNet::GetTime();
+		RakNet::Time tSend, dtSendToReceive = ~(RakNet::Time)0;
+		unsigned short tSendLow;
+		if (full)
+		{
+			bitstream.Write((RakNet::MessageID)ID_TIMESTAMP);
+			bitstream.Write(tSend = tBefore);
+		}
+		else
+		{
+			// clock may tick while writing; send time is whichever matches
+			WriteTimestamp(bitstream);
+			memcpy(&tSendLow, bitstream.GetData() + sizeof(RakNet::MessageID), sizeof(tSendLow));
+			tSend = ((unsigned short)tBefore == tSendLow) ? tBefore : (tBefore + 1);
+		}
+		bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_INPUTS);
+		bitstream.Read(msgID_out);
+		ReadTimestamp(bitstream, RakNet::UNASSIGNED_SYSTEM_ADDRESS, tSend + delay, dtSendToReceive, msgID_out);
+		return dtSendToReceive;
+	}
+};
+
+// compact timestamps: every delay up to half the 16-bit range is read
+//	back exactly, full RakNet stamps still read, and a live session reports
+//	header bytes saved by each message type
+//	usage: -bench-timestamps
+int benchTimestamps()
+{
+	enum { DELAY_MAX = 40000, MATCHES = 4, PLAYERS = MATCHES * 2, ENTITIES = 64, DURATION = 2000 };
+	gproNet::cLoopbackNetwork network;
+	gproNet::cTransportLoopback serverTransport(network, 20);
+	cBenchTimestampServer server(&serverTransport);
+	gproNet::sMetricsSnapshot* const snapshot = new gproNet::sMetricsSnapshot;
+	sResumePlayer* const player = new sResumePlayer[PLAYERS];
+	RakNet::Time delay, exact = 0, tStart, tTick = 0;
+	RakNet::MessageID msgID;
+	unsigned long long bytes = 0, saved = 0;
+	unsigned int i, wrong = 0, wrongFull = 0, tick = 0;
+
+	// reconstruction, each delay on both sides of the clock's 16-bit wrap
+	for (delay = 0; delay < DELAY_MAX; ++delay)
+	{
+		if (server.Probe(false, delay, msgID) != delay || msgID != gproNet::ID_GPRO_MESSAGE_INPUTS)
+			++wrong;
+		else if (exact == delay)
+			exact = delay + 1;
+		if (server.Probe(true, delay, msgID) != delay || msgID != gproNet::ID_GPRO_MESSAGE_INPUTS)
+			++wrongFull;
+	}
+	printf("header %u bytes (was %u) | delays read back exactly up to %u ms | %u of %u longer delays wrapped | full stamps %u wrong \n",
+		(unsigned int)gproNet::MESSAGE_HEADER_BYTES, (unsigned int)gproNet::MESSAGE_HEADER_FULL_BYTES,
+		(unsigned int)exact - 1, wrong, (unsigned int)(DELAY_MAX - exact), wrongFull);
+
+	// live session: matches, moving entities and chat
+	for (i = 0; i < ENTITIES; ++i)
+	{
+		gproNet::sSpatialPose const spawn = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { (float)i, 0.0f, 0.0f } };
+		server.GetEntities().Create(spawn);
+	}
+	for (i = 0; i < PLAYERS; ++i)
+	{
+		player[i].transport = new gproNet::cTransportLoopback(network, 20);
+		player[i].server = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+		player[i].token = 0;
+		player[i].player = 0;
+		player[i].cutAt = 0;
+		player[i].cut = false;
+		player[i].resuming = player[i].ended = player[i].full = false;
+		player[i].tLost = player[i].dtResume = 0;
+		player[i].resumeBytes = 0;
+		player[i].transport->Startup(1, 0, 0);
+		player[i].transport->Connect("127.0.0.1", gproNet::SET_GPRO_SERVER_PORT);
+	}
+	for (tStart = RakNet::GetTime(); RakNet::GetTime() - tStart < DURATION;)
+	{
+		server.MessageLoop();
+		if (RakNet::GetTime() - tTick >= 16)
+		{
+			tTick = RakNet::GetTime();
+			for (i = 0; i < ENTITIES; i += 4)
+			{
+				gproNet::sSpatialPose pose;
+				server.GetEntities().GetPose(i, pose);
+				pose.translate[2] += 0.5f;
+				server.GetEntities().SetPose(i, pose);
+			}
+			if (++tick % 30 == 0)
+				server.PostChat(gproNet::CHAT_ROOM_GLOBAL, "tick");
+			server.Tick();
+		}
+		for (i = 0; i < PLAYERS; ++i)
+			resumePlayerReceive(player[i]);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	server.GetMetrics().Snapshot(*snapshot);
+	printf(" msg | pkt out    | bytes out    | saved      | share \n");
+	for (i = 0; i < gproNet::METRICS_MESSAGE_IDS; ++i)
+	{
+		gproNet::sMessageMetrics const& m = snapshot->message[i];
+		if (m.packetsOut)
+		{
+			printf(" %3u | %10llu | %12llu | %10llu | %5.1f%% \n", i, m.packetsOut, m.bytesOut, m.bytesSaved,
+				100.0 * (double)m.bytesSaved / (double)(m.bytesOut + m.bytesSaved));
+			bytes += m.bytesOut;
+			saved += m.bytesSaved;
+		}
+	}
+	printf(" all | %10s | %12llu | %10llu | %5.1f%% \n", "", bytes, saved, 100.0 * (double)saved / (double)(bytes + saved));
+
+	for (i = 0; i < PLAYERS; ++i)
+	{
+		player[i].transport->Shutdown();
+		delete player[i].transport;
+	}
+	delete[] player;
+	delete snapshot;
+	return ((wrong != DELAY_MAX - exact || wrongFull || exact <= 32767) ? 1 : 0);
+}
+
+// traced client: plays mancala through the manager's own send and
+//	receive paths, each of its moves one traced interaction
+class cBenchTraceClient : public gproNet::cRakNetManager
+{
+public:
+	gproNet::cLockstepSession game;
+	RakNet::SystemAddress server;
+	unsigned char player;
+	bool moved;							// move sent, not yet applied
+	std::vector<unsigned int> traces;	// traces begun by this client
+
+	cBenchTraceClient(gproNet::cTransport* const transport)
+		: gproNet::cRakNetManager(transport), server(RakNet::UNASSIGNED_SYSTEM_ADDRESS), player(0), moved(false)
+	{
+	}
+
+	// send first legal move if it is own turn, as one traced interaction
+	void Move()
+	{
+		gproNet::sLockstepMove move = { player, 0, 0, 0, 0 };
+		unsigned char cup;
+		if (moved || game.GetGame() != gproNet::LOCKSTEP_MANCALA || game.IsOver() || game.GetTurn() != player ||
+			server == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+			return;
+		for (cup = gpro_mancala_cup1; cup <= gpro_mancala_cup6; ++cup)
+		{
+			gproNet::cLockstepSession trial = game;
+			move.a = cup;
+			if (trial.Apply(move) == 0)
+			{
+				RakNet::BitStream bitstream;
+				traces.push_back(BeginTrace());
+				WriteTimestamp(bitstream);
+				bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_GAME_MOVE);
+				game.WriteMove(bitstream, move);
+				Send(bitstream, server, false);
+				EndTrace();
+				moved = true;
+				return;
+			}
+		}
+	}
+
+protected:
+	virtual bool ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const /*dtSendToReceive*/, RakNet::MessageID const msgID)
+	{
+		switch (msgID)
+		{
+		case ID_CONNECTION_REQUEST_ACCEPTED:
+		{
+			RakNet::BitStream bitstream_w;
+			server = sender;
+			WriteTimestamp(bitstream_w);
+			bitstream_w.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_GAME_JOIN);
+			gproNet::WriteBitsValue(bitstream_w, gproNet::LOCKSTEP_MANCALA, 2);
+			Send(bitstream_w, server, false);
+		}	return true;
+		case gproNet::ID_GPRO_MESSAGE_GAME_START:
+		{
+			unsigned int game, index;
+			gproNet::ReadBitsValue(bitstream, game, 2);
+			gproNet::ReadBitsValue(bitstream, index, 1);
+			if (game != gproNet::LOCKSTEP_NONE)
+			{
+				this->game.Start((gproNet::eLockstepGame)game);
+				player = (unsigned char)index;
+			}
+		}	return true;
+		case gproNet::ID_GPRO_MESSAGE_GAME_MOVE:
+		{
+			gproNet::sLockstepMove move;
+			unsigned int sequence, turn;
+			if (bitstream.Read(sequence) && gproNet::ReadBitsValue(bitstream, turn, 1) && game.ReadMove(bitstream, move) &&
+				sequence == game.GetSequence() + 1 && game.Apply(move) == 0)
+				moved = false;
+		}	return true;
+		}
+		return false;
+	}
+};
+
+// where one traced move spent its time, in microseconds
+struct sBenchTraceBreakdown
+{
+	unsigned int mover;				// client that made the move, or ~0 if not seen
+	unsigned int found;				// server and client handlers seen (3 if all)
+	unsigned long long tStart;		// move begun on mover
+	unsigned long long tEnd;		// echo handled on mover
+	unsigned int send, toServer, server, back, client;
+};
+
+// tracing: two traced clients play mancala through a loopback server;
+//	every move is one trace, followed from the mover's send through
+//	transit, server handling and the relayed move on both clients, and
+//	all three processes are exported as one Chrome trace JSON file
+//	(open in Perfetto or chrome://tracing)
+//	usage: -bench-trace
+int benchTrace()
+{
+	enum { CLIENTS = 2, LATENCY = 20, DURATION = 10000 };
+	char const path[] = "gpro-net-bench-trace.json";
+	gproNet::cLoopbackNetwork network;
+	gproNet::cTransportLoopback serverTransport(network, LATENCY);
+	gproNet::cRakNetServer server(&serverTransport, gproNet::SET_GPRO_SERVER_PORT, 16);
+	gproNet::cSpanRecorder serverSpans("server", 1);
+	gproNet::cSpanRecorder clientSpans0("client 0", 2), clientSpans1("client 1", 3);
+	gproNet::cSpanRecorder* const clientSpans[CLIENTS] = { &clientSpans0, &clientSpans1 };
+	gproNet::cSpanRecorder const* const recorders[1 + CLIENTS] = { &serverSpans, &clientSpans0, &clientSpans1 };
+	gproNet::cTransportLoopback* transport[CLIENTS];
+	cBenchTraceClient* client[CLIENTS];
+	std::unordered_map<unsigned int, sBenchTraceBreakdown> breakdown;
+	std::vector<gproNet::sSpan> spans;
+	RakNet::Time tStart, tTick = 0;
+	unsigned long long total = 0, send = 0, toServer = 0, handled = 0, back = 0, handledBack = 0;
+	unsigned int complete = 0, traces = 0, c, r, i;
+	int exported;
+
+	server.SetSpans(&serverSpans);
+	for (c = 0; c < CLIENTS; ++c)
+	{
+		transport[c] = new gproNet::cTransportLoopback(network, LATENCY);
+		client[c] = new cBenchTraceClient(transport[c]);
+		client[c]->SetSpans(clientSpans[c]);
+		transport[c]->Startup(1, 0, 0);
+		transport[c]->Connect("127.0.0.1", gproNet::SET_GPRO_SERVER_PORT);
+	}
+	for (tStart = RakNet::GetTime(); RakNet::GetTime() - tStart < DURATION && !(client[0]->game.IsOver() && client[1]->game.IsOver());)
+	{
+		server.MessageLoop();
+		if (RakNet::GetTime() - tTick >= 16)
+		{
+			tTick = RakNet::GetTime();
+			server.Tick();
+		}
+		for (c = 0; c < CLIENTS; ++c)
+		{
+			client[c]->MessageLoop();
+			client[c]->Move();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	// movers' interactions first, then handlers everywhere
+	for (c = 0; c < CLIENTS; ++c)
+		for (i = 0; i < (unsigned int)client[c]->traces.size(); ++i)
+		{
+			sBenchTraceBreakdown const empty = { c, 0, 0, 0, 0, 0, 0, 0, 0 };
+			breakdown[client[c]->traces[i]] = empty;
+		}
+	for (r = 0; r < 1 + CLIENTS; ++r)
+	{
+		recorders[r]->Snapshot(spans);
+		for (i = 0; i < (unsigned int)spans.size(); ++i)
+		{
+			gproNet::sSpan const& span = spans[i];
+			std::unordered_map<unsigned int, sBenchTraceBreakdown>::iterator const move = breakdown.find(span.trace);
+			if (move == breakdown.end() || (span.msgID != gproNet::ID_GPRO_MESSAGE_GAME_MOVE && span.kind != gproNet::SPAN_INTERACTION))
+				continue;
+			sBenchTraceBreakdown& b = move->second;
+			bool const mover = (r == 1 + b.mover);
+			switch (span.kind)
+			{
+			case gproNet::SPAN_INTERACTION:
+				b.tStart = span.tStart;
+				b.send = span.duration;
+				break;
+			case gproNet::SPAN_TRANSIT:
+				if (!r)
+					b.toServer = span.duration;
+				else if (mover)
+					b.back = span.duration;
+				break;
+			case gproNet::SPAN_HANDLE:
+				++b.found;
+				if (!r)
+					b.server = span.duration;
+				else if (mover)
+				{
+					b.client = span.duration;
+					b.tEnd = span.tStart + span.duration;
+				}
+				break;
+			}
+		}
+	}
+	for (std::unordered_map<unsigned int, sBenchTraceBreakdown>::const_iterator move = breakdown.begin(); move != breakdown.end(); ++move)
+	{
+		sBenchTraceBreakdown const& b = move->second;
+		++traces;
+		if (b.found == 1 + CLIENTS && b.tEnd > b.tStart)
+		{
+			++complete;
+			total += b.tEnd - b.tStart;
+			send += b.send;
+			toServer += b.toServer;
+			handled += b.server;
+			back += b.back;
+			handledBack += b.client;
+		}
+	}
+	exported = gproNet::cSpanRecorder::ExportChrome(path, recorders, 1 + CLIENTS);
+
+	printf("%u moves traced, %u followed through server and both clients \n", traces, complete);
+	if (complete)
+		printf("avg us | send %6llu | to server %6llu | server %6llu | back %6llu | client %6llu | move to echo %6llu \n",
+			send / complete, toServer / complete, handled / complete, back / complete, handledBack / complete, total / complete);
+	printf("%d spans exported to %s (trace header %u bytes per traced message) \n", exported, path, (unsigned int)gproNet::MESSAGE_TRACE_BYTES);
+
+	for (c = 0; c < CLIENTS; ++c)
+	{
+		delete client[c];
+		transport[c]->Shutdown();
+		delete transport[c];
+	}
+	return ((traces && complete == traces && exported > 0) ? 0 : 1);
+}
+
+// one bot game against random fleet: shots until every ship cell is hit;
+//	checks vector density against scalar on every move
+static unsigned int benchBattleshipGame(unsigned long long& random, bool const announce, unsigned int& mismatch_out,
+	RakNet::TimeUS& dtMove_out, RakNet::TimeUS& dtScalar_out, unsigned int& moves_out)
+{
+	gpro_battleship fleet, attack;
+	gproNet::sBattleshipDensity density, reference;
+	unsigned char afloat = gpro_battleship_ship, ship, row = 0, col = 0, result;
+	unsigned int shots = 0, r, c;
+	RakNet::TimeUS t;
+	gpro_battleship_reset(fleet);
+	gpro_battleship_reset(attack);
+	gproNet::BattleshipPlaceRandom(fleet, random);
+	while (gpro_battleship_lost(fleet) != 1)
+	{
+		gproNet::BattleshipDensity(attack, afloat, density);
+		t = RakNet::GetTimeUS();
+		gproNet::BattleshipDensityScalar(attack, afloat, reference);
+		dtScalar_out += RakNet::GetTimeUS() - t;
+		if (memcmp(density.cell, reference.cell, sizeof(density.cell)))
+			++mismatch_out;
+
+		t = RakNet::GetTimeUS();
+		gproNet::BattleshipTarget(attack, afloat, random, row, col);
+		dtMove_out += RakNet::GetTimeUS() - t;
+		++moves_out;
+
+		gpro_battleship_defend(fleet, row, col, &result);
+		gpro_battleship_record(attack, row, col, result);
+		++shots;
+
+		// ships are only known sunk if the game says so
+		if (announce)
+			for (ship = gpro_battleship_ship_p2; ship; ship <<= 1)
+			{
+				bool sunk = true;
+				for (r = 0; r < 10; ++r)
+					for (c = 0; c < 10; ++c)
+						if (gpro_flag_check(fleet[r][c], ship) && !gpro_flag_check(fleet[r][c], gpro_battleship_damage))
+							sunk = false;
+				if (sunk)
+					afloat &= (unsigned char)~ship;
+			}
+	}
+	return shots;
+}
+
+// battleship bots: random fleets are placed without retries and are
+//	always valid; density bot plays against random fleets, with and
+//	without sinking announced, checked against the scalar kernel on
+//	every move and compared with random shots
+//	usage: -bench-battleship
+int benchBattleship()
+{
+	enum { FLEETS = 100000, GAMES = 2000 };
+	unsigned long long random = 0x6770726f6e6574ull;
+	gpro_battleship fleet;
+	unsigned int* const use = new unsigned int[100]();
+	unsigned int invalid = 0, mismatch = 0, moves = 0, useMin = ~0u, useMax = 0, i, j, r, c, last, order[100];
+	unsigned long long shots[2] = { 0 }, shotsRandom = 0;
+	std::mt19937_64 shuffle(random);
+	RakNet::TimeUS t, dtPlace, dtMove = 0, dtScalar = 0;
+
+	// placement, timed alone, then replayed and checked
+	t = RakNet::GetTimeUS();
+	for (i = 0; i < FLEETS; ++i)
+	{
+		gpro_battleship_reset(fleet);
+		gproNet::BattleshipPlaceRandom(fleet, random);
+	}
+	dtPlace = RakNet::GetTimeUS() - t;
+	random = 0x6770726f6e6574ull;
+	for (i = 0; i < FLEETS; ++i)
+	{
+		gpro_battleship_reset(fleet);
+		if (gproNet::BattleshipPlaceRandom(fleet, random) != 0 || gpro_battleship_validate(fleet) != 0)
+			++invalid;
+		for (r = 0; r < 10; ++r)
+			for (c = 0; c < 10; ++c)
+				use[r * 10 + c] += gpro_flag_check(fleet[r][c], gpro_battleship_ship) ? 1 : 0;
+	}
+	for (i = 0; i < 100; ++i)
+	{
+		useMin = use[i] < useMin ? use[i] : useMin;
+		useMax = use[i] > useMax ? use[i] : useMax;
+	}
+	printf("placement | %u fleets, %6.0f ns each | %u invalid | cell occupied %4.1f%% to %4.1f%% of fleets \n",
+		(unsigned int)FLEETS, (double)dtPlace * 1000.0 / (double)FLEETS, invalid,
+		100.0 * (double)useMin / (double)FLEETS, 100.0 * (double)useMax / (double)FLEETS);
+
+	// bot games, then random shots: last ship cell in shuffled order
+	for (i = 0; i < GAMES; ++i)
+	{
+		shots[0] += benchBattleshipGame(random, false, mismatch, dtMove, dtScalar, moves);
+		shots[1] += benchBattleshipGame(random, true, mismatch, dtMove, dtScalar, moves);
+
+		gpro_battleship_reset(fleet);
+		gproNet::BattleshipPlaceRandom(fleet, random);
+		for (j = 0; j < 100; ++j)
+			order[j] = j;
+		std::shuffle(order, order + 100, shuffle);
+		for (j = 0, last = 0; j < 100; ++j)
+			if (gpro_flag_check(fleet[order[j] / 10][order[j] % 10], gpro_battleship_ship))
+				last = j + 1;
+		shotsRandom += last;
+	}
+	printf("shots to win | density %5.1f (sinks unknown) %5.1f (sinks announced) | random %5.1f \n",
+		(double)shots[0] / (double)GAMES, (double)shots[1] / (double)GAMES, (double)shotsRandom / (double)GAMES);
+	printf("bot move %6.0f ns (%8.0f moves/s) | scalar density alone %6.0f ns | %u of %u densities differ \n",
+		(double)dtMove * 1000.0 / (double)moves, moves * 1000000.0 / (double)(dtMove ? dtMove : 1),
+		(double)dtScalar * 1000.0 / (double)moves, mismatch, moves);
+
+	delete[] use;
+	return ((invalid || mismatch) ? 1 : 0);
+}
+
+
+int main(int const argc, char const* const argv[])
+{
+	int i;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-bench-channels"))
+			return benchChannels();
+		else if (!strcmp(argv[i], "-bench-replication"))
+			return benchReplication();
+		else if (!strcmp(argv[i], "-bench-entities"))
+			return benchEntities();
+		else if (!strcmp(argv[i], "-bench-quantize"))
+			return benchQuantize();
+		else if (!strcmp(argv[i], "-bench-rewind"))
+			return benchRewind();
+		else if (!strcmp(argv[i], "-bench-chat"))
+			return benchChat();
+		else if (!strcmp(argv[i], "-bench-broadcast"))
+			return benchBroadcast();
+		else if (!strcmp(argv[i], "-bench-relay"))
+			return benchRelay();
+		else if (!strcmp(argv[i], "-bench-shards"))
+			return benchShards();
+		else if (!strcmp(argv[i], "-bench-checkpoint"))
+			return benchCheckpoint();
+		else if (!strcmp(argv[i], "-bench-pool"))
+			return benchPool();
+		else if (!strcmp(argv[i], "-bench-tasks"))
+			return benchTasks();
+		else if (!strcmp(argv[i], "-bench-jobs"))
+			return benchJobs();
+		else if (!strcmp(argv[i], "-bench-resume"))
+			return benchResume();
+		else if (!strcmp(argv[i], "-bench-timestamps"))
+			return benchTimestamps();
+		else if (!strcmp(argv[i], "-bench-trace"))
+			return benchTrace();
+		else if (!strcmp(argv[i], "-bench-battleship"))
+			return benchBattleship();
+		else if (!strcmp(argv[i], "-spectate") && i + 3 < argc)
+			return runSpectators(argv[i + 1], (unsigned short)atoi(argv[i + 2]), (unsigned int)atoi(argv[i + 3]));
+		else if (!strcmp(argv[i], "-route-players") && i + 3 < argc)
+			return runRoutedPlayers(argv[i + 1], (unsigned short)atoi(argv[i + 2]), (unsigned int)atoi(argv[i + 3]));
+	}
+
+	printf("usage: -bench-<channels|replication|entities|quantize|rewind|chat|broadcast|relay|shards|\n"
+		"\tcheckpoint|pool|tasks|jobs|resume|timestamps|trace|battleship> \n"
+		"\t-spectate <host> <port> <count> \n"
+		"\t-route-players <host> <router port> <count> \n");
+	return 1;
+}
\ No newline at end of file
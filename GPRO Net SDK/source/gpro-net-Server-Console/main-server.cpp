@@ -23,15 +23,206 @@
 */
 
 #include "gpro-net/gpro-net-server/gpro-net-RakNet-Server.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-RakNet-Relay.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-RakNet-Router.hpp"
+#include "gpro-net/gpro-net/gpro-net-Loopback.hpp"
+
+#include <thread>
+
+
+// replay captured trace through server without sockets
+//	usage: -replay <trace> [-fast]
+int replayTrace(char const path[], bool const realTime)
+{
+	gproNet::cTraceReader trace;
+	if (trace.Open(path))
+	{
+		gproNet::cLoopbackNetwork network;
+		gproNet::cTransportLoopback transport(network);
+		gproNet::cRakNetServer server(&transport);
+		RakNet::TimeUS const tStart = RakNet::GetTimeUS();
+		int const count = server.Replay(trace, realTime);
+		RakNet::TimeUS const dt = RakNet::GetTimeUS() - tStart;
+		printf("replayed %d of %llu messages in %llu us (%.0f msg/s) \n", count, trace.GetCount(),
+			(unsigned long long)dt, dt ? (double)count * 1000000.0 / (double)dt : 0.0);
+		return count;
+	}
+	printf("could not open trace '%s' \n", path);
+	return -1;
+}
+
+// run relay process: subscribe to upstream and forward to spectators
+//	usage: -relay <host> <port> [-listen <port>] [-delay <ms>]
+int runRelay(char const host[], unsigned short const hostPort, unsigned short const port, RakNet::Time const delay)
+{
+	gproNet::cRakNetRelay relay(host, hostPort, port, gproNet::RELAY_SPECTATORS, delay);
+	RakNet::Time tReport = 0;
+	while (1)
+	{
+		relay.MessageLoop();
+		relay.Update();
+		if (RakNet::GetTime() - tReport >= 5000)
+		{
+			tReport = RakNet::GetTime();
+			printf("relay %s | %u spectators | %u entities \n", relay.IsSubscribed() ? "subscribed" : "waiting",
+				relay.GetSpectatorCount(), relay.GetEntities().GetCount());
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return 0;
+}
+
+// run router process: shards and clients connect to it
+//	usage: -router [-listen <port>]
+int runRouter(unsigned short const port)
+{
+	gproNet::cRakNetRouter router(port);
+	RakNet::Time tReport = 0;
+	while (1)
+	{
+		router.MessageLoop();
+		if (RakNet::GetTime() - tReport >= 5000)
+		{
+			tReport = RakNet::GetTime();
+			printf("router | %u shards \n", router.GetShardCount());
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return 0;
+}
 
 
 int main(int const argc, char const* const argv[])
 {
-	gproNet::cRakNetServer server;
+	gproNet::cTraceWriter capture;
+	gproNet::sMetricsSnapshot* metrics = 0;
+	RakNet::Time tMetrics = 0, tTick = 0, tSpans = 0, tSoak = 0, tStart = 0;
+	RakNet::TimeUS tLoop = 0, loopMax = 0;
+	std::unique_ptr<gproNet::sMetricsHistogram> loop;
+	unsigned long long memoryStart = 0;
+	unsigned int soak = 0;
+	char const* capturePath = 0;
+	char const* spansPath = 0;
+	char const* replayPath = 0;
+	char const* relayHost = 0;
+	char const* routerHost = 0;
+	char const* checkpointPath = 0;
+	unsigned short relayHostPort = 0, routerPort = 0, port = 0;
+	RakNet::Time relayDelay = 0;
+	bool realTime = true, router = false;
+	int i;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-capture") && i + 1 < argc)
+			capturePath = argv[++i];
+		else if (!strcmp(argv[i], "-replay") && i + 1 < argc)
+			replayPath = argv[++i];
+		else if (!strcmp(argv[i], "-fast"))
+			realTime = false;
+		else if (!strcmp(argv[i], "-metrics") && !metrics)
+			metrics = new gproNet::sMetricsSnapshot;
+		else if (!strcmp(argv[i], "-relay") && i + 2 < argc)
+		{
+			relayHost = argv[++i];
+			relayHostPort = (unsigned short)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "-listen") && i + 1 < argc)
+			port = (unsigned short)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-delay") && i + 1 < argc)
+			relayDelay = (RakNet::Time)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-spans") && i + 1 < argc)
+			spansPath = argv[++i];
+		else if (!strcmp(argv[i], "-soak") && i + 1 < argc)
+			soak = (unsigned int)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-checkpoint") && i + 1 < argc)
+			checkpointPath = argv[++i];
+		else if (!strcmp(argv[i], "-router"))
+			router = true;
+		else if (!strcmp(argv[i], "-shard") && i + 2 < argc)
+		{
+			routerHost = argv[++i];
+			routerPort = (unsigned short)atoi(argv[++i]);
+		}
+	}
+
+	if (replayPath)
+		return (replayTrace(replayPath, realTime) >= 0 ? 0 : 1);
+	if (relayHost)
+		return runRelay(relayHost, relayHostPort, port ? port : (unsigned short)gproNet::SET_GPRO_RELAY_PORT, relayDelay);
+	if (router)
+		return runRouter(port ? port : (unsigned short)gproNet::SET_GPRO_ROUTER_PORT);
+
+	// plain server, or shard behind router: -shard <host> <port> [-listen <port>]
+	gproNet::cJobSystem jobs;
+	gproNet::cRakNetServer server(port ? port : (unsigned short)gproNet::SET_GPRO_SERVER_PORT);
+	gproNet::cSpanRecorder spans("server", port ? port : (unsigned int)gproNet::SET_GPRO_SERVER_PORT);
+	gproNet::cSpanRecorder const* const spansExport = &spans;
+	server.SetJobs(&jobs);
+	if (spansPath)
+		server.SetSpans(&spans);
+	if (capturePath && capture.Open(capturePath))
+		server.SetCapture(&capture);
+	if (routerHost)
+		server.ConnectRouter(routerHost, routerPort);
+	if (checkpointPath)
+		printf("%d matches resumed from checkpoints \n", server.OpenCheckpoints(checkpointPath));
+	if (soak)
+	{
+		loop.reset(new gproNet::sMetricsHistogram);
+		memset(loop.get(), 0, sizeof(*loop));
+		memoryStart = gproNet::GetProcessMemory();
+		tStart = tSoak = RakNet::GetTime();
+	}
 
 	while (1)
 	{
+		if (loop)
+			tLoop = RakNet::GetTimeUS();
+
 		server.MessageLoop();
+
+		// fixed 60 Hz simulation tick
+		if (RakNet::GetTime() - tTick >= 16)
+		{
+			tTick = RakNet::GetTime();
+			server.Tick();
+		}
+
+		// periodic metrics report
+		if (metrics && RakNet::GetTime() - tMetrics >= 5000)
+		{
+			tMetrics = RakNet::GetTime();
+			server.GetMetrics().Snapshot(*metrics);
+			metrics->Print(stdout);
+		}
+
+		// periodic export of traced spans: -spans <path>
+		if (spansPath && RakNet::GetTime() - tSpans >= 5000)
+		{
+			tSpans = RakNet::GetTime();
+			gproNet::cSpanRecorder::ExportChrome(spansPath, &spansExport, 1);
+		}
+
+		// soak report: -soak <seconds>; time of each loop pass (messages
+		//	and tick), seats and memory drifting over hours mean trouble
+		if (loop)
+		{
+			tLoop = RakNet::GetTimeUS() - tLoop;
+			loop->count[gproNet::sMetricsHistogram::GetBucket(tLoop * 1000)]++;
+			if (tLoop > loopMax)
+				loopMax = tLoop;
+			if (RakNet::GetTime() - tSoak >= soak * 1000ull)
+			{
+				tSoak = RakNet::GetTime();
+				printf("[%6.1f min] loop p50 %.0f p99 %.0f max %llu us | seated %u held %u | memory %.1f MB (start %.1f) \n",
+					(double)(tSoak - tStart) / 60000.0, (double)loop->GetPercentile(50.0) / 1000.0, (double)loop->GetPercentile(99.0) / 1000.0, (unsigned long long)loopMax,
+					server.GetSeatedCount(), server.GetHeldCount(), (double)gproNet::GetProcessMemory() / 1048576.0, (double)memoryStart / 1048576.0);
+				fflush(stdout);
+				memset(loop.get(), 0, sizeof(*loop));
+				loopMax = 0;
+			}
+		}
 	}
 
 	printf("\n\n");
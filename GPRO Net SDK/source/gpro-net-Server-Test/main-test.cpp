@@ -0,0 +1,1612 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	main-test.cpp
+	Main source for console test application: assertion checks of the
+	framework's parts, in named groups; exits nonzero if any check fails.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-RateControl.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-ChatRooms.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-HashRing.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-Checkpoint.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-Jobs.hpp"
+#include "gpro-net/gpro-net-server/gpro-net-RakNet-Server.hpp"
+#include "gpro-net/gpro-net/gpro-net-Loopback.hpp"
+#include "gpro-net/gpro-net/gpro-net-RakNet.hpp"
+#include "gpro-net/gpro-net/gpro-net-Metrics.hpp"
+#include "gpro-net/gpro-net/gpro-net-Entity.hpp"
+#include "gpro-net/gpro-net/gpro-net-Quantize.hpp"
+#include "gpro-net/gpro-net/gpro-net-Lockstep.hpp"
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-gamerules.h"
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-zobrist.h"
+#include "gpro-net/gpro-net/gpro-net-BitStreamPool.hpp"
+#include "gpro-net/gpro-net/gpro-net-Task.hpp"
+#include "gpro-net/gpro-net/gpro-net-Span.hpp"
+#include "gpro-net/gpro-net/gpro-net-BattleshipAI.hpp"
+
+#include "RakNet/BitStream.h"
+#include "RakNet/MessageIdentifiers.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+// checks failed in current group; checks hold in release builds too,
+//	unlike assert
+static unsigned int testFailed = 0;
+
+static void testCheck(bool const condition, char const expression[], int const line)
+{
+	if (!condition)
+	{
+		printf("  line %d: %s \n", line, expression);
+		++testFailed;
+	}
+}
+
+#define TEST_CHECK(condition) testCheck((condition), #condition, __LINE__)
+
+
+// splitmix64 step, so runs repeat
+static unsigned long long testRandom(unsigned long long& state)
+{
+	unsigned long long z = (state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+// random value in range
+static float testRandomFloat(unsigned long long& state, float const lower, float const upper)
+{
+	return lower + (upper - lower) * (float)(testRandom(state) >> 40) / (float)(1ull << 24);
+}
+
+// random pose within the pose codec's ranges
+static gproNet::sSpatialPose testRandomPose(unsigned long long& state)
+{
+	gproNet::sSpatialPose pose;
+	unsigned int axis;
+	for (axis = 0; axis < 3; ++axis)
+	{
+		pose.scale[axis] = testRandomFloat(state, 0.5f, 4.0f);
+		pose.rotate[axis] = testRandomFloat(state, -3.0f, 3.0f);
+		pose.translate[axis] = testRandomFloat(state, -500.0f, 500.0f);
+	}
+	return pose;
+}
+
+// poses agree to within a quantization step of each field
+static bool testPoseNear(gproNet::sSpatialPose const& a, gproNet::sSpatialPose const& b)
+{
+	unsigned int axis;
+	for (axis = 0; axis < 3; ++axis)
+		if (fabsf(a.scale[axis] - b.scale[axis]) > gproNet::sSpatialPoseScaleCodec::fromSteps ||
+			fabsf(a.rotate[axis] - b.rotate[axis]) > gproNet::sSpatialPoseRotateCodec::fromSteps ||
+			fabsf(a.translate[axis] - b.translate[axis]) > gproNet::sSpatialPoseTranslateCodec::fromSteps)
+			return false;
+	return true;
+}
+
+// fleet on alternate rows starting at column (at most 5)
+static void testFleet(gpro_battleship board, unsigned char const col)
+{
+	unsigned char ship, row = 0;
+	gpro_battleship_reset(board);
+	for (ship = gpro_battleship_ship_p2; ship; ship <<= 1, row += 2)
+		gpro_battleship_place(board, ship, row, col, 1);
+}
+
+// send numbered message
+//	return: message number from transport, 0 if not sent
+static unsigned int testSend(gproNet::cTransport& transport, unsigned int const number, PacketReliability const reliability, RakNet::SystemAddress const recipient)
+{
+	RakNet::BitStream bitstream;
+	bitstream.Write((RakNet::MessageID)ID_USER_PACKET_ENUM);
+	bitstream.Write(number);
+	return transport.Send(&bitstream, MEDIUM_PRIORITY, reliability, 0, recipient, false);
+}
+
+// take next packet: message identifier and number after it (0 if none)
+//	return: was there a packet
+static bool testReceive(gproNet::cTransport& transport, RakNet::MessageID& msgID_out, unsigned int& number_out)
+{
+	RakNet::Packet* const packet = transport.Receive();
+	if (packet)
+	{
+		RakNet::BitStream bitstream(packet->data, packet->length, false);
+		number_out = 0;
+		bitstream.Read(msgID_out);
+		bitstream.Read(number_out);
+		transport.DeallocatePacket(packet);
+		return true;
+	}
+	return false;
+}
+
+// peer that keeps identifiers of the messages it handles; exposes
+//	header helpers of manager, which are not public
+class cTestPeer : public gproNet::cRakNetManager
+{
+public:
+	std::vector<RakNet::MessageID> handled;
+
+	cTestPeer(gproNet::cTransport* const transport)
+		: gproNet::cRakNetManager(transport)
+	{
+	}
+
+	using gproNet::cRakNetManager::WriteTimestamp;
+	using gproNet::cRakNetManager::ReadTimestamp;
+	using gproNet::cRakNetManager::PeekHeaderBytes;
+	using gproNet::cRakNetManager::PeekMessageID;
+	using gproNet::cRakNetManager::Restamp;
+
+protected:
+	virtual bool ProcessMessage(RakNet::BitStream& /*bitstream*/, RakNet::SystemAddress const /*sender*/, RakNet::Time const /*dtSendToReceive*/, RakNet::MessageID const msgID)
+	{
+		if (msgID < gproNet::ID_GPRO_MESSAGE_COMMON_BEGIN)
+			return false;
+		handled.push_back(msgID);
+		return true;
+	}
+};
+
+// loopback transport seeing peers' clocks offset by set differential
+class cTestSkewTransport : public gproNet::cTransportLoopback
+{
+public:
+	RakNet::Time differential;
+
+	cTestSkewTransport(gproNet::cLoopbackNetwork& network)
+		: gproNet::cTransportLoopback(network), differential(0)
+	{
+	}
+
+	virtual RakNet::Time GetClockDifferential(RakNet::SystemAddress const /*address*/)
+	{
+		return differential;
+	}
+};
+
+
+// loopback transport: handshake arrives after one trip and full peers
+//	turn others away; unreliable sends are lost at about the set rate,
+//	reliable ones all arrive in order; a cut link is heard lost on both
+//	sides once its timeout passes, and may then connect again
+void testLoopback()
+{
+	enum { SENDS = 2000, LATENCY = 10, RESEND = 100, TIMEOUT = 1000, PORT = 21000 };
+	gproNet::cLoopbackNetwork network(true);
+	gproNet::cTransportLoopback a(network, LATENCY), b(network, LATENCY), c(network, LATENCY);
+	RakNet::SystemAddress const addressA("127.0.0.1", PORT), addressB("127.0.0.1", PORT + 1);
+	RakNet::SystemAddress list[2];
+	RakNet::MessageID msgID = 0;
+	unsigned int i, number = 0, received, next, round;
+
+	TEST_CHECK(a.Startup(1, 0, PORT) && b.Startup(1, 1, PORT + 1) && !c.Startup(1, 0, PORT + 1) && c.Startup(1, 0, PORT + 2));
+	TEST_CHECK(a.Connect("127.0.0.1", PORT + 1) && c.Connect("127.0.0.1", PORT + 1));
+	TEST_CHECK(!testReceive(a, msgID, number) && !testReceive(b, msgID, number));
+	network.Advance(LATENCY);
+	TEST_CHECK(testReceive(a, msgID, number) && msgID == ID_CONNECTION_REQUEST_ACCEPTED);
+	TEST_CHECK(testReceive(b, msgID, number) && msgID == ID_NEW_INCOMING_CONNECTION && !testReceive(b, msgID, number));
+	TEST_CHECK(testReceive(c, msgID, number) && msgID == ID_NO_FREE_INCOMING_CONNECTIONS);
+	TEST_CHECK(a.GetConnections(list, 2) == 1 && list[0] == addressB);
+
+	// unreliable: about a quarter lost, the rest in order
+	a.SetLoss(0.25f, RESEND);
+	for (i = 0; i < SENDS; ++i)
+		TEST_CHECK(testSend(a, i, UNRELIABLE, addressB) != 0);
+	network.Advance(LATENCY);
+	for (received = next = 0; testReceive(b, msgID, number); ++received)
+	{
+		TEST_CHECK(number >= next);
+		next = number + 1;
+	}
+	TEST_CHECK(received > SENDS * 65 / 100 && received < SENDS * 85 / 100);
+
+	// reliable: all arrive in order, those behind a lost one late
+	for (i = 0; i < SENDS; ++i)
+		testSend(a, i, RELIABLE_ORDERED, addressB);
+	network.Advance(LATENCY);
+	for (round = received = next = 0; round < 100 && next < SENDS; ++round)
+	{
+		while (testReceive(b, msgID, number))
+			TEST_CHECK(number == next++);
+		if (!round)
+			received = next;
+		network.Advance(RESEND);
+	}
+	TEST_CHECK(next == SENDS && received < SENDS);
+
+	// cut: nothing gets through, both sides hear of it after timeout
+	a.SetLoss(0.0f);
+	TEST_CHECK(a.Cut(addressB, TIMEOUT) && !a.Cut(addressB, TIMEOUT));
+	TEST_CHECK(!testSend(a, 0, RELIABLE_ORDERED, addressB) && !testSend(b, 0, RELIABLE_ORDERED, addressA));
+	network.Advance(TIMEOUT - 1);
+	TEST_CHECK(!testReceive(a, msgID, number) && !testReceive(b, msgID, number));
+	network.Advance(1);
+	TEST_CHECK(testReceive(a, msgID, number) && msgID == ID_CONNECTION_LOST);
+	TEST_CHECK(testReceive(b, msgID, number) && msgID == ID_CONNECTION_LOST);
+	TEST_CHECK(!a.GetConnections(list, 2) && !b.GetConnections(list, 2));
+
+	TEST_CHECK(a.Connect("127.0.0.1", PORT + 1));
+	network.Advance(LATENCY);
+	TEST_CHECK(testReceive(a, msgID, number) && msgID == ID_CONNECTION_REQUEST_ACCEPTED);
+	TEST_CHECK(testReceive(b, msgID, number) && msgID == ID_NEW_INCOMING_CONNECTION);
+	TEST_CHECK(testSend(a, 7, RELIABLE_ORDERED, addressB) != 0);
+	network.Advance(LATENCY);
+	TEST_CHECK(testReceive(b, msgID, number) && msgID == ID_USER_PACKET_ENUM && number == 7);
+}
+
+
+// trace files: captured packets read back as received and replay through
+//	the same handlers; a reopened trace continues after its records, and
+//	files that are not traces, or claim more than they hold, are refused
+//	and left as they were
+void testTrace()
+{
+	enum { PACKETS = 200, PORT = 21100 };
+	char const path[] = "gpro-net-test.gptr";
+	gproNet::cLoopbackNetwork network(true);
+	gproNet::cTransportLoopback serverTransport(network), clientTransport(network), replayTransport(network);
+	cTestPeer server(&serverTransport), replayed(&replayTransport);
+	gproNet::cTraceWriter writer;
+	gproNet::cTraceReader reader;
+	gproNet::sTraceRecord const* record = 0;
+	unsigned char const* data = 0;
+	std::vector<std::vector<unsigned char>> sent;
+	gpro_filemap filemap = { { 0, 0 }, 0, 0, 0 };
+	unsigned char junk[64], junkRead[sizeof(junk) * 2];
+	unsigned int i, n;
+	FILE* file;
+
+	remove(path);
+	TEST_CHECK(writer.Open(path, 1024));
+	server.SetCapture(&writer);
+	TEST_CHECK(serverTransport.Startup(1, 1, PORT) && clientTransport.Startup(1, 0, 0) && clientTransport.Connect("127.0.0.1", PORT));
+	for (i = 0; i < PACKETS; ++i)
+	{
+		std::vector<unsigned char> packet(1 + i % 50);
+		packet[0] = (unsigned char)(gproNet::ID_GPRO_MESSAGE_COMMON_BEGIN + i % 3);
+		for (n = 1; n < packet.size(); ++n)
+			packet[n] = (unsigned char)(i + n);
+		clientTransport.Send(packet.data(), (unsigned int)packet.size(), MEDIUM_PRIORITY, RELIABLE_ORDERED, 0, RakNet::SystemAddress("127.0.0.1", PORT), false);
+		sent.push_back(packet);
+	}
+	while (server.MessageLoop() > 0);
+	TEST_CHECK(server.handled.size() == PACKETS);
+	server.SetCapture(0);
+	writer.Close();
+
+	TEST_CHECK(reader.Open(path) && reader.GetCount() == PACKETS + 1);
+	TEST_CHECK(reader.Next(record, data) && record->length == 1 && data[0] == ID_NEW_INCOMING_CONNECTION);
+	for (i = 0; i < PACKETS && reader.Next(record, data); ++i)
+		TEST_CHECK(record->length == sent[i].size() && !memcmp(data, sent[i].data(), record->length) &&
+			gproNet::cTraceReader::GetSender(*record).GetPort() == clientTransport.GetPort());
+	TEST_CHECK(i == PACKETS && !reader.Next(record, data));
+	reader.Rewind();
+	TEST_CHECK(replayed.Replay(reader, false) == PACKETS && replayed.handled == server.handled);
+	reader.Close();
+
+	TEST_CHECK(writer.Open(path, 1024));
+	{
+		RakNet::Packet packet;
+		packet.systemAddress = RakNet::SystemAddress("127.0.0.1", PORT);
+		packet.data = sent[PACKETS - 1].data();
+		packet.length = (unsigned int)sent[PACKETS - 1].size();
+		TEST_CHECK(writer.Append(&packet, 1));
+	}
+	writer.Close();
+	TEST_CHECK(reader.Open(path) && reader.GetCount() == PACKETS + 2);
+	reader.Close();
+
+	// committed records past end of file
+	if (gpro_filemapOpen(&filemap, path, 0, 0) == 0)
+	{
+		((gproNet::sTraceHeader*)filemap.data)->used = filemap.size;
+		gpro_filemapClose(&filemap);
+	}
+	TEST_CHECK(!reader.Open(path) && !writer.Open(path, 1024));
+
+	// not a trace at all
+	memset(junk, 0x5a, sizeof(junk));
+	if ((file = fopen(path, "wb")) != 0)
+	{
+		fwrite(junk, 1, sizeof(junk), file);
+		fclose(file);
+	}
+	TEST_CHECK(!writer.Open(path, 1024) && !reader.Open(path));
+	if ((file = fopen(path, "rb")) != 0)
+	{
+		n = (unsigned int)fread(junkRead, 1, sizeof(junkRead), file);
+		fclose(file);
+		TEST_CHECK(n == sizeof(junk) && !memcmp(junk, junkRead, sizeof(junk)));
+	}
+	remove(path);
+}
+
+
+// metrics recording thread: every message to one of eight peers with
+//	handler times spread to 99 us, and sends to a peer of its own
+static void testMetricsRecord(gproNet::cMetrics* const metrics, unsigned int const thread, unsigned int const records)
+{
+	unsigned int i;
+	for (i = 0; i < records; ++i)
+	{
+		metrics->RecordReceive((RakNet::MessageID)(100 + i % 4), RakNet::SystemAddress("127.0.0.1", (unsigned short)(22000 + i % 8)), 10, 1000ull * (i % 100));
+		metrics->RecordSend(100, RakNet::SystemAddress("127.0.0.1", (unsigned short)(22100 + thread)), 20, 2);
+	}
+}
+
+// metrics: buckets bound their values within an eighth; counts from
+//	several threads merge, and never go back in snapshots taken while
+//	recording; forgotten connections leave snapshots and their slots are
+//	reclaimed, emptied, for new peers
+void testMetrics()
+{
+	enum { THREADS = 4, RECORDS = 20000, PEERS = 8, PORT = 22000 };
+	gproNet::cMetrics metrics;
+	gproNet::sMetricsSnapshot* const snapshot = new gproNet::sMetricsSnapshot;
+	std::vector<std::thread> thread;
+	unsigned long long value, packets, previous = 0;
+	unsigned int i, t, bucket, found;
+
+	for (i = 1; i < 100000000; i = i * 3 / 2 + 1)
+	{
+		bucket = gproNet::sMetricsHistogram::GetBucket(i);
+		value = gproNet::sMetricsHistogram::GetBucketValue(bucket);
+		TEST_CHECK(value <= i && (i - value) * 8 <= i && gproNet::sMetricsHistogram::GetBucketValue(bucket + 1) > i);
+	}
+
+	for (t = 0; t < THREADS; ++t)
+		thread.push_back(std::thread(testMetricsRecord, &metrics, t, (unsigned int)RECORDS));
+	for (i = 0; i < 50; ++i)
+	{
+		metrics.Snapshot(*snapshot);
+		for (t = 100, packets = 0; t < 104; ++t)
+			packets += snapshot->message[t].packetsIn;
+		TEST_CHECK(packets >= previous);
+		previous = packets;
+	}
+	for (t = 0; t < THREADS; ++t)
+		thread[t].join();
+
+	metrics.Snapshot(*snapshot);
+	for (t = 100; t < 104; ++t)
+	{
+		TEST_CHECK(snapshot->message[t].packetsIn == THREADS * RECORDS / 4 && snapshot->message[t].bytesIn == THREADS * RECORDS / 4 * 10);
+		TEST_CHECK(snapshot->message[t].handlerTime.GetTotal() == THREADS * RECORDS / 4);
+	}
+	TEST_CHECK(snapshot->message[100].packetsOut == THREADS * RECORDS && snapshot->message[100].bytesSaved == THREADS * RECORDS * 2);
+	value = snapshot->message[100].handlerTime.GetPercentile(50.0);
+	TEST_CHECK(value >= 40000 && value <= 48000);
+	TEST_CHECK(snapshot->connectionCount == PEERS + THREADS);
+	for (i = found = 0; i < snapshot->connectionCount; ++i)
+		if (snapshot->connection[i].address.GetPort() < PORT + PEERS)
+		{
+			TEST_CHECK(snapshot->connection[i].packetsIn == THREADS * RECORDS / PEERS && !snapshot->connection[i].packetsOut);
+			++found;
+		}
+	TEST_CHECK(found == PEERS);
+
+	// fill this thread's table, forget everyone, then fill it again
+	for (i = 0; i < PEERS; ++i)
+		metrics.ForgetConnection(RakNet::SystemAddress("127.0.0.1", (unsigned short)(PORT + i)));
+	for (t = 0; t < THREADS; ++t)
+		metrics.ForgetConnection(RakNet::SystemAddress("127.0.0.1", (unsigned short)(PORT + 100 + t)));
+	metrics.Snapshot(*snapshot);
+	TEST_CHECK(snapshot->connectionCount == 0);
+	for (i = 0; i < gproNet::METRICS_CONNECTIONS; ++i)
+		metrics.RecordSend(1, RakNet::SystemAddress("127.0.0.1", (unsigned short)(PORT + 200 + i)), 5);
+	for (i = 0; i < gproNet::METRICS_CONNECTIONS; ++i)
+		metrics.ForgetConnection(RakNet::SystemAddress("127.0.0.1", (unsigned short)(PORT + 200 + i)));
+	for (i = 0; i < gproNet::METRICS_CONNECTIONS; ++i)
+		metrics.RecordSend(1, RakNet::SystemAddress("127.0.0.1", (unsigned short)(PORT + 400 + i)), 5);
+	metrics.Snapshot(*snapshot);
+	TEST_CHECK(snapshot->connectionCount == gproNet::METRICS_CONNECTIONS);
+	for (i = 0; i < snapshot->connectionCount; ++i)
+		TEST_CHECK(snapshot->connection[i].address.GetPort() >= PORT + 400 &&
+			snapshot->connection[i].packetsOut == 1 && snapshot->connection[i].bytesOut == 5);
+	delete snapshot;
+}
+
+
+// schemas: fields round trip, clamp out of range values and refuse short
+//	streams; whole messages and poses round trip
+void testSchemas()
+{
+	typedef gproNet::sRangeCodec<-100, 100> range;
+	typedef gproNet::sQuantizedCodec<-10, 10, 1, 10> quantized;
+	typedef gproNet::sStringCodec<8> string;
+	enum { POSES = 37 };
+	unsigned long long random = 1;
+	unsigned int i;
+	int value;
+	float real;
+	char text[9];
+	bool flag;
+
+	// fixed widths
+	TEST_CHECK(gproNet::BitsFor(0) == 0 && gproNet::BitsFor(1) == 1 && gproNet::BitsFor(255) == 8 && gproNet::BitsFor(256) == 9);
+	TEST_CHECK(range::bits == 8 && quantized::bits == 10 && string::bits == 4 + 8 * 8);
+	{
+		RakNet::BitStream bitstream;
+		range::Write(bitstream, -100);
+		range::Write(bitstream, 37);
+		range::Write(bitstream, 1000);
+		gproNet::sBoolCodec::Write(bitstream, true);
+		quantized::Write(bitstream, 3.3f);
+		quantized::Write(bitstream, -50.0f);
+		string::Write(bitstream, "truncated text");
+		TEST_CHECK(bitstream.GetNumberOfBitsUsed() == 3 * range::bits + 1 + 2 * quantized::bits + string::bits);
+
+		TEST_CHECK(range::Read(bitstream, value) && value == -100);
+		TEST_CHECK(range::Read(bitstream, value) && value == 37);
+		TEST_CHECK(range::Read(bitstream, value) && value == 100);
+		TEST_CHECK(gproNet::sBoolCodec::Read(bitstream, flag) && flag);
+		TEST_CHECK(quantized::Read(bitstream, real) && fabsf(real - 3.3f) <= quantized::fromSteps / 2.0f);
+		TEST_CHECK(quantized::Read(bitstream, real) && real == quantized::lower);
+		TEST_CHECK(string::Read(bitstream, text) && !strcmp(text, "truncate"));
+		TEST_CHECK(!range::Read(bitstream, value));
+	}
+
+	// whole messages
+	{
+		RakNet::BitStream bitstream;
+		gproNet::sInputs inputs = { true, false, true, false, false, true }, inputsRead;
+		gproNet::sTestMessage message, messageRead;
+		strcpy(message.text, "hello");
+		gproNet::sInputsSchema::Write(bitstream, inputs);
+		gproNet::sTestMessageSchema::Write(bitstream, message);
+		TEST_CHECK(gproNet::sInputsSchema::Read(bitstream, inputsRead) && !memcmp(&inputs, &inputsRead, sizeof(inputs)));
+		TEST_CHECK(gproNet::sTestMessageSchema::Read(bitstream, messageRead) && !strcmp(messageRead.text, "hello"));
+	}
+
+	// poses
+	{
+		gproNet::sSpatialPose pose[POSES], poseRead;
+		RakNet::BitStream bitstream;
+		for (i = 0; i < POSES; ++i)
+		{
+			pose[i] = testRandomPose(random);
+			pose[i].Write(bitstream);
+		}
+		TEST_CHECK(bitstream.GetNumberOfBitsUsed() == POSES * gproNet::sSpatialPoseSchema::maxBits);
+		for (i = 0; i < POSES; ++i)
+		{
+			poseRead.Read(bitstream);
+			TEST_CHECK(testPoseNear(pose[i], poseRead));
+		}
+	}
+}
+
+
+// entity store: identifiers and slots stay consistent through creation
+//	and destruction, dirty tracking sends only changes, and a mirror fed
+//	the updates ends with the same entities
+void testEntities()
+{
+	enum { COUNT = 300, ROUNDS = 20 };
+	gproNet::cEntityStore store, mirror;
+	gproNet::sSpatialPose pose, poseRead;
+	std::vector<unsigned int> live;
+	unsigned long long random = 2;
+	unsigned int i, id, round;
+	float const moved[3] = { 1.0f, 2.0f, 3.0f };
+
+	for (i = 0; i < COUNT; ++i)
+		live.push_back(store.Create(testRandomPose(random)));
+	TEST_CHECK(store.GetCount() == COUNT && store.GetDirtyCount() == COUNT);
+	for (i = 0; i < COUNT; ++i)
+		TEST_CHECK(store.GetID(store.GetSlot(live[i])) == live[i]);
+
+	for (round = 0; round < ROUNDS; ++round)
+	{
+		RakNet::BitStream bitstream;
+		unsigned int written;
+
+		// move some, destroy some, create some
+		for (i = 0; i < COUNT / 10; ++i)
+			store.SetPose(live[testRandom(random) % live.size()], testRandomPose(random));
+		for (i = 0; i < 5; ++i)
+		{
+			id = (unsigned int)(testRandom(random) % live.size());
+			TEST_CHECK(store.Destroy(live[id]));
+			TEST_CHECK(store.GetSlot(live[id]) == (unsigned int)gproNet::ENTITY_INVALID);
+			live[id] = live.back();
+			live.pop_back();
+		}
+		for (i = 0; i < 5; ++i)
+			live.push_back(store.Create(testRandomPose(random)));
+
+		written = store.WriteDirty(bitstream);
+		TEST_CHECK(written <= store.GetCount() && !store.GetDirtyCount());
+		TEST_CHECK(store.GetDestroyedCount() == 5);
+		TEST_CHECK(store.WriteDestroyed(bitstream) == 5 && !store.GetDestroyedCount());
+		TEST_CHECK(mirror.ReadDirty(bitstream) == (int)written);
+		TEST_CHECK(mirror.ReadDestroyed(bitstream) == 5);
+	}
+	TEST_CHECK(mirror.GetCount() == store.GetCount());
+	for (i = 0; i < live.size(); ++i)
+		TEST_CHECK(store.GetPose(live[i], pose) && mirror.GetPose(live[i], poseRead) && testPoseNear(pose, poseRead));
+
+	// unchanged pose marks nothing; one field marks one entity
+	store.GetPose(live[0], pose);
+	TEST_CHECK(store.SetPose(live[0], pose) && !store.GetDirtyCount());
+	TEST_CHECK(store.SetField(live[0], gproNet::ENTITY_FIELD_TRANSLATE, moved) && store.GetDirtyCount() == 1);
+	{
+		RakNet::BitStream bitstream;
+		TEST_CHECK(store.WriteDirty(bitstream) == 1);
+		TEST_CHECK(bitstream.GetNumberOfBytesUsed() <= gproNet::cEntityStore::GetUpdateMaxBytes(1));
+	}
+
+	// truncated update is refused
+	{
+		RakNet::BitStream bitstream, truncated;
+		gproNet::cEntityStore other;
+		store.WriteAll(bitstream);
+		truncated.Write((char const*)bitstream.GetData(), bitstream.GetNumberOfBytesUsed() / 2);
+		TEST_CHECK(other.ReadDirty(truncated) < 0);
+	}
+	TEST_CHECK(!store.Destroy(0xfffff));
+}
+
+
+// batch quantization: every supported kernel writes the same bits as the
+//	pose schema and decodes to within a step
+void testQuantize()
+{
+	enum { POSES = 37 };
+	gproNet::sSpatialPose pose;
+	std::vector<float> soa[9], soaRead[9];
+	float const* in[9];
+	float* out[9];
+	unsigned char packed[(POSES * gproNet::sSpatialPoseSchema::maxBits + 7) / 8];
+	RakNet::BitStream bitstream;
+	gproNet::eQuantizeMode const mode = gproNet::GetQuantizeMode();
+	unsigned long long random = 4;
+	unsigned int i, axis, bits;
+	int kernel;
+
+	for (i = 0; i < 9; ++i)
+	{
+		soa[i].resize(POSES);
+		soaRead[i].resize(POSES);
+		in[i] = soa[i].data();
+		out[i] = soaRead[i].data();
+	}
+	for (i = 0; i < POSES; ++i)
+	{
+		pose = testRandomPose(random);
+		pose.Write(bitstream);
+		for (axis = 0; axis < 3; ++axis)
+		{
+			soa[axis][i] = pose.scale[axis];
+			soa[3 + axis][i] = pose.rotate[axis];
+			soa[6 + axis][i] = pose.translate[axis];
+		}
+	}
+	for (kernel = gproNet::QUANTIZE_SCALAR; kernel <= gproNet::QUANTIZE_AVX2; ++kernel)
+	{
+		if (gproNet::SetQuantizeMode((gproNet::eQuantizeMode)kernel) != kernel)
+			continue;
+		memset(packed, 0, sizeof(packed));
+		bits = gproNet::EncodePoseBatch(in, in + 3, in + 6, POSES, packed);
+		TEST_CHECK(bits == POSES * gproNet::sSpatialPoseSchema::maxBits);
+		TEST_CHECK(!memcmp(packed, bitstream.GetData(), gproNet::GetPoseBatchBytes(POSES)));
+		gproNet::DecodePoseBatch(packed, POSES, out, out + 3, out + 6);
+		for (i = 0; i < POSES; ++i)
+			for (axis = 0; axis < 3; ++axis)
+				TEST_CHECK(fabsf(soaRead[axis][i] - soa[axis][i]) <= gproNet::sSpatialPoseScaleCodec::fromSteps &&
+					fabsf(soaRead[6 + axis][i] - soa[6 + axis][i]) <= gproNet::sSpatialPoseTranslateCodec::fromSteps);
+	}
+	gproNet::SetQuantizeMode(mode);
+}
+
+
+// play random legal moves until game is over or limit
+//	(every applied move must keep incremental hashes right)
+//	return: moves applied
+static unsigned int testPlay(gproNet::cLockstepSession& session, unsigned long long& random, unsigned int const limit)
+{
+	gproNet::sLockstepMove move;
+	unsigned int moves = 0, tries;
+	while (!session.IsOver() && moves < limit)
+	{
+		for (tries = 0; tries < 100000; ++tries)
+		{
+			move.player = session.GetTurn();
+			move.a = (unsigned char)(testRandom(random) % 10);
+			move.b = (unsigned char)(testRandom(random) % 10);
+			move.c = (unsigned char)(testRandom(random) % 8);
+			move.d = (unsigned char)(testRandom(random) % 4);
+			if (session.GetGame() == gproNet::LOCKSTEP_CHECKERS)
+				move.b %= 4;
+			if (session.GetGame() == gproNet::LOCKSTEP_MANCALA)
+				move.a = (unsigned char)(gpro_mancala_cup1 + move.a % 6);
+			if (session.Apply(move) == 0)
+				break;
+		}
+		if (tries == 100000)
+			break;
+		TEST_CHECK(session.VerifyBoards() == 0);
+		++moves;
+	}
+	return moves;
+}
+
+// lockstep rules: legal openings, refused moves change nothing, stones
+//	are kept, games end, and state survives save, load and resync
+void testLockstep()
+{
+	gproNet::cLockstepSession session, copy;
+	gproNet::sLockstepRecord record;
+	gproNet::sLockstepMove move = { 0, 0, 0, 0, 0 };
+	gpro_battleship board[2];
+	unsigned long long random = 3, hash;
+	unsigned int openings = 0, stones, game;
+	int side, cup;
+
+	// checkers: seven opening moves, none backwards or onto own pieces
+	session.Start(gproNet::LOCKSTEP_CHECKERS);
+	for (move.a = 0; move.a < 8; ++move.a)
+		for (move.b = 0; move.b < 4; ++move.b)
+			for (move.c = 0; move.c < 8; ++move.c)
+				for (move.d = 0; move.d < 4; ++move.d)
+				{
+					copy = session;
+					if (copy.Apply(move) == 0)
+						++openings;
+				}
+	TEST_CHECK(openings == 7);
+	hash = session.Hash(0);
+	move.a = 2;
+	move.b = 0;
+	move.c = 1;
+	move.d = 0;
+	TEST_CHECK(session.Apply(move) < 0 && session.Hash(0) == hash && session.GetSequence() == 0);
+	move.player = 1;
+	TEST_CHECK(session.Apply(move) < 0 && session.GetTurn() == 0);
+
+	// mancala: empty cup refused, stones kept, play ends
+	session.Start(gproNet::LOCKSTEP_MANCALA);
+	move.player = 0;
+	move.a = gpro_mancala_cup1;
+	TEST_CHECK(session.Apply(move) == 0);
+	move.player = session.GetTurn();
+	if (move.player == 0)
+		TEST_CHECK(session.Apply(move) < 0);
+	testPlay(session, random, 1000);
+	TEST_CHECK(session.IsOver());
+	for (side = stones = 0; side < 2; ++side)
+		for (cup = gpro_mancala_score; cup <= gpro_mancala_cup6; ++cup)
+			stones += session.GetMancala()[side][cup];
+	TEST_CHECK(stones == 48);
+
+	// battleship: bad fleet refused; fleets play out
+	session.Start(gproNet::LOCKSTEP_BATTLESHIP);
+	gpro_battleship_reset(board[0]);
+	board[0][0][0] = gpro_battleship_ship_c5;
+	TEST_CHECK(session.SetBoard(0, board[0]) == -2 && !session.HasBoard(0));
+	testFleet(board[0], 0);
+	testFleet(board[1], 5);
+	TEST_CHECK(session.SetBoard(0, board[0]) == 0 && session.SetBoard(1, board[1]) == 0);
+	TEST_CHECK(testPlay(session, random, 200) <= 200 && session.IsOver());
+
+	// every game: saved, loaded and resent state hashes the same
+	for (game = gproNet::LOCKSTEP_CHECKERS; game < gproNet::LOCKSTEP_GAME_COUNT; ++game)
+	{
+		session.Start((gproNet::eLockstepGame)game);
+		if (game == gproNet::LOCKSTEP_BATTLESHIP)
+		{
+			session.SetBoard(0, board[0]);
+			session.SetBoard(1, board[1]);
+		}
+		testPlay(session, random, 21);
+		session.Save(record);
+		TEST_CHECK(copy.Load(record));
+		TEST_CHECK(copy.GetSequence() == session.GetSequence() && copy.GetTurn() == session.GetTurn());
+		TEST_CHECK(copy.Hash(0) == session.Hash(0) && copy.Hash(1) == session.Hash(1));
+		{
+			RakNet::BitStream bitstream;
+			gproNet::cLockstepSession resynced;
+			session.WriteState(bitstream, 1);
+			TEST_CHECK(bitstream.GetNumberOfBytesUsed() <= gproNet::LOCKSTEP_STATE_BYTES);
+			TEST_CHECK(resynced.ReadState(bitstream, 1) && resynced.Hash(1) == session.Hash(1));
+		}
+		{
+			RakNet::BitStream bitstream;
+			gproNet::sLockstepMove moveRead;
+			move.player = 1;
+			move.a = gpro_mancala_cup6;
+			move.b = 3;
+			move.c = 7;
+			move.d = 2;
+			session.WriteMove(bitstream, move);
+			TEST_CHECK(bitstream.GetNumberOfBytesUsed() <= gproNet::LOCKSTEP_MOVE_BYTES);
+			TEST_CHECK(session.ReadMove(bitstream, moveRead) && moveRead.player == 1 && moveRead.a == move.a);
+		}
+	}
+}
+
+
+// zobrist hashing: cell and range updates equal a full recompute, moves
+//	of every game keep incremental board hashes equal to it, and one
+//	position reached by two move orders hashes the same
+void testZobrist()
+{
+	unsigned char cells[gpro_zobrist_cells] = { 0 }, before[gpro_zobrist_cells];
+	unsigned long long random = 5, hash = 1, full = 1;
+	gproNet::cLockstepSession session, other;
+	gproNet::sLockstepMove move = { 0, 0, 0, 0, 0 };
+	gpro_battleship board[2];
+	unsigned int i, cell, game;
+
+	TEST_CHECK(gpro_zobrist_board(cells, sizeof(cells), &hash) == 0 && hash == 0);
+	for (i = 0; i < 1000; ++i)
+	{
+		cell = (unsigned int)(testRandom(random) % gpro_zobrist_cells);
+		before[0] = cells[cell];
+		cells[cell] = (unsigned char)testRandom(random);
+		TEST_CHECK(gpro_zobrist_cell(&hash, cell, before[0], cells[cell]) == 0);
+		TEST_CHECK(gpro_zobrist_board(cells, sizeof(cells), &full) == 0 && hash == full && gpro_zobrist_verify(cells, sizeof(cells), hash) == 0);
+	}
+	memcpy(before, cells, sizeof(cells));
+	for (i = 0; i < 40; ++i)
+		cells[10 + i] ^= (unsigned char)(i % 3 ? testRandom(random) : 0);
+	TEST_CHECK(gpro_zobrist_range(&hash, 10, before + 10, cells + 10, 40) == 0 && gpro_zobrist_verify(cells, sizeof(cells), hash) == 0);
+	TEST_CHECK(gpro_zobrist_verify(cells, sizeof(cells), hash ^ 1) == -2);
+	TEST_CHECK(gpro_zobrist_cell(&hash, gpro_zobrist_cells, 0, 1) == -1 && gpro_zobrist_board(cells, gpro_zobrist_cells + 1, &full) == -1);
+
+	testFleet(board[0], 1);
+	testFleet(board[1], 4);
+	for (game = gproNet::LOCKSTEP_CHECKERS; game < gproNet::LOCKSTEP_GAME_COUNT; ++game)
+		for (i = 0; i < 5; ++i)
+		{
+			session.Start((gproNet::eLockstepGame)game);
+			if (game == gproNet::LOCKSTEP_BATTLESHIP)
+				TEST_CHECK(session.SetBoard(0, board[0]) == 0 && session.SetBoard(1, board[1]) == 0);
+			TEST_CHECK(session.VerifyBoards() == 0);
+			testPlay(session, random, 1000);
+		}
+
+	// battleship: attacks on two cells swapped around the reply between
+	session.Start(gproNet::LOCKSTEP_BATTLESHIP);
+	session.SetBoard(0, board[0]);
+	session.SetBoard(1, board[1]);
+	other = session;
+	move.a = 0;
+	move.b = 4;
+	TEST_CHECK(session.Apply(move) == 0);
+	move.a = 3;
+	move.b = 3;
+	TEST_CHECK(other.Apply(move) == 0);
+	move.player = 1;
+	move.a = move.b = 9;
+	TEST_CHECK(session.Apply(move) == 0 && other.Apply(move) == 0);
+	move.player = 0;
+	move.a = 3;
+	move.b = 3;
+	TEST_CHECK(session.Apply(move) == 0);
+	move.a = 0;
+	move.b = 4;
+	TEST_CHECK(other.Apply(move) == 0);
+	TEST_CHECK(session.Hash(0) == other.Hash(0) && session.Hash(1) == other.Hash(1));
+	TEST_CHECK(session.Hash(0) != session.Hash(1));
+}
+
+
+// rate control: each sign of congestion slows a connection one level per
+//	hold down to the last, a quiet link speeds it up one level per hold,
+//	and a lasting step in round trip becomes the new base within two
+//	windows instead of reading as queuing forever
+void testRate()
+{
+	gproNet::cRateController control;
+	gproNet::sRateState state;
+	gproNet::sLinkStatistics link = { 50, 0.0f, 0, 0 };
+	RakNet::Time time = 1000, tChange = 0;
+	unsigned int i, slower = 0, faster = 0;
+	int change;
+
+	control.Reset(state, time);
+	for (i = 0; i < 40; ++i)
+		TEST_CHECK(control.Update(state, link, time += gproNet::RATE_SAMPLE_INTERVAL) == 0);
+	TEST_CHECK(state.level == 0 && state.pingBase == 50);
+
+	// queuing: down to last level, no faster than the hold
+	link.ping = 200;
+	for (i = 0; i < 40; ++i)
+		if ((change = control.Update(state, link, time += gproNet::RATE_SAMPLE_INTERVAL)) != 0)
+		{
+			TEST_CHECK(change == 1 && (!slower || time - tChange >= gproNet::RATE_DECREASE_HOLD));
+			tChange = time;
+			++slower;
+		}
+	TEST_CHECK(slower == gproNet::RATE_LEVEL_COUNT - 1 && state.level == gproNet::RATE_LEVEL_COUNT - 1);
+
+	// quiet again: back up one level per hold
+	link.ping = 50;
+	for (i = 0; i < 80; ++i)
+		if ((change = control.Update(state, link, time += gproNet::RATE_SAMPLE_INTERVAL)) != 0)
+		{
+			TEST_CHECK(change == -1 && time - tChange >= gproNet::RATE_INCREASE_HOLD);
+			tChange = time;
+			++faster;
+		}
+	TEST_CHECK(faster == gproNet::RATE_LEVEL_COUNT - 1 && state.level == 0);
+
+	// loss and send buffer each count as congestion
+	link.packetLoss = 0.1f;
+	TEST_CHECK(control.Update(state, link, time += gproNet::RATE_SAMPLE_INTERVAL) == 1);
+	link.packetLoss = 0.0f;
+	link.bytesInSendBuffer = 1 << 20;
+	TEST_CHECK(control.Update(state, link, time += gproNet::RATE_DECREASE_HOLD) == 1 && state.level == 2);
+	link.bytesInSendBuffer = 0;
+
+	// route change: round trip steps up for good; slows at first, then
+	//	the new round trip is the base and the rate comes back
+	link.ping = 300;
+	for (i = 0, slower = 0; i < 4 * gproNet::RATE_BASE_WINDOW / gproNet::RATE_SAMPLE_INTERVAL; ++i)
+		if (control.Update(state, link, time += gproNet::RATE_SAMPLE_INTERVAL) > 0)
+			++slower;
+	TEST_CHECK(slower > 0 && state.pingBase == 300 && state.level == 0);
+	TEST_CHECK(control.Update(state, link, time += gproNet::RATE_SAMPLE_INTERVAL) == 0);
+
+	// and a drop back is simply a lower base
+	link.ping = 40;
+	TEST_CHECK(control.Update(state, link, time += gproNet::RATE_SAMPLE_INTERVAL) == 0 && state.pingBase == 40);
+}
+
+
+// chat rooms: membership, posts written once and in order in batches of
+//	at most the batch size, history of the newest posts oldest first, and
+//	closed rooms neither take posts nor write anything
+void testChat()
+{
+	enum { ROOM = 5, POSTS = 150, MEMBERS = 3, PORT = 23000 };
+	gproNet::cChatRooms rooms;
+	gproNet::sChatMessage message;
+	std::vector<gproNet::sChatMessage> read;
+	RakNet::SystemAddress member[MEMBERS];
+	unsigned int i, id, count, batches = 0, active = 0;
+	bool history = true;
+	char text[gproNet::CHAT_TEXT_MAX + 1];
+
+	for (i = 0; i < MEMBERS; ++i)
+		member[i] = RakNet::SystemAddress("127.0.0.1", (unsigned short)(PORT + i));
+	memset(&message, 0, sizeof(message));
+	message.room = ROOM;
+	TEST_CHECK(!rooms.Post(message) && !rooms.Join(ROOM, member[0]));
+	rooms.Open(ROOM);
+	rooms.Open(gproNet::CHAT_ROOM_GLOBAL);
+	for (i = 0; i < MEMBERS; ++i)
+		TEST_CHECK(rooms.Join(ROOM, member[i]) && rooms.Join(gproNet::CHAT_ROOM_GLOBAL, member[i]));
+	TEST_CHECK(!rooms.Join(ROOM, member[0]) && rooms.GetMembers(ROOM)->size() == MEMBERS);
+	rooms.LeaveAll(member[2]);
+	TEST_CHECK(!rooms.IsMember(ROOM, member[2]) && !rooms.IsMember(gproNet::CHAT_ROOM_GLOBAL, member[2]) && rooms.IsMember(ROOM, member[1]));
+	TEST_CHECK(rooms.Leave(ROOM, member[1]) && !rooms.Leave(ROOM, member[1]) && rooms.GetMembers(ROOM)->size() == 1);
+
+	for (i = 0; i < POSTS; ++i)
+	{
+		message.sender = i;
+		sprintf(message.text, "message %u", i);
+		TEST_CHECK(rooms.Post(message));
+	}
+	message.room = gproNet::CHAT_ROOM_GLOBAL;
+	TEST_CHECK(rooms.Post(message));
+	while (rooms.NextActive(id))
+		active |= (id == ROOM ? 1 : id == gproNet::CHAT_ROOM_GLOBAL ? 2 : 4);
+	TEST_CHECK(active == 3);
+
+	for (;;)
+	{
+		RakNet::BitStream bitstream;
+		if (!(count = rooms.WritePending(ROOM, bitstream)))
+			break;
+		TEST_CHECK(count <= gproNet::CHAT_BATCH_MAX);
+		TEST_CHECK(gproNet::ReadChatBatch(bitstream, read, history) == (int)count && !history);
+		++batches;
+	}
+	TEST_CHECK(read.size() == POSTS && batches == ((unsigned int)POSTS + gproNet::CHAT_BATCH_MAX - 1) / gproNet::CHAT_BATCH_MAX);
+	for (i = 0; i < read.size(); ++i)
+	{
+		sprintf(text, "message %u", i);
+		TEST_CHECK(read[i].room == ROOM && read[i].sender == i && !strcmp(read[i].text, text));
+	}
+	{
+		RakNet::BitStream bitstream;
+		TEST_CHECK(!rooms.WritePending(ROOM, bitstream) && !bitstream.GetNumberOfBitsUsed());
+	}
+
+	read.clear();
+	{
+		RakNet::BitStream bitstream;
+		TEST_CHECK(rooms.WriteHistory(ROOM, bitstream) == gproNet::CHAT_HISTORY);
+		TEST_CHECK(gproNet::ReadChatBatch(bitstream, read, history) == gproNet::CHAT_HISTORY && history);
+		TEST_CHECK(read.front().sender == POSTS - (unsigned int)gproNet::CHAT_HISTORY && read.back().sender == POSTS - 1);
+	}
+
+	message.room = ROOM;
+	TEST_CHECK(rooms.Post(message));
+	rooms.Close(ROOM);
+	while (rooms.NextActive(id))
+		TEST_CHECK(id != ROOM);
+	{
+		RakNet::BitStream bitstream;
+		TEST_CHECK(rooms.WriteHistory(ROOM, bitstream) < 0 && !rooms.WritePending(ROOM, bitstream) && !rooms.Post(message));
+	}
+}
+
+
+// hash ring: keys spread over shards, adding a shard moves only keys to
+//	it, removing it puts them back
+void testHashRing()
+{
+	enum { KEYS = 20000, SHARDS = 4 };
+	gproNet::cHashRing ring;
+	std::vector<unsigned int> owner(KEYS);
+	unsigned int count[SHARDS + 2] = { 0 };
+	unsigned int preference[SHARDS + 2];
+	unsigned int key, shard, moved = 0, wrong = 0;
+
+	TEST_CHECK(ring.Find(1) == gproNet::HASH_RING_NONE);
+	TEST_CHECK(!ring.Add(gproNet::HASH_RING_NONE));
+	for (shard = 1; shard <= SHARDS; ++shard)
+		TEST_CHECK(ring.Add(shard));
+	TEST_CHECK(!ring.Add(1) && ring.GetCount() == SHARDS && ring.Contains(SHARDS) && !ring.Contains(SHARDS + 1));
+
+	for (key = 0; key < KEYS; ++key)
+	{
+		owner[key] = ring.Find(key);
+		TEST_CHECK(owner[key] >= 1 && owner[key] <= SHARDS);
+		++count[owner[key]];
+	}
+	for (shard = 1; shard <= SHARDS; ++shard)
+		TEST_CHECK(count[shard] > KEYS / SHARDS / 2 && count[shard] < KEYS / SHARDS * 2);
+
+	// new shard takes about its share, from every other shard
+	TEST_CHECK(ring.Add(SHARDS + 1));
+	for (key = 0; key < KEYS; ++key)
+	{
+		shard = ring.Find(key);
+		if (shard != owner[key])
+		{
+			++moved;
+			wrong += (shard != SHARDS + 1) ? 1 : 0;
+		}
+	}
+	TEST_CHECK(!wrong);
+	TEST_CHECK(moved > KEYS / (SHARDS + 1) / 2 && moved < KEYS / (SHARDS + 1) * 2);
+
+	// preference starts at owner and lists every shard once
+	for (key = 0; key < 100; ++key)
+	{
+		TEST_CHECK(ring.GetPreference(key, preference, SHARDS + 2) == SHARDS + 1);
+		TEST_CHECK(preference[0] == ring.Find(key));
+		for (shard = 1; shard < SHARDS + 1; ++shard)
+			TEST_CHECK(preference[shard] != preference[0]);
+	}
+
+	TEST_CHECK(ring.Remove(SHARDS + 1) && !ring.Remove(SHARDS + 1));
+	for (key = wrong = 0; key < KEYS; ++key)
+		wrong += (ring.Find(key) != owner[key]) ? 1 : 0;
+	TEST_CHECK(!wrong);
+}
+
+
+// checkpoint store: saves survive reopening, released and full slots
+//	behave, a save cut short loads as before it, and files of another
+//	layout are refused
+void testCheckpoint()
+{
+	enum { SLOTS = 4 };
+	char const path[] = "gpro-net-test.gpck";
+	gproNet::cCheckpointStore store;
+	gproNet::sMatchCheckpoint record, recordRead;
+	gpro_filemap filemap = { { 0, 0 }, 0, 0, 0 };
+	unsigned int slot;
+
+	remove(path);
+	memset(&record, 0, sizeof(record));
+	TEST_CHECK(store.Open(path, SLOTS) && store.GetSlotCount() == SLOTS);
+	for (slot = 0; slot < SLOTS; ++slot)
+		TEST_CHECK(store.Allocate() == (int)slot);
+	TEST_CHECK(store.Allocate() < 0);
+	for (slot = 0; slot < SLOTS; ++slot)
+	{
+		record.chatRoom = slot;
+		record.player[0] = 100 + slot;
+		for (record.session.sequence = 1; record.session.sequence <= 3; ++record.session.sequence)
+			TEST_CHECK(store.Save(slot, record));
+	}
+	TEST_CHECK(store.Release(1) && !store.Load(1, recordRead));
+	store.Close();
+
+	// live slots come back; released slot is free again
+	TEST_CHECK(store.Open(path, SLOTS));
+	TEST_CHECK(store.Load(0, recordRead) && recordRead.session.sequence == 3 && recordRead.player[0] == 100);
+	TEST_CHECK(store.Load(3, recordRead) && recordRead.chatRoom == 3);
+	TEST_CHECK(!store.Load(1, recordRead));
+	TEST_CHECK(store.Allocate() == 1 && store.Allocate() < 0);
+	store.Close();
+
+	// fourth save of slot 2 cut short: older copy (save 2) published
+	//	half written
+	if (gpro_filemapOpen(&filemap, path, 0, 0) == 0)
+	{
+		gproNet::sMatchCheckpoint* const target = (gproNet::sMatchCheckpoint*)((char*)filemap.data + sizeof(gproNet::sCheckpointHeader)) + (2 * 2 + 0);
+		target->generation = 4;
+		memset(&target->session, 0xcd, sizeof(target->session) / 2);
+		gpro_filemapClose(&filemap);
+	}
+	TEST_CHECK(store.Open(path, SLOTS));
+	TEST_CHECK(store.Load(2, recordRead) && recordRead.session.sequence == 3);
+	store.Close();
+
+	// other layout, and a file that is not a checkpoint file
+	TEST_CHECK(!store.Open(path, SLOTS * 2) && !store.IsOpen());
+	if (gpro_filemapOpen(&filemap, path, 0, 0) == 0)
+	{
+		memset(filemap.data, 0x5a, sizeof(gproNet::sCheckpointHeader));
+		gpro_filemapClose(&filemap);
+	}
+	TEST_CHECK(!store.Open(path, SLOTS));
+	remove(path);
+}
+
+
+// bitstream pools: a released stream comes back, emptied, for the next
+//	request of its size class; a grown stream serves its new size; pooled
+//	streams allocate nothing once warm, and each thread has its own pool
+void testPool()
+{
+	gproNet::cBitStreamPool& pool = gproNet::cBitStreamPool::GetLocal();
+	gproNet::cBitStreamPool* other = 0;
+	RakNet::BitStream* stream;
+	unsigned long long allocations = 0;
+	unsigned int i, bytes;
+	char data[3000] = { 0 };
+
+	stream = pool.Acquire(1000);
+	stream->Write(data, 100);
+	pool.Release(stream, false);
+	TEST_CHECK(pool.Acquire(1000) == stream && !stream->GetNumberOfBitsUsed());
+	TEST_CHECK(pool.Acquire(1000) != stream);
+
+	stream->Write(data, sizeof(data));
+	bytes = (unsigned int)(stream->GetNumberOfBitsAllocated() >> 3);
+	allocations = pool.GetAllocationCount();
+	pool.Release(stream, true);
+	TEST_CHECK(pool.GetAllocationCount() == allocations + 1);
+	for (i = gproNet::BITSTREAM_POOL_CLASS_MIN; i * 2 <= bytes; i *= 2);
+	TEST_CHECK(pool.Acquire(i) == stream);
+	pool.Release(stream, false);
+
+	for (i = 0; i < 100; ++i)
+	{
+		if (i == 1)
+			allocations = pool.GetAllocationCount();
+		{
+			gproNet::cPooledBitStream small(200), large(5000);
+			small->Write(data, 200);
+			large->Write(data, sizeof(data));
+		}
+	}
+	TEST_CHECK(pool.GetAllocationCount() == allocations && pool.GetAcquireCount() >= 200);
+
+	std::thread([&other]() { other = &gproNet::cBitStreamPool::GetLocal(); }).join();
+	TEST_CHECK(other && other != &pool);
+}
+
+
+// task for tests: message from sender, a tick, a delay, then any
+//	sender's message; records how far it got (100 if first wait timed out)
+static gproNet::cTask testTaskSession(gproNet::cTaskScheduler& tasks, RakNet::SystemAddress const sender, unsigned int& step)
+{
+	gproNet::sTaskMessage message;
+	unsigned int value = 0;
+	message = co_await tasks.Receive(gproNet::ID_GPRO_MESSAGE_GAME_JOIN, sender, 1000);
+	if (!message.bitstream)
+	{
+		step = 100;
+		co_return;
+	}
+	message.bitstream->Read(value);
+	step = value;
+	co_await tasks.NextTick();
+	++step;
+	co_await tasks.Delay(50);
+	++step;
+	message = co_await tasks.Receive(gproNet::ID_GPRO_MESSAGE_GAME_START, RakNet::UNASSIGNED_SYSTEM_ADDRESS);
+	step += 10;
+}
+
+// coroutine tasks: resumed only by what they wait for, in order; waits
+//	time out; restarted tasks reuse pooled frames
+void testTasks()
+{
+	gproNet::cTaskScheduler tasks;
+	RakNet::SystemAddress const sender("127.0.0.1", 24000), other("127.0.0.1", 24001);
+	RakNet::BitStream bitstream;
+	RakNet::Time const now = RakNet::GetTime();
+	unsigned long long allocations = 0;
+	unsigned int step = 0, i;
+
+	bitstream.Write(5u);
+	TEST_CHECK(tasks.Start(testTaskSession(tasks, sender, step)) && tasks.GetWaitingCount() == 1 && step == 0);
+	TEST_CHECK(!tasks.Dispatch(bitstream, other, 0, gproNet::ID_GPRO_MESSAGE_GAME_JOIN) && step == 0);
+	TEST_CHECK(!tasks.Dispatch(bitstream, sender, 0, gproNet::ID_GPRO_MESSAGE_GAME_START) && step == 0);
+	TEST_CHECK(tasks.Dispatch(bitstream, sender, 0, gproNet::ID_GPRO_MESSAGE_GAME_JOIN) == 1 && step == 5);
+	TEST_CHECK(tasks.Update(now) == 1 && step == 6);
+	TEST_CHECK(!tasks.Update(now) && step == 6);
+	TEST_CHECK(tasks.Update(now + 1000) == 1 && step == 7);
+	TEST_CHECK(tasks.Dispatch(bitstream, other, 0, gproNet::ID_GPRO_MESSAGE_GAME_START) == 1 && step == 17);
+	TEST_CHECK(!tasks.GetWaitingCount());
+
+	TEST_CHECK(tasks.Start(testTaskSession(tasks, sender, step)));
+	TEST_CHECK(!tasks.Update(now) && tasks.Update(RakNet::GetTime() + 2000) == 1 && step == 100 && !tasks.GetWaitingCount());
+
+	for (i = 0; i < 100; ++i)
+	{
+		if (i == 1)
+			allocations = gproNet::cTaskFramePool::GetTotalAllocationCount();
+		bitstream.ResetReadPointer();
+		tasks.Start(testTaskSession(tasks, sender, step));
+		tasks.Dispatch(bitstream, sender, 0, gproNet::ID_GPRO_MESSAGE_GAME_JOIN);
+		tasks.Update(now);
+		tasks.Update(RakNet::GetTime() + 1000);
+		tasks.Dispatch(bitstream, sender, 0, gproNet::ID_GPRO_MESSAGE_GAME_START);
+	}
+	TEST_CHECK(step == 17 && !tasks.GetWaitingCount() && gproNet::cTaskFramePool::GetTotalAllocationCount() == allocations);
+}
+
+
+// job step: takes next place in shared order
+struct sTestJobStep
+{
+	std::atomic<unsigned int>* order;
+	unsigned int ranAt;
+};
+
+static void testJobStep(void* const data)
+{
+	sTestJobStep* const step = (sTestJobStep*)data;
+	step->ranAt = step->order->fetch_add(1) + 1;
+}
+
+static void testJobTouch(void* const data)
+{
+	((std::atomic<unsigned int>*)data)->fetch_add(1);
+}
+
+static void testJobCount(void* const data, unsigned int const begin, unsigned int const end)
+{
+	std::atomic<unsigned int>* const count = (std::atomic<unsigned int>*)data;
+	unsigned int i;
+	for (i = begin; i < end; ++i)
+		count[i].fetch_add(1, std::memory_order_relaxed);
+}
+
+// job system: parallel-for visits every index once for any grain, chains
+//	run in dependency order, parents finish after their children, and a
+//	handle reads finished once its storage runs a later job
+void testJobs()
+{
+	enum { COUNT = 100000, STEPS = 3 };
+	static unsigned int const grain[] = { 1, 7, 1000, COUNT * 2 };
+	gproNet::cJobSystem jobs(4);
+	std::atomic<unsigned int>* const count = new std::atomic<unsigned int>[COUNT];
+	std::atomic<unsigned int> order(0), touched(0);
+	sTestJobStep step[STEPS];
+	gproNet::sJobHandle handle[STEPS], parent, reused = gproNet::sJobHandle();
+	std::vector<gproNet::sJobHandle> held;
+	unsigned int i, g, wrong;
+
+	for (g = 0; g < sizeof(grain) / sizeof(*grain); ++g)
+	{
+		for (i = 0; i < COUNT; ++i)
+			count[i].store(0, std::memory_order_relaxed);
+		jobs.ParallelFor(testJobCount, count, COUNT, grain[g]);
+		for (i = wrong = 0; i < COUNT; ++i)
+			wrong += (count[i].load(std::memory_order_relaxed) != 1) ? 1 : 0;
+		TEST_CHECK(!wrong);
+	}
+
+	for (i = 0; i < STEPS; ++i)
+	{
+		step[i].order = &order;
+		step[i].ranAt = 0;
+		handle[i] = jobs.Create(testJobStep, &step[i]);
+	}
+	TEST_CHECK(jobs.AddDependency(handle[1], handle[0]) && jobs.AddDependency(handle[2], handle[1]));
+	for (i = STEPS; i-- > 0;)
+		jobs.Run(handle[i]);
+	jobs.Wait(handle[STEPS - 1]);
+	TEST_CHECK(step[0].ranAt == 1 && step[1].ranAt == 2 && step[2].ranAt == 3);
+	TEST_CHECK(jobs.IsFinished(handle[0]) && jobs.IsFinished(handle[1]));
+
+	for (i = 0; i < COUNT; ++i)
+		count[i].store(0, std::memory_order_relaxed);
+	parent = jobs.Create(testJobTouch, &touched);
+	jobs.Run(jobs.CreateParallelFor(testJobCount, count, COUNT, 100, parent));
+	jobs.Run(parent);
+	jobs.Wait(parent);
+	for (i = wrong = 0; i < COUNT; ++i)
+		wrong += (count[i].load(std::memory_order_relaxed) != 1) ? 1 : 0;
+	TEST_CHECK(!wrong && touched == 1);
+
+	// later jobs take the finished job's storage while not yet run
+	for (i = 0; i < gproNet::JOB_RING_SIZE * 2 && reused.job != handle[0].job; ++i)
+		held.push_back(reused = jobs.Create(testJobTouch, &touched));
+	TEST_CHECK(reused.job == handle[0].job && reused.generation != handle[0].generation);
+	TEST_CHECK(jobs.IsFinished(handle[0]) && !jobs.IsFinished(reused));
+	for (i = 0; i < held.size(); ++i)
+		jobs.Run(held[i]);
+	for (i = 0; i < held.size(); ++i)
+		jobs.Wait(held[i]);
+	TEST_CHECK(touched == held.size() + 1 && jobs.IsFinished(reused));
+	delete[] count;
+}
+
+
+// read compact stamp of send time on sender's clock, received at local
+//	time
+//	return: delay read back
+static RakNet::Time testStamp(cTestPeer& peer, RakNet::Time const tSend, RakNet::Time const tReceive, RakNet::MessageID& msgID_out)
+{
+	RakNet::BitStream bitstream;
+	RakNet::Time dtSendToReceive = 0;
+	bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_TIMESTAMP);
+	bitstream.Write((unsigned short)tSend);
+	bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_COMMON_BEGIN);
+	bitstream.Read(msgID_out);
+	peer.ReadTimestamp(bitstream, RakNet::UNASSIGNED_SYSTEM_ADDRESS, tReceive, dtSendToReceive, msgID_out);
+	return dtSendToReceive;
+}
+
+// timestamps: compact send time comes back whole across the 16-bit wrap
+//	under any clock differential, for delays from -32767 to 32768 ms, and
+//	one past either end aliases a whole wrap; full stamps read as before;
+//	headers are found and restamped in place
+void testTimestamps()
+{
+	static long long const delay[] = { -32767, -1000, -1, 0, 1, 999, 32767, 32768 };
+	static RakNet::Time const differential[] = { 0, 7, 40000, (RakNet::Time)0 - 40000, 90000000, (RakNet::Time)0 - 90000000 };
+	static RakNet::Time const receive[] = { 65535, 65536, 65536 * 1000 + 100, 0x12345678 };
+	gproNet::cLoopbackNetwork network;
+	cTestSkewTransport transport(network);
+	cTestPeer peer(&transport);
+	RakNet::MessageID msgID = 0;
+	RakNet::Time tReceive, tSend;
+	unsigned int d, r, i;
+
+	for (d = 0; d < sizeof(differential) / sizeof(*differential); ++d)
+		for (r = 0; r < sizeof(receive) / sizeof(*receive); ++r)
+		{
+			transport.differential = differential[d];
+			tReceive = receive[r];
+			for (i = 0; i < sizeof(delay) / sizeof(*delay); ++i)
+			{
+				tSend = tReceive - (RakNet::Time)delay[i] + differential[d];
+				TEST_CHECK(testStamp(peer, tSend, tReceive, msgID) == (RakNet::Time)delay[i] && msgID == gproNet::ID_GPRO_MESSAGE_COMMON_BEGIN);
+			}
+			tSend = tReceive - 32769 + differential[d];
+			TEST_CHECK(testStamp(peer, tSend, tReceive, msgID) == (RakNet::Time)(32769 - 65536));
+			tSend = tReceive + 32768 + differential[d];
+			TEST_CHECK(testStamp(peer, tSend, tReceive, msgID) == 32768);
+		}
+
+	// full stamp is on local clock, any delay
+	{
+		RakNet::BitStream bitstream;
+		RakNet::Time dtSendToReceive = 0;
+		bitstream.Write((RakNet::MessageID)ID_TIMESTAMP);
+		bitstream.Write((RakNet::Time)1000);
+		bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_COMMON_BEGIN);
+		bitstream.Read(msgID);
+		peer.ReadTimestamp(bitstream, RakNet::UNASSIGNED_SYSTEM_ADDRESS, 1000 + 3600000, dtSendToReceive, msgID);
+		TEST_CHECK(dtSendToReceive == 3600000 && msgID == gproNet::ID_GPRO_MESSAGE_COMMON_BEGIN);
+	}
+	{
+		RakNet::BitStream bitstream;
+		peer.WriteTimestamp(bitstream);
+		bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_CHAT);
+		TEST_CHECK(bitstream.GetNumberOfBytesUsed() == gproNet::MESSAGE_HEADER_BYTES && bitstream.GetData()[0] == gproNet::ID_GPRO_MESSAGE_TIMESTAMP);
+	}
+
+	// headers: compact and full stamps found
+	//	behind trace header,
+	//	and rewritten in place
+	{
+		RakNet::BitStream compact, full;
+		unsigned short stamp;
+		RakNet::Time time;
+		RakNet::MessageID id;
+		compact.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_TRACE);
+		compact.Write(1u);
+		compact.Write(2u);
+		compact.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_TIMESTAMP);
+		compact.Write((unsigned short)7);
+		compact.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_CHAT);
+		full.Write((RakNet::MessageID)ID_TIMESTAMP);
+		full.Write((RakNet::Time)7);
+		full.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_CHAT);
+		TEST_CHECK(cTestPeer::PeekHeaderBytes(compact.GetData(), compact.GetNumberOfBytesUsed()) == gproNet::MESSAGE_TRACE_BYTES + gproNet::MESSAGE_HEADER_BYTES);
+		TEST_CHECK(cTestPeer::PeekHeaderBytes(full.GetData(), full.GetNumberOfBytesUsed()) == gproNet::MESSAGE_HEADER_FULL_BYTES);
+		TEST_CHECK(cTestPeer::PeekMessageID(compact.GetData(), compact.GetNumberOfBytesUsed()) == gproNet::ID_GPRO_MESSAGE_CHAT);
+		TEST_CHECK(cTestPeer::PeekMessageID(full.GetData(), full.GetNumberOfBytesUsed()) == gproNet::ID_GPRO_MESSAGE_CHAT);
+
+		TEST_CHECK(cTestPeer::Restamp(compact.GetData(), compact.GetNumberOfBytesUsed(), 0x12345678));
+		TEST_CHECK(cTestPeer::Restamp(full.GetData(), full.GetNumberOfBytesUsed(), 0x12345678));
+		compact.IgnoreBytes(gproNet::MESSAGE_TRACE_BYTES + sizeof(RakNet::MessageID));
+		full.IgnoreBytes(sizeof(RakNet::MessageID));
+		TEST_CHECK(compact.Read(stamp) && stamp == 0x5678 && compact.Read(id) && id == gproNet::ID_GPRO_MESSAGE_CHAT);
+		TEST_CHECK(full.Read(time) && time == 0x12345678 && full.Read(id) && id == gproNet::ID_GPRO_MESSAGE_CHAT);
+	}
+}
+
+
+// span recording thread: spans numbered by start time
+static void testSpansRecord(gproNet::cSpanRecorder* const recorder, unsigned int const count)
+{
+	gproNet::sSpan span = { 0, 1, 0, 0, 0, gproNet::SPAN_LOOP, 0, 0, 0 };
+	unsigned int i;
+	for (i = 0; i < count; ++i)
+	{
+		span.tStart = i;
+		recorder->Record(span);
+	}
+}
+
+// spans: every thread's spans come back from its ring, in order (a
+//	thread taking an exited thread's slot continues its ring); a full
+//	ring keeps the newest; identifiers are distinct and non-zero; export
+//	writes every span
+void testSpans()
+{
+	enum { THREADS = 3, COUNT = 1000 };
+	char const path[] = "gpro-net-test.json";
+	gproNet::cSpanRecorder recorder("test", 1), wrapped("wrapped", 2);
+	gproNet::cSpanRecorder const* const recorders[] = { &recorder, &wrapped };
+	std::vector<gproNet::sSpan> spans;
+	std::vector<std::thread> thread;
+	std::vector<unsigned int> id;
+	unsigned long long next[THREADS] = { 0 }, expect;
+	unsigned int i, t, wrong = 0;
+
+	for (t = 0; t < THREADS; ++t)
+		thread.push_back(std::thread(testSpansRecord, &recorder, (unsigned int)COUNT));
+	for (t = 0; t < THREADS; ++t)
+		thread[t].join();
+	TEST_CHECK(recorder.Snapshot(spans) == THREADS * COUNT);
+	for (i = 0; i < spans.size(); ++i)
+		if (spans[i].thread >= THREADS || spans[i].tStart != next[spans[i].thread]++ % COUNT)
+			++wrong;
+	TEST_CHECK(!wrong);
+
+	// ring wraps; the oldest span may be mid-overwrite, so one ring less
+	//	one come back
+	testSpansRecord(&wrapped, gproNet::SPAN_RING + 100);
+	TEST_CHECK(wrapped.Snapshot(spans) == gproNet::SPAN_RING - 1);
+	for (i = 0, expect = 101; i < spans.size(); ++i)
+		if (spans[i].thread || spans[i].tStart != expect++)
+			++wrong;
+	TEST_CHECK(!wrong && expect == gproNet::SPAN_RING + 100);
+
+	for (i = 0; i < 1000; ++i)
+		id.push_back(recorder.NewID());
+	std::sort(id.begin(), id.end());
+	TEST_CHECK(id[0] && std::unique(id.begin(), id.end()) == id.end());
+
+	TEST_CHECK(gproNet::cSpanRecorder::ExportChrome(path, recorders, 2) == THREADS * COUNT + gproNet::SPAN_RING - 1);
+	remove(path);
+}
+
+
+// battleship targeting: vector density matches the scalar reference and
+//	rates attacked cells 0, random fleets are valid, and the density bot
+//	sinks them in far fewer shots than random fire (about 96 on average)
+void testBattleship()
+{
+	enum { GAMES = 40 };
+	gpro_battleship fleet, attack;
+	gproNet::sBattleshipDensity density, reference;
+	gproNet::cLockstepSession session;
+	unsigned long long random = 6;
+	unsigned char row = 0, col = 0, result, ship;
+	unsigned int game, shots = 0, wrong = 0, r, c;
+
+	for (game = 0; game < GAMES; ++game)
+	{
+		unsigned char afloat = gpro_battleship_ship;
+		gpro_battleship_reset(fleet);
+		gpro_battleship_reset(attack);
+		TEST_CHECK(gproNet::BattleshipPlaceRandom(fleet, random) == 0 && gpro_battleship_validate(fleet) == 0);
+		TEST_CHECK(gproNet::BattleshipPlaceRandom(fleet, random) == -2);
+		while (gpro_battleship_lost(fleet) != 1 && shots < GAMES * 100)
+		{
+			gproNet::BattleshipDensity(attack, afloat, density);
+			gproNet::BattleshipDensityScalar(attack, afloat, reference);
+			wrong += memcmp(density.cell, reference.cell, sizeof(density.cell)) ? 1 : 0;
+			TEST_CHECK(gproNet::BattleshipTarget(attack, afloat, random, row, col) == 0 && row < 10 && col < 10);
+			TEST_CHECK(!gpro_flag_check(attack[row][col], gpro_battleship_attack_rec));
+			gpro_battleship_defend(fleet, row, col, &result);
+			gpro_battleship_record(attack, row, col, result);
+			++shots;
+
+			// sinking announced on odd games
+			if (game & 1)
+				for (ship = gpro_battleship_ship_p2; ship; ship <<= 1)
+				{
+					bool sunk = true;
+					for (r = 0; r < 10; ++r)
+						for (c = 0; c < 10; ++c)
+							if (gpro_flag_check(fleet[r][c], ship) && !gpro_flag_check(fleet[r][c], gpro_battleship_damage))
+								sunk = false;
+					if (sunk)
+						afloat &= (unsigned char)~ship;
+				}
+		}
+		gproNet::BattleshipDensity(attack, afloat, density);
+		for (r = 0; r < 10; ++r)
+			for (c = 0; c < 10; ++c)
+				if (gpro_flag_check(attack[r][c], gpro_battleship_attack_rec) && density.cell[r][c])
+					++wrong;
+	}
+	TEST_CHECK(!wrong && shots < GAMES * 70);
+
+	// random fleets play out in lockstep; nothing left to attack
+	session.Start(gproNet::LOCKSTEP_BATTLESHIP);
+	for (r = 0; r < 2; ++r)
+	{
+		gpro_battleship_reset(fleet);
+		gproNet::BattleshipPlaceRandom(fleet, random);
+		TEST_CHECK(session.SetBoard((unsigned char)r, fleet) == 0);
+	}
+	TEST_CHECK(testPlay(session, random, 200) <= 200 && session.IsOver());
+	for (r = 0; r < 10; ++r)
+		for (c = 0; c < 10; ++c)
+			gpro_battleship_record(attack, (unsigned char)r, (unsigned char)c, gpro_battleship_miss);
+	TEST_CHECK(gproNet::BattleshipTarget(attack, gpro_battleship_ship, random, row, col) == -2);
+}
+
+
+// run server as the console does for a while; clients' packets are read
+//	and dropped
+static void testServe(gproNet::cRakNetServer& server, gproNet::cTransport* const client[], unsigned int const count, RakNet::Time const duration)
+{
+	RakNet::Time const tStart = RakNet::GetTime();
+	RakNet::Packet* packet;
+	unsigned int i;
+	do
+	{
+		server.MessageLoop();
+		server.Tick();
+		for (i = 0; i < count; ++i)
+			while ((packet = client[i]->Receive()) != 0)
+				client[i]->DeallocatePacket(packet);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	} while (RakNet::GetTime() - tStart < duration);
+}
+
+// soak counters: players in matches are seated; one leaving frees both
+//	seats of its match, one dropped is held instead until its grace runs
+//	out, then both are gone; process memory is known
+void testSoak()
+{
+	enum { PLAYERS = 4, TIMEOUT = 30, GRACE = 200, SETTLE = 20, PORT = 21200 };
+	gproNet::cLoopbackNetwork network;
+	gproNet::cTransportLoopback serverTransport(network), clientTransport[PLAYERS] = { network, network, network, network };
+	gproNet::cTransport* client[PLAYERS];
+	gproNet::cRakNetServer server(&serverTransport, PORT, PLAYERS);
+	RakNet::SystemAddress const address("127.0.0.1", PORT);
+	unsigned int i;
+
+	server.SetResumeGrace(GRACE);
+	for (i = 0; i < PLAYERS; ++i)
+	{
+		client[i] = &clientTransport[i];
+		TEST_CHECK(clientTransport[i].Startup(1, 0, 0) && clientTransport[i].Connect("127.0.0.1", PORT));
+	}
+	testServe(server, client, PLAYERS, SETTLE);
+	TEST_CHECK(server.GetSeatedCount() == 0 && server.GetHeldCount() == 0);
+
+	// pairs in join order
+	for (i = 0; i < PLAYERS; ++i)
+	{
+		RakNet::BitStream bitstream;
+		bitstream.Write((RakNet::MessageID)gproNet::ID_GPRO_MESSAGE_GAME_JOIN);
+		gproNet::WriteBitsValue(bitstream, gproNet::LOCKSTEP_MANCALA, 2);
+		clientTransport[i].Send(&bitstream, HIGH_PRIORITY, RELIABLE_ORDERED, gproNet::CHANNEL_GAME, address, false);
+		testServe(server, client, PLAYERS, 1);
+	}
+	testServe(server, client, PLAYERS, SETTLE);
+	TEST_CHECK(server.GetSeatedCount() == PLAYERS && server.GetHeldCount() == 0);
+
+	clientTransport[0].Disconnect(address);
+	testServe(server, client, PLAYERS, SETTLE);
+	TEST_CHECK(server.GetSeatedCount() == PLAYERS - 2 && server.GetHeldCount() == 0);
+
+	TEST_CHECK(clientTransport[2].Cut(address, TIMEOUT));
+	testServe(server, client, PLAYERS, TIMEOUT + SETTLE);
+	TEST_CHECK(server.GetSeatedCount() == PLAYERS - 3 && server.GetHeldCount() == 1);
+	testServe(server, client, PLAYERS, GRACE);
+	TEST_CHECK(server.GetSeatedCount() == 0 && server.GetHeldCount() == 0);
+
+	TEST_CHECK(gproNet::GetProcessMemory() > 0);
+	for (i = 0; i < PLAYERS; ++i)
+		clientTransport[i].Shutdown();
+}
+
+
+int main(int const argc, char const* const argv[])
+{
+	struct
+	{
+		char const* name;
+		void (*test)();
+	} const group[] = {
+		{ "loopback", testLoopback },
+		{ "trace", testTrace },
+		{ "metrics", testMetrics },
+		{ "schemas", testSchemas },
+		{ "entities", testEntities },
+		{ "quantize", testQuantize },
+		{ "lockstep", testLockstep },
+		{ "zobrist", testZobrist },
+		{ "rate", testRate },
+		{ "chat", testChat },
+		{ "hashring", testHashRing },
+		{ "checkpoint", testCheckpoint },
+		{ "pool", testPool },
+		{ "tasks", testTasks },
+		{ "jobs", testJobs },
+		{ "timestamps", testTimestamps },
+		{ "spans", testSpans },
+		{ "battleship", testBattleship },
+		{ "soak", testSoak },
+	};
+	unsigned int failed = 0, i;
+	int arg;
+	bool run;
+
+	// run named groups, or all
+	for (i = 0; i < sizeof(group) / sizeof(*group); ++i)
+	{
+		for (arg = 1, run = (argc < 2); arg < argc && !run; ++arg)
+			run = !strcmp(argv[arg], group[i].name);
+		if (!run)
+			continue;
+		testFailed = 0;
+		group[i].test();
+		printf("%-12s %s (%u failed) \n", group[i].name, testFailed ? "FAIL" : "pass", testFailed);
+		failed += testFailed;
+	}
+	return (failed ? 1 : 0);
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-ChatRooms.cpp
+	Source for chat rooms with batched delivery and history.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-ChatRooms.hpp"
+
+#include <algorithm>
+
+
+namespace gproNet
+{
+	void cChatRooms::Open(unsigned int const id)
+	{
+		if (room.find(id) == room.end())
+		{
+			sChatRoom& opened = room[id];
+			opened.pendingSent = 0;
+			opened.historyCount = 0;
+		}
+	}
+
+	void cChatRooms::Close(unsigned int const id)
+	{
+		// stale entry in active list is skipped when reached
+		room.erase(id);
+	}
+
+	bool cChatRooms::IsOpen(unsigned int const id) const
+	{
+		return (room.find(id) != room.end());
+	}
+
+	bool cChatRooms::Join(unsigned int const id, RakNet::SystemAddress const client)
+	{
+		std::map<unsigned int, sChatRoom>::iterator const itr = room.find(id);
+		if (itr == room.end() || IsMember(id, client))
+			return false;
+		itr->second.member.push_back(client);
+		return true;
+	}
+
+	bool cChatRooms::Leave(unsigned int const id, RakNet::SystemAddress const client)
+	{
+		std::map<unsigned int, sChatRoom>::iterator const itr = room.find(id);
+		std::vector<RakNet::SystemAddress>::iterator member;
+		if (itr == room.end())
+			return false;
+		member = std::find(itr->second.member.begin(), itr->second.member.end(), client);
+		if (member == itr->second.member.end())
+			return false;
+		*member = itr->second.member.back();
+		itr->second.member.pop_back();
+		return true;
+	}
+
+	void cChatRooms::LeaveAll(RakNet::SystemAddress const client)
+	{
+		std::map<unsigned int, sChatRoom>::iterator itr;
+		for (itr = room.begin(); itr != room.end(); ++itr)
+			Leave(itr->first, client);
+	}
+
+	bool cChatRooms::IsMember(unsigned int const id, RakNet::SystemAddress const client) const
+	{
+		std::map<unsigned int, sChatRoom>::const_iterator const itr = room.find(id);
+		return (itr != room.end() &&
+			std::find(itr->second.member.begin(), itr->second.member.end(), client) != itr->second.member.end());
+	}
+
+	std::vector<RakNet::SystemAddress> const* cChatRooms::GetMembers(unsigned int const id) const
+	{
+		std::map<unsigned int, sChatRoom>::const_iterator const itr = room.find(id);
+		return (itr != room.end() ? &itr->second.member : 0);
+	}
+
+	bool cChatRooms::Post(sChatMessage const& message)
+	{
+		std::map<unsigned int, sChatRoom>::iterator const itr = room.find(message.room);
+		if (itr == room.end())
+			return false;
+		sChatRoom& posted = itr->second;
+		if (posted.pending.empty())
+			active.push_back(message.room);
+		posted.pending.push_back(message);
+		posted.history[posted.historyCount++ % CHAT_HISTORY] = message;
+		return true;
+	}
+
+	int cChatRooms::WriteHistory(unsigned int const id, RakNet::BitStream& bitstream) const
+	{
+		std::map<unsigned int, sChatRoom>::const_iterator const itr = room.find(id);
+		unsigned int count, i;
+		if (itr == room.end())
+			return -1;
+		sChatRoom const& written = itr->second;
+		count = written.historyCount < CHAT_HISTORY ? (unsigned int)written.historyCount : (unsigned int)CHAT_HISTORY;
+		WriteChatBatch(bitstream, id, true, count);
+		for (i = written.historyCount - count; i < written.historyCount; ++i)
+			WriteChatEntry(bitstream, written.history[i % CHAT_HISTORY]);
+		return (int)count;
+	}
+
+	bool cChatRooms::NextActive(unsigned int& id_out)
+	{
+		while (!active.empty())
+		{
+			id_out = active.back();
+			active.pop_back();
+			if (room.find(id_out) != room.end())
+				return true;
+		}
+		return false;
+	}
+
+	unsigned int cChatRooms::WritePending(unsigned int const id, RakNet::BitStream& bitstream)
+	{
+		std::map<unsigned int, sChatRoom>::iterator const itr = room.find(id);
+		unsigned int count, i;
+		if (itr == room.end())
+			return 0;
+		sChatRoom& written = itr->second;
+		count = (unsigned int)written.pending.size() - written.pendingSent;
+		if (!count)
+		{
+			// capacity is kept for the next tick's posts
+			written.pending.clear();
+			written.pendingSent = 0;
+			return 0;
+		}
+		count = count < CHAT_BATCH_MAX ? (unsigned int)count : (unsigned int)CHAT_BATCH_MAX;
+		WriteChatBatch(bitstream, id, false, count);
+		for (i = 0; i < count; ++i)
+			WriteChatEntry(bitstream, written.pending[written.pendingSent + i]);
+		written.pendingSent += count;
+		return count;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Checkpoint.cpp
+	Source for memory-mapped match checkpoints.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-Checkpoint.hpp"
+
+#include <atomic>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+
+
+namespace gproNet
+{
+	// checkpoint file identification
+	static char const checkpointMagic[4] = { 'G', 'P', 'C', 'K' };
+	enum { CHECKPOINT_VERSION = 1 };
+
+	static_assert(std::is_trivially_copyable<sMatchCheckpoint>::value, "checkpoint record must be plain data");
+
+
+	cCheckpointStore::cCheckpointStore()
+		: filemap()
+	{
+	}
+
+	cCheckpointStore::~cCheckpointStore()
+	{
+		Close();
+	}
+
+	sMatchCheckpoint* cCheckpointStore::GetRecord(unsigned int const slot, unsigned int const copy) const
+	{
+		return (sMatchCheckpoint*)((char*)filemap.data + sizeof(sCheckpointHeader)) + (slot * 2 + copy);
+	}
+
+	unsigned int cCheckpointStore::Checksum(sMatchCheckpoint const& record, unsigned int const generation)
+	{
+		// FNV-1a
+		unsigned char const* data = (unsigned char const*)&record + offsetof(sMatchCheckpoint, live);
+		unsigned char const* const end = (unsigned char const*)&record + sizeof(record);
+		unsigned int hash = 2166136261u ^ generation;
+		while (data < end)
+			hash = (hash ^ *(data++)) * 16777619u;
+		return hash;
+	}
+
+	bool cCheckpointStore::IsValid(sMatchCheckpoint const& record)
+	{
+		return (record.generation != 0 && record.checksum == Checksum(record, record.generation));
+	}
+
+	bool cCheckpointStore::Open(char const path[], unsigned int const slots)
+	{
+		unsigned long long const size = sizeof(sCheckpointHeader) + (unsigned long long)slots * 2 * sizeof(sMatchCheckpoint);
+		sMatchCheckpoint record;
+		unsigned int slot, copy;
+		if (!filemap.data && slots && gpro_filemapOpen(&filemap, path, size, 0) == 0)
+		{
+			sCheckpointHeader* const header = (sCheckpointHeader*)filemap.data;
+			sCheckpointHeader const blank = { { 0 }, 0, 0, 0 };
+			if (memcmp(header, &blank, sizeof(blank)) == 0)
+			{
+				// new file, mapping is zero-filled; any other header that
+				//	does not match (e.g. version cleared) is corrupt, and is
+				//	left alone
+				memcpy(header->magic, checkpointMagic, sizeof(checkpointMagic));
+				header->slots = slots;
+				header->recordSize = sizeof(sMatchCheckpoint);
+				header->version = CHECKPOINT_VERSION;
+			}
+			if (memcmp(header->magic, checkpointMagic, sizeof(checkpointMagic)) == 0 && header->version == CHECKPOINT_VERSION &&
+				header->slots == slots && header->recordSize == sizeof(sMatchCheckpoint) && filemap.size >= size)
+			{
+				// newest complete copy of each slot; free slots taken lowest first
+				generation.assign(slots, 0);
+				freeSlot.clear();
+				for (slot = slots; slot-- > 0;)
+				{
+					for (copy = 0; copy < 2; ++copy)
+					{
+						sMatchCheckpoint const& existing = *GetRecord(slot, copy);
+						if (IsValid(existing) && (!generation[slot] || (int)(existing.generation - generation[slot]) > 0))
+							generation[slot] = existing.generation;
+					}
+					if (!Load(slot, record))
+						freeSlot.push_back(slot);
+				}
+				return true;
+			}
+			gpro_filemapClose(&filemap);
+		}
+		return false;
+	}
+
+	void cCheckpointStore::Close()
+	{
+		if (filemap.data)
+			gpro_filemapFlush(&filemap, 0, 0, 1);
+		gpro_filemapClose(&filemap);
+		generation.clear();
+		freeSlot.clear();
+	}
+
+	bool cCheckpointStore::IsOpen() const
+	{
+		return (filemap.data != 0);
+	}
+
+	unsigned int cCheckpointStore::GetSlotCount() const
+	{
+		return (unsigned int)generation.size();
+	}
+
+	int cCheckpointStore::Allocate()
+	{
+		int slot = -1;
+		if (!freeSlot.empty())
+		{
+			slot = (int)freeSlot.back();
+			freeSlot.pop_back();
+		}
+		return slot;
+	}
+
+	void cCheckpointStore::Write(unsigned int const slot, sMatchCheckpoint& record)
+	{
+		// older copy is the other parity; 0 means unwritten, so wrap past it
+		//	to the next generation of the older copy's parity
+		unsigned int const next = (generation[slot] + 1) ? (generation[slot] + 1) : 2;
+		sMatchCheckpoint* const target = GetRecord(slot, next & 1);
+		record.generation = next;
+		record.checksum = Checksum(record, next);
+
+		// a crash before the last store leaves this copy invalid and the
+		//	other one intact
+		target->generation = 0;
+		std::atomic_thread_fence(std::memory_order_release);
+		memcpy((char*)target + sizeof(record.generation), (char const*)&record + sizeof(record.generation), sizeof(record) - sizeof(record.generation));
+		std::atomic_thread_fence(std::memory_order_release);
+		target->generation = next;
+		generation[slot] = next;
+	}
+
+	bool cCheckpointStore::Save(unsigned int const slot, sMatchCheckpoint& record)
+	{
+		if (filemap.data && slot < generation.size())
+		{
+			record.live = 1;
+			Write(slot, record);
+			return true;
+		}
+		return false;
+	}
+
+	bool cCheckpointStore::Release(unsigned int const slot)
+	{
+		if (filemap.data && slot < generation.size())
+		{
+			sMatchCheckpoint record;
+			memset(&record, 0, sizeof(record));
+			Write(slot, record);
+			freeSlot.push_back(slot);
+			return true;
+		}
+		return false;
+	}
+
+	bool cCheckpointStore::Load(unsigned int const slot, sMatchCheckpoint& record_out) const
+	{
+		if (filemap.data && slot < generation.size())
+		{
+			sMatchCheckpoint const* const copy0 = GetRecord(slot, 0);
+			sMatchCheckpoint const* const copy1 = GetRecord(slot, 1);
+			bool const valid0 = IsValid(*copy0), valid1 = IsValid(*copy1);
+			sMatchCheckpoint const* const newest = (valid0 && (!valid1 || (int)(copy0->generation - copy1->generation) > 0)) ? copy0 : valid1 ? copy1 : 0;
+			if (newest && newest->live)
+			{
+				record_out = *newest;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool cCheckpointStore::Sync(bool const wait) const
+	{
+		return (filemap.data && gpro_filemapFlush(&filemap, 0, 0, wait ? 1 : 0) == 0);
+	}
+}
\ No newline at end of file
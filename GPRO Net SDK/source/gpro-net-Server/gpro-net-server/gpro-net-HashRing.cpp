@@ -0,0 +1,128 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-HashRing.cpp
+	Source for consistent hashing of keys onto shards.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-HashRing.hpp"
+
+#include <algorithm>
+
+
+namespace gproNet
+{
+	// ring order; ties (rare) broken by shard so order is the same everywhere
+	static bool HashRingPointLess(sHashRingPoint const& lh, sHashRingPoint const& rh)
+	{
+		return (lh.hash < rh.hash) || (lh.hash == rh.hash && lh.shard < rh.shard);
+	}
+
+	// first point at or after hash
+	static bool HashRingPointBelow(sHashRingPoint const& lh, unsigned int const hash)
+	{
+		return (lh.hash < hash);
+	}
+
+
+	cHashRing::cHashRing()
+		: shards(0)
+	{
+	}
+
+	bool cHashRing::Add(unsigned int const shard)
+	{
+		unsigned int i;
+		if (shard == HASH_RING_NONE || Contains(shard))
+			return false;
+		for (i = 0; i < HASH_RING_POINTS; ++i)
+		{
+			sHashRingPoint const p = { Hash(Hash(shard) ^ (i * 0x9e3779b9u)), shard };
+			point.insert(std::upper_bound(point.begin(), point.end(), p, HashRingPointLess), p);
+		}
+		++shards;
+		return true;
+	}
+
+	bool cHashRing::Remove(unsigned int const shard)
+	{
+		size_t i, j;
+		for (i = j = 0; i < point.size(); ++i)
+			if (point[i].shard != shard)
+				point[j++] = point[i];
+		if (j == point.size())
+			return false;
+		point.resize(j);
+		--shards;
+		return true;
+	}
+
+	bool cHashRing::Contains(unsigned int const shard) const
+	{
+		size_t i;
+		for (i = 0; i < point.size(); ++i)
+			if (point[i].shard == shard)
+				return true;
+		return false;
+	}
+
+	unsigned int cHashRing::GetCount() const
+	{
+		return shards;
+	}
+
+	unsigned int cHashRing::Find(unsigned int const key) const
+	{
+		std::vector<sHashRingPoint>::const_iterator itr;
+		if (point.empty())
+			return HASH_RING_NONE;
+		itr = std::lower_bound(point.begin(), point.end(), Hash(key), HashRingPointBelow);
+		return (itr != point.end() ? itr : point.begin())->shard;
+	}
+
+	unsigned int cHashRing::GetPreference(unsigned int const key, unsigned int shard_out[], unsigned int const max) const
+	{
+		size_t i, start, n;
+		unsigned int count = 0, j;
+		if (point.empty())
+			return 0;
+		start = std::lower_bound(point.begin(), point.end(), Hash(key), HashRingPointBelow) - point.begin();
+		for (n = 0; n < point.size() && count < max && count < shards; ++n)
+		{
+			i = (start + n) % point.size();
+			for (j = 0; j < count && shard_out[j] != point[i].shard; ++j);
+			if (j == count)
+				shard_out[count++] = point[i].shard;
+		}
+		return count;
+	}
+
+	unsigned int cHashRing::Hash(unsigned int const value)
+	{
+		// murmur3 finalizer: every input bit affects every output bit
+		unsigned int hash = value;
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6bu;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35u;
+		hash ^= hash >> 16;
+		return hash;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,213 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-History.cpp
+	Source for pose history and lag compensation.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-History.hpp"
+
+#include <math.h>
+
+
+namespace gproNet
+{
+	// blend angles the short way around
+	inline float HistoryBlendAngle(float const a0, float const a1, float const blend)
+	{
+		float delta = a1 - a0;
+		if (delta > 3.14159265f)
+			delta -= 6.28318531f;
+		else if (delta < -3.14159265f)
+			delta += 6.28318531f;
+		return a0 + delta * blend;
+	}
+
+
+	cPoseHistory::cPoseHistory(unsigned int const entities, unsigned int const frames)
+		: pose((size_t)entities * frames), poseTick((size_t)entities * frames, ~0u), tickFirst(entities, 0)
+		, frameTick(frames, ~0u), frameTime(frames, 0)
+		, frames(frames), entities(entities), tickLatest(0), idEnd(0), recorded(false)
+	{
+	}
+
+	void cPoseHistory::Record(unsigned int const tick, RakNet::Time const time, cEntityStore const& store)
+	{
+		unsigned int const frame = tick % frames;
+		unsigned int const count = store.GetCount();
+		float const* const component[ENTITY_FIELD_COUNT][3] = {
+			{ store.GetComponent(ENTITY_FIELD_SCALE, 0), store.GetComponent(ENTITY_FIELD_SCALE, 1), store.GetComponent(ENTITY_FIELD_SCALE, 2) },
+			{ store.GetComponent(ENTITY_FIELD_ROTATE, 0), store.GetComponent(ENTITY_FIELD_ROTATE, 1), store.GetComponent(ENTITY_FIELD_ROTATE, 2) },
+			{ store.GetComponent(ENTITY_FIELD_TRANSLATE, 0), store.GetComponent(ENTITY_FIELD_TRANSLATE, 1), store.GetComponent(ENTITY_FIELD_TRANSLATE, 2) },
+		};
+		unsigned int slot, id, axis;
+
+		frameTick[frame] = tick;
+		frameTime[frame] = time;
+		tickLatest = tick;
+		recorded = true;
+		for (slot = 0; slot < count; ++slot)
+		{
+			// identifiers past capacity are not tracked (never hit)
+			id = store.GetID(slot);
+			if (id < entities)
+			{
+				sSpatialPose& entry = pose[(size_t)id * frames + frame];
+				for (axis = 0; axis < 3; ++axis)
+				{
+					entry.scale[axis] = component[ENTITY_FIELD_SCALE][axis][slot];
+					entry.rotate[axis] = component[ENTITY_FIELD_ROTATE][axis][slot];
+					entry.translate[axis] = component[ENTITY_FIELD_TRANSLATE][axis][slot];
+				}
+				poseTick[(size_t)id * frames + frame] = tick;
+				idEnd = id >= idEnd ? id + 1 : idEnd;
+			}
+		}
+	}
+
+	bool cPoseHistory::FindFrames(RakNet::Time const time, unsigned int& tick0_out, unsigned int& tick1_out, float& blend_out) const
+	{
+		unsigned int tick, frame, next;
+		if (!recorded)
+			return false;
+
+		// walk back from newest until a frame at or before time
+		tick1_out = tick0_out = tickLatest;
+		blend_out = 0.0f;
+		for (tick = tickLatest; tickLatest - tick < frames; --tick)
+		{
+			frame = tick % frames;
+			if (frameTick[frame] != tick)
+				break;
+			if (frameTime[frame] <= time)
+			{
+				tick0_out = tick;
+				if (tick != tickLatest)
+				{
+					next = (tick + 1) % frames;
+					tick1_out = tick + 1;
+					if (frameTime[next] > frameTime[frame])
+						blend_out = (float)(time - frameTime[frame]) / (float)(frameTime[next] - frameTime[frame]);
+				}
+				else
+					tick1_out = tick;
+				return true;
+			}
+
+			// older than history: clamp to oldest
+			tick1_out = tick0_out = tick;
+			if (!tick)
+				break;
+		}
+		return true;
+	}
+
+	bool cPoseHistory::SampleFrames(unsigned int const id, unsigned int const tick0, unsigned int const tick1, float const blend, sSpatialPose& pose_out) const
+	{
+		size_t const base = (size_t)id * frames;
+		bool const has0 = (id < entities && poseTick[base + tick0 % frames] == tick0 && tick0 >= tickFirst[id]);
+		bool const has1 = (id < entities && poseTick[base + tick1 % frames] == tick1 && tick1 >= tickFirst[id]);
+		unsigned int axis;
+
+		if (has0 && has1)
+		{
+			sSpatialPose const& p0 = pose[base + tick0 % frames];
+			sSpatialPose const& p1 = pose[base + tick1 % frames];
+			for (axis = 0; axis < 3; ++axis)
+			{
+				pose_out.scale[axis] = p0.scale[axis] + (p1.scale[axis] - p0.scale[axis]) * blend;
+				pose_out.rotate[axis] = HistoryBlendAngle(p0.rotate[axis], p1.rotate[axis], blend);
+				pose_out.translate[axis] = p0.translate[axis] + (p1.translate[axis] - p0.translate[axis]) * blend;
+			}
+			return true;
+		}
+		if (has0 || has1)
+		{
+			pose_out = pose[base + (has0 ? tick0 : tick1) % frames];
+			return true;
+		}
+		return false;
+	}
+
+	void cPoseHistory::Forget(unsigned int const id)
+	{
+		// poses up to latest tick are from old entity; next tick is new
+		if (id < entities)
+			tickFirst[id] = tickLatest + 1;
+	}
+
+	bool cPoseHistory::Sample(unsigned int const id, RakNet::Time const time, sSpatialPose& pose_out) const
+	{
+		unsigned int tick0, tick1;
+		float blend;
+		return FindFrames(time, tick0, tick1, blend) && SampleFrames(id, tick0, tick1, blend, pose_out);
+	}
+
+	unsigned int cPoseHistory::Raycast(float const origin[3], float const direction[3], float const maxDistance, RakNet::Time const time, unsigned int const ignoreID, float& distance_out) const
+	{
+		unsigned int tick0, tick1, id, hit = (unsigned int)ENTITY_INVALID;
+		float blend, offset[3], along, miss, radius, depth;
+		sSpatialPose target;
+
+		distance_out = maxDistance;
+		if (!FindFrames(time, tick0, tick1, blend))
+			return hit;
+		for (id = 0; id < idEnd; ++id)
+		{
+			if (id == ignoreID || !SampleFrames(id, tick0, tick1, blend, target))
+				continue;
+
+			// ray against sphere around rewound entity
+			offset[0] = target.translate[0] - origin[0];
+			offset[1] = target.translate[1] - origin[1];
+			offset[2] = target.translate[2] - origin[2];
+			along = offset[0] * direction[0] + offset[1] * direction[1] + offset[2] * direction[2];
+			radius = fabsf(target.scale[0]) > fabsf(target.scale[1]) ? fabsf(target.scale[0]) : fabsf(target.scale[1]);
+			radius = fabsf(target.scale[2]) > radius ? fabsf(target.scale[2]) : radius;
+			miss = offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2] - along * along;
+			if (along <= 0.0f || miss > radius * radius)
+				continue;
+			depth = along - sqrtf(radius * radius - miss);
+			if (depth < distance_out)
+			{
+				distance_out = depth;
+				hit = id;
+			}
+		}
+		return hit;
+	}
+
+	unsigned long long cPoseHistory::GetMemoryUsage() const
+	{
+		return (unsigned long long)pose.capacity() * sizeof(sSpatialPose) +
+			(unsigned long long)poseTick.capacity() * sizeof(unsigned int) +
+			(unsigned long long)tickFirst.capacity() * sizeof(unsigned int) +
+			(unsigned long long)frameTick.capacity() * sizeof(unsigned int) +
+			(unsigned long long)frameTime.capacity() * sizeof(RakNet::Time);
+	}
+
+	void cPoseHistory::GetForward(sSpatialPose const& pose, float direction_out[3])
+	{
+		float const pitch = pose.rotate[0], yaw = pose.rotate[1];
+		direction_out[0] = sinf(yaw) * cosf(pitch);
+		direction_out[1] = -sinf(pitch);
+		direction_out[2] = cosf(yaw) * cosf(pitch);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,344 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Jobs.cpp
+	Source for work-stealing job system.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-Jobs.hpp"
+
+#include <assert.h>
+
+
+namespace gproNet
+{
+	// worker of calling thread, if it is a worker thread
+	static thread_local sJobWorker* jobWorkerLocal = 0;
+
+
+	cJobSystem::cJobSystem(unsigned int threads)
+		: owner(std::this_thread::get_id()), queued(0), sleeping(0), waiting(0), running(true)
+	{
+		sJobWorker* self;
+		unsigned int i, j;
+
+		if (!threads)
+			threads = std::thread::hardware_concurrency();
+		if (!threads)
+			threads = 1;
+		for (i = 0; i < threads; ++i)
+		{
+			self = new sJobWorker;
+			self->system = this;
+			self->ring = new sJob[JOB_RING_SIZE];
+			for (j = 0; j < JOB_RING_SIZE; ++j)
+			{
+				self->ring[j].unfinished.store(0, std::memory_order_relaxed);
+				self->ring[j].generation.store(0, std::memory_order_relaxed);
+			}
+			self->ringNext = 0;
+			self->deque.resize(JOB_RING_SIZE);
+			self->head = self->tail = 0;
+			self->victim = (i + 1) % threads;
+			worker.push_back(self);
+		}
+		for (i = 1; i < threads; ++i)
+			thread.push_back(std::thread(&cJobSystem::Work, this, i));
+	}
+
+	cJobSystem::~cJobSystem()
+	{
+		unsigned int i, j;
+		{
+			std::lock_guard<std::mutex> guard(sleepLock);
+			running = false;
+			wake.notify_all();
+		}
+		for (i = 0; i < thread.size(); ++i)
+			thread[i].join();
+		for (i = 0; i < worker.size(); ++i)
+		{
+			for (j = 0; j < worker[i]->spare.size(); ++j)
+				delete worker[i]->spare[j];
+			delete[] worker[i]->ring;
+			delete worker[i];
+		}
+	}
+
+	sJobWorker& cJobSystem::GetWorker()
+	{
+		if (jobWorkerLocal && jobWorkerLocal->system == this)
+			return *jobWorkerLocal;
+
+		// ring and deque of constructing thread are not shared
+		assert(std::this_thread::get_id() == owner);
+		return *worker[0];
+	}
+
+	void cJobSystem::Push(sJob* const job)
+	{
+		sJobWorker& self = GetWorker();
+		bool full;
+
+		// counted first, so idle threads never miss a queued job
+		++queued;
+		{
+			std::lock_guard<std::mutex> guard(self.lock);
+			full = (self.tail - self.head == JOB_RING_SIZE);
+			if (!full)
+				self.deque[self.tail++ & (JOB_RING_SIZE - 1)] = job;
+		}
+		if (full)
+		{
+			--queued;
+			Execute(job);
+			return;
+		}
+		if (sleeping || waiting)
+		{
+			std::lock_guard<std::mutex> guard(sleepLock);
+			wake.notify_one();
+		}
+	}
+
+	sJob* cJobSystem::Take(sJobWorker& self)
+	{
+		unsigned int const count = (unsigned int)worker.size();
+		unsigned int i, index;
+		sJob* job = 0;
+
+		if (!queued)
+			return 0;
+
+		// newest own job is likely still in cache
+		{
+			std::lock_guard<std::mutex> guard(self.lock);
+			if (self.tail != self.head)
+				job = self.deque[--self.tail & (JOB_RING_SIZE - 1)];
+		}
+
+		// oldest job of another thread is likely the largest
+		for (i = 0; !job && i < count; ++i)
+		{
+			index = (self.victim + i) % count;
+			sJobWorker& other = *worker[index];
+			if (&other == &self)
+				continue;
+			std::lock_guard<std::mutex> guard(other.lock);
+			if (other.tail != other.head)
+			{
+				job = other.deque[other.head++ & (JOB_RING_SIZE - 1)];
+				self.victim = index;
+			}
+		}
+		if (job)
+			--queued;
+		return job;
+	}
+
+	void cJobSystem::Execute(sJob* const job)
+	{
+		if (job->range)
+			Split(job);
+		else if (job->func)
+			job->func(job->data);
+		Finish(job);
+	}
+
+	void cJobSystem::Finish(sJob* job)
+	{
+		sJob* dependent[JOB_DEPENDENTS];
+		sJob* parent;
+		unsigned int dependents, i;
+
+		while (job)
+		{
+			// job may be reused once done, so read links first
+			parent = job->parent;
+			dependents = job->dependents;
+			for (i = 0; i < dependents; ++i)
+				dependent[i] = job->dependent[i];
+			// ordered with waiting: a thread about to sleep in Wait either
+			//	sees the job done or is counted here and woken
+			if (job->unfinished.fetch_sub(1, std::memory_order_seq_cst) != 1)
+				return;
+			if (waiting.load(std::memory_order_seq_cst))
+			{
+				std::lock_guard<std::mutex> guard(sleepLock);
+				wake.notify_all();
+			}
+			for (i = 0; i < dependents; ++i)
+				if (dependent[i]->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					Push(dependent[i]);
+			job = parent;
+		}
+	}
+
+	void cJobSystem::Split(sJob* const job)
+	{
+		sJob* child;
+		unsigned int mid;
+		while (job->end - job->begin > job->grain)
+		{
+			mid = job->begin + (job->end - job->begin) / 2;
+			child = Make(0, job->data, job);
+			child->range = job->range;
+			child->begin = mid;
+			child->end = job->end;
+			child->grain = job->grain;
+			job->end = mid;
+			if (child->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				Push(child);
+		}
+		if (job->begin < job->end)
+			job->range(job->data, job->begin, job->end);
+	}
+
+	void cJobSystem::Work(unsigned int const index)
+	{
+		sJobWorker& self = *worker[index];
+		sJob* job;
+
+		jobWorkerLocal = &self;
+		while (running)
+		{
+			if ((job = Take(self)) != 0)
+			{
+				Execute(job);
+				continue;
+			}
+			std::unique_lock<std::mutex> guard(sleepLock);
+			++sleeping;
+			while (running && !queued)
+				wake.wait(guard);
+			--sleeping;
+		}
+	}
+
+	sJob* cJobSystem::Make(fJob const func, void* const data, sJob* const parent)
+	{
+		sJobWorker& self = GetWorker();
+		sJob* job = &self.ring[self.ringNext & (JOB_RING_SIZE - 1)];
+		unsigned int i;
+
+		// oldest ring slot may still be in flight: never overwrite it
+		if (!job->unfinished.load(std::memory_order_acquire))
+			++self.ringNext;
+		else
+		{
+			for (i = 0, job = 0; !job && i < self.spare.size(); ++i)
+				if (!self.spare[i]->unfinished.load(std::memory_order_acquire))
+					job = self.spare[i];
+			if (!job)
+			{
+				job = new sJob;
+				job->generation.store(0, std::memory_order_relaxed);
+				self.spare.push_back(job);
+			}
+		}
+
+		// new generation before the job reads as unfinished again, so old
+		//	handles to this storage stay finished
+		job->generation.fetch_add(1, std::memory_order_release);
+		job->func = func;
+		job->range = 0;
+		job->data = data;
+		job->begin = job->end = job->grain = 0;
+		job->parent = parent;
+		job->unfinished.store(1, std::memory_order_relaxed);
+		job->blockers.store(1, std::memory_order_relaxed);
+		job->dependents = 0;
+		if (parent)
+			parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+		return job;
+	}
+
+	sJobHandle cJobSystem::Create(fJob const func, void* const data, sJobHandle const parent)
+	{
+		sJob* const job = Make(func, data, parent.job);
+		sJobHandle const handle = { job, job->generation.load(std::memory_order_relaxed) };
+		return handle;
+	}
+
+	sJobHandle cJobSystem::CreateParallelFor(fJobRange const func, void* const data, unsigned int const count, unsigned int const grain, sJobHandle const parent)
+	{
+		sJobHandle const handle = Create(0, data, parent);
+		handle.job->range = func;
+		handle.job->end = count;
+		handle.job->grain = grain ? grain : 1;
+		return handle;
+	}
+
+	bool cJobSystem::AddDependency(sJobHandle const job, sJobHandle const prerequisite)
+	{
+		if (prerequisite.job->dependents >= JOB_DEPENDENTS)
+			return false;
+		prerequisite.job->dependent[prerequisite.job->dependents++] = job.job;
+		++job.job->blockers;
+		return true;
+	}
+
+	void cJobSystem::Run(sJobHandle const job)
+	{
+		if (job.job->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			Push(job.job);
+	}
+
+	bool cJobSystem::IsFinished(sJobHandle const job)
+	{
+		// storage given to a later job means this one finished long ago
+		return (job.job->generation.load(std::memory_order_acquire) != job.generation ||
+			!job.job->unfinished.load(std::memory_order_seq_cst));
+	}
+
+	void cJobSystem::Wait(sJobHandle const job)
+	{
+		sJobWorker& self = GetWorker();
+		sJob* next;
+		while (!IsFinished(job))
+		{
+			if ((next = Take(self)) != 0)
+			{
+				Execute(next);
+				continue;
+			}
+
+			// rest of job runs elsewhere: sleep until a job is queued for
+			//	this thread to help with, or this one finishes
+			std::unique_lock<std::mutex> guard(sleepLock);
+			waiting.fetch_add(1, std::memory_order_seq_cst);
+			while (!queued && !IsFinished(job))
+				wake.wait(guard);
+			--waiting;
+		}
+	}
+
+	void cJobSystem::ParallelFor(fJobRange const func, void* const data, unsigned int const count, unsigned int const grain)
+	{
+		sJobHandle const job = CreateParallelFor(func, data, count, grain);
+		Run(job);
+		Wait(job);
+	}
+
+	unsigned int cJobSystem::GetThreadCount() const
+	{
+		return (unsigned int)worker.size();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-RakNet-Relay.cpp
+	Source for spectator relay.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-RakNet-Relay.hpp"
+
+
+namespace gproNet
+{
+	cRakNetRelay::cRakNetRelay(char const host[], unsigned short const hostPort, unsigned short const port, unsigned short const maxSpectators, RakNet::Time const delay)
+		: cRakNetRelay((cTransport*)0, host, hostPort, port, maxSpectators, delay)
+	{
+	}
+
+	cRakNetRelay::cRakNetRelay(cTransport* const transport, char const host[], unsigned short const hostPort, unsigned short const port, unsigned short const maxSpectators, RakNet::Time const delay)
+		: cRakNetManager(transport), upstream(RakNet::UNASSIGNED_SYSTEM_ADDRESS), delay(delay), spectators(0)
+	{
+		peer->Startup(maxSpectators + 1, maxSpectators, port);
+		peer->Connect(host, hostPort);
+	}
+
+	cRakNetRelay::~cRakNetRelay()
+	{
+		peer->Shutdown();
+	}
+
+	unsigned int cRakNetRelay::Update()
+	{
+		RakNet::Time const now = RakNet::GetTime();
+		unsigned int count = 0;
+		while (!queue.empty() && queue.front().tRelease <= now)
+		{
+			// forward to everyone but upstream in one broadcast
+			sRelayMessage const& relayed = queue.front();
+			Apply(relayed);
+			if (spectators)
+				SendToAll(relayed.message, &upstream, 1);
+			queue.pop_front();
+			++count;
+		}
+		return count;
+	}
+
+	void cRakNetRelay::SetDelay(RakNet::Time const delay)
+	{
+		this->delay = delay;
+	}
+
+	bool cRakNetRelay::IsSubscribed() const
+	{
+		return (upstream != RakNet::UNASSIGNED_SYSTEM_ADDRESS);
+	}
+
+	unsigned int cRakNetRelay::GetSpectatorCount() const
+	{
+		return spectators;
+	}
+
+	cEntityStore const& cRakNetRelay::GetEntities() const
+	{
+		return entities;
+	}
+
+	void cRakNetRelay::Apply(sRelayMessage const& relayed)
+	{
+		unsigned int const header = PeekHeaderBytes(relayed.message.GetData(), relayed.message.GetLength());
+		RakNet::BitStream bitstream((unsigned char*)relayed.message.GetData(), relayed.message.GetLength(), false);
+		bitstream.IgnoreBytes(header);
+		if (relayed.msgID == ID_GPRO_MESSAGE_ENTITY_UPDATE)
+			entities.ReadDirty(bitstream);
+		else if (relayed.msgID == ID_GPRO_MESSAGE_ENTITY_DESTROY)
+			entities.ReadDestroyed(bitstream);
+	}
+
+	bool cRakNetRelay::ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID)
+	{
+		if (cRakNetManager::ProcessMessage(bitstream, sender, dtSendToReceive, msgID))
+			return true;
+
+		// relay-specific messages
+		switch (msgID)
+		{
+		case ID_CONNECTION_REQUEST_ACCEPTED:
+		{
+			// subscribe to upstream as spectator
+			cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES);
+			upstream = sender;
+			WriteTimestamp(*bitstream_w);
+			bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_SPECTATE);
+			Send(*bitstream_w, upstream, false);
+		}	return true;
+		case ID_NEW_INCOMING_CONNECTION:
+		{
+			// new spectator starts from the delayed snapshot
+			++spectators;
+			if (entities.GetCount())
+			{
+				cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + cEntityStore::GetUpdateMaxBytes(entities.GetCount()));
+				WriteTimestamp(*bitstream_w);
+				bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_ENTITY_UPDATE);
+				entities.WriteAll(*bitstream_w);
+				Send(*bitstream_w, sender, false);
+			}
+		}	return true;
+		case ID_DISCONNECTION_NOTIFICATION:
+		case ID_CONNECTION_LOST:
+			if (sender == upstream)
+			{
+				// nothing more is coming; what is queued still goes out
+				upstream = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+			}
+			else if (spectators)
+				--spectators;
+			return true;
+		case ID_GPRO_MESSAGE_SPECTATE:
+			// downstream peers only ever watch
+			return true;
+
+			// match state from upstream, held for delay
+		case ID_GPRO_MESSAGE_ENTITY_UPDATE:
+		case ID_GPRO_MESSAGE_ENTITY_DESTROY:
+		case ID_GPRO_MESSAGE_CHAT:
+			if (sender == upstream)
+			{
+				// stamped as sent at release on this clock, so spectators
+				//	read the last hop only, however long the delay
+				sRelayMessage relayed;
+				relayed.tRelease = RakNet::GetTime() + delay;
+				relayed.msgID = msgID;
+				Restamp(bitstream.GetData(), bitstream.GetNumberOfBytesUsed(), relayed.tRelease);
+				relayed.message = cSharedMessage(bitstream.GetData(), bitstream.GetNumberOfBytesUsed());
+				queue.push_back(relayed);
+			}
+			return true;
+		}
+		return false;
+	}
+}
\ No newline at end of file
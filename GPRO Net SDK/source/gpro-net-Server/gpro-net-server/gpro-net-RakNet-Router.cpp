@@ -0,0 +1,205 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-RakNet-Router.cpp
+	Source for match router in front of sharded servers.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-RakNet-Router.hpp"
+
+#include <math.h>
+
+
+namespace gproNet
+{
+	cRakNetRouter::cRakNetRouter(unsigned short const port, unsigned short const maxConnections)
+		: cRakNetRouter((cTransport*)0, port, maxConnections)
+	{
+	}
+
+	cRakNetRouter::cRakNetRouter(cTransport* const transport, unsigned short const port, unsigned short const maxConnections)
+		: cRakNetManager(transport), loadFactor(1.25f)
+	{
+		peer->Startup(maxConnections, maxConnections, port);
+	}
+
+	cRakNetRouter::~cRakNetRouter()
+	{
+		peer->Shutdown();
+	}
+
+	unsigned short cRakNetRouter::Route(unsigned int const key)
+	{
+		RakNet::Time const now = RakNet::GetTime();
+		std::map<unsigned int, sRouterMatch>::iterator itr;
+		std::map<unsigned short, sRouterShard>::iterator shard;
+		sRouterShard* choice = 0, * fallback = 0;
+		unsigned int preference[ROUTER_SHARDS];
+		unsigned int count, i, load, bound, total = 0;
+
+		// forget matches whose other players never came
+		for (itr = matches.begin(); itr != matches.end();)
+		{
+			if (itr->second.tExpire <= now)
+				itr = matches.erase(itr);
+			else
+				++itr;
+		}
+
+		// later players of a match follow the first
+		itr = matches.find(key);
+		if (itr != matches.end())
+		{
+			unsigned short const port = itr->second.port;
+			++shards[port].pending;
+			if (++itr->second.routed >= ROUTER_MATCH_PLAYERS)
+				matches.erase(itr);
+			return port;
+		}
+		if (shards.empty())
+			return 0;
+
+		// first shard in ring order under the load bound, which counts this
+		//	player; if all are over it, the first that is not full
+		for (shard = shards.begin(); shard != shards.end(); ++shard)
+			total += shard->second.load + shard->second.pending;
+		bound = (unsigned int)ceilf(loadFactor * (float)(total + 1) / (float)shards.size());
+		count = ring.GetPreference(key, preference, ROUTER_SHARDS);
+		for (i = 0; i < count && !choice; ++i)
+		{
+			sRouterShard& candidate = shards[(unsigned short)preference[i]];
+			load = candidate.load + candidate.pending;
+			if (load < candidate.capacity)
+			{
+				if (load < bound)
+					choice = &candidate;
+				else if (!fallback)
+					fallback = &candidate;
+			}
+		}
+		if (!choice && !(choice = fallback))
+			return 0;
+
+		// remembered for the other players
+		sRouterMatch& match = matches[key];
+		match.port = choice->port;
+		match.routed = 1;
+		match.tExpire = now + ROUTER_MATCH_TIMEOUT;
+		++choice->pending;
+		return choice->port;
+	}
+
+	void cRakNetRouter::SetLoadFactor(float const loadFactor)
+	{
+		this->loadFactor = loadFactor > 1.0f ? loadFactor : 1.0f;
+	}
+
+	unsigned int cRakNetRouter::GetShardCount() const
+	{
+		return (unsigned int)shards.size();
+	}
+
+	sRouterShard const* cRakNetRouter::GetShard(unsigned short const port) const
+	{
+		std::map<unsigned short, sRouterShard>::const_iterator const itr = shards.find(port);
+		return (itr != shards.end() ? &itr->second : 0);
+	}
+
+	bool cRakNetRouter::RemoveShard(RakNet::SystemAddress const address)
+	{
+		std::map<unsigned short, sRouterShard>::iterator shard;
+		std::map<unsigned int, sRouterMatch>::iterator itr;
+		for (shard = shards.begin(); shard != shards.end(); ++shard)
+			if (shard->second.address == address)
+			{
+				// matches waiting on it start over wherever the ring says
+				for (itr = matches.begin(); itr != matches.end();)
+				{
+					if (itr->second.port == shard->first)
+						itr = matches.erase(itr);
+					else
+						++itr;
+				}
+				ring.Remove(shard->first);
+				shards.erase(shard);
+				return true;
+			}
+		return false;
+	}
+
+	bool cRakNetRouter::ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID)
+	{
+		if (cRakNetManager::ProcessMessage(bitstream, sender, dtSendToReceive, msgID))
+			return true;
+
+		// router-specific messages
+		switch (msgID)
+		{
+		case ID_NEW_INCOMING_CONNECTION:
+			//printf("A shard or client is incoming.\n");
+			return true;
+		case ID_NO_FREE_INCOMING_CONNECTIONS:
+			//printf("The router is full.\n");
+			return true;
+		case ID_DISCONNECTION_NOTIFICATION:
+		case ID_CONNECTION_LOST:
+			// clients leave once routed; only shards need forgetting
+			RemoveShard(sender);
+			return true;
+
+			// shard reporting in; first report adds it to the ring
+		case ID_GPRO_MESSAGE_SHARD_LOAD:
+		{
+			unsigned short port, load, capacity;
+			if (!bitstream.Read(port) || !bitstream.Read(load) || !bitstream.Read(capacity) || !port)
+				return false;
+			sRouterShard& shard = shards[port];
+			if (ring.Add(port))
+				shard.port = port;
+			shard.address = sender;
+			shard.load = load;
+			shard.capacity = capacity;
+			shard.pending = 0;
+		}	return true;
+
+			// client asking where to play
+		case ID_GPRO_MESSAGE_ROUTE:
+		{
+			cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + sizeof(unsigned short));
+			unsigned int key;
+			if (!bitstream.Read(key))
+				return false;
+			WriteTimestamp(*bitstream_w);
+			bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_ROUTE);
+			bitstream_w->Write(Route(key));
+			Send(*bitstream_w, sender, false);
+		}	return true;
+
+			// test message
+		case ID_GPRO_MESSAGE_COMMON_BEGIN:
+		{
+			// router receives greeting, client moves on before any reply
+			ReadTest(bitstream);
+		}	return true;
+
+		}
+		return false;
+	}
+}
\ No newline at end of file
@@ -24,21 +24,688 @@
 
 #include "gpro-net/gpro-net-server/gpro-net-RakNet-Server.hpp"
 
+#include <math.h>
+
 
 namespace gproNet
 {
-	cRakNetServer::cRakNetServer()
+	cRakNetServer::cRakNetServer(unsigned short const port, unsigned short const maxClients)
+		: cRakNetServer((cTransport*)0, port, maxClients)
+	{
+	}
+
+	cRakNetServer::cRakNetServer(cTransport* const transport, unsigned short const port, unsigned short const maxClients)
+		: cRakNetManager(transport), tick(0), interpolationDelay(100), jobs(0), chatRoomNext(CHAT_ROOM_GLOBAL + 1)
+		, port(port), maxClients(maxClients), router(RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+		, tokenSource(std::random_device()()), resumeGrace(SERVER_RESUME_GRACE)
 	{
-		RakNet::SocketDescriptor sd(SET_GPRO_SERVER_PORT, 0);
-		unsigned short MAX_CLIENTS = 10;
+		RakNet::BitStream bitstream_w(MESSAGE_HEADER_BYTES + sTestMessageSchema::maxBytes);
+		unsigned int i;
 
-		peer->Startup(MAX_CLIENTS, &sd, 1);
-		peer->SetMaximumIncomingConnections(MAX_CLIENTS);
+		for (i = 0; i < LOCKSTEP_GAME_COUNT; ++i)
+			lobby[i] = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+		chat.Open(CHAT_ROOM_GLOBAL);
+		greeting = cSharedMessage(WriteTest(bitstream_w, "Hello client from server", false));
+		peer->Startup(maxClients + 1, maxClients, port);
 	}
 
 	cRakNetServer::~cRakNetServer()
 	{
-		peer->Shutdown(0);
+		peer->Shutdown();
+	}
+
+	cEntityStore& cRakNetServer::GetEntities()
+	{
+		return entities;
+	}
+
+	unsigned int cRakNetServer::ReplicateEntities()
+	{
+		std::map<RakNet::SystemAddress, sClientReplica>::iterator itr;
+		sJobHandle job = sJobHandle();
+		unsigned int count, i, id;
+
+		// destroyed go to every client (not router) now, before any update
+		//	could reuse them
+		if (entities.GetDestroyedCount())
+		{
+			cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + cEntityStore::GetDestroyedMaxBytes(entities.GetDestroyedCount()));
+			WriteTimestamp(*bitstream_w);
+			bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_ENTITY_DESTROY);
+			entities.WriteDestroyed(*bitstream_w);
+			Send(*bitstream_w, router, true);
+		}
+
+		dirtyID.clear();
+		dirtyMask.clear();
+		count = entities.CollectDirty(dirtyID, dirtyMask);
+		fullRate.clear();
+		for (itr = replicas.begin(); itr != replicas.end(); ++itr)
+		{
+			sClientReplica& replica = itr->second;
+			sRateLevel const& level = cRateController::GetLevel(replica.rate.level);
+			bool const due = (tick - replica.tickSent >= level.interval);
+
+			// full-rate clients with nothing held share one update, if it
+			//	fits their budget
+			if (due && replica.pendingID.empty() && level.precision == ENTITY_PRECISION_FULL &&
+				cEntityStore::GetUpdateMaxBytes(count) <= level.budget)
+			{
+				if (count)
+					fullRate.push_back(itr->first);
+				replica.tickSent = tick;
+				continue;
+			}
+
+			// hold changes until client is due
+			for (i = 0; i < count; ++i)
+			{
+				id = dirtyID[i];
+				if (id >= replica.pendingMask.size())
+					replica.pendingMask.resize(id + 1, 0);
+				if (!replica.pendingMask[id])
+					replica.pendingID.push_back(id);
+				replica.pendingMask[id] |= dirtyMask[i];
+			}
+			if (due)
+			{
+				if (!replica.pendingID.empty())
+					encoding.push_back(&*itr);
+				replica.tickSent = tick;
+			}
+		}
+
+		// fork: encode each due client's snapshot on the job system while
+		//	the shared update is written here
+		if (jobs && encoding.size() > 1)
+		{
+			job = jobs->CreateParallelFor(EncodeReplicas, this, (unsigned int)encoding.size(), 1);
+			jobs->Run(job);
+		}
+		else
+			EncodeReplicas(this, 0, (unsigned int)encoding.size());
+		if (!fullRate.empty())
+		{
+			cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + cEntityStore::GetUpdateMaxBytes(count));
+			WriteTimestamp(*bitstream_w);
+			bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_ENTITY_UPDATE);
+			entities.WriteMasked(*bitstream_w, dirtyID.data(), dirtyMask.data(), count, ENTITY_PRECISION_FULL);
+			SendToList(*bitstream_w, fullRate.data(), (unsigned int)fullRate.size());
+		}
+
+		// join, then send from tick thread
+		if (job.job)
+			jobs->Wait(job);
+		for (i = 0; i < encoding.size(); ++i)
+			if (!encoding[i]->second.selected.empty())
+				Send(*encoding[i]->second.encoded, encoding[i]->first, false);
+		encoding.clear();
+		return count;
+	}
+
+	void cRakNetServer::EncodeReplicas(void* const data, unsigned int const begin, unsigned int const end)
+	{
+		cRakNetServer* const server = (cRakNetServer*)data;
+		std::map<RakNet::SystemAddress, unsigned int>::const_iterator player;
+		sSpatialPose interest, pose;
+		unsigned int i, j, k, id, count, objects, selected;
+		float dx, dy, dz;
+		for (i = begin; i < end; ++i)
+		{
+			sClientReplica& replica = server->encoding[i]->second;
+			sRateLevel const& level = cRateController::GetLevel(replica.rate.level);
+			bool const located = (player = server->players.find(server->encoding[i]->first)) != server->players.end() &&
+				server->entities.GetPose(player->second, interest);
+			count = (unsigned int)replica.pendingID.size();
+
+			// grow per-identifier tables to cover held identifiers
+			objects = replica.scheduler.GetObjectCount();
+			for (j = 0; j < count; ++j)
+				if (replica.pendingID[j] >= objects)
+					objects = replica.pendingID[j] + 1;
+			if (objects > replica.scheduler.GetObjectCount())
+			{
+				replica.scheduler.SetObjectCount(objects);
+				replica.size.resize(objects);
+			}
+
+			// held entities gain priority each snapshot they wait, more the
+			//	closer they are to client's own; destroyed ones cost nothing
+			//	and are dropped by the encoder
+			for (j = 0; j < count; ++j)
+			{
+				id = replica.pendingID[j];
+				if (server->entities.GetPose(id, pose))
+				{
+					dx = located ? pose.translate[0] - interest.translate[0] : 0.0f;
+					dy = located ? pose.translate[1] - interest.translate[1] : 0.0f;
+					dz = located ? pose.translate[2] - interest.translate[2] : 0.0f;
+					replica.scheduler.Accumulate(id, cReplicationScheduler::GetPriority(1.0f,
+						sqrtf(dx * dx + dy * dy + dz * dz), 1.0f / (float)SERVER_REPLICA_RANGE));
+					replica.size[id] = cEntityStore::GetEntityBytes(replica.pendingMask[id], level.precision);
+				}
+				else
+				{
+					replica.scheduler.Accumulate(id, 1.0f);
+					replica.size[id] = 0;
+				}
+			}
+
+			// fill budget; chosen go out now, the rest stay held
+			replica.scheduler.SetBudget(level.budget);
+			replica.selected.resize(count);
+			selected = replica.scheduler.Schedule(replica.size.data(), replica.selected.data());
+			replica.selected.resize(selected);
+			replica.mask.resize(selected);
+			for (j = 0; j < selected; ++j)
+			{
+				replica.mask[j] = replica.pendingMask[replica.selected[j]];
+				replica.pendingMask[replica.selected[j]] = 0;
+			}
+			for (j = k = 0; j < count; ++j)
+				if (replica.pendingMask[replica.pendingID[j]])
+					replica.pendingID[k++] = replica.pendingID[j];
+			replica.pendingID.resize(k);
+			if (!selected)
+				continue;
+
+			// kept per client, so once grown it is only reused
+			if (replica.encoded)
+				replica.encoded->Reset();
+			else
+				replica.encoded.reset(new RakNet::BitStream(MESSAGE_HEADER_BYTES + cEntityStore::GetUpdateMaxBytes(selected)));
+			server->WriteTimestamp(*replica.encoded);
+			replica.encoded->Write((RakNet::MessageID)ID_GPRO_MESSAGE_ENTITY_UPDATE);
+			server->entities.WriteMasked(*replica.encoded, replica.selected.data(), replica.mask.data(), selected, level.precision);
+		}
+	}
+
+	void cRakNetServer::UpdateRates(RakNet::Time const time)
+	{
+		std::map<RakNet::SystemAddress, sClientReplica>::iterator itr;
+		sLinkStatistics link;
+		int change;
+		for (itr = replicas.begin(); itr != replicas.end(); ++itr)
+		{
+			sRateState& rate = itr->second.rate;
+			if (rateControl.IsSampleDue(rate, time) && peer->GetStatistics(itr->first, link))
+			{
+				change = rateControl.Update(rate, link, time);
+				metrics.RecordRate(itr->first, rate.level, change, link.ping);
+			}
+		}
+	}
+
+	unsigned int cRakNetServer::Tick()
+	{
+		RakNet::Time const time = RakNet::GetTime();
+		history.Record(++tick, time, entities);
+		UpdateRates(time);
+		ReplicateEntities();
+
+		// fork: checksum and copy each changed match's checkpoint on the
+		//	job system, joined before anything is synced to disk
+		if (jobs && saving.size() > SERVER_SAVE_GRAIN)
+			jobs->ParallelFor(SaveMatches, this, (unsigned int)saving.size(), SERVER_SAVE_GRAIN);
+		else
+			SaveMatches(this, 0, (unsigned int)saving.size());
+		saving.clear();
+		FlushChat();
+		ExpireSessions(time);
+		if (tick % SERVER_LOAD_INTERVAL == 0)
+			SendLoad();
+		if (tick % SERVER_SYNC_INTERVAL == 0)
+			checkpoints.Sync(false);
+		return tick;
+	}
+
+	bool cRakNetServer::ConnectRouter(char const host[], unsigned short const hostPort)
+	{
+		return peer->Connect(host, hostPort);
+	}
+
+	bool cRakNetServer::SendLoad()
+	{
+		if (router == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+			return false;
+		cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + 3 * sizeof(unsigned short));
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_SHARD_LOAD);
+		bitstream_w->Write(port);
+		bitstream_w->Write((unsigned short)replicas.size());
+		bitstream_w->Write(maxClients);
+		return (Send(*bitstream_w, router, false) != 0);
+	}
+
+	unsigned int cRakNetServer::FlushChat()
+	{
+		std::vector<RakNet::SystemAddress> const* member;
+		unsigned int room, count = 0, sent;
+		while (chat.NextActive(room))
+		{
+			member = chat.GetMembers(room);
+			do
+			{
+				cPooledBitStream bitstream_w((unsigned int)MESSAGE_HEADER_BYTES + CHAT_BATCH_HEADER_BYTES + CHAT_BATCH_MAX * CHAT_ENTRY_BYTES);
+				WriteTimestamp(*bitstream_w);
+				bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_CHAT);
+				sent = chat.WritePending(room, *bitstream_w);
+				if (sent)
+					SendToList(*bitstream_w, member->data(), (unsigned int)member->size());
+				count += sent;
+			} while (sent);
+		}
+		return count;
+	}
+
+	bool cRakNetServer::PostChat(unsigned int const room, char const text[])
+	{
+		sChatMessage message;
+		message.room = room;
+		message.sender = CHAT_SENDER_SERVER;
+		strncpy(message.text, text, CHAT_TEXT_MAX);
+		message.text[CHAT_TEXT_MAX] = 0;
+		return chat.Post(message);
+	}
+
+	cRateController& cRakNetServer::GetRateController()
+	{
+		return rateControl;
+	}
+
+	void cRakNetServer::SetInterpolationDelay(RakNet::Time const delay)
+	{
+		interpolationDelay = delay;
+	}
+
+	void cRakNetServer::SetJobs(cJobSystem* const jobs)
+	{
+		this->jobs = jobs;
+	}
+
+	void cRakNetServer::SetResumeGrace(RakNet::Time const grace)
+	{
+		resumeGrace = grace;
+	}
+
+	unsigned int cRakNetServer::GetSeatedCount() const
+	{
+		return (unsigned int)matches.size();
+	}
+
+	unsigned int cRakNetServer::GetHeldCount() const
+	{
+		return (unsigned int)held.size();
+	}
+
+	unsigned int cRakNetServer::ProcessShot(RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive)
+	{
+		std::map<RakNet::SystemAddress, unsigned int>::const_iterator const player = players.find(sender);
+		sSpatialPose shooter;
+		float direction[3], distance;
+		unsigned int target = (unsigned int)ENTITY_INVALID;
+		if (player != players.end() && entities.GetPose(player->second, shooter))
+		{
+			// shooter saw targets as of send time, minus display delay
+			RakNet::Time const tView = RakNet::GetTime() - dtSendToReceive - interpolationDelay;
+			cPoseHistory::GetForward(shooter, direction);
+			target = history.Raycast(shooter.translate, direction, 1024.0f, tView, player->second, distance);
+			if (target != (unsigned int)ENTITY_INVALID)
+				ProcessHit(player->second, target, distance);
+		}
+		return target;
+	}
+
+	void cRakNetServer::ProcessHit(unsigned int const shooterID, unsigned int const targetID, float const distance)
+	{
+		// only the two players involved hear of it
+		std::map<RakNet::SystemAddress, unsigned int>::const_iterator itr;
+		sEntityHit const hit = { shooterID, targetID, distance };
+		cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + sEntityHitSchema::maxBytes);
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_ENTITY_HIT);
+		sEntityHitSchema::Write(*bitstream_w, hit);
+		for (itr = players.begin(); itr != players.end(); ++itr)
+			if (itr->second == shooterID || itr->second == targetID)
+				Send(*bitstream_w, itr->first, false);
+	}
+
+	int cRakNetServer::OpenCheckpoints(char const path[], unsigned int const slots)
+	{
+		sMatchCheckpoint record;
+		unsigned int slot;
+		int count = 0;
+		if (!checkpoints.Open(path, slots))
+			return -1;
+		for (slot = 0; slot < checkpoints.GetSlotCount(); ++slot)
+		{
+			std::shared_ptr<sLockstepMatch> match;
+			if (!checkpoints.Load(slot, record))
+				continue;
+			match = std::make_shared<sLockstepMatch>();
+			if (!match->session.Load(record.session) || record.chatRoom == CHAT_ROOM_GLOBAL || record.chatRoom > CHAT_ROOM_MAX)
+			{
+				checkpoints.Release(slot);
+				continue;
+			}
+
+			// players are known by identifier until they reconnect
+			match->address[0] = match->address[1] = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+			match->player[0] = record.player[0];
+			match->player[1] = record.player[1];
+			match->chatRoom = record.chatRoom;
+			match->slot = (int)slot;
+			match->logFirst = match->session.GetSequence() + 1;
+			match->heldToken[0] = match->heldToken[1] = 0;
+			match->unsaved = false;
+			chat.Open(match->chatRoom);
+			restored[match->player[0]] = restored[match->player[1]] = match;
+			++count;
+		}
+		return count;
+	}
+
+	void cRakNetServer::SaveMatch(sLockstepMatch const& match)
+	{
+		if (match.slot >= 0)
+		{
+			sMatchCheckpoint record;
+			record.chatRoom = match.chatRoom;
+			record.player[0] = match.player[0];
+			record.player[1] = match.player[1];
+			match.session.Save(record.session);
+			checkpoints.Save((unsigned int)match.slot, record);
+		}
+	}
+
+	void cRakNetServer::QueueSave(std::shared_ptr<sLockstepMatch> const& match)
+	{
+		if (!match->unsaved && match->slot >= 0)
+		{
+			match->unsaved = true;
+			saving.push_back(match);
+		}
+	}
+
+	void cRakNetServer::SaveMatches(void* const data, unsigned int const begin, unsigned int const end)
+	{
+		cRakNetServer* const server = (cRakNetServer*)data;
+		unsigned int i;
+		for (i = begin; i < end; ++i)
+		{
+			// a match that ended since it changed has no slot left
+			sLockstepMatch& match = *server->saving[i];
+			match.unsaved = false;
+			server->SaveMatch(match);
+		}
+	}
+
+	bool cRakNetServer::ResumeMatch(RakNet::SystemAddress const client)
+	{
+		std::map<unsigned long long, std::shared_ptr<sLockstepMatch>>::iterator const itr = restored.find(peer->GetGUID(client));
+		if (itr != restored.end())
+		{
+			std::shared_ptr<sLockstepMatch> const match = itr->second;
+			unsigned char const player = (match->player[1] == itr->first) ? 1 : 0;
+			restored.erase(itr);
+			match->address[player] = client;
+			matches[client] = match;
+			JoinChat(client, match->chatRoom);
+			SendGameStart(*match, player);
+			SendGameState(*match, player);
+			return true;
+		}
+		return false;
+	}
+
+	bool cRakNetServer::JoinGame(RakNet::SystemAddress const client, eLockstepGame const game)
+	{
+		std::map<RakNet::SystemAddress, std::shared_ptr<sLockstepMatch>>::const_iterator const current = matches.find(client);
+		unsigned int const currentRoom = (current != matches.end()) ? current->second->chatRoom : (unsigned int)CHAT_ROOM_GLOBAL;
+		RakNet::SystemAddress const waiting = (lobby[game] != client) ? lobby[game] : RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+		std::shared_ptr<sLockstepMatch> match;
+		unsigned int room = CHAT_ROOM_GLOBAL, tries;
+
+		// players get a room of their own (the joining client's current
+		//	one is about to close); if all are in use, there is no match and
+		//	the client keeps its current game
+		if (waiting != RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+			for (room = chatRoomNext, tries = 0; chat.IsOpen(room) && room != currentRoom; room = room % CHAT_ROOM_MAX + 1)
+				if (++tries >= CHAT_ROOM_MAX)
+					return false;
+		LeaveGame(client);
+		if (waiting == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+		{
+			lobby[game] = client;
+			return true;
+		}
+		chatRoomNext = room % CHAT_ROOM_MAX + 1;
+
+		// pair with waiting client, who moves first
+		match = std::make_shared<sLockstepMatch>();
+		match->session.Start(game);
+		match->address[0] = lobby[game];
+		match->address[1] = client;
+		match->player[0] = peer->GetGUID(match->address[0]);
+		match->player[1] = peer->GetGUID(match->address[1]);
+		match->slot = checkpoints.Allocate();
+		match->logFirst = match->session.GetSequence() + 1;
+		match->heldToken[0] = match->heldToken[1] = 0;
+		match->unsaved = false;
+		lobby[game] = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+		matches[match->address[0]] = matches[match->address[1]] = match;
+		match->chatRoom = room;
+		chat.Open(match->chatRoom);
+		JoinChat(match->address[0], match->chatRoom);
+		JoinChat(match->address[1], match->chatRoom);
+		QueueSave(match);
+		SendGameStart(*match, 0);
+		SendGameStart(*match, 1);
+		return true;
+	}
+
+	void cRakNetServer::LeaveGame(RakNet::SystemAddress const client)
+	{
+		std::map<RakNet::SystemAddress, std::shared_ptr<sLockstepMatch>>::iterator const itr = matches.find(client);
+		unsigned int i;
+		for (i = 0; i < LOCKSTEP_GAME_COUNT; ++i)
+			if (lobby[i] == client)
+				lobby[i] = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+		if (itr != matches.end())
+		{
+			std::shared_ptr<sLockstepMatch> const match = itr->second;
+			match->address[(match->address[0] == client) ? 0 : 1] = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+			matches.erase(itr);
+			EndMatch(match);
+		}
+	}
+
+	void cRakNetServer::EndMatch(std::shared_ptr<sLockstepMatch> const match)
+	{
+		std::map<unsigned long long, std::shared_ptr<sLockstepMatch>>::iterator itr;
+		unsigned char i;
+
+		// players present are told the game is over; the rest (never back
+		//	after a restart, or dropped) lose their seats
+		match->session.Start(LOCKSTEP_NONE);
+		for (i = 0; i < 2; ++i)
+		{
+			if (match->address[i] != RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+			{
+				SendGameStart(*match, i);
+				matches.erase(match->address[i]);
+				continue;
+			}
+			itr = restored.find(match->player[i]);
+			if (itr != restored.end() && itr->second == match)
+				restored.erase(itr);
+			if (match->heldToken[i])
+				held.erase(match->heldToken[i]);
+			match->heldToken[i] = 0;
+		}
+		if (match->slot >= 0)
+			checkpoints.Release((unsigned int)match->slot);
+		match->slot = -1;
+		chat.Close(match->chatRoom);
+	}
+
+	void cRakNetServer::LogMove(sLockstepMatch& match, sLockstepMove const& move)
+	{
+		unsigned int const sequence = match.session.GetSequence();
+		match.log[sequence % SERVER_MOVE_LOG] = move;
+		match.logTurn[sequence % SERVER_MOVE_LOG] = match.session.GetTurn();
+		if (sequence - match.logFirst >= SERVER_MOVE_LOG)
+			match.logFirst = sequence - SERVER_MOVE_LOG + 1;
+	}
+
+	RakNet::BitStream& cRakNetServer::WriteLoggedMove(RakNet::BitStream& bitstream, sLockstepMatch const& match, unsigned int const sequence)
+	{
+		WriteTimestamp(bitstream);
+		bitstream.Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_MOVE);
+		bitstream.Write(sequence);
+		WriteBitsValue(bitstream, match.logTurn[sequence % SERVER_MOVE_LOG], 1);
+		match.session.WriteMove(bitstream, match.log[sequence % SERVER_MOVE_LOG]);
+		return bitstream;
+	}
+
+	void cRakNetServer::IssueToken(RakNet::SystemAddress const client)
+	{
+		cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + sizeof(unsigned long long));
+		unsigned long long token;
+		while (!(token = tokenSource()) || held.count(token));
+		tokens[client] = token;
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_RESUME);
+		bitstream_w->Write(token);
+		Send(*bitstream_w, client, false);
+	}
+
+	bool cRakNetServer::HoldSession(RakNet::SystemAddress const client)
+	{
+		std::map<RakNet::SystemAddress, std::shared_ptr<sLockstepMatch>>::iterator const itr = matches.find(client);
+		std::map<RakNet::SystemAddress, unsigned long long>::iterator const token = tokens.find(client);
+		if (resumeGrace && itr != matches.end() && token != tokens.end() && itr->second->session.GetGame() != LOCKSTEP_NONE)
+		{
+			std::shared_ptr<sLockstepMatch> const match = itr->second;
+			sHeldSession& session = held[token->second];
+			session.match = match;
+			session.player = (match->address[1] == client) ? 1 : 0;
+			session.deadline = RakNet::GetTime() + resumeGrace;
+			match->address[session.player] = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+			match->heldToken[session.player] = token->second;
+			matches.erase(itr);
+			return true;
+		}
+		return false;
+	}
+
+	bool cRakNetServer::ResumeSession(RakNet::SystemAddress const client, unsigned long long const token, eLockstepGame const game, unsigned int const sequence)
+	{
+		std::map<unsigned long long, sHeldSession>::iterator const itr = held.find(token);
+		unsigned int last, i;
+		if (itr == held.end())
+			return false;
+		std::shared_ptr<sLockstepMatch> const match = itr->second.match;
+		unsigned char const player = itr->second.player;
+		last = match->session.GetSequence();
+		held.erase(itr);
+		LeaveGame(client);
+		match->address[player] = client;
+		match->player[player] = peer->GetGUID(client);
+		match->heldToken[player] = 0;
+		matches[client] = match;
+		JoinChat(client, match->chatRoom);
+		QueueSave(match);
+
+		// client still has its copy up to its last move; if everything
+		//	after that is logged, it only needs those
+		if (game == match->session.GetGame() && sequence <= last && sequence + 1 >= match->logFirst)
+		{
+			if (game == LOCKSTEP_BATTLESHIP && match->session.HasBoard(0) && match->session.HasBoard(1))
+			{
+				cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES);
+				WriteTimestamp(*bitstream_w);
+				bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_SETUP);
+				Send(*bitstream_w, client, false);
+			}
+			for (i = sequence + 1; i <= last; ++i)
+			{
+				cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + sizeof(unsigned int) + LOCKSTEP_MOVE_BYTES);
+				Send(WriteLoggedMove(*bitstream_w, *match, i), client, false);
+			}
+		}
+		else
+		{
+			SendGameStart(*match, player);
+			SendGameState(*match, player);
+		}
+		return true;
+	}
+
+	unsigned int cRakNetServer::ExpireSessions(RakNet::Time const time)
+	{
+		std::map<unsigned long long, sHeldSession>::iterator itr = held.begin();
+		unsigned int count = 0;
+
+		// ending match may forget both its players' seats, so start over
+		while (itr != held.end())
+		{
+			if (itr->second.deadline <= time)
+			{
+				EndMatch(itr->second.match);
+				itr = held.begin();
+				++count;
+			}
+			else
+				++itr;
+		}
+		return count;
+	}
+
+	void cRakNetServer::SendGameStart(sLockstepMatch const& match, unsigned char const player)
+	{
+		// game, player and room (19 bits)
+		cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + 3);
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_START);
+		WriteBitsValue(*bitstream_w, match.session.GetGame(), 2);
+		WriteBitsValue(*bitstream_w, player, 1);
+		WriteBitsValue(*bitstream_w, match.chatRoom, CHAT_ROOM_BITS);
+		Send(*bitstream_w, match.address[player], false);
+	}
+
+	void cRakNetServer::SendNoGame(RakNet::SystemAddress const client)
+	{
+		cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + 3);
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_START);
+		WriteBitsValue(*bitstream_w, LOCKSTEP_NONE, 2);
+		WriteBitsValue(*bitstream_w, 0, 1);
+		WriteBitsValue(*bitstream_w, CHAT_ROOM_GLOBAL, CHAT_ROOM_BITS);
+		Send(*bitstream_w, client, false);
+	}
+
+	void cRakNetServer::SendGameState(sLockstepMatch const& match, unsigned char const player)
+	{
+		cPooledBitStream bitstream_w((unsigned int)MESSAGE_HEADER_BYTES + LOCKSTEP_STATE_BYTES);
+		WriteTimestamp(*bitstream_w);
+		bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_RESYNC);
+		match.session.WriteState(*bitstream_w, player);
+		Send(*bitstream_w, match.address[player], false);
+	}
+
+	bool cRakNetServer::JoinChat(RakNet::SystemAddress const client, unsigned int const room)
+	{
+		if (chat.Join(room, client))
+		{
+			cPooledBitStream bitstream_w((unsigned int)MESSAGE_HEADER_BYTES + CHAT_BATCH_HEADER_BYTES + CHAT_HISTORY * CHAT_ENTRY_BYTES);
+			WriteTimestamp(*bitstream_w);
+			bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_CHAT);
+			chat.WriteHistory(room, *bitstream_w);
+			Send(*bitstream_w, client, false);
+			return true;
+		}
+		return false;
 	}
 
 	bool cRakNetServer::ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID)
@@ -50,26 +717,205 @@ namespace gproNet
 		switch (msgID)
 		{
 		case ID_NEW_INCOMING_CONNECTION:
+		{
 			//printf("A connection is incoming.\n");
-			return true;
+			sSpatialPose const spawn = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+			unsigned int const id = entities.Create(spawn);
+			sClientReplica& replica = replicas[sender];
+			if (id != (unsigned int)ENTITY_INVALID)
+				players[sender] = id;
+			rateControl.Reset(replica.rate, RakNet::GetTime());
+			replica.tickSent = tick;
+
+			// new client needs every entity, not just recent changes
+			if (entities.GetCount())
+			{
+				cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + cEntityStore::GetUpdateMaxBytes(entities.GetCount()));
+				WriteTimestamp(*bitstream_w);
+				bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_ENTITY_UPDATE);
+				entities.WriteAll(*bitstream_w);
+				Send(*bitstream_w, sender, false);
+			}
+			JoinChat(sender, CHAT_ROOM_GLOBAL);
+			IssueToken(sender);
+			ResumeMatch(sender);
+			SendLoad();
+		}	return true;
 		case ID_NO_FREE_INCOMING_CONNECTIONS:
 			//printf("The server is full.\n");
 			return true;
 		case ID_DISCONNECTION_NOTIFICATION:
 			//printf("A client has disconnected.\n");
-			return true;
 		case ID_CONNECTION_LOST:
 			//printf("A client lost the connection.\n");
-			return true;
+		{
+			// only a client that did not mean to leave keeps its seat
+			std::map<RakNet::SystemAddress, unsigned int>::iterator const player = players.find(sender);
+			if (sender == router)
+			{
+				router = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
+				return true;
+			}
+			if (player != players.end())
+			{
+				entities.Destroy(player->second);
+				history.Forget(player->second);
+				players.erase(player);
+			}
+			replicas.erase(sender);
+			if (msgID != ID_CONNECTION_LOST || !HoldSession(sender))
+				LeaveGame(sender);
+			tokens.erase(sender);
+			chat.LeaveAll(sender);
+			SendLoad();
+		}	return true;
+
+			// shard connected to router
+		case ID_CONNECTION_REQUEST_ACCEPTED:
+		{
+			router = sender;
+			SendLoad();
+		}	return true;
+
+			// player input
+		case ID_GPRO_MESSAGE_INPUTS:
+		{
+			sInputs inputs;
+			if (!sInputsSchema::Read(bitstream, inputs))
+				return false;
+			if (inputs.shoot)
+				ProcessShot(sender, dtSendToReceive);
+		}	return true;
+
+			// lockstep games
+		case ID_GPRO_MESSAGE_GAME_JOIN:
+		{
+			unsigned int game;
+			if (!ReadBitsValue(bitstream, game, 2))
+				return false;
+			if (game == LOCKSTEP_NONE)
+				LeaveGame(sender);
+			else if (!JoinGame(sender, (eLockstepGame)game))
+				SendNoGame(sender);
+		}	return true;
+		case ID_GPRO_MESSAGE_GAME_SETUP:
+		{
+			std::map<RakNet::SystemAddress, std::shared_ptr<sLockstepMatch>>::iterator const itr = matches.find(sender);
+			gpro_battleship board;
+			if (itr == matches.end() || !cLockstepSession::ReadBoard(bitstream, board))
+				return false;
+			sLockstepMatch& match = *itr->second;
+			if (match.session.SetBoard((match.address[1] == sender) ? 1 : 0, board) == 0)
+			{
+				QueueSave(itr->second);
+
+				// both players are told once the last board is placed, since
+				//	moves before then are dropped
+				if (match.session.HasBoard(0) && match.session.HasBoard(1))
+				{
+					cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES);
+					WriteTimestamp(*bitstream_w);
+					bitstream_w->Write((RakNet::MessageID)ID_GPRO_MESSAGE_GAME_SETUP);
+					SendToList(*bitstream_w, match.address, 2);
+				}
+			}
+		}	return true;
+		case ID_GPRO_MESSAGE_GAME_MOVE:
+		{
+			std::map<RakNet::SystemAddress, std::shared_ptr<sLockstepMatch>>::iterator const itr = matches.find(sender);
+			sLockstepMove move;
+			if (itr == matches.end() || !itr->second->session.ReadMove(bitstream, move))
+				return false;
+			sLockstepMatch& match = *itr->second;
+			move.player = (match.address[1] == sender) ? 1 : 0;
+
+			// battleship starts once both boards are placed
+			if (match.session.GetGame() == LOCKSTEP_BATTLESHIP && !(match.session.HasBoard(0) && match.session.HasBoard(1)))
+				return true;
+
+			// only validated moves are relayed; client that sent an illegal
+			//	move has likely diverged, so it gets the real state
+			if (match.session.Apply(move) == 0)
+			{
+				cPooledBitStream bitstream_w(MESSAGE_HEADER_BYTES + sizeof(unsigned int) + LOCKSTEP_MOVE_BYTES);
+				QueueSave(itr->second);
+				LogMove(match, move);
+				WriteLoggedMove(*bitstream_w, match, match.session.GetSequence());
+				SendToList(*bitstream_w, match.address, 2);
+
+				// finished match gives up seats, room and checkpoint now,
+				//	not when a player leaves
+				if (match.session.IsOver())
+					EndMatch(itr->second);
+			}
+			else
+				SendGameState(match, move.player);
+		}	return true;
+		case ID_GPRO_MESSAGE_GAME_HASH:
+		{
+			std::map<RakNet::SystemAddress, std::shared_ptr<sLockstepMatch>>::iterator const itr = matches.find(sender);
+			unsigned int sequence;
+			unsigned long long hash;
+			if (itr == matches.end() || !bitstream.Read(sequence) || !bitstream.Read(hash))
+				return false;
+			unsigned char const player = (itr->second->address[1] == sender) ? 1 : 0;
+			if (itr->second->session.VerifyHash(sequence, player, hash) < 0)
+				SendGameState(*itr->second, player);
+		}	return true;
+		case ID_GPRO_MESSAGE_GAME_RESYNC:
+		{
+			std::map<RakNet::SystemAddress, std::shared_ptr<sLockstepMatch>>::iterator const itr = matches.find(sender);
+			if (itr == matches.end())
+				return false;
+			SendGameState(*itr->second, (itr->second->address[1] == sender) ? 1 : 0);
+		}	return true;
+		case ID_GPRO_MESSAGE_RESUME:
+		{
+			// client whose seat is gone is told its game is over
+			unsigned long long token;
+			unsigned int game, sequence;
+			if (!bitstream.Read(token) || !ReadBitsValue(bitstream, game, 2) || !bitstream.Read(sequence))
+				return false;
+			if (!ResumeSession(sender, token, (eLockstepGame)game, sequence) && game != LOCKSTEP_NONE)
+				SendNoGame(sender);
+		}	return true;
+
+			// spectators (e.g. relays) keep receiving replication, but have no
+			//	entity and do not play
+		case ID_GPRO_MESSAGE_SPECTATE:
+		{
+			std::map<RakNet::SystemAddress, unsigned int>::iterator const player = players.find(sender);
+			if (player != players.end())
+			{
+				entities.Destroy(player->second);
+				history.Forget(player->second);
+				players.erase(player);
+			}
+			LeaveGame(sender);
+		}	return true;
+
+			// chat
+		case ID_GPRO_MESSAGE_CHAT:
+		{
+			// held until flushed; posts to rooms the sender is not in are dropped
+			std::map<RakNet::SystemAddress, unsigned int>::const_iterator const player = players.find(sender);
+			sChatMessage message;
+			if (!ReadChatPost(bitstream, message))
+				return false;
+			if (chat.IsMember(message.room, sender))
+			{
+				if (player != players.end())
+					message.sender = player->second;
+				chat.Post(message);
+			}
+		}	return true;
 
 			// test message
 		case ID_GPRO_MESSAGE_COMMON_BEGIN:
 		{
 			// server receives greeting, print it and send one back
-			RakNet::BitStream bitstream_w;
 			ReadTest(bitstream);
-			WriteTest(bitstream_w, "Hello client from server");
-			peer->Send(&bitstream_w, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 0, sender, false);
+			Send(greeting, sender, false);
 		}	return true;
 
 		}
@@ -0,0 +1,109 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-RateControl.cpp
+	Source for congestion-aware per-connection update rate control.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-RateControl.hpp"
+
+
+namespace gproNet
+{
+	// rate levels; first halve rate, then trade precision and size for
+	//	rate (full rate budget fits one unfragmented datagram)
+	static sRateLevel const rateLevel[RATE_LEVEL_COUNT] = {
+		{ 1, ENTITY_PRECISION_FULL, 1200 },
+		{ 2, ENTITY_PRECISION_FULL, 1200 },
+		{ 3, ENTITY_PRECISION_HIGH, 1000 },
+		{ 4, ENTITY_PRECISION_MEDIUM, 800 },
+		{ 6, ENTITY_PRECISION_LOW, 600 },
+	};
+
+
+	cRateController::cRateController()
+		: pingMargin(80), lossLimit(0.02f), bufferLimit(16384)
+	{
+	}
+
+	void cRateController::SetLimits(unsigned int const pingMargin, float const lossLimit, unsigned int const bufferLimit)
+	{
+		this->pingMargin = pingMargin;
+		this->lossLimit = lossLimit;
+		this->bufferLimit = bufferLimit;
+	}
+
+	void cRateController::Reset(sRateState& state, RakNet::Time const time) const
+	{
+		state.level = 0;
+		state.pingBase = state.pingWindow[0] = state.pingWindow[1] = (unsigned int)(-1);
+		state.tChange = state.tCongested = state.tSample = state.tWindow = time;
+	}
+
+	bool cRateController::IsSampleDue(sRateState const& state, RakNet::Time const time) const
+	{
+		return (time - state.tSample >= RATE_SAMPLE_INTERVAL);
+	}
+
+	int cRateController::Update(sRateState& state, sLinkStatistics const& link, RakNet::Time const time) const
+	{
+		bool congested = (link.packetLoss > lossLimit) || (link.bytesInSendBuffer > bufferLimit);
+		state.tSample = time;
+
+		// base round trip is the lowest seen in the current and previous
+		//	windows; old lows expire, so a route change that raises the
+		//	round trip for good becomes the new base within two windows
+		//	instead of reading as queuing forever
+		if (time - state.tWindow >= RATE_BASE_WINDOW)
+		{
+			state.pingWindow[1] = (time - state.tWindow < 2 * RATE_BASE_WINDOW) ? state.pingWindow[0] : (unsigned int)(-1);
+			state.pingWindow[0] = (unsigned int)(-1);
+			state.tWindow = time;
+		}
+		if (link.ping < state.pingWindow[0])
+			state.pingWindow[0] = link.ping;
+		state.pingBase = (state.pingWindow[0] < state.pingWindow[1]) ? state.pingWindow[0] : state.pingWindow[1];
+		if (link.ping > state.pingBase + pingMargin)
+			congested = true;
+
+		if (congested)
+		{
+			state.tCongested = time;
+			if (state.level + 1 < RATE_LEVEL_COUNT && time - state.tChange >= RATE_DECREASE_HOLD)
+			{
+				++state.level;
+				state.tChange = time;
+				return +1;
+			}
+		}
+		else if (state.level > 0 && time - state.tCongested >= RATE_INCREASE_HOLD && time - state.tChange >= RATE_INCREASE_HOLD)
+		{
+			--state.level;
+			state.tChange = time;
+			return -1;
+		}
+		return 0;
+	}
+
+	sRateLevel const& cRateController::GetLevel(unsigned int const level)
+	{
+		return rateLevel[level < RATE_LEVEL_COUNT ? level : RATE_LEVEL_COUNT - 1];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Replication.cpp
+	Source for bandwidth-limited replication scheduling.
+*/
+
+#include "gpro-net/gpro-net-server/gpro-net-Replication.hpp"
+
+#include <algorithm>
+
+
+namespace gproNet
+{
+	cReplicationScheduler::cReplicationScheduler(unsigned int const budget)
+		: budget(budget), bytesUsed(0)
+	{
+	}
+
+	void cReplicationScheduler::SetBudget(unsigned int const budget)
+	{
+		this->budget = budget;
+	}
+
+	unsigned int cReplicationScheduler::GetBudget() const
+	{
+		return budget;
+	}
+
+	unsigned int cReplicationScheduler::GetBytesUsed() const
+	{
+		return bytesUsed;
+	}
+
+	void cReplicationScheduler::SetObjectCount(unsigned int const count)
+	{
+		accumulator.resize(count, 0.0f);
+		order.resize(count);
+	}
+
+	unsigned int cReplicationScheduler::GetObjectCount() const
+	{
+		return (unsigned int)accumulator.size();
+	}
+
+	void cReplicationScheduler::Accumulate(unsigned int const index, float const priority)
+	{
+		accumulator[index] += priority;
+	}
+
+	void cReplicationScheduler::Reset(unsigned int const index)
+	{
+		accumulator[index] = 0.0f;
+	}
+
+	unsigned int cReplicationScheduler::Schedule(unsigned int const size[], unsigned int selected_out[])
+	{
+		unsigned int const count = (unsigned int)accumulator.size();
+		unsigned int i, index, selected = 0, remaining = budget, smallest = ~0u;
+		float const* const priority = accumulator.data();
+
+		// only objects with something to send compete
+		for (i = 0, index = 0; index < count; ++index)
+			if (priority[index] > 0.0f)
+			{
+				order[i++] = index;
+				smallest = size[index] < smallest ? size[index] : smallest;
+			}
+		std::sort(order.begin(), order.begin() + i,
+			[priority](unsigned int const a, unsigned int const b) { return priority[a] > priority[b]; });
+
+		// greedy fill; an object too big for what is left waits and keeps
+		//	accumulating, while smaller ones behind it may still fit
+		for (index = 0; index < i && remaining >= smallest; ++index)
+			if (size[order[index]] <= remaining)
+			{
+				remaining -= size[order[index]];
+				accumulator[order[index]] = 0.0f;
+				selected_out[selected++] = order[index];
+			}
+		bytesUsed = budget - remaining;
+		return selected;
+	}
+
+	float cReplicationScheduler::GetPriority(float const typeWeight, float const distance, float const falloff)
+	{
+		return typeWeight / (1.0f + distance * falloff);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,277 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-BattleshipAI.cpp
+	Source for battleship targeting and random fleet placement.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-BattleshipAI.hpp"
+
+#include <string.h>
+
+#if (defined _M_X64 || defined _M_IX86 || defined __x86_64__ || defined __i386__)
+#define GPRO_NET_BATTLESHIP_X86
+#include <emmintrin.h>
+#endif	// x86
+
+
+namespace gproNet
+{
+	// length of ship by flag; zero if not a single ship
+	static unsigned int BattleshipLength(unsigned char const ship)
+	{
+		switch (ship)
+		{
+		case gpro_battleship_ship_p2: return 2;
+		case gpro_battleship_ship_s3: return 3;
+		case gpro_battleship_ship_d3: return 3;
+		case gpro_battleship_ship_b4: return 4;
+		case gpro_battleship_ship_c5: return 5;
+		}
+		return 0;
+	}
+
+	// splitmix64 step
+	static unsigned long long BattleshipRandom(unsigned long long& state)
+	{
+		unsigned long long z = (state += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	static unsigned int BattleshipCount(unsigned int bits)
+	{
+		unsigned int count = 0;
+		for (; bits; bits &= bits - 1)
+			++count;
+		return count;
+	}
+
+
+	void BattleshipDensityScalar(gpro_battleship const board, unsigned char const afloat, sBattleshipDensity& density_out)
+	{
+		unsigned char ship;
+		unsigned int length, r, c, i, weight;
+		memset(&density_out, 0, sizeof(density_out));
+		for (ship = gpro_battleship_ship_p2; ship; ship <<= 1)
+			if (gpro_flag_check(afloat, ship))
+			{
+				length = BattleshipLength(ship);
+				for (r = 0; r < BATTLESHIP_SIZE; ++r)
+					for (c = 0; c < BATTLESHIP_SIZE; ++c)
+					{
+						// along row, then along column
+						if (c + length <= BATTLESHIP_SIZE)
+						{
+							for (i = 0, weight = 1; i < length && !gpro_flag_check(board[r][c + i], gpro_battleship_miss); ++i)
+								weight += gpro_flag_check(board[r][c + i], gpro_battleship_hit) ? BATTLESHIP_HIT_WEIGHT : 0;
+							if (i == length)
+								for (i = 0; i < length; ++i)
+									density_out.cell[r][c + i] += (unsigned short)weight;
+						}
+						if (r + length <= BATTLESHIP_SIZE)
+						{
+							for (i = 0, weight = 1; i < length && !gpro_flag_check(board[r + i][c], gpro_battleship_miss); ++i)
+								weight += gpro_flag_check(board[r + i][c], gpro_battleship_hit) ? BATTLESHIP_HIT_WEIGHT : 0;
+							if (i == length)
+								for (i = 0; i < length; ++i)
+									density_out.cell[r + i][c] += (unsigned short)weight;
+						}
+					}
+			}
+
+		// only open cells can be attacked
+		for (r = 0; r < BATTLESHIP_SIZE; ++r)
+			for (c = 0; c < BATTLESHIP_SIZE; ++c)
+				if (gpro_flag_check(board[r][c], gpro_battleship_attack_rec))
+					density_out.cell[r][c] = 0;
+	}
+
+#ifdef GPRO_NET_BATTLESHIP_X86
+	// one row per vector, one byte lane per column: blocked lanes (misses
+	//	and columns past the board) are 1, hit lanes are the hit weight;
+	//	placement weights stay within a byte (1 + 5 * 40) and are widened
+	//	to 16 bits where they are summed per cell
+	void BattleshipDensity(gpro_battleship const board, unsigned char const afloat, sBattleshipDensity& density_out)
+	{
+		__m128i const zero = _mm_setzero_si128(), one = _mm_set1_epi8(1);
+		__m128i const missFlag = _mm_set1_epi8(gpro_battleship_miss), hitFlag = _mm_set1_epi8(gpro_battleship_hit);
+		__m128i const attackFlag = _mm_set1_epi8(gpro_battleship_attack_rec), hitWeight = _mm_set1_epi8(BATTLESHIP_HIT_WEIGHT);
+		__m128i const outside = _mm_set_epi8(1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+		__m128i miss[BATTLESHIP_SIZE], hit[BATTLESHIP_SIZE], open[BATTLESHIP_SIZE], sum[BATTLESHIP_SIZE][2];
+		__m128i blocked, hits, m, h, weight, lo, hi;
+		unsigned char row[BATTLESHIP_LANES] = { 0 };
+		unsigned char ship;
+		unsigned int length, r, i;
+
+		for (r = 0; r < BATTLESHIP_SIZE; ++r)
+		{
+			memcpy(row, board[r], BATTLESHIP_SIZE);
+			m = _mm_loadu_si128((__m128i const*)row);
+			miss[r] = _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(m, missFlag), missFlag), one), outside);
+			hit[r] = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(m, hitFlag), hitFlag), hitWeight);
+			open[r] = _mm_cmpeq_epi8(_mm_and_si128(m, attackFlag), zero);
+			sum[r][0] = sum[r][1] = zero;
+		}
+
+		for (ship = gpro_battleship_ship_p2; ship; ship <<= 1)
+			if (gpro_flag_check(afloat, ship))
+			{
+				length = BattleshipLength(ship);
+
+				// along row: lane c of window is start c; covers lanes c
+				//	to c + length - 1, so sum shifted copies back up
+				for (r = 0; r < BATTLESHIP_SIZE; ++r)
+				{
+					blocked = m = miss[r];
+					hits = h = hit[r];
+					for (i = 1; i < length; ++i)
+					{
+						m = _mm_srli_si128(m, 1);
+						h = _mm_srli_si128(h, 1);
+						blocked = _mm_or_si128(blocked, m);
+						hits = _mm_add_epi8(hits, h);
+					}
+					weight = _mm_and_si128(_mm_add_epi8(hits, one), _mm_cmpeq_epi8(blocked, zero));
+					for (i = 0; i < length; ++i)
+					{
+						sum[r][0] = _mm_add_epi16(sum[r][0], _mm_unpacklo_epi8(weight, zero));
+						sum[r][1] = _mm_add_epi16(sum[r][1], _mm_unpackhi_epi8(weight, zero));
+						weight = _mm_slli_si128(weight, 1);
+					}
+				}
+
+				// along column: every lane is its own column
+				for (r = 0; r + length <= BATTLESHIP_SIZE; ++r)
+				{
+					blocked = miss[r];
+					hits = hit[r];
+					for (i = 1; i < length; ++i)
+					{
+						blocked = _mm_or_si128(blocked, miss[r + i]);
+						hits = _mm_add_epi8(hits, hit[r + i]);
+					}
+					weight = _mm_and_si128(_mm_add_epi8(hits, one), _mm_cmpeq_epi8(blocked, zero));
+					lo = _mm_unpacklo_epi8(weight, zero);
+					hi = _mm_unpackhi_epi8(weight, zero);
+					for (i = 0; i < length; ++i)
+					{
+						sum[r + i][0] = _mm_add_epi16(sum[r + i][0], lo);
+						sum[r + i][1] = _mm_add_epi16(sum[r + i][1], hi);
+					}
+				}
+			}
+
+		// only open cells can be attacked
+		for (r = 0; r < BATTLESHIP_SIZE; ++r)
+		{
+			_mm_store_si128((__m128i*)density_out.cell[r], _mm_and_si128(sum[r][0], _mm_unpacklo_epi8(open[r], open[r])));
+			_mm_store_si128((__m128i*)density_out.cell[r] + 1, _mm_and_si128(sum[r][1], _mm_unpackhi_epi8(open[r], open[r])));
+		}
+	}
+#else	// !GPRO_NET_BATTLESHIP_X86
+	void BattleshipDensity(gpro_battleship const board, unsigned char const afloat, sBattleshipDensity& density_out)
+	{
+		BattleshipDensityScalar(board, afloat, density_out);
+	}
+#endif	// GPRO_NET_BATTLESHIP_X86
+
+	int BattleshipTarget(gpro_battleship const board, unsigned char const afloat, unsigned long long& random, unsigned char& row_out, unsigned char& col_out)
+	{
+		sBattleshipDensity density;
+		unsigned int r, c, best = 0, ties = 0;
+		BattleshipDensity(board, afloat, density);
+
+		// highest weight; open cells with no weight left still count, so
+		//	inconsistent records never stall the game
+		for (r = 0; r < BATTLESHIP_SIZE; ++r)
+			for (c = 0; c < BATTLESHIP_SIZE; ++c)
+				if (!gpro_flag_check(board[r][c], gpro_battleship_attack_rec))
+				{
+					unsigned int const weight = density.cell[r][c] + 1u;
+					if (weight > best)
+					{
+						best = weight;
+						ties = 0;
+					}
+					if (weight == best && BattleshipRandom(random) % ++ties == 0)
+					{
+						row_out = (unsigned char)r;
+						col_out = (unsigned char)c;
+					}
+				}
+		return (best ? 0 : -2);
+	}
+
+	int BattleshipPlaceRandom(gpro_battleship board, unsigned long long& random)
+	{
+		unsigned short used[BATTLESHIP_SIZE] = { 0 }, along[BATTLESHIP_SIZE], down[BATTLESHIP_SIZE], open;
+		unsigned int total, pick, length, r, c, i;
+		unsigned char ship;
+		for (r = 0; r < BATTLESHIP_SIZE; ++r)
+			for (c = 0; c < BATTLESHIP_SIZE; ++c)
+				if (gpro_flag_check(board[r][c], gpro_battleship_ship))
+					return -2;
+
+		for (ship = gpro_battleship_ship_c5; ship; ship >>= 1)
+		{
+			if (!(length = BattleshipLength(ship)))
+				break;
+
+			// bit c of each mask is a free placement starting at (r, c)
+			for (r = 0, total = 0; r < BATTLESHIP_SIZE; ++r)
+			{
+				open = (unsigned short)((~used[r] & ((1u << BATTLESHIP_SIZE) - 1)) & ((1u << (BATTLESHIP_SIZE + 1 - length)) - 1));
+				down[r] = 0;
+				for (i = 1, along[r] = (unsigned short)~used[r]; i < length; ++i)
+					along[r] &= (unsigned short)~(used[r] >> i);
+				along[r] &= open;
+				if (r + length <= BATTLESHIP_SIZE)
+				{
+					for (i = 0, down[r] = (unsigned short)((1u << BATTLESHIP_SIZE) - 1); i < length; ++i)
+						down[r] &= (unsigned short)~used[r + i];
+				}
+				total += BattleshipCount(along[r]) + BattleshipCount(down[r]);
+			}
+
+			// every ship before this one leaves room, so total is never 0
+			pick = (unsigned int)(BattleshipRandom(random) % total);
+			for (r = 0; r < BATTLESHIP_SIZE; ++r)
+				for (c = 0; c < BATTLESHIP_SIZE; ++c)
+				{
+					if (((along[r] >> c) & 1) && !pick--)
+					{
+						gpro_battleship_place(board, ship, (unsigned char)r, (unsigned char)c, 1);
+						used[r] |= (unsigned short)(((1u << length) - 1) << c);
+						r = c = BATTLESHIP_SIZE;
+					}
+					else if (((down[r] >> c) & 1) && !pick--)
+					{
+						gpro_battleship_place(board, ship, (unsigned char)r, (unsigned char)c, 0);
+						for (i = 0; i < length; ++i)
+							used[r + i] |= (unsigned short)(1u << c);
+						r = c = BATTLESHIP_SIZE;
+					}
+				}
+		}
+		return 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-BitStreamPool.cpp
+	Source for pooled, reusable write streams.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-BitStreamPool.hpp"
+
+
+namespace gproNet
+{
+	std::atomic<unsigned long long> cBitStreamPool::totalAllocations(0);
+
+
+	cBitStreamPool::cBitStreamPool()
+		: acquired(0), allocations(0)
+	{
+	}
+
+	cBitStreamPool::~cBitStreamPool()
+	{
+		unsigned int c, i;
+		for (c = 0; c < BITSTREAM_POOL_CLASS_COUNT; ++c)
+			for (i = 0; i < freeList[c].size(); ++i)
+				delete freeList[c][i];
+	}
+
+	unsigned int cBitStreamPool::GetClass(unsigned int const bytes)
+	{
+		unsigned int c = 0;
+		while (c < BITSTREAM_POOL_CLASS_COUNT - 1 && ((unsigned int)BITSTREAM_POOL_CLASS_MIN << c) < bytes)
+			++c;
+		return c;
+	}
+
+	RakNet::BitStream* cBitStreamPool::Acquire(unsigned int const bytes)
+	{
+		unsigned int const c = GetClass(bytes);
+		unsigned int const classBytes = (unsigned int)BITSTREAM_POOL_CLASS_MIN << c;
+		RakNet::BitStream* bitstream;
+		++acquired;
+		if (!freeList[c].empty())
+		{
+			bitstream = freeList[c].back();
+			freeList[c].pop_back();
+			return bitstream;
+		}
+
+		// list empty; sizes beyond the largest class are made exact
+		++allocations;
+		++totalAllocations;
+		return new RakNet::BitStream(bytes > classBytes ? bytes : classBytes);
+	}
+
+	void cBitStreamPool::Release(RakNet::BitStream* const bitstream, bool const grew)
+	{
+		// largest class the stream's buffer holds, so a grown stream serves
+		//	larger requests from then on
+		unsigned int const bytes = (unsigned int)(bitstream->GetNumberOfBitsAllocated() >> 3);
+		unsigned int c = GetClass(bytes);
+		if (c && ((unsigned int)BITSTREAM_POOL_CLASS_MIN << c) > bytes)
+			--c;
+		if (grew)
+		{
+			++allocations;
+			++totalAllocations;
+		}
+		bitstream->Reset();
+		freeList[c].push_back(bitstream);
+	}
+
+	unsigned long long cBitStreamPool::GetAcquireCount() const
+	{
+		return acquired;
+	}
+
+	unsigned long long cBitStreamPool::GetAllocationCount() const
+	{
+		return allocations;
+	}
+
+	cBitStreamPool& cBitStreamPool::GetLocal()
+	{
+		static thread_local cBitStreamPool pool;
+		return pool;
+	}
+
+	unsigned long long cBitStreamPool::GetTotalAllocationCount()
+	{
+		return totalAllocations.load(std::memory_order_relaxed);
+	}
+
+
+	cPooledBitStream::cPooledBitStream(unsigned int const bytes)
+		: pool(cBitStreamPool::GetLocal()), bitstream(pool.Acquire(bytes)), allocated(bitstream->GetNumberOfBitsAllocated())
+	{
+	}
+
+	cPooledBitStream::~cPooledBitStream()
+	{
+		pool.Release(bitstream, bitstream->GetNumberOfBitsAllocated() != allocated);
+	}
+
+	RakNet::BitStream& cPooledBitStream::operator*() const
+	{
+		return *bitstream;
+	}
+
+	RakNet::BitStream* cPooledBitStream::operator->() const
+	{
+		return bitstream;
+	}
+}
\ No newline at end of file
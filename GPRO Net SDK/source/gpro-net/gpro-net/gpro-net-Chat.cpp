@@ -0,0 +1,90 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Chat.cpp
+	Source for chat messages and their compressed encoding.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Chat.hpp"
+#include "gpro-net/gpro-net/gpro-net-Schema.hpp"
+
+#include "RakNet/StringCompressor.h"
+
+
+namespace gproNet
+{
+	void WriteChatText(RakNet::BitStream& bitstream, char const text[])
+	{
+		RakNet::StringCompressor::Instance()->EncodeString(text, CHAT_TEXT_MAX + 1, &bitstream);
+	}
+
+	bool ReadChatText(RakNet::BitStream& bitstream, char text_out[])
+	{
+		return RakNet::StringCompressor::Instance()->DecodeString(text_out, CHAT_TEXT_MAX + 1, &bitstream);
+	}
+
+	void WriteChatPost(RakNet::BitStream& bitstream, unsigned int const room, char const text[])
+	{
+		WriteBitsValue(bitstream, room, CHAT_ROOM_BITS);
+		WriteChatText(bitstream, text);
+	}
+
+	bool ReadChatPost(RakNet::BitStream& bitstream, sChatMessage& message_out)
+	{
+		message_out.sender = CHAT_SENDER_SERVER;
+		return ReadBitsValue(bitstream, message_out.room, CHAT_ROOM_BITS)
+			&& ReadChatText(bitstream, message_out.text);
+	}
+
+	void WriteChatBatch(RakNet::BitStream& bitstream, unsigned int const room, bool const history, unsigned int const count)
+	{
+		WriteBitsValue(bitstream, room, CHAT_ROOM_BITS);
+		WriteBitsValue(bitstream, history ? 1 : 0, 1);
+		WriteBitsValue(bitstream, count, CHAT_BATCH_BITS);
+	}
+
+	void WriteChatEntry(RakNet::BitStream& bitstream, sChatMessage const& message)
+	{
+		WriteBitsValue(bitstream, message.sender, ENTITY_ID_BITS);
+		WriteChatText(bitstream, message.text);
+	}
+
+	int ReadChatBatch(RakNet::BitStream& bitstream, std::vector<sChatMessage>& message_out, bool& history_out)
+	{
+		unsigned int room, history, count, i;
+		size_t const base = message_out.size();
+		if (!ReadBitsValue(bitstream, room, CHAT_ROOM_BITS) || !ReadBitsValue(bitstream, history, 1) || !ReadBitsValue(bitstream, count, CHAT_BATCH_BITS))
+			return -1;
+		history_out = (history != 0);
+		message_out.resize(base + count);
+		for (i = 0; i < count; ++i)
+		{
+			sChatMessage& message = message_out[base + i];
+			message.room = room;
+			if (!ReadBitsValue(bitstream, message.sender, ENTITY_ID_BITS) || !ReadChatText(bitstream, message.text))
+			{
+				message_out.resize(base);
+				return -1;
+			}
+		}
+		return (int)count;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,460 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Entity.cpp
+	Source for replicated entity storage.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Entity.hpp"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif	// _MSC_VER
+
+
+namespace gproNet
+{
+	// index of lowest set bit; bits must not be zero
+	inline unsigned int EntityLowestBit(unsigned long long const bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+#if (defined _M_X64 || defined _M_ARM64)
+		_BitScanForward64(&index, bits);
+#else	// !(defined _M_X64 || defined _M_ARM64)
+		if (!_BitScanForward(&index, (unsigned long)bits))
+		{
+			_BitScanForward(&index, (unsigned long)(bits >> 32));
+			index += 32;
+		}
+#endif	// (defined _M_X64 || defined _M_ARM64)
+		return (unsigned int)index;
+#else	// !_MSC_VER
+		return (unsigned int)__builtin_ctzll(bits);
+#endif	// _MSC_VER
+	}
+
+	// bits of precision dropped at each level
+	enum { ENTITY_PRECISION_BITS = 2, ENTITY_PRECISION_LEVEL_BITS = 2 };
+
+	// quantize and write three values of field, dropping low bits
+	template<typename codec>
+	inline void EntityWriteField(RakNet::BitStream& bitstream, std::vector<float> const component[3], unsigned int const slot, unsigned int const drop)
+	{
+		WriteBitsValue(bitstream, codec::Quantize(component[0][slot]) >> drop, codec::bits - drop);
+		WriteBitsValue(bitstream, codec::Quantize(component[1][slot]) >> drop, codec::bits - drop);
+		WriteBitsValue(bitstream, codec::Quantize(component[2][slot]) >> drop, codec::bits - drop);
+	}
+
+	// read and dequantize three values of field; dropped bits restore to
+	//	middle of range they covered
+	template<typename codec>
+	inline bool EntityReadField(RakNet::BitStream& bitstream, std::vector<float> component[3], unsigned int const slot, unsigned int const drop)
+	{
+		unsigned int const middle = drop ? (1u << (drop - 1)) : 0u;
+		unsigned int value[3];
+		if (ReadBitsValue(bitstream, value[0], codec::bits - drop) &&
+			ReadBitsValue(bitstream, value[1], codec::bits - drop) &&
+			ReadBitsValue(bitstream, value[2], codec::bits - drop))
+		{
+			component[0][slot] = codec::Dequantize((value[0] << drop) | middle);
+			component[1][slot] = codec::Dequantize((value[1] << drop) | middle);
+			component[2][slot] = codec::Dequantize((value[2] << drop) | middle);
+			return true;
+		}
+		return false;
+	}
+
+
+	void cEntityStore::AddSlot(unsigned int const id, sSpatialPose const& pose)
+	{
+		unsigned int const slot = (unsigned int)slotID.size();
+		unsigned int const word = slot / 64;
+		unsigned long long const bit = 1ull << (slot % 64);
+		unsigned int field, axis;
+		float const* const value[ENTITY_FIELD_COUNT] = { pose.scale, pose.rotate, pose.translate };
+
+		for (field = 0; field < ENTITY_FIELD_COUNT; ++field)
+			for (axis = 0; axis < 3; ++axis)
+				component[field][axis].push_back(value[field][axis]);
+		for (field = 0; field <= ENTITY_FIELD_COUNT; ++field)
+		{
+			if (word >= dirty[field].size())
+				dirty[field].push_back(0);
+			dirty[field][word] |= bit;
+		}
+		slotID.push_back(id);
+		if (id >= idSlot.size())
+			idSlot.resize(id + 1, (unsigned int)ENTITY_INVALID);
+		idSlot[id] = slot;
+	}
+
+	void cEntityStore::RemoveSlot(unsigned int const slot)
+	{
+		unsigned int const last = (unsigned int)slotID.size() - 1;
+		unsigned int field, axis;
+
+		idSlot[slotID[slot]] = (unsigned int)ENTITY_INVALID;
+		if (slot != last)
+		{
+			for (field = 0; field < ENTITY_FIELD_COUNT; ++field)
+				for (axis = 0; axis < 3; ++axis)
+					component[field][axis][slot] = component[field][axis][last];
+			for (field = 0; field <= ENTITY_FIELD_COUNT; ++field)
+			{
+				unsigned long long& word = dirty[field][slot / 64];
+				word &= ~(1ull << (slot % 64));
+				word |= ((dirty[field][last / 64] >> (last % 64)) & 1ull) << (slot % 64);
+			}
+			slotID[slot] = slotID[last];
+			idSlot[slotID[slot]] = slot;
+		}
+		for (field = 0; field < ENTITY_FIELD_COUNT; ++field)
+			for (axis = 0; axis < 3; ++axis)
+				component[field][axis].pop_back();
+		for (field = 0; field <= ENTITY_FIELD_COUNT; ++field)
+		{
+			dirty[field][last / 64] &= ~(1ull << (last % 64));
+			dirty[field].resize((last + 63) / 64);
+		}
+		slotID.pop_back();
+	}
+
+	void cEntityStore::WriteSlot(RakNet::BitStream& bitstream, unsigned int const slot, unsigned int const mask, eEntityPrecision const precision) const
+	{
+		unsigned int const drop = (unsigned int)precision * ENTITY_PRECISION_BITS;
+		WriteBitsValue(bitstream, slotID[slot], ENTITY_ID_BITS);
+		WriteBitsValue(bitstream, mask, ENTITY_FIELD_COUNT);
+		if (mask & (1u << ENTITY_FIELD_SCALE))
+			EntityWriteField<sSpatialPoseScaleCodec>(bitstream, component[ENTITY_FIELD_SCALE], slot, drop);
+		if (mask & (1u << ENTITY_FIELD_ROTATE))
+			EntityWriteField<sSpatialPoseRotateCodec>(bitstream, component[ENTITY_FIELD_ROTATE], slot, drop);
+		if (mask & (1u << ENTITY_FIELD_TRANSLATE))
+			EntityWriteField<sSpatialPoseTranslateCodec>(bitstream, component[ENTITY_FIELD_TRANSLATE], slot, drop);
+	}
+
+	unsigned int cEntityStore::Create(sSpatialPose const& pose)
+	{
+		unsigned int id;
+		if (!freeID.empty())
+		{
+			id = freeID.back();
+			freeID.pop_back();
+		}
+		else if (idSlot.size() < ENTITY_ID_MAX)
+			id = (unsigned int)idSlot.size();
+		else
+			return (unsigned int)ENTITY_INVALID;
+		AddSlot(id, pose);
+		return id;
+	}
+
+	bool cEntityStore::Destroy(unsigned int const id)
+	{
+		unsigned int const slot = GetSlot(id);
+		if (slot != (unsigned int)ENTITY_INVALID)
+		{
+			// identifier is not reused until peers have been told
+			RemoveSlot(slot);
+			destroyed.push_back(id);
+			return true;
+		}
+		return false;
+	}
+
+	void cEntityStore::Clear()
+	{
+		unsigned int field, axis;
+		for (field = 0; field < ENTITY_FIELD_COUNT; ++field)
+			for (axis = 0; axis < 3; ++axis)
+				component[field][axis].clear();
+		for (field = 0; field <= ENTITY_FIELD_COUNT; ++field)
+			dirty[field].clear();
+		slotID.clear();
+		idSlot.clear();
+		freeID.clear();
+		destroyed.clear();
+	}
+
+	unsigned int cEntityStore::GetCount() const
+	{
+		return (unsigned int)slotID.size();
+	}
+
+	unsigned int cEntityStore::GetSlot(unsigned int const id) const
+	{
+		return id < idSlot.size() ? idSlot[id] : (unsigned int)ENTITY_INVALID;
+	}
+
+	unsigned int cEntityStore::GetID(unsigned int const slot) const
+	{
+		return slotID[slot];
+	}
+
+	bool cEntityStore::GetPose(unsigned int const id, sSpatialPose& pose_out) const
+	{
+		unsigned int const slot = GetSlot(id);
+		unsigned int axis;
+		if (slot != (unsigned int)ENTITY_INVALID)
+		{
+			for (axis = 0; axis < 3; ++axis)
+			{
+				pose_out.scale[axis] = component[ENTITY_FIELD_SCALE][axis][slot];
+				pose_out.rotate[axis] = component[ENTITY_FIELD_ROTATE][axis][slot];
+				pose_out.translate[axis] = component[ENTITY_FIELD_TRANSLATE][axis][slot];
+			}
+			return true;
+		}
+		return false;
+	}
+
+	bool cEntityStore::SetPose(unsigned int const id, sSpatialPose const& pose)
+	{
+		return SetField(id, ENTITY_FIELD_SCALE, pose.scale) &&
+			SetField(id, ENTITY_FIELD_ROTATE, pose.rotate) &&
+			SetField(id, ENTITY_FIELD_TRANSLATE, pose.translate);
+	}
+
+	bool cEntityStore::SetField(unsigned int const id, eEntityField const field, float const value[3])
+	{
+		unsigned int const slot = GetSlot(id);
+		unsigned int axis;
+		bool changed = false;
+		if (slot != (unsigned int)ENTITY_INVALID)
+		{
+			for (axis = 0; axis < 3; ++axis)
+				if (component[field][axis][slot] != value[axis])
+				{
+					component[field][axis][slot] = value[axis];
+					changed = true;
+				}
+			if (changed)
+				MarkDirty(slot, field);
+			return true;
+		}
+		return false;
+	}
+
+	float* cEntityStore::GetComponent(eEntityField const field, unsigned int const axis)
+	{
+		return component[field][axis].data();
+	}
+
+	float const* cEntityStore::GetComponent(eEntityField const field, unsigned int const axis) const
+	{
+		return component[field][axis].data();
+	}
+
+	void cEntityStore::MarkDirty(unsigned int const slot, eEntityField const field)
+	{
+		unsigned long long const bit = 1ull << (slot % 64);
+		dirty[field][slot / 64] |= bit;
+		dirty[ENTITY_FIELD_COUNT][slot / 64] |= bit;
+	}
+
+	bool cEntityStore::IsDirty(unsigned int const slot) const
+	{
+		return ((dirty[ENTITY_FIELD_COUNT][slot / 64] >> (slot % 64)) & 1ull) != 0;
+	}
+
+	void cEntityStore::ClearDirty()
+	{
+		unsigned int field;
+		for (field = 0; field <= ENTITY_FIELD_COUNT; ++field)
+			std::fill(dirty[field].begin(), dirty[field].end(), 0ull);
+	}
+
+	unsigned int cEntityStore::GetDirtyCount() const
+	{
+		std::vector<unsigned long long> const& any = dirty[ENTITY_FIELD_COUNT];
+		unsigned int count = 0;
+		size_t i;
+		for (i = 0; i < any.size(); ++i)
+		{
+			unsigned long long bits = any[i];
+			for (; bits; bits &= bits - 1)
+				++count;
+		}
+		return count;
+	}
+
+	unsigned int cEntityStore::WriteDirty(RakNet::BitStream& bitstream, eEntityPrecision const precision)
+	{
+		std::vector<unsigned long long>& any = dirty[ENTITY_FIELD_COUNT];
+		unsigned int const count = GetDirtyCount();
+		unsigned int slot, mask;
+		size_t i;
+
+		WriteBitsValue(bitstream, count, ENTITY_ID_BITS);
+		WriteBitsValue(bitstream, precision, ENTITY_PRECISION_LEVEL_BITS);
+		for (i = 0; i < any.size(); ++i)
+		{
+			unsigned long long bits = any[i];
+			for (; bits; bits &= bits - 1)
+			{
+				slot = (unsigned int)(i * 64) + EntityLowestBit(bits);
+				mask = (unsigned int)((dirty[ENTITY_FIELD_SCALE][i] >> (slot % 64)) & 1ull) |
+					(unsigned int)(((dirty[ENTITY_FIELD_ROTATE][i] >> (slot % 64)) & 1ull) << 1) |
+					(unsigned int)(((dirty[ENTITY_FIELD_TRANSLATE][i] >> (slot % 64)) & 1ull) << 2);
+				WriteSlot(bitstream, slot, mask, precision);
+			}
+			dirty[ENTITY_FIELD_SCALE][i] = dirty[ENTITY_FIELD_ROTATE][i] = dirty[ENTITY_FIELD_TRANSLATE][i] = any[i] = 0;
+		}
+		return count;
+	}
+
+	unsigned int cEntityStore::WriteAll(RakNet::BitStream& bitstream, eEntityPrecision const precision) const
+	{
+		unsigned int const count = GetCount();
+		unsigned int slot;
+		WriteBitsValue(bitstream, count, ENTITY_ID_BITS);
+		WriteBitsValue(bitstream, precision, ENTITY_PRECISION_LEVEL_BITS);
+		for (slot = 0; slot < count; ++slot)
+			WriteSlot(bitstream, slot, (1u << ENTITY_FIELD_COUNT) - 1, precision);
+		return count;
+	}
+
+	unsigned int cEntityStore::CollectDirty(std::vector<unsigned int>& id_out, std::vector<unsigned char>& mask_out)
+	{
+		std::vector<unsigned long long>& any = dirty[ENTITY_FIELD_COUNT];
+		unsigned int count = 0, slot;
+		size_t i;
+		for (i = 0; i < any.size(); ++i)
+		{
+			unsigned long long bits = any[i];
+			for (; bits; bits &= bits - 1, ++count)
+			{
+				slot = (unsigned int)(i * 64) + EntityLowestBit(bits);
+				id_out.push_back(slotID[slot]);
+				mask_out.push_back((unsigned char)(((dirty[ENTITY_FIELD_SCALE][i] >> (slot % 64)) & 1ull) |
+					(((dirty[ENTITY_FIELD_ROTATE][i] >> (slot % 64)) & 1ull) << 1) |
+					(((dirty[ENTITY_FIELD_TRANSLATE][i] >> (slot % 64)) & 1ull) << 2)));
+			}
+			dirty[ENTITY_FIELD_SCALE][i] = dirty[ENTITY_FIELD_ROTATE][i] = dirty[ENTITY_FIELD_TRANSLATE][i] = any[i] = 0;
+		}
+		return count;
+	}
+
+	unsigned int cEntityStore::WriteMasked(RakNet::BitStream& bitstream, unsigned int const id[], unsigned char const mask[], unsigned int const count, eEntityPrecision const precision) const
+	{
+		unsigned int written = 0, i, slot;
+		for (i = 0; i < count; ++i)
+			if (mask[i] && GetSlot(id[i]) != (unsigned int)ENTITY_INVALID)
+				++written;
+		WriteBitsValue(bitstream, written, ENTITY_ID_BITS);
+		WriteBitsValue(bitstream, precision, ENTITY_PRECISION_LEVEL_BITS);
+		for (i = 0; i < count; ++i)
+			if (mask[i] && (slot = GetSlot(id[i])) != (unsigned int)ENTITY_INVALID)
+				WriteSlot(bitstream, slot, mask[i], precision);
+		return written;
+	}
+
+	int cEntityStore::ReadDirty(RakNet::BitStream& bitstream)
+	{
+		sSpatialPose const identity = { { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+		unsigned int count, precision, drop, i, id, mask, slot;
+		if (!ReadBitsValue(bitstream, count, ENTITY_ID_BITS) ||
+			!ReadBitsValue(bitstream, precision, ENTITY_PRECISION_LEVEL_BITS))
+			return -1;
+		drop = precision * ENTITY_PRECISION_BITS;
+		for (i = 0; i < count; ++i)
+		{
+			if (!ReadBitsValue(bitstream, id, ENTITY_ID_BITS) || id >= ENTITY_ID_MAX ||
+				!ReadBitsValue(bitstream, mask, ENTITY_FIELD_COUNT))
+				return -1;
+			if ((slot = GetSlot(id)) == (unsigned int)ENTITY_INVALID)
+			{
+				AddSlot(id, identity);
+				slot = GetSlot(id);
+			}
+			if (((mask & (1u << ENTITY_FIELD_SCALE)) && !EntityReadField<sSpatialPoseScaleCodec>(bitstream, component[ENTITY_FIELD_SCALE], slot, drop)) ||
+				((mask & (1u << ENTITY_FIELD_ROTATE)) && !EntityReadField<sSpatialPoseRotateCodec>(bitstream, component[ENTITY_FIELD_ROTATE], slot, drop)) ||
+				((mask & (1u << ENTITY_FIELD_TRANSLATE)) && !EntityReadField<sSpatialPoseTranslateCodec>(bitstream, component[ENTITY_FIELD_TRANSLATE], slot, drop)))
+				return -1;
+			if (mask & (1u << ENTITY_FIELD_SCALE))
+				MarkDirty(slot, ENTITY_FIELD_SCALE);
+			if (mask & (1u << ENTITY_FIELD_ROTATE))
+				MarkDirty(slot, ENTITY_FIELD_ROTATE);
+			if (mask & (1u << ENTITY_FIELD_TRANSLATE))
+				MarkDirty(slot, ENTITY_FIELD_TRANSLATE);
+		}
+		return (int)count;
+	}
+
+	unsigned int cEntityStore::GetDestroyedCount() const
+	{
+		return (unsigned int)destroyed.size();
+	}
+
+	unsigned int cEntityStore::WriteDestroyed(RakNet::BitStream& bitstream)
+	{
+		unsigned int const count = (unsigned int)destroyed.size();
+		unsigned int i;
+		WriteBitsValue(bitstream, count, ENTITY_ID_BITS);
+		for (i = 0; i < count; ++i)
+			WriteBitsValue(bitstream, destroyed[i], ENTITY_ID_BITS);
+
+		// peers know, identifiers may be reused
+		freeID.insert(freeID.end(), destroyed.begin(), destroyed.end());
+		destroyed.clear();
+		return count;
+	}
+
+	int cEntityStore::ReadDestroyed(RakNet::BitStream& bitstream)
+	{
+		unsigned int count, i, id, slot;
+		if (!ReadBitsValue(bitstream, count, ENTITY_ID_BITS))
+			return -1;
+		for (i = 0; i < count; ++i)
+		{
+			if (!ReadBitsValue(bitstream, id, ENTITY_ID_BITS))
+				return -1;
+			if ((slot = GetSlot(id)) != (unsigned int)ENTITY_INVALID)
+				RemoveSlot(slot);
+		}
+		return (int)count;
+	}
+
+	unsigned int cEntityStore::GetUpdateMaxBytes(unsigned int const count)
+	{
+		return ((unsigned int)ENTITY_ID_BITS + ENTITY_PRECISION_LEVEL_BITS +
+			count * ((unsigned int)ENTITY_ID_BITS + ENTITY_FIELD_COUNT + sSpatialPoseSchema::maxBits) + 7) / 8;
+	}
+
+	unsigned int cEntityStore::GetEntityBytes(unsigned int const mask, eEntityPrecision const precision)
+	{
+		unsigned int const drop = (unsigned int)precision * ENTITY_PRECISION_BITS;
+		unsigned int bits = (unsigned int)ENTITY_ID_BITS + ENTITY_FIELD_COUNT;
+		if (mask & (1u << ENTITY_FIELD_SCALE))
+			bits += 3 * (sSpatialPoseScaleCodec::bits - drop);
+		if (mask & (1u << ENTITY_FIELD_ROTATE))
+			bits += 3 * (sSpatialPoseRotateCodec::bits - drop);
+		if (mask & (1u << ENTITY_FIELD_TRANSLATE))
+			bits += 3 * (sSpatialPoseTranslateCodec::bits - drop);
+		return (bits + 7) / 8;
+	}
+
+	unsigned int cEntityStore::GetDestroyedMaxBytes(unsigned int const count)
+	{
+		return ((count + 1) * ENTITY_ID_BITS + 7) / 8;
+	}
+}
\ No newline at end of file
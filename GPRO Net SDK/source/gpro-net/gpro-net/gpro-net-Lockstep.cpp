@@ -0,0 +1,490 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Lockstep.cpp
+	Source for deterministic lockstep sessions of turn-based games.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Lockstep.hpp"
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-gamerules.h"
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-zobrist.h"
+
+#include <assert.h>
+#include <string.h>
+
+
+namespace gproNet
+{
+	// ships on a full battleship board: 2 + 3 + 3 + 4 + 5
+	enum { LOCKSTEP_BATTLESHIP_CELLS = 17 };
+
+	// mix of session counters, combined with board hash (splitmix64)
+	inline unsigned long long LockstepMix(unsigned long long value)
+	{
+		value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+		value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+		return value ^ (value >> 31);
+	}
+
+
+	cLockstepSession::cLockstepSession()
+	{
+		Start(LOCKSTEP_NONE);
+	}
+
+	void cLockstepSession::Start(eLockstepGame const game)
+	{
+		unsigned int i;
+		this->game = game;
+		sequence = 0;
+		turn = 0;
+		chain = false;
+		chainRow = chainCol = 0;
+		gpro_checkers_reset(checkers);
+		gpro_mancala_reset(mancala);
+		gpro_battleship_reset(battleship[0]);
+		gpro_battleship_reset(battleship[1]);
+		hasBoard[0] = hasBoard[1] = false;
+		for (i = 0; i < LOCKSTEP_HASH_HISTORY; ++i)
+			checkpointSequence[i] = ~0u;
+		HashBoards();
+		Checkpoint();
+	}
+
+	void cLockstepSession::HashBoards()
+	{
+		switch (game)
+		{
+		case LOCKSTEP_CHECKERS:
+			gpro_zobrist_board(checkers, sizeof(checkers), &boardHash[0]);
+			boardHash[1] = boardHash[0];
+			break;
+		case LOCKSTEP_MANCALA:
+			gpro_zobrist_board(mancala, sizeof(mancala), &boardHash[0]);
+			boardHash[1] = boardHash[0];
+			break;
+		case LOCKSTEP_BATTLESHIP:
+			gpro_zobrist_board(battleship[0], sizeof(gpro_battleship), &boardHash[0]);
+			gpro_zobrist_board(battleship[1], sizeof(gpro_battleship), &boardHash[1]);
+			break;
+		default:
+			boardHash[0] = boardHash[1] = 0;
+		}
+	}
+
+	int cLockstepSession::VerifyBoards() const
+	{
+		switch (game)
+		{
+		case LOCKSTEP_CHECKERS:
+			return gpro_zobrist_verify(checkers, sizeof(checkers), boardHash[0]);
+		case LOCKSTEP_MANCALA:
+			return gpro_zobrist_verify(mancala, sizeof(mancala), boardHash[0]);
+		case LOCKSTEP_BATTLESHIP:
+			if (gpro_zobrist_verify(battleship[0], sizeof(gpro_battleship), boardHash[0]) < 0)
+				return -2;
+			return gpro_zobrist_verify(battleship[1], sizeof(gpro_battleship), boardHash[1]);
+		default:
+			return 0;
+		}
+	}
+
+	int cLockstepSession::SetBoard(unsigned char const player, gpro_battleship const board)
+	{
+		if (game == LOCKSTEP_BATTLESHIP && player < 2 && board)
+		{
+			gpro_battleship placed;
+			unsigned int r, c;
+			if (sequence)
+				return -2;
+			for (r = 0; r < 10; ++r)
+				for (c = 0; c < 10; ++c)
+					placed[r][c] = (unsigned char)gpro_flag_check(board[r][c], gpro_battleship_ship);
+			if (gpro_battleship_validate(placed) < 0)
+				return -2;
+			memcpy(battleship[player], placed, sizeof(placed));
+			hasBoard[player] = true;
+			HashBoards();
+			Checkpoint();
+			return 0;
+		}
+		return -1;
+	}
+
+	int cLockstepSession::Apply(sLockstepMove& move)
+	{
+		int result;
+		if (move.player > 1)
+			return -1;
+		if (move.player != turn || IsOver())
+			return -2;
+		switch (game)
+		{
+		case LOCKSTEP_CHECKERS:
+			if (move.a >= 8 || move.b >= 4 || move.c >= 8 || move.d >= 4)
+				return -1;
+		{
+			// only moved piece, destination and jumped piece change
+			unsigned int const from = move.a * 4u + move.b, to = move.c * 4u + move.d;
+			unsigned int const jumped = (move.a + move.c) / 2 * 4u + (move.b * 2 + (move.a & 1) + move.d * 2 + (move.c & 1)) / 4;
+			unsigned char* const cell = &checkers[0][0];
+			unsigned char const before[3] = { cell[from], cell[to], cell[jumped] };
+
+			// piece that jumped must keep jumping
+			if (chain && (move.a != chainRow || move.b != chainCol))
+				return -2;
+			result = gpro_checkers_move(checkers, move.player ? gpro_checkers_player2 : gpro_checkers_player1, move.a, move.b, move.c, move.d);
+			if (result < 0)
+				return result;
+			gpro_zobrist_cell(&boardHash[0], from, before[0], cell[from]);
+			gpro_zobrist_cell(&boardHash[0], to, before[1], cell[to]);
+			if (jumped != from && jumped != to)
+				gpro_zobrist_cell(&boardHash[0], jumped, before[2], cell[jumped]);
+			boardHash[1] = boardHash[0];
+			chain = (result > 0);
+			chainRow = move.c;
+			chainCol = move.d;
+			if (!chain)
+				turn ^= 1;
+		}	break;
+		case LOCKSTEP_MANCALA:
+		{
+			// sowing can wrap around the board, so compare all cups
+			gpro_mancala before;
+			memcpy(before, mancala, sizeof(mancala));
+			result = gpro_mancala_move(mancala, move.player, move.a);
+			if (result < 0)
+				return result;
+			gpro_zobrist_range(&boardHash[0], 0, &before[0][0], &mancala[0][0], sizeof(mancala));
+			boardHash[1] = boardHash[0];
+			if (!result)
+				turn ^= 1;
+		}	break;
+		case LOCKSTEP_BATTLESHIP:
+		{
+			unsigned char const attacker = move.player, defender = move.player ^ 1;
+			if (move.a >= 10 || move.b >= 10)
+				return -1;
+			if (!hasBoard[attacker] && !hasBoard[defender])
+				return -2;
+
+			// check both boards before changing either
+			if ((hasBoard[attacker] && gpro_flag_check(battleship[attacker][move.a][move.b], gpro_battleship_attack_rec)) ||
+				(hasBoard[defender] && gpro_flag_check(battleship[defender][move.a][move.b], gpro_battleship_damage)))
+				return -2;
+			if (hasBoard[defender])
+			{
+				unsigned char const before = battleship[defender][move.a][move.b];
+				gpro_battleship_defend(battleship[defender], move.a, move.b, &move.c);
+				gpro_zobrist_cell(&boardHash[defender], move.a * 10u + move.b, before, battleship[defender][move.a][move.b]);
+			}
+			if (hasBoard[attacker])
+			{
+				unsigned char const before = battleship[attacker][move.a][move.b];
+				if (gpro_battleship_record(battleship[attacker], move.a, move.b, move.c) < 0)
+					return -2;
+				gpro_zobrist_cell(&boardHash[attacker], move.a * 10u + move.b, before, battleship[attacker][move.a][move.b]);
+			}
+			turn ^= 1;
+		}	break;
+		default:
+			return -1;
+		}
+		++sequence;
+#ifdef _DEBUG
+		assert(VerifyBoards() == 0);
+#endif	// _DEBUG
+		if (IsCheck())
+			Checkpoint();
+		return 0;
+	}
+
+	void cLockstepSession::Checkpoint()
+	{
+		unsigned int const index = (sequence / LOCKSTEP_HASH_INTERVAL) % LOCKSTEP_HASH_HISTORY;
+		checkpoint[index][0] = Hash(0);
+		checkpoint[index][1] = Hash(1);
+		checkpointSequence[index] = sequence;
+	}
+
+	unsigned long long cLockstepSession::Hash(unsigned char const player) const
+	{
+		unsigned long long const counters = ((unsigned long long)sequence << 32) | ((unsigned long long)game << 16) |
+			((unsigned long long)turn << 8) | (unsigned long long)(chain ? 1 + chainRow * 4 + chainCol : 0);
+		return boardHash[player & 1] ^ LockstepMix(counters);
+	}
+
+	int cLockstepSession::VerifyHash(unsigned int const sequence, unsigned char const player, unsigned long long const hash) const
+	{
+		unsigned int const index = (sequence / LOCKSTEP_HASH_INTERVAL) % LOCKSTEP_HASH_HISTORY;
+		if (player > 1 || checkpointSequence[index] != sequence)
+			return +1;
+		return (checkpoint[index][player] == hash) ? 0 : -2;
+	}
+
+	bool cLockstepSession::IsOver() const
+	{
+		unsigned int r, c, p, count[2] = { 0 };
+		bool movable = chain;
+		switch (game)
+		{
+		case LOCKSTEP_CHECKERS:
+		{
+			// side to move loses with no pieces, or none that can step or jump
+			unsigned char const own = turn ? gpro_checkers_player2 : gpro_checkers_player1;
+			for (r = 0; r < 8; ++r)
+				for (c = 0; c < 4; ++c)
+				{
+					count[0] += gpro_flag_check(checkers[r][c], gpro_checkers_player1) ? 1 : 0;
+					count[1] += gpro_flag_check(checkers[r][c], gpro_checkers_player2) ? 1 : 0;
+					if (!movable && gpro_flag_check(checkers[r][c], own))
+						movable = (gpro_checkers_canMove(checkers, (unsigned char)r, (unsigned char)c) == 1);
+				}
+		}	return (!count[0] || !count[1] || !movable);
+		case LOCKSTEP_MANCALA:
+			return (gpro_mancala_over(mancala) == 1);
+		case LOCKSTEP_BATTLESHIP:
+			// own ships sunk, or all opponent ships hit
+			for (p = 0; p < 2; ++p)
+				if (hasBoard[p])
+				{
+					if (gpro_battleship_lost(battleship[p]) == 1)
+						return true;
+					for (r = 0; r < 10; ++r)
+						for (c = 0; c < 10; ++c)
+							count[p] += gpro_flag_check(battleship[p][r][c], gpro_battleship_hit) ? 1 : 0;
+					if (count[p] == LOCKSTEP_BATTLESHIP_CELLS)
+						return true;
+				}
+			return false;
+		default:
+			return false;
+		}
+	}
+
+	bool cLockstepSession::IsCheck() const
+	{
+		return (sequence % LOCKSTEP_HASH_INTERVAL == 0);
+	}
+
+	eLockstepGame cLockstepSession::GetGame() const
+	{
+		return game;
+	}
+
+	unsigned int cLockstepSession::GetSequence() const
+	{
+		return sequence;
+	}
+
+	unsigned char cLockstepSession::GetTurn() const
+	{
+		return turn;
+	}
+
+	bool cLockstepSession::HasBoard(unsigned char const player) const
+	{
+		return (player < 2 && hasBoard[player]);
+	}
+
+	gpro_checkers const& cLockstepSession::GetCheckers() const
+	{
+		return checkers;
+	}
+
+	gpro_mancala const& cLockstepSession::GetMancala() const
+	{
+		return mancala;
+	}
+
+	gpro_battleship const& cLockstepSession::GetBattleship(unsigned char const player) const
+	{
+		return battleship[player & 1];
+	}
+
+	RakNet::BitStream& cLockstepSession::WriteMove(RakNet::BitStream& bitstream, sLockstepMove const& move) const
+	{
+		WriteBitsValue(bitstream, move.player, 1);
+		switch (game)
+		{
+		case LOCKSTEP_CHECKERS:
+			WriteBitsValue(bitstream, move.a, 3);
+			WriteBitsValue(bitstream, move.b, 2);
+			WriteBitsValue(bitstream, move.c, 3);
+			WriteBitsValue(bitstream, move.d, 2);
+			break;
+		case LOCKSTEP_MANCALA:
+			WriteBitsValue(bitstream, move.a, 3);
+			break;
+		case LOCKSTEP_BATTLESHIP:
+			WriteBitsValue(bitstream, move.a, 4);
+			WriteBitsValue(bitstream, move.b, 4);
+			WriteBitsValue(bitstream, move.c, 2);
+			break;
+		default:
+			break;
+		}
+		return bitstream;
+	}
+
+	bool cLockstepSession::ReadMove(RakNet::BitStream& bitstream, sLockstepMove& move_out) const
+	{
+		unsigned int player, a = 0, b = 0, c = 0, d = 0;
+		bool result = ReadBitsValue(bitstream, player, 1);
+		switch (game)
+		{
+		case LOCKSTEP_CHECKERS:
+			result = result && ReadBitsValue(bitstream, a, 3) && ReadBitsValue(bitstream, b, 2) &&
+				ReadBitsValue(bitstream, c, 3) && ReadBitsValue(bitstream, d, 2);
+			break;
+		case LOCKSTEP_MANCALA:
+			result = result && ReadBitsValue(bitstream, a, 3);
+			break;
+		case LOCKSTEP_BATTLESHIP:
+			result = result && ReadBitsValue(bitstream, a, 4) && ReadBitsValue(bitstream, b, 4) &&
+				ReadBitsValue(bitstream, c, 2);
+			break;
+		default:
+			return false;
+		}
+		move_out.player = (unsigned char)player;
+		move_out.a = (unsigned char)a;
+		move_out.b = (unsigned char)b;
+		move_out.c = (unsigned char)c;
+		move_out.d = (unsigned char)d;
+		return result;
+	}
+
+	RakNet::BitStream& cLockstepSession::WriteState(RakNet::BitStream& bitstream, unsigned char const player) const
+	{
+		WriteBitsValue(bitstream, game, 2);
+		bitstream.Write(sequence);
+		WriteBitsValue(bitstream, turn, 1);
+		WriteBitsValue(bitstream, chain ? 1 : 0, 1);
+		WriteBitsValue(bitstream, chainRow, 3);
+		WriteBitsValue(bitstream, chainCol, 2);
+		switch (game)
+		{
+		case LOCKSTEP_CHECKERS:
+			bitstream.WriteBits((unsigned char const*)checkers, sizeof(checkers) * 8, true);
+			break;
+		case LOCKSTEP_MANCALA:
+			bitstream.WriteBits((unsigned char const*)mancala, sizeof(mancala) * 8, true);
+			break;
+		case LOCKSTEP_BATTLESHIP:
+			bitstream.WriteBits((unsigned char const*)battleship[player & 1], sizeof(gpro_battleship) * 8, true);
+			break;
+		default:
+			break;
+		}
+		return bitstream;
+	}
+
+	bool cLockstepSession::ReadState(RakNet::BitStream& bitstream, unsigned char const player)
+	{
+		unsigned int game, turn, chain, chainRow, chainCol, sequence;
+		bool result = ReadBitsValue(bitstream, game, 2) && bitstream.Read(sequence) &&
+			ReadBitsValue(bitstream, turn, 1) && ReadBitsValue(bitstream, chain, 1) &&
+			ReadBitsValue(bitstream, chainRow, 3) && ReadBitsValue(bitstream, chainCol, 2);
+		if (!result || game == LOCKSTEP_NONE || player > 1)
+			return false;
+		Start((eLockstepGame)game);
+		switch (game)
+		{
+		case LOCKSTEP_CHECKERS:
+			result = bitstream.ReadBits((unsigned char*)checkers, sizeof(checkers) * 8, true);
+			break;
+		case LOCKSTEP_MANCALA:
+			result = bitstream.ReadBits((unsigned char*)mancala, sizeof(mancala) * 8, true);
+			break;
+		case LOCKSTEP_BATTLESHIP:
+			result = bitstream.ReadBits((unsigned char*)battleship[player], sizeof(gpro_battleship) * 8, true);
+			hasBoard[player] = true;
+			break;
+		}
+		this->sequence = sequence;
+		this->turn = (unsigned char)turn;
+		this->chain = (chain != 0);
+		this->chainRow = (unsigned char)chainRow;
+		this->chainCol = (unsigned char)chainCol;
+		HashBoards();
+		Checkpoint();
+		return result;
+	}
+
+	void cLockstepSession::Save(sLockstepRecord& record_out) const
+	{
+		record_out.sequence = sequence;
+		record_out.game = (unsigned char)game;
+		record_out.turn = turn;
+		record_out.chain = chain ? 1 : 0;
+		record_out.chainRow = chainRow;
+		record_out.chainCol = chainCol;
+		record_out.hasBoard[0] = hasBoard[0] ? 1 : 0;
+		record_out.hasBoard[1] = hasBoard[1] ? 1 : 0;
+		record_out.reserved = 0;
+		memcpy(record_out.checkers, checkers, sizeof(checkers));
+		memcpy(record_out.mancala, mancala, sizeof(mancala));
+		memcpy(record_out.battleship, battleship, sizeof(battleship));
+	}
+
+	bool cLockstepSession::Load(sLockstepRecord const& record)
+	{
+		if (record.game >= LOCKSTEP_GAME_COUNT || record.turn > 1)
+			return false;
+		Start((eLockstepGame)record.game);
+		sequence = record.sequence;
+		turn = record.turn;
+		chain = (record.chain != 0);
+		chainRow = record.chainRow;
+		chainCol = record.chainCol;
+		hasBoard[0] = (record.hasBoard[0] != 0);
+		hasBoard[1] = (record.hasBoard[1] != 0);
+		memcpy(checkers, record.checkers, sizeof(checkers));
+		memcpy(mancala, record.mancala, sizeof(mancala));
+		memcpy(battleship, record.battleship, sizeof(battleship));
+		HashBoards();
+		Checkpoint();
+		return true;
+	}
+
+	RakNet::BitStream& cLockstepSession::WriteBoard(RakNet::BitStream& bitstream, gpro_battleship const board)
+	{
+		// ship flags only, in 5 bits per cell
+		unsigned int r, c;
+		for (r = 0; r < 10; ++r)
+			for (c = 0; c < 10; ++c)
+				WriteBitsValue(bitstream, gpro_flag_check(board[r][c], gpro_battleship_ship) >> 3, 5);
+		return bitstream;
+	}
+
+	bool cLockstepSession::ReadBoard(RakNet::BitStream& bitstream, gpro_battleship board_out)
+	{
+		unsigned int r, c, value;
+		for (r = 0; r < 10; ++r)
+			for (c = 0; c < 10; ++c)
+			{
+				if (!ReadBitsValue(bitstream, value, 5))
+					return false;
+				board_out[r][c] = (unsigned char)(value << 3);
+			}
+		return true;
+	}
+}
\ No newline at end of file
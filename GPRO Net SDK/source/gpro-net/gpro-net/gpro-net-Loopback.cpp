@@ -0,0 +1,397 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Loopback.cpp
+	Source for in-process loopback transport.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Loopback.hpp"
+
+#include <string.h>
+
+#include "RakNet/MessageIdentifiers.h"
+
+
+namespace gproNet
+{
+	// first port handed out to transports started on port 0
+	enum { LOOPBACK_EPHEMERAL_PORT = 49152 };
+
+
+	cLoopbackNetwork::cLoopbackNetwork(bool const manualClock)
+		: time(0), manualClock(manualClock), sequence(0), nextPort(LOOPBACK_EPHEMERAL_PORT)
+	{
+	}
+
+	cTransportLoopback* cLoopbackNetwork::FindEndpoint(unsigned short const port) const
+	{
+		size_t i;
+		for (i = 0; i < endpoints.size(); ++i)
+			if (endpoints[i]->port == port)
+				return endpoints[i];
+		return 0;
+	}
+
+	RakNet::Time cLoopbackNetwork::GetTime()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return manualClock ? time : RakNet::GetTime();
+	}
+
+	void cLoopbackNetwork::Advance(RakNet::Time const dt)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		time += dt;
+	}
+
+
+	bool cTransportLoopback::sQueuedPacket::operator >(sQueuedPacket const& rh) const
+	{
+		return (tDeliver > rh.tDeliver) || (tDeliver == rh.tDeliver && sequence > rh.sequence);
+	}
+
+
+	cTransportLoopback::cTransportLoopback(cLoopbackNetwork& network, RakNet::Time const latency)
+		: network(network), latency(latency), loss(0.0f), resend(0), tReliable(0), port(0), maxConnections(0), maxIncoming(0)
+	{
+	}
+
+	cTransportLoopback::~cTransportLoopback()
+	{
+		Shutdown();
+	}
+
+	void cTransportLoopback::SetLatency(RakNet::Time const latency)
+	{
+		std::lock_guard<std::mutex> lock(network.mutex);
+		this->latency = latency;
+	}
+
+	void cTransportLoopback::SetLoss(float const loss, RakNet::Time const resend)
+	{
+		std::lock_guard<std::mutex> lock(network.mutex);
+		this->loss = loss < 0.0f ? 0.0f : loss < 0.99f ? loss : 0.99f;
+		this->resend = resend;
+		lossRandom.seed(port ? port : 1);
+	}
+
+	bool cTransportLoopback::Cut(RakNet::SystemAddress const address, RakNet::Time const timeout)
+	{
+		std::lock_guard<std::mutex> lock(network.mutex);
+		int const i = IsConnected(address.GetPort());
+		if (i >= 0)
+		{
+			// nothing more gets through, each side times out on its own
+			RakNet::MessageID const msgID = ID_CONNECTION_LOST;
+			unsigned short const peer = connections[i];
+			cTransportLoopback* const target = network.FindEndpoint(peer);
+			int j;
+			RemoveConnection(i);
+			Deliver(this, peer, &msgID, sizeof(msgID), timeout > latency ? timeout - latency : 0);
+			if (target && (j = target->IsConnected(port)) >= 0)
+			{
+				target->RemoveConnection(j);
+				target->Deliver(target, port, &msgID, sizeof(msgID), timeout > target->latency ? timeout - target->latency : 0);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	bool cTransportLoopback::Lose(bool const reliable, RakNet::Time& delay_out)
+	{
+		std::uniform_real_distribution<float> roll(0.0f, 1.0f);
+		delay_out = 0;
+		if (loss > 0.0f)
+		{
+			if (!reliable)
+				return (roll(lossRandom) < loss);
+			while (roll(lossRandom) < loss)
+				delay_out += resend;
+		}
+		return false;
+	}
+
+	unsigned short cTransportLoopback::GetPort() const
+	{
+		return port;
+	}
+
+	void cTransportLoopback::Deliver(cTransportLoopback* const target, unsigned short const sender, unsigned char const* const data, unsigned int const length, RakNet::Time const delay)
+	{
+		sQueuedPacket queued;
+		RakNet::Packet* const packet = new RakNet::Packet;
+		packet->systemAddress = RakNet::SystemAddress("127.0.0.1", sender);
+		packet->guid = RakNet::RakNetGUID(sender);
+		packet->length = length;
+		packet->bitSize = length * 8;
+		packet->data = new unsigned char[length];
+		packet->deleteData = true;
+		packet->wasGeneratedLocally = false;
+		memcpy(packet->data, data, length);
+
+		queued.tDeliver = (network.manualClock ? network.time : RakNet::GetTime()) + latency + delay;
+		queued.sequence = network.sequence++;
+		queued.packet = packet;
+		target->inbox.push(queued);
+	}
+
+	void cTransportLoopback::DeliverID(cTransportLoopback* const target, RakNet::MessageID const msgID, RakNet::Time const delay)
+	{
+		Deliver(target, port, &msgID, sizeof(msgID), delay);
+	}
+
+	int cTransportLoopback::IsConnected(unsigned short const port) const
+	{
+		size_t i;
+		for (i = 0; i < connections.size(); ++i)
+			if (connections[i] == port)
+				return (int)i;
+		return -1;
+	}
+
+	unsigned int cTransportLoopback::GetIncomingCount() const
+	{
+		unsigned int count = 0;
+		size_t i;
+		for (i = 0; i < incoming.size(); ++i)
+			count += incoming[i] ? 1 : 0;
+		return count;
+	}
+
+	void cTransportLoopback::RemoveConnection(int const index)
+	{
+		connections.erase(connections.begin() + index);
+		incoming.erase(incoming.begin() + index);
+	}
+
+	bool cTransportLoopback::Startup(unsigned short const maxConnections, unsigned short const maxIncoming, unsigned short const port)
+	{
+		std::lock_guard<std::mutex> lock(network.mutex);
+		if (this->port == 0)
+		{
+			unsigned short bind = port;
+			if (!bind)
+				while (network.FindEndpoint(bind = network.nextPort++) || !bind);
+			if (!network.FindEndpoint(bind))
+			{
+				this->port = bind;
+				this->maxConnections = maxConnections;
+				this->maxIncoming = maxIncoming;
+				network.endpoints.push_back(this);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool cTransportLoopback::Connect(char const /*host*/[], unsigned short const port)
+	{
+		// host is ignored, every endpoint lives on the same machine
+		std::lock_guard<std::mutex> lock(network.mutex);
+		if (this->port != 0 && this->port != port && IsConnected(port) < 0)
+		{
+			cTransportLoopback* const target = network.FindEndpoint(port);
+			if (!target || connections.size() >= maxConnections)
+			{
+				// nobody listening, or we are full
+				RakNet::MessageID const msgID = ID_CONNECTION_ATTEMPT_FAILED;
+				Deliver(this, port, &msgID, sizeof(msgID));
+			}
+			else if (target->GetIncomingCount() >= target->maxIncoming || target->connections.size() >= target->maxConnections)
+			{
+				// remote is full
+				target->DeliverID(this, ID_NO_FREE_INCOMING_CONNECTIONS);
+			}
+			else
+			{
+				// connect both sides, each hears about it after one trip;
+				//	lost handshakes are retried like reliable packets
+				RakNet::Time delay;
+				connections.push_back(port);
+				incoming.push_back(false);
+				target->connections.push_back(this->port);
+				target->incoming.push_back(true);
+				Lose(true, delay);
+				DeliverID(target, ID_NEW_INCOMING_CONNECTION, delay);
+				target->DeliverID(this, ID_CONNECTION_REQUEST_ACCEPTED, delay);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void cTransportLoopback::Disconnect(RakNet::SystemAddress const address)
+	{
+		std::lock_guard<std::mutex> lock(network.mutex);
+		int const i = IsConnected(address.GetPort());
+		if (i >= 0)
+		{
+			cTransportLoopback* const target = network.FindEndpoint(connections[i]);
+			int j;
+			RemoveConnection(i);
+			if (target && (j = target->IsConnected(port)) >= 0)
+			{
+				target->RemoveConnection(j);
+				DeliverID(target, ID_DISCONNECTION_NOTIFICATION);
+			}
+		}
+	}
+
+	void cTransportLoopback::Shutdown()
+	{
+		std::lock_guard<std::mutex> lock(network.mutex);
+		if (port != 0)
+		{
+			size_t i;
+			int j;
+
+			// tell peers we are leaving
+			for (i = 0; i < connections.size(); ++i)
+			{
+				cTransportLoopback* const target = network.FindEndpoint(connections[i]);
+				if (target && (j = target->IsConnected(port)) >= 0)
+				{
+					target->RemoveConnection(j);
+					DeliverID(target, ID_DISCONNECTION_NOTIFICATION);
+				}
+			}
+			connections.clear();
+			incoming.clear();
+
+			// leave network and drop anything not yet received
+			for (i = 0; i < network.endpoints.size(); ++i)
+				if (network.endpoints[i] == this)
+					network.endpoints.erase(network.endpoints.begin() + i--);
+			while (!inbox.empty())
+			{
+				RakNet::Packet* const packet = inbox.top().packet;
+				inbox.pop();
+				delete[] packet->data;
+				delete packet;
+			}
+			port = 0;
+		}
+	}
+
+	RakNet::Packet* cTransportLoopback::Receive()
+	{
+		std::lock_guard<std::mutex> lock(network.mutex);
+		if (!inbox.empty())
+		{
+			RakNet::Time const now = network.manualClock ? network.time : RakNet::GetTime();
+			if (inbox.top().tDeliver <= now)
+			{
+				RakNet::Packet* const packet = inbox.top().packet;
+				inbox.pop();
+				return packet;
+			}
+		}
+		return 0;
+	}
+
+	void cTransportLoopback::DeallocatePacket(RakNet::Packet* packet)
+	{
+		if (packet)
+		{
+			delete[] packet->data;
+			delete packet;
+		}
+	}
+
+	unsigned int cTransportLoopback::Send(RakNet::BitStream const* bitstream, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::AddressOrGUID const recipient, bool const broadcast)
+	{
+		if (bitstream)
+			return Send(bitstream->GetData(), bitstream->GetNumberOfBytesUsed(), priority, reliability, orderingChannel, recipient, broadcast);
+		return 0;
+	}
+
+	unsigned int cTransportLoopback::Send(unsigned char const data[], unsigned int const length, PacketPriority const /*priority*/, PacketReliability const reliability, char const /*orderingChannel*/, RakNet::AddressOrGUID const recipient, bool const broadcast)
+	{
+		// priority and channel have no effect; reliability only matters
+		//	when packets are lost
+		std::lock_guard<std::mutex> lock(network.mutex);
+		if (port != 0 && data)
+		{
+			unsigned short const target = (recipient.rakNetGuid != RakNet::UNASSIGNED_RAKNET_GUID) ?
+				(unsigned short)recipient.rakNetGuid.g : recipient.systemAddress.GetPort();
+			unsigned int const number = network.sequence;
+			bool const reliable = (reliability != UNRELIABLE && reliability != UNRELIABLE_SEQUENCED && reliability != UNRELIABLE_WITH_ACK_RECEIPT);
+			RakNet::Time const now = network.manualClock ? network.time : RakNet::GetTime();
+			RakNet::Time delay;
+			size_t i;
+			if (!broadcast && IsConnected(target) < 0)
+				return 0;
+			if (Lose(reliable, delay))
+				return (number + 1);
+
+			// resent packet holds back every reliable one after it
+			if (reliable)
+			{
+				if (now + latency + delay < tReliable)
+					delay = tReliable - now - latency;
+				tReliable = now + latency + delay;
+			}
+			if (broadcast)
+			{
+				// everyone except recipient
+				for (i = 0; i < connections.size(); ++i)
+					if (connections[i] != target)
+						Deliver(network.FindEndpoint(connections[i]), port, data, length, delay);
+			}
+			else
+				Deliver(network.FindEndpoint(target), port, data, length, delay);
+			return (number + 1);
+		}
+		return 0;
+	}
+
+	unsigned short cTransportLoopback::GetConnections(RakNet::SystemAddress list_out[], unsigned short const max)
+	{
+		std::lock_guard<std::mutex> lock(network.mutex);
+		unsigned short count;
+		for (count = 0; count < max && count < connections.size(); ++count)
+			list_out[count] = RakNet::SystemAddress("127.0.0.1", connections[count]);
+		return count;
+	}
+
+	unsigned long long cTransportLoopback::GetGUID(RakNet::SystemAddress const address)
+	{
+		// transport keeps its port when it reconnects, so port is identity
+		std::lock_guard<std::mutex> lock(network.mutex);
+		return (IsConnected(address.GetPort()) >= 0 ? address.GetPort() : 0);
+	}
+
+	bool cTransportLoopback::GetStatistics(RakNet::SystemAddress const address, sLinkStatistics& stats_out)
+	{
+		// nothing is lost or queued; round trip is both artificial delays
+		std::lock_guard<std::mutex> lock(network.mutex);
+		if (port != 0 && IsConnected(address.GetPort()) >= 0)
+		{
+			cTransportLoopback const* const target = network.FindEndpoint(address.GetPort());
+			stats_out.ping = (unsigned int)(latency + (target ? target->latency : 0));
+			stats_out.packetLoss = 0.0f;
+			stats_out.bytesInSendBuffer = 0;
+			stats_out.bytesPerSecond = 0;
+			return true;
+		}
+		return false;
+	}
+}
\ No newline at end of file
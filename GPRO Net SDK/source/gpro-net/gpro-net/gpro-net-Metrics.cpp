@@ -0,0 +1,432 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Metrics.cpp
+	Source for per-message and per-connection metrics.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Metrics.hpp"
+
+#include <atomic>
+#include <thread>
+#include <string.h>
+
+#if (defined _WINDOWS || defined _WIN32)
+#include "RakNet/WindowsIncludes.h"
+#include <Psapi.h>
+#else	// !(defined _WINDOWS || defined _WIN32)
+#include <unistd.h>
+#endif	// (defined _WINDOWS || defined _WIN32)
+
+
+namespace gproNet
+{
+	// counters for one message identifier; own cache lines
+	struct alignas(64) sMessageCounters
+	{
+		std::atomic<unsigned long long> packetsIn, bytesIn;
+		std::atomic<unsigned long long> packetsOut, bytesOut, bytesSaved;
+		std::atomic<unsigned int> handlerTime[METRICS_HISTOGRAM_BUCKETS];
+	};
+
+	// counters for one remote peer; address is valid once used is set,
+	//	stale slots belong to disconnected peers and may be reclaimed; a
+	//	used slot's address only changes under the metrics lock
+	struct alignas(64) sConnectionCounters
+	{
+		std::atomic<bool> used, stale;
+		RakNet::SystemAddress address;
+		std::atomic<unsigned long long> packetsIn, bytesIn;
+		std::atomic<unsigned long long> packetsOut, bytesOut;
+		std::atomic<unsigned long long> rateDecreases, rateIncreases;
+		std::atomic<unsigned int> rateLevel, ping;
+	};
+
+	// all counters written by one thread
+	struct sMetricsBlock
+	{
+		sMessageCounters message[METRICS_MESSAGE_IDS];
+		sConnectionCounters connection[METRICS_CONNECTIONS];
+		std::thread::id owner;
+	};
+
+
+	// slot of this thread; returned to free list when thread exits
+	struct sThreadSlot
+	{
+		unsigned int index;
+		sThreadSlot();
+		~sThreadSlot();
+	};
+	static std::mutex& ThreadSlotMutex()
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+	static std::vector<unsigned int>& ThreadSlotFree()
+	{
+		static std::vector<unsigned int> free;
+		return free;
+	}
+	static unsigned int threadSlotNext;
+	static thread_local sThreadSlot threadSlot;
+
+	sThreadSlot::sThreadSlot()
+	{
+		std::lock_guard<std::mutex> lock(ThreadSlotMutex());
+		std::vector<unsigned int>& free = ThreadSlotFree();
+		if (free.empty())
+			index = threadSlotNext++;
+		else
+		{
+			index = free.back();
+			free.pop_back();
+		}
+	}
+
+	sThreadSlot::~sThreadSlot()
+	{
+		std::lock_guard<std::mutex> lock(ThreadSlotMutex());
+		ThreadSlotFree().push_back(index);
+	}
+
+
+	// single writer per counter: plain load and store, no locked add
+	template<typename type>
+	inline void MetricsAdd(std::atomic<type>& counter, type const value)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	// find or claim slot for address in writer's own block; stale slots
+	//	are skipped while searching and reclaimed if address is new, under
+	//	the lock that snapshots read addresses with (rare: once per peer)
+	inline sConnectionCounters* MetricsConnection(sMetricsBlock& block, RakNet::SystemAddress const& address, std::mutex& mutex)
+	{
+		sConnectionCounters* reclaim = 0;
+		unsigned int i, slot = (unsigned int)(RakNet::SystemAddress::ToInteger(address) % METRICS_CONNECTIONS);
+		for (i = 0; i < METRICS_CONNECTIONS; ++i, slot = (slot + 1) % METRICS_CONNECTIONS)
+		{
+			sConnectionCounters& connection = block.connection[slot];
+			if (!connection.used.load(std::memory_order_relaxed))
+			{
+				if (reclaim)
+					break;
+				connection.address = address;
+				connection.used.store(true, std::memory_order_release);
+				return &connection;
+			}
+			if (connection.stale.load(std::memory_order_acquire))
+			{
+				if (!reclaim)
+					reclaim = &connection;
+			}
+			else if (connection.address == address)
+				return &connection;
+		}
+		if (reclaim)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			reclaim->packetsIn.store(0, std::memory_order_relaxed);
+			reclaim->bytesIn.store(0, std::memory_order_relaxed);
+			reclaim->packetsOut.store(0, std::memory_order_relaxed);
+			reclaim->bytesOut.store(0, std::memory_order_relaxed);
+			reclaim->rateDecreases.store(0, std::memory_order_relaxed);
+			reclaim->rateIncreases.store(0, std::memory_order_relaxed);
+			reclaim->rateLevel.store(0, std::memory_order_relaxed);
+			reclaim->ping.store(0, std::memory_order_relaxed);
+			reclaim->address = address;
+			reclaim->stale.store(false, std::memory_order_relaxed);
+		}
+
+		// null if table full, connection not tracked
+		return reclaim;
+	}
+
+
+	unsigned int sMetricsHistogram::GetBucket(unsigned long long const value)
+	{
+		unsigned long long const v = value < (1ull << METRICS_HISTOGRAM_RANGE_BITS) ? value : ((1ull << METRICS_HISTOGRAM_RANGE_BITS) - 1);
+		unsigned int exponent = METRICS_HISTOGRAM_SUB_BITS;
+		if (v < (1ull << METRICS_HISTOGRAM_SUB_BITS))
+			return (unsigned int)v;
+		while (v >> (exponent + 1))
+			++exponent;
+		return ((exponent - METRICS_HISTOGRAM_SUB_BITS + 1) << METRICS_HISTOGRAM_SUB_BITS) |
+			(unsigned int)((v >> (exponent - METRICS_HISTOGRAM_SUB_BITS)) & ((1u << METRICS_HISTOGRAM_SUB_BITS) - 1));
+	}
+
+	unsigned long long sMetricsHistogram::GetBucketValue(unsigned int const bucket)
+	{
+		unsigned int const octave = bucket >> METRICS_HISTOGRAM_SUB_BITS;
+		unsigned long long const sub = bucket & ((1u << METRICS_HISTOGRAM_SUB_BITS) - 1);
+		if (octave == 0)
+			return sub;
+		return ((1ull << METRICS_HISTOGRAM_SUB_BITS) | sub) << (octave - 1);
+	}
+
+	unsigned long long sMetricsHistogram::GetTotal() const
+	{
+		unsigned long long total = 0;
+		unsigned int i;
+		for (i = 0; i < METRICS_HISTOGRAM_BUCKETS; ++i)
+			total += count[i];
+		return total;
+	}
+
+	unsigned long long sMetricsHistogram::GetPercentile(double const percentile) const
+	{
+		unsigned long long const total = GetTotal();
+		unsigned long long const target = (unsigned long long)((double)total * percentile / 100.0 + 0.5);
+		unsigned long long sum = 0;
+		unsigned int i;
+		for (i = 0; i < METRICS_HISTOGRAM_BUCKETS; ++i)
+			if (count[i] && (sum += count[i]) >= target)
+				return GetBucketValue(i);
+		return 0;
+	}
+
+
+	void sMetricsSnapshot::Print(FILE* const file) const
+	{
+		char address[64];
+		unsigned int i;
+		fprintf(file, " msg | pkt in     | bytes in     | pkt out    | bytes out    | saved      | p50 ns     | p99 ns     | max ns \n");
+		for (i = 0; i < METRICS_MESSAGE_IDS; ++i)
+		{
+			sMessageMetrics const& m = message[i];
+			if (m.packetsIn || m.packetsOut)
+			{
+				unsigned int max = METRICS_HISTOGRAM_BUCKETS;
+				while (max > 0 && !m.handlerTime.count[max - 1])
+					--max;
+				fprintf(file, " %3u | %10llu | %12llu | %10llu | %12llu | %10llu | %10llu | %10llu | %llu \n", i,
+					m.packetsIn, m.bytesIn, m.packetsOut, m.bytesOut, m.bytesSaved,
+					m.handlerTime.GetPercentile(50.0), m.handlerTime.GetPercentile(99.0),
+					max ? sMetricsHistogram::GetBucketValue(max - 1) : 0ull);
+			}
+		}
+		fprintf(file, " connection            | pkt in     | bytes in     | pkt out    | bytes out    | rate | ping  | slower | faster \n");
+		for (i = 0; i < connectionCount; ++i)
+		{
+			sConnectionMetrics const& c = connection[i];
+			c.address.ToString(true, address);
+			fprintf(file, " %-21s | %10llu | %12llu | %10llu | %12llu | %4u | %5u | %6llu | %llu \n", address,
+				c.packetsIn, c.bytesIn, c.packetsOut, c.bytesOut,
+				c.rateLevel, c.ping, c.rateDecreases, c.rateIncreases);
+		}
+	}
+
+
+	cMetrics::cMetrics()
+	{
+		unsigned int i;
+		for (i = 0; i < METRICS_THREADS; ++i)
+			threadBlock[i].store(0, std::memory_order_relaxed);
+	}
+
+	cMetrics::~cMetrics()
+	{
+		size_t i;
+		for (i = 0; i < blocks.size(); ++i)
+			delete blocks[i];
+	}
+
+	sMetricsBlock& cMetrics::GetBlock()
+	{
+		// steady state: one load, no lock; thread reusing slot of exited
+		//	thread continues its block (single writer either way)
+		unsigned int const slot = threadSlot.index;
+		sMetricsBlock* block = slot < METRICS_THREADS ? threadBlock[slot].load(std::memory_order_acquire) : 0;
+		if (block)
+			return *block;
+
+		// first record from this thread, or more threads than table
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			std::thread::id const owner = std::this_thread::get_id();
+			size_t i;
+			if (slot >= METRICS_THREADS)
+				for (i = 0; i < blocks.size() && !block; ++i)
+					if (blocks[i]->owner == owner)
+						block = blocks[i];
+			if (!block)
+			{
+				block = new sMetricsBlock();
+				blocks.push_back(block);
+				if (slot < METRICS_THREADS)
+					threadBlock[slot].store(block, std::memory_order_release);
+				else
+					block->owner = owner;
+			}
+			return *block;
+		}
+	}
+
+	void cMetrics::RecordReceive(RakNet::MessageID const msgID, RakNet::SystemAddress const& sender, unsigned int const bytes, unsigned long long const handlerTime)
+	{
+		sMetricsBlock& block = GetBlock();
+		sMessageCounters& message = block.message[msgID];
+		sConnectionCounters* const connection = MetricsConnection(block, sender, mutex);
+		MetricsAdd(message.packetsIn, 1ull);
+		MetricsAdd(message.bytesIn, (unsigned long long)bytes);
+		MetricsAdd(message.handlerTime[sMetricsHistogram::GetBucket(handlerTime)], 1u);
+		if (connection)
+		{
+			MetricsAdd(connection->packetsIn, 1ull);
+			MetricsAdd(connection->bytesIn, (unsigned long long)bytes);
+		}
+	}
+
+	void cMetrics::RecordSend(RakNet::MessageID const msgID, RakNet::SystemAddress const& recipient, unsigned int const bytes, unsigned int const saved)
+	{
+		sMetricsBlock& block = GetBlock();
+		sMessageCounters& message = block.message[msgID];
+		MetricsAdd(message.packetsOut, 1ull);
+		MetricsAdd(message.bytesOut, (unsigned long long)bytes);
+		if (saved)
+			MetricsAdd(message.bytesSaved, (unsigned long long)saved);
+		if (recipient != RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+		{
+			sConnectionCounters* const connection = MetricsConnection(block, recipient, mutex);
+			if (connection)
+			{
+				MetricsAdd(connection->packetsOut, 1ull);
+				MetricsAdd(connection->bytesOut, (unsigned long long)bytes);
+			}
+		}
+	}
+
+	void cMetrics::RecordRate(RakNet::SystemAddress const& address, unsigned int const level, int const change, unsigned int const ping)
+	{
+		sConnectionCounters* const connection = MetricsConnection(GetBlock(), address, mutex);
+		if (connection)
+		{
+			connection->rateLevel.store(level, std::memory_order_relaxed);
+			connection->ping.store(ping, std::memory_order_relaxed);
+			if (change > 0)
+				MetricsAdd(connection->rateDecreases, 1ull);
+			else if (change < 0)
+				MetricsAdd(connection->rateIncreases, 1ull);
+		}
+	}
+
+	void cMetrics::ForgetConnection(RakNet::SystemAddress const& address)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		size_t b;
+		unsigned int i;
+		for (b = 0; b < blocks.size(); ++b)
+			for (i = 0; i < METRICS_CONNECTIONS; ++i)
+			{
+				sConnectionCounters& connection = blocks[b]->connection[i];
+				if (connection.used.load(std::memory_order_acquire) && connection.address == address)
+					connection.stale.store(true, std::memory_order_release);
+			}
+	}
+
+	void cMetrics::Snapshot(sMetricsSnapshot& snapshot_out) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		size_t b;
+		unsigned int i, j, k, level, ping;
+
+		memset(snapshot_out.message, 0, sizeof(snapshot_out.message));
+		snapshot_out.connectionCount = 0;
+		for (b = 0; b < blocks.size(); ++b)
+		{
+			sMetricsBlock const& block = *blocks[b];
+			for (i = 0; i < METRICS_MESSAGE_IDS; ++i)
+			{
+				sMessageCounters const& src = block.message[i];
+				sMessageMetrics& dst = snapshot_out.message[i];
+				dst.packetsIn += src.packetsIn.load(std::memory_order_relaxed);
+				dst.bytesIn += src.bytesIn.load(std::memory_order_relaxed);
+				dst.packetsOut += src.packetsOut.load(std::memory_order_relaxed);
+				dst.bytesOut += src.bytesOut.load(std::memory_order_relaxed);
+				dst.bytesSaved += src.bytesSaved.load(std::memory_order_relaxed);
+				for (j = 0; j < METRICS_HISTOGRAM_BUCKETS; ++j)
+					dst.handlerTime.count[j] += src.handlerTime[j].load(std::memory_order_relaxed);
+			}
+			for (i = 0; i < METRICS_CONNECTIONS; ++i)
+			{
+				sConnectionCounters const& src = block.connection[i];
+				if (src.used.load(std::memory_order_acquire) && !src.stale.load(std::memory_order_relaxed))
+				{
+					// merge with same address from other threads
+					for (k = 0; k < snapshot_out.connectionCount; ++k)
+						if (snapshot_out.connection[k].address == src.address)
+							break;
+					if (k == snapshot_out.connectionCount)
+					{
+						if (k == METRICS_CONNECTIONS)
+							continue;
+						snapshot_out.connection[k].address = src.address;
+						snapshot_out.connection[k].packetsIn = snapshot_out.connection[k].bytesIn = 0;
+						snapshot_out.connection[k].packetsOut = snapshot_out.connection[k].bytesOut = 0;
+						snapshot_out.connection[k].rateDecreases = snapshot_out.connection[k].rateIncreases = 0;
+						snapshot_out.connection[k].rateLevel = snapshot_out.connection[k].ping = 0;
+						++snapshot_out.connectionCount;
+					}
+					snapshot_out.connection[k].packetsIn += src.packetsIn.load(std::memory_order_relaxed);
+					snapshot_out.connection[k].bytesIn += src.bytesIn.load(std::memory_order_relaxed);
+					snapshot_out.connection[k].packetsOut += src.packetsOut.load(std::memory_order_relaxed);
+					snapshot_out.connection[k].bytesOut += src.bytesOut.load(std::memory_order_relaxed);
+					snapshot_out.connection[k].rateDecreases += src.rateDecreases.load(std::memory_order_relaxed);
+					snapshot_out.connection[k].rateIncreases += src.rateIncreases.load(std::memory_order_relaxed);
+
+					// rate decisions come from one thread; other blocks hold zero
+					level = src.rateLevel.load(std::memory_order_relaxed);
+					ping = src.ping.load(std::memory_order_relaxed);
+					if (level > snapshot_out.connection[k].rateLevel)
+						snapshot_out.connection[k].rateLevel = level;
+					if (ping > snapshot_out.connection[k].ping)
+						snapshot_out.connection[k].ping = ping;
+				}
+			}
+		}
+	}
+
+
+	unsigned int GetThreadSlot()
+	{
+		return threadSlot.index;
+	}
+
+	unsigned long long GetProcessMemory()
+	{
+#if (defined _WINDOWS || defined _WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+		if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return counters.WorkingSetSize;
+		return 0;
+#else	// !(defined _WINDOWS || defined _WIN32)
+		// second field is resident pages
+		unsigned long long pages = 0, resident = 0;
+		FILE* const file = fopen("/proc/self/statm", "r");
+		if (!file)
+			return 0;
+		if (fscanf(file, "%llu %llu", &pages, &resident) != 2)
+			resident = 0;
+		fclose(file);
+		return resident * (unsigned long long)sysconf(_SC_PAGESIZE);
+#endif	// (defined _WINDOWS || defined _WIN32)
+	}
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Policy.cpp
+	Source for per-message send policies.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Policy.hpp"
+
+
+namespace gproNet
+{
+	cMessagePolicyTable::cMessagePolicyTable(PacketPriority const priority, PacketReliability const reliability, char const orderingChannel)
+	{
+		unsigned int i;
+		for (i = 0; i < 256; ++i)
+		{
+			policy[i].msgID = (RakNet::MessageID)i;
+			policy[i].priority = priority;
+			policy[i].reliability = reliability;
+			policy[i].orderingChannel = orderingChannel;
+		}
+	}
+
+	void cMessagePolicyTable::Set(sMessagePolicy const list[], unsigned int const count)
+	{
+		unsigned int i;
+		for (i = 0; i < count; ++i)
+			policy[list[i].msgID] = list[i];
+	}
+
+	sMessagePolicy const& cMessagePolicyTable::Get(RakNet::MessageID const msgID) const
+	{
+		return policy[msgID];
+	}
+}
\ No newline at end of file
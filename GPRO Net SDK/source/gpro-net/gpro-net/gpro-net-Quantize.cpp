@@ -0,0 +1,389 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Quantize.cpp
+	Source for batch pose quantization kernels.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Quantize.hpp"
+
+#if (defined _M_X64 || defined _M_IX86 || defined __x86_64__ || defined __i386__)
+#define GPRO_NET_QUANTIZE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GPRO_NET_TARGET_AVX2
+#else	// !_MSC_VER
+#define GPRO_NET_TARGET_AVX2 __attribute__((target("avx2")))
+#endif	// _MSC_VER
+#endif	// x86
+
+
+namespace gproNet
+{
+	// poses per block of temporary step indices
+	enum { QUANTIZE_BLOCK = 256 };
+
+	// pose fields in schema order
+	static sQuantizeRange const quantizePoseRange[3] = {
+		QuantizeRangeOf<sSpatialPoseScaleCodec>(),
+		QuantizeRangeOf<sSpatialPoseRotateCodec>(),
+		QuantizeRangeOf<sSpatialPoseTranslateCodec>(),
+	};
+
+
+	// scalar kernels: same expressions as sQuantizedCodec
+	static void QuantizeScalar(float const values[], unsigned int const begin, unsigned int const count, sQuantizeRange const& range, unsigned int steps_out[])
+	{
+		unsigned int i;
+		float value;
+		for (i = begin; i < count; ++i)
+		{
+			value = values[i];
+			value = value > range.lower ? value : range.lower;
+			value = value < range.upper ? value : range.upper;
+			steps_out[i] = (unsigned int)((value - range.lower) * range.toSteps + 0.5f);
+		}
+	}
+
+	static void DequantizeScalar(unsigned int const steps[], unsigned int const begin, unsigned int const count, sQuantizeRange const& range, float values_out[])
+	{
+		unsigned int i;
+		for (i = begin; i < count; ++i)
+			values_out[i] = (float)steps[i] * range.fromSteps + range.lower;
+	}
+
+
+#ifdef GPRO_NET_QUANTIZE_X86
+	// max/min operand order matches the scalar comparisons, including NaN
+	//	(which becomes lower); multiply and add stay separate (no FMA) so
+	//	rounding matches the scalar path
+	static void QuantizeSSE2(float const values[], unsigned int const count, sQuantizeRange const& range, unsigned int steps_out[])
+	{
+		__m128 const lower = _mm_set1_ps(range.lower), upper = _mm_set1_ps(range.upper);
+		__m128 const toSteps = _mm_set1_ps(range.toSteps), half = _mm_set1_ps(0.5f);
+		__m128 value;
+		unsigned int i;
+		for (i = 0; i + 4 <= count; i += 4)
+		{
+			value = _mm_loadu_ps(values + i);
+			value = _mm_min_ps(_mm_max_ps(value, lower), upper);
+			value = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(value, lower), toSteps), half);
+			_mm_storeu_si128((__m128i*)(steps_out + i), _mm_cvttps_epi32(value));
+		}
+		QuantizeScalar(values, i, count, range, steps_out);
+	}
+
+	static void DequantizeSSE2(unsigned int const steps[], unsigned int const count, sQuantizeRange const& range, float values_out[])
+	{
+		__m128 const lower = _mm_set1_ps(range.lower), fromSteps = _mm_set1_ps(range.fromSteps);
+		__m128 value;
+		unsigned int i;
+		for (i = 0; i + 4 <= count; i += 4)
+		{
+			value = _mm_cvtepi32_ps(_mm_loadu_si128((__m128i const*)(steps + i)));
+			_mm_storeu_ps(values_out + i, _mm_add_ps(_mm_mul_ps(value, fromSteps), lower));
+		}
+		DequantizeScalar(steps, i, count, range, values_out);
+	}
+
+	GPRO_NET_TARGET_AVX2 static void QuantizeAVX2(float const values[], unsigned int const count, sQuantizeRange const& range, unsigned int steps_out[])
+	{
+		__m256 const lower = _mm256_set1_ps(range.lower), upper = _mm256_set1_ps(range.upper);
+		__m256 const toSteps = _mm256_set1_ps(range.toSteps), half = _mm256_set1_ps(0.5f);
+		__m256 value;
+		unsigned int i;
+		for (i = 0; i + 8 <= count; i += 8)
+		{
+			value = _mm256_loadu_ps(values + i);
+			value = _mm256_min_ps(_mm256_max_ps(value, lower), upper);
+			value = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(value, lower), toSteps), half);
+			_mm256_storeu_si256((__m256i*)(steps_out + i), _mm256_cvttps_epi32(value));
+		}
+		QuantizeScalar(values, i, count, range, steps_out);
+	}
+
+	GPRO_NET_TARGET_AVX2 static void DequantizeAVX2(unsigned int const steps[], unsigned int const count, sQuantizeRange const& range, float values_out[])
+	{
+		__m256 const lower = _mm256_set1_ps(range.lower), fromSteps = _mm256_set1_ps(range.fromSteps);
+		__m256 value;
+		unsigned int i;
+		for (i = 0; i + 8 <= count; i += 8)
+		{
+			value = _mm256_cvtepi32_ps(_mm256_loadu_si256((__m256i const*)(steps + i)));
+			_mm256_storeu_ps(values_out + i, _mm256_add_ps(_mm256_mul_ps(value, fromSteps), lower));
+		}
+		DequantizeScalar(steps, i, count, range, values_out);
+	}
+
+	static bool QuantizeHasAVX2()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		__cpuid(info, 1);
+		if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else	// !_MSC_VER
+		return __builtin_cpu_supports("avx2") != 0;
+#endif	// _MSC_VER
+	}
+#endif	// GPRO_NET_QUANTIZE_X86
+
+
+	// best supported mode, detected once
+	static eQuantizeMode QuantizeDetect()
+	{
+#ifdef GPRO_NET_QUANTIZE_X86
+		return QuantizeHasAVX2() ? QUANTIZE_AVX2 : QUANTIZE_SSE2;
+#else	// !GPRO_NET_QUANTIZE_X86
+		return QUANTIZE_SCALAR;
+#endif	// GPRO_NET_QUANTIZE_X86
+	}
+	static eQuantizeMode const quantizeBest = QuantizeDetect();
+	static eQuantizeMode quantizeMode = quantizeBest;
+
+
+	// bits of value in the order RakNet writes them: low byte first, each
+	//	byte from its top bit, the top partial byte last
+	template<unsigned int bits>
+	inline unsigned int QuantizeToStreamOrder(unsigned int const value)
+	{
+		if constexpr (bits > 8)
+			return ((value & 0xFF) << (bits - 8)) | QuantizeToStreamOrder<bits - 8>(value >> 8);
+		else
+			return value;
+	}
+
+	template<unsigned int bits>
+	inline unsigned int QuantizeFromStreamOrder(unsigned int const ordered)
+	{
+		if constexpr (bits > 8)
+			return ((ordered >> (bits - 8)) & 0xFF) | (QuantizeFromStreamOrder<bits - 8>(ordered & ((1u << (bits - 8)) - 1)) << 8);
+		else
+			return ordered;
+	}
+
+	// most-significant-bit-first packer; at most 31 bits stay pending, so
+	//	up to 32 more fit before writing
+	struct sQuantizePacker
+	{
+		unsigned char* data;
+		unsigned long long bitsPending;
+		unsigned int countPending;
+
+		template<unsigned int bits>
+		inline void Push(unsigned int const value)
+		{
+			bitsPending = (bitsPending << bits) | QuantizeToStreamOrder<bits>(value);
+			if ((countPending += bits) >= 32)
+			{
+				unsigned int const word = (unsigned int)(bitsPending >> (countPending -= 32));
+				data[0] = (unsigned char)(word >> 24);
+				data[1] = (unsigned char)(word >> 16);
+				data[2] = (unsigned char)(word >> 8);
+				data[3] = (unsigned char)(word);
+				data += 4;
+			}
+		}
+		inline void Flush()
+		{
+			for (; countPending >= 8; countPending -= 8)
+				*(data++) = (unsigned char)(bitsPending >> (countPending - 8));
+			if (countPending)
+				*(data++) = (unsigned char)(bitsPending << (8 - countPending));
+			countPending = 0;
+		}
+	};
+
+	// most-significant-bit-first unpacker; reads no further than the last
+	//	byte holding requested bits
+	struct sQuantizeUnpacker
+	{
+		unsigned char const* data;
+		unsigned long long bitsPending;
+		unsigned int countPending;
+
+		template<unsigned int bits>
+		inline unsigned int Pull()
+		{
+			while (countPending < bits)
+			{
+				bitsPending = (bitsPending << 8) | *(data++);
+				countPending += 8;
+			}
+			return QuantizeFromStreamOrder<bits>((unsigned int)(bitsPending >> (countPending -= bits)) & ((1u << bits) - 1));
+		}
+	};
+
+
+	eQuantizeMode SetQuantizeMode(eQuantizeMode const mode)
+	{
+		quantizeMode = (mode == QUANTIZE_AUTO || mode > quantizeBest) ? quantizeBest : mode;
+		return quantizeMode;
+	}
+
+	eQuantizeMode GetQuantizeMode()
+	{
+		return quantizeMode;
+	}
+
+	void QuantizeBatch(float const values[], unsigned int const count, sQuantizeRange const& range, unsigned int steps_out[])
+	{
+		switch (quantizeMode)
+		{
+#ifdef GPRO_NET_QUANTIZE_X86
+		case QUANTIZE_AVX2:
+			QuantizeAVX2(values, count, range, steps_out);
+			break;
+		case QUANTIZE_SSE2:
+			QuantizeSSE2(values, count, range, steps_out);
+			break;
+#endif	// GPRO_NET_QUANTIZE_X86
+		default:
+			QuantizeScalar(values, 0, count, range, steps_out);
+			break;
+		}
+	}
+
+	void DequantizeBatch(unsigned int const steps[], unsigned int const count, sQuantizeRange const& range, float values_out[])
+	{
+		switch (quantizeMode)
+		{
+#ifdef GPRO_NET_QUANTIZE_X86
+		case QUANTIZE_AVX2:
+			DequantizeAVX2(steps, count, range, values_out);
+			break;
+		case QUANTIZE_SSE2:
+			DequantizeSSE2(steps, count, range, values_out);
+			break;
+#endif	// GPRO_NET_QUANTIZE_X86
+		default:
+			DequantizeScalar(steps, 0, count, range, values_out);
+			break;
+		}
+	}
+
+	unsigned int EncodePoseBatch(float const* const scale[3], float const* const rotate[3], float const* const translate[3], unsigned int const count, unsigned char data_out[])
+	{
+		float const* const* const field[3] = { scale, rotate, translate };
+		unsigned int steps[9][QUANTIZE_BLOCK];
+		sQuantizePacker packer = { data_out, 0, 0 };
+		unsigned int base, block, i, k;
+
+		for (base = 0; base < count; base += block)
+		{
+			block = (count - base) < QUANTIZE_BLOCK ? (count - base) : (unsigned int)QUANTIZE_BLOCK;
+			for (k = 0; k < 9; ++k)
+				QuantizeBatch(field[k / 3][k % 3] + base, block, quantizePoseRange[k / 3], steps[k]);
+			for (i = 0; i < block; ++i)
+			{
+				packer.Push<sSpatialPoseScaleCodec::bits>(steps[0][i]);
+				packer.Push<sSpatialPoseScaleCodec::bits>(steps[1][i]);
+				packer.Push<sSpatialPoseScaleCodec::bits>(steps[2][i]);
+				packer.Push<sSpatialPoseRotateCodec::bits>(steps[3][i]);
+				packer.Push<sSpatialPoseRotateCodec::bits>(steps[4][i]);
+				packer.Push<sSpatialPoseRotateCodec::bits>(steps[5][i]);
+				packer.Push<sSpatialPoseTranslateCodec::bits>(steps[6][i]);
+				packer.Push<sSpatialPoseTranslateCodec::bits>(steps[7][i]);
+				packer.Push<sSpatialPoseTranslateCodec::bits>(steps[8][i]);
+			}
+		}
+		packer.Flush();
+		return count * sSpatialPoseSchema::maxBits;
+	}
+
+	void DecodePoseBatch(unsigned char const data[], unsigned int const count, float* const scale_out[3], float* const rotate_out[3], float* const translate_out[3])
+	{
+		float* const* const field[3] = { scale_out, rotate_out, translate_out };
+		unsigned int steps[9][QUANTIZE_BLOCK];
+		sQuantizeUnpacker unpacker = { data, 0, 0 };
+		unsigned int base, block, i, k;
+
+		for (base = 0; base < count; base += block)
+		{
+			block = (count - base) < QUANTIZE_BLOCK ? (count - base) : (unsigned int)QUANTIZE_BLOCK;
+			for (i = 0; i < block; ++i)
+			{
+				steps[0][i] = unpacker.Pull<sSpatialPoseScaleCodec::bits>();
+				steps[1][i] = unpacker.Pull<sSpatialPoseScaleCodec::bits>();
+				steps[2][i] = unpacker.Pull<sSpatialPoseScaleCodec::bits>();
+				steps[3][i] = unpacker.Pull<sSpatialPoseRotateCodec::bits>();
+				steps[4][i] = unpacker.Pull<sSpatialPoseRotateCodec::bits>();
+				steps[5][i] = unpacker.Pull<sSpatialPoseRotateCodec::bits>();
+				steps[6][i] = unpacker.Pull<sSpatialPoseTranslateCodec::bits>();
+				steps[7][i] = unpacker.Pull<sSpatialPoseTranslateCodec::bits>();
+				steps[8][i] = unpacker.Pull<sSpatialPoseTranslateCodec::bits>();
+			}
+			for (k = 0; k < 9; ++k)
+				DequantizeBatch(steps[k], block, quantizePoseRange[k / 3], field[k / 3][k % 3] + base);
+		}
+	}
+
+	RakNet::BitStream& WritePoseBatch(RakNet::BitStream& bitstream, float const* const scale[3], float const* const rotate[3], float const* const translate[3], unsigned int const count)
+	{
+		// whole blocks are a whole number of bytes, so each block continues
+		//	exactly where the last left off
+		unsigned char data[(QUANTIZE_BLOCK * sSpatialPoseSchema::maxBits + 7) / 8];
+		float const* scaleBlock[3];
+		float const* rotateBlock[3];
+		float const* translateBlock[3];
+		unsigned int base, block, axis;
+		for (base = 0; base < count; base += block)
+		{
+			block = (count - base) < QUANTIZE_BLOCK ? (count - base) : (unsigned int)QUANTIZE_BLOCK;
+			for (axis = 0; axis < 3; ++axis)
+			{
+				scaleBlock[axis] = scale[axis] + base;
+				rotateBlock[axis] = rotate[axis] + base;
+				translateBlock[axis] = translate[axis] + base;
+			}
+			bitstream.WriteBits(data, EncodePoseBatch(scaleBlock, rotateBlock, translateBlock, block, data), false);
+		}
+		return bitstream;
+	}
+
+	bool ReadPoseBatch(RakNet::BitStream& bitstream, unsigned int const count, float* const scale_out[3], float* const rotate_out[3], float* const translate_out[3])
+	{
+		unsigned char data[(QUANTIZE_BLOCK * sSpatialPoseSchema::maxBits + 7) / 8];
+		float* scaleBlock[3];
+		float* rotateBlock[3];
+		float* translateBlock[3];
+		unsigned int base, block, axis;
+		for (base = 0; base < count; base += block)
+		{
+			block = (count - base) < QUANTIZE_BLOCK ? (count - base) : (unsigned int)QUANTIZE_BLOCK;
+			if (!bitstream.ReadBits(data, block * sSpatialPoseSchema::maxBits, false))
+				return false;
+			for (axis = 0; axis < 3; ++axis)
+			{
+				scaleBlock[axis] = scale_out[axis] + base;
+				rotateBlock[axis] = rotate_out[axis] + base;
+				translateBlock[axis] = translate_out[axis] + base;
+			}
+			DecodePoseBatch(data, block, scaleBlock, rotateBlock, translateBlock);
+		}
+		return true;
+	}
+}
\ No newline at end of file
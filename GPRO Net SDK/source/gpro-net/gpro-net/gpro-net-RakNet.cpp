@@ -24,17 +24,63 @@
 
 #include "gpro-net/gpro-net/gpro-net-RakNet.hpp"
 
+#include <chrono>
+#include <thread>
+
 
 namespace gproNet
 {
+	sMessagePolicy const commonMessagePolicy[] = {
+		// poses: only the latest matters, never hold back other traffic
+		{ ID_GPRO_MESSAGE_SPATIAL_POSE, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, CHANNEL_STREAM },
+		// inputs: latest matters, but drive simulation so go out first
+		{ ID_GPRO_MESSAGE_INPUTS, HIGH_PRIORITY, UNRELIABLE_SEQUENCED, CHANNEL_INPUT },
+		// moves: every one must arrive, in order, on their own channel
+		{ ID_GPRO_MESSAGE_GAME_MOVE, HIGH_PRIORITY, RELIABLE_ORDERED, CHANNEL_GAME },
+		// entity changes: only changed fields are sent, so none may be lost,
+		//	and removals stay in order with updates
+		{ ID_GPRO_MESSAGE_ENTITY_UPDATE, MEDIUM_PRIORITY, RELIABLE_ORDERED, CHANNEL_STREAM },
+		{ ID_GPRO_MESSAGE_ENTITY_DESTROY, MEDIUM_PRIORITY, RELIABLE_ORDERED, CHANNEL_STREAM },
+		// hits: must arrive, in order with the entities they name
+		{ ID_GPRO_MESSAGE_ENTITY_HIT, MEDIUM_PRIORITY, RELIABLE_ORDERED, CHANNEL_STREAM },
+		// lockstep: everything stays in order with moves, so a resync
+		//	replaces exactly the moves sent before it
+		{ ID_GPRO_MESSAGE_GAME_JOIN, HIGH_PRIORITY, RELIABLE_ORDERED, CHANNEL_GAME },
+		{ ID_GPRO_MESSAGE_GAME_START, HIGH_PRIORITY, RELIABLE_ORDERED, CHANNEL_GAME },
+		{ ID_GPRO_MESSAGE_GAME_SETUP, HIGH_PRIORITY, RELIABLE_ORDERED, CHANNEL_GAME },
+		{ ID_GPRO_MESSAGE_GAME_HASH, MEDIUM_PRIORITY, RELIABLE_ORDERED, CHANNEL_GAME },
+		{ ID_GPRO_MESSAGE_GAME_RESYNC, HIGH_PRIORITY, RELIABLE_ORDERED, CHANNEL_GAME },
+		// chat: every message in order, behind all game traffic
+		{ ID_GPRO_MESSAGE_CHAT, LOW_PRIORITY, RELIABLE_ORDERED, CHANNEL_CHAT },
+		// spectating: stays in order with the entity stream it changes
+		{ ID_GPRO_MESSAGE_SPECTATE, HIGH_PRIORITY, RELIABLE_ORDERED, CHANNEL_STREAM },
+		// routing: answer must arrive before the client can play; only the
+		//	latest load report matters, but it must get through
+		{ ID_GPRO_MESSAGE_ROUTE, HIGH_PRIORITY, RELIABLE_ORDERED, CHANNEL_DEFAULT },
+		{ ID_GPRO_MESSAGE_SHARD_LOAD, LOW_PRIORITY, RELIABLE_SEQUENCED, CHANNEL_DEFAULT },
+		// resuming: delta of moves that follows must stay in order with it
+		{ ID_GPRO_MESSAGE_RESUME, HIGH_PRIORITY, RELIABLE_ORDERED, CHANNEL_GAME },
+	};
+	unsigned int const commonMessagePolicyCount = sizeof(commonMessagePolicy) / sizeof(*commonMessagePolicy);
+
+
 	cRakNetManager::cRakNetManager()
-		: peer(RakNet::RakPeerInterface::GetInstance())
+		: cRakNetManager(0)
 	{
 	}
 
+	cRakNetManager::cRakNetManager(cTransport* const transport)
+		: peer(transport ? transport : new cTransportRakNet), ownsPeer(!transport), capture(0)
+		, spans(0), spansTracedOnly(true), traceContext(), traceStart(0), tracedCount(0)
+		, policy(MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, CHANNEL_DEFAULT)
+	{
+		policy.Set(commonMessagePolicy, commonMessagePolicyCount);
+	}
+
 	cRakNetManager::~cRakNetManager()
 	{
-		RakNet::RakPeerInterface::DestroyInstance(peer);
+		if (ownsPeer)
+			delete peer;
 	}
 
 	bool cRakNetManager::ProcessMessage(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID)
@@ -48,17 +94,40 @@ namespace gproNet
 
 	RakNet::BitStream& cRakNetManager::WriteTimestamp(RakNet::BitStream& bitstream)
 	{
-		bitstream.Write((RakNet::MessageID)ID_TIMESTAMP);
-		bitstream.Write((RakNet::Time)RakNet::GetTime());
+		if (traceContext.trace)
+		{
+			bitstream.Write((RakNet::MessageID)ID_GPRO_MESSAGE_TRACE);
+			bitstream.Write(traceContext.trace);
+			bitstream.Write(traceContext.span);
+		}
+		bitstream.Write((RakNet::MessageID)ID_GPRO_MESSAGE_TIMESTAMP);
+		bitstream.Write((unsigned short)RakNet::GetTime());
 		return bitstream;
 	}
 
-	RakNet::BitStream& cRakNetManager::ReadTimestamp(RakNet::BitStream& bitstream, RakNet::Time& dtSendToReceive_out, RakNet::MessageID& msgID_out)
+	RakNet::BitStream& cRakNetManager::ReadTimestamp(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time& dtSendToReceive_out, RakNet::MessageID& msgID_out)
+	{
+		return ReadTimestamp(bitstream, sender, RakNet::GetTime(), dtSendToReceive_out, msgID_out);
+	}
+
+	RakNet::BitStream& cRakNetManager::ReadTimestamp(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const tReceive, RakNet::Time& dtSendToReceive_out, RakNet::MessageID& msgID_out)
 	{
-		RakNet::Time tSend = 0, tReceive = 0;
-		if (msgID_out == ID_TIMESTAMP)
+		RakNet::Time tSend = 0;
+		if (msgID_out == ID_GPRO_MESSAGE_TIMESTAMP)
 		{
-			tReceive = RakNet::GetTime();
+			// sender's clock now, as seen from here, is the base; send time
+			//	is nearest it with the same low bits, then back on local clock
+			RakNet::Time const differential = peer->GetClockDifferential(sender);
+			RakNet::Time const tBase = tReceive + differential;
+			unsigned short tSendLow = 0;
+			bitstream.Read(tSendLow);
+			bitstream.Read(msgID_out);
+			tSend = tBase + (RakNet::Time)(long long)(short)(unsigned short)(tSendLow - (unsigned short)tBase) - differential;
+			dtSendToReceive_out = (tReceive - tSend);
+		}
+		else if (msgID_out == ID_TIMESTAMP)
+		{
+			// full time, already on local clock
 			bitstream.Read(tSend);
 			bitstream.Read(msgID_out);
 			dtSendToReceive_out = (tReceive - tSend);
@@ -66,138 +135,346 @@ namespace gproNet
 		return bitstream;
 	}
 
-	RakNet::BitStream& cRakNetManager::WriteTest(RakNet::BitStream& bitstream, char const message[])
+	RakNet::BitStream& cRakNetManager::WriteTest(RakNet::BitStream& bitstream, char const message[], bool const timestamp)
 	{
-		WriteTimestamp(bitstream);
+		sTestMessage test;
+		strncpy(test.text, message, sizeof(test.text) - 1);
+		test.text[sizeof(test.text) - 1] = 0;
+		if (timestamp)
+			WriteTimestamp(bitstream);
 		bitstream.Write((RakNet::MessageID)ID_GPRO_MESSAGE_COMMON_BEGIN);
-		bitstream.Write(message);
-		return bitstream;
+		return sTestMessageSchema::Write(bitstream, test);
 	}
 
 	RakNet::BitStream& cRakNetManager::ReadTest(RakNet::BitStream& bitstream)
 	{
-		RakNet::RakString rs;
-		bitstream.Read(rs);
-		printf("%s\n", rs.C_String());
+		sTestMessage test;
+		if (sTestMessageSchema::Read(bitstream, test))
+			printf("%s\n", test.text);
 		return bitstream;
 	}
 
+	unsigned int cRakNetManager::Send(RakNet::BitStream const& bitstream, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::SystemAddress const recipient, bool const broadcast)
+	{
+		return Send(bitstream.GetData(), bitstream.GetNumberOfBytesUsed(), priority, reliability, orderingChannel, recipient, broadcast);
+	}
+
+	unsigned int cRakNetManager::Send(unsigned char const data[], unsigned int const length, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::SystemAddress const recipient, bool const broadcast)
+	{
+		unsigned long long const tStart = spans ? cSpanRecorder::GetTime() : 0;
+		unsigned int const number = peer->Send(data, length, priority, reliability, orderingChannel, recipient, broadcast);
+		bool const traced = (length > MESSAGE_TRACE_BYTES && data[0] == ID_GPRO_MESSAGE_TRACE);
+		unsigned int const stamp = traced ? MESSAGE_TRACE_BYTES : 0;
+		if (number)
+			metrics.RecordSend(PeekMessageID(data, length), broadcast ? RakNet::UNASSIGNED_SYSTEM_ADDRESS : recipient, length,
+				(length >= stamp + MESSAGE_HEADER_BYTES && data[stamp] == ID_GPRO_MESSAGE_TIMESTAMP) ? MESSAGE_HEADER_FULL_BYTES - MESSAGE_HEADER_BYTES : 0);
+
+		// send span follows from span message was written in
+		if (spans && number && (traced || !spansTracedOnly))
+		{
+			sSpan span = { tStart, 0, 0, 0, 0, SPAN_SEND, PeekMessageID(data, length), 0, length };
+			if (traced)
+			{
+				RakNet::BitStream header((unsigned char*)data, MESSAGE_TRACE_BYTES, false);
+				header.IgnoreBytes(sizeof(RakNet::MessageID));
+				header.Read(span.trace);
+				header.Read(span.parent);
+			}
+			span.duration = (unsigned int)(cSpanRecorder::GetTime() - tStart);
+			spans->Record(span);
+		}
+		return number;
+	}
+
+	unsigned int cRakNetManager::Send(RakNet::BitStream const& bitstream, RakNet::SystemAddress const recipient, bool const broadcast)
+	{
+		sMessagePolicy const& send = policy.Get(PeekMessageID(bitstream.GetData(), bitstream.GetNumberOfBytesUsed()));
+		return Send(bitstream, send.priority, send.reliability, send.orderingChannel, recipient, broadcast);
+	}
+
+	unsigned int cRakNetManager::Send(cSharedMessage const& message, RakNet::SystemAddress const recipient, bool const broadcast)
+	{
+		if (message.IsEmpty())
+			return 0;
+		sMessagePolicy const& send = policy.Get(PeekMessageID(message.GetData(), message.GetLength()));
+		return Send(message.GetData(), message.GetLength(), send.priority, send.reliability, send.orderingChannel, recipient, broadcast);
+	}
+
+	unsigned int cRakNetManager::SendToList(cSharedMessage const& message, RakNet::SystemAddress const recipient[], unsigned int const count)
+	{
+		sMessagePolicy const& send = policy.Get(PeekMessageID(message.GetData(), message.GetLength()));
+		unsigned int sent = 0, i;
+		if (!message.IsEmpty())
+			for (i = 0; i < count; ++i)
+				if (Send(message.GetData(), message.GetLength(), send.priority, send.reliability, send.orderingChannel, recipient[i], false))
+					++sent;
+		return sent;
+	}
+
+	unsigned int cRakNetManager::SendToList(RakNet::BitStream const& bitstream, RakNet::SystemAddress const recipient[], unsigned int const count)
+	{
+		unsigned char const* const data = bitstream.GetData();
+		unsigned int const length = bitstream.GetNumberOfBytesUsed();
+		sMessagePolicy const& send = policy.Get(PeekMessageID(data, length));
+		unsigned int sent = 0, i;
+		if (length)
+			for (i = 0; i < count; ++i)
+				if (Send(data, length, send.priority, send.reliability, send.orderingChannel, recipient[i], false))
+					++sent;
+		return sent;
+	}
+
+	unsigned int cRakNetManager::SendToAll(cSharedMessage const& message, RakNet::SystemAddress const exclude[], unsigned int const excludeCount)
+	{
+		sMessagePolicy const& send = policy.Get(PeekMessageID(message.GetData(), message.GetLength()));
+		unsigned int sent = 0, count, i, j;
+		if (message.IsEmpty())
+			return 0;
+
+		// transport broadcast handles one exclusion itself
+		if (excludeCount <= 1)
+			return (Send(message.GetData(), message.GetLength(), send.priority, send.reliability, send.orderingChannel,
+				excludeCount ? exclude[0] : RakNet::UNASSIGNED_SYSTEM_ADDRESS, true) ? 1 : 0);
+
+		// list connections, growing list until all fit
+		if (connectionList.size() < 32)
+			connectionList.resize(32);
+		while ((count = peer->GetConnections(connectionList.data(), (unsigned short)connectionList.size())) == connectionList.size() && count < 0xffff)
+			connectionList.resize(connectionList.size() * 2 < 0xffff ? connectionList.size() * 2 : 0xffff);
+		for (i = 0; i < count; ++i)
+		{
+			for (j = 0; j < excludeCount; ++j)
+				if (connectionList[i] == exclude[j])
+					break;
+			if (j == excludeCount && Send(message.GetData(), message.GetLength(), send.priority, send.reliability, send.orderingChannel, connectionList[i], false))
+				++sent;
+		}
+		return sent;
+	}
+
+	unsigned int cRakNetManager::PeekHeaderBytes(unsigned char const* const data, unsigned int const length)
+	{
+		unsigned int const trace = (length > MESSAGE_TRACE_BYTES && data[0] == ID_GPRO_MESSAGE_TRACE) ? MESSAGE_TRACE_BYTES : 0;
+		if (length >= trace + MESSAGE_HEADER_BYTES && data[trace] == ID_GPRO_MESSAGE_TIMESTAMP)
+			return trace + MESSAGE_HEADER_BYTES;
+		if (length >= trace + MESSAGE_HEADER_FULL_BYTES && data[trace] == ID_TIMESTAMP)
+			return trace + MESSAGE_HEADER_FULL_BYTES;
+		return length > trace ? trace + sizeof(RakNet::MessageID) : 0;
+	}
+
+	RakNet::MessageID cRakNetManager::PeekMessageID(unsigned char const* const data, unsigned int const length)
+	{
+		unsigned int const header = PeekHeaderBytes(data, length);
+		return header ? data[header - sizeof(RakNet::MessageID)] : 0;
+	}
+
+	bool cRakNetManager::Restamp(unsigned char data[], unsigned int const length, RakNet::Time const tSend)
+	{
+		unsigned int const header = PeekHeaderBytes(data, length);
+		unsigned int const trace = (length > MESSAGE_TRACE_BYTES && data[0] == ID_GPRO_MESSAGE_TRACE) ? MESSAGE_TRACE_BYTES : 0;
+		if (header == trace + MESSAGE_HEADER_BYTES && data[trace] == ID_GPRO_MESSAGE_TIMESTAMP)
+		{
+			RakNet::BitStream stamp(data + trace + sizeof(RakNet::MessageID), sizeof(unsigned short), false);
+			stamp.SetWriteOffset(0);
+			stamp.Write((unsigned short)tSend);
+			return true;
+		}
+		if (header == trace + MESSAGE_HEADER_FULL_BYTES && data[trace] == ID_TIMESTAMP)
+		{
+			RakNet::BitStream stamp(data + trace + sizeof(RakNet::MessageID), sizeof(RakNet::Time), false);
+			stamp.SetWriteOffset(0);
+			stamp.Write(tSend);
+			return true;
+		}
+		return false;
+	}
+
+	bool cRakNetManager::ProcessPacket(unsigned char* const data, unsigned int const length, RakNet::SystemAddress const sender, RakNet::Time const tReceive)
+	{
+		RakNet::MessageID msgID = 0;
+		RakNet::Time dtSendToReceive = 0;
+		RakNet::BitStream bitstream(data, length, false);
+		std::chrono::steady_clock::time_point const tStart = std::chrono::steady_clock::now();
+		sSpanContext const outer = traceContext;
+		sSpan span = { spans ? cSpanRecorder::GetTime() : 0, 0, 0, 0, 0, SPAN_HANDLE, 0, 0, length };
+		RakNet::BitSize_t content;
+		bool processed, timestamped;
+		bitstream.Read(msgID);
+
+		// adopt sender's trace; messages sent while handling follow from
+		//	this handler's span, or from the sender's if not recording
+		if (msgID == ID_GPRO_MESSAGE_TRACE)
+		{
+			bitstream.Read(span.trace);
+			bitstream.Read(span.parent);
+			bitstream.Read(msgID);
+			++tracedCount;
+		}
+		if (spans && (span.trace || !spansTracedOnly))
+			span.id = spans->NewID();
+		traceContext.trace = span.trace;
+		traceContext.span = span.id ? span.id : span.parent;
+
+		// process timestamp
+		timestamped = (msgID == ID_GPRO_MESSAGE_TIMESTAMP || msgID == ID_TIMESTAMP);
+		ReadTimestamp(bitstream, sender, tReceive, dtSendToReceive, msgID);
+		content = bitstream.GetReadOffset();
+
+		// process content
+		processed = ProcessMessage(bitstream, sender, dtSendToReceive, msgID);
+
+		// tasks waiting for message read it after handler
+		bitstream.SetReadOffset(content);
+		if (tasks.Dispatch(bitstream, sender, dtSendToReceive, msgID))
+			processed = true;
+
+		// count message and handler time
+		metrics.RecordReceive(msgID, sender, length,
+			(unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tStart).count());
+		if (msgID == ID_DISCONNECTION_NOTIFICATION || msgID == ID_CONNECTION_LOST)
+			metrics.ForgetConnection(sender);
+
+		// transit ends where handling starts (resolution of timestamp;
+		//	skipped if clocks disagree by more than a minute)
+		if (span.id)
+		{
+			span.msgID = msgID;
+			span.duration = (unsigned int)(cSpanRecorder::GetTime() - span.tStart);
+			spans->Record(span);
+			if (timestamped && dtSendToReceive < 60000)
+			{
+				sSpan const transit = { span.tStart - (unsigned long long)dtSendToReceive * 1000, (unsigned int)dtSendToReceive * 1000,
+					span.trace, 0, span.parent, SPAN_TRANSIT, msgID, 0, length };
+				spans->Record(transit);
+			}
+		}
+		traceContext = outer;
+		return processed;
+	}
+
 	int cRakNetManager::MessageLoop()
 	{
 		int count = 0;
 		RakNet::Packet* packet = 0;
-		RakNet::MessageID msgID = 0;
-		RakNet::Time dtSendToReceive = 0;
+		RakNet::Time tReceive = 0;
+		unsigned long long const tStart = spans ? cSpanRecorder::GetTime() : 0;
+		unsigned int const traced = tracedCount;
 
-		while (packet = peer->Receive())
+		while ((packet = peer->Receive()) != 0)
 		{
-			RakNet::BitStream bitstream(packet->data, packet->length, false);
-			bitstream.Read(msgID);
+			tReceive = RakNet::GetTime();
 
-			// process timestamp
-			ReadTimestamp(bitstream, dtSendToReceive, msgID);
+			// record raw packet before anything reads it
+			if (capture)
+				capture->Append(packet, tReceive);
 
 			// process content
-			if (ProcessMessage(bitstream, packet->systemAddress, dtSendToReceive, msgID))
+			if (ProcessPacket(packet->data, packet->length, packet->systemAddress, tReceive))
 				++count;
 
 			// done with packet
 			peer->DeallocatePacket(packet);
 		}
 
+		// tasks waiting for tick or time
+		tasks.Update(RakNet::GetTime());
+
+		// pass encloses spans of messages it handled
+		if (spans && count && (tracedCount != traced || !spansTracedOnly))
+		{
+			sSpan const span = { tStart, (unsigned int)(cSpanRecorder::GetTime() - tStart), 0, 0, 0, SPAN_LOOP, 0, 0, 0 };
+			spans->Record(span);
+		}
+
 		// done
 		return count;
 	}
-}
-
 
-/* INITIAL INFORMATION FROM QUIZ TO BE EDITED*/
-
-// Description of spatial pose.
-struct sSpatialPose
-{
-	float scale[3];     // non-uniform scale
-	float rotate[3];    // orientation as Euler angles
-	float translate[3]; // translation
-
-	// read from stream
-	RakNet::BitStream& Read(RakNet::BitStream& bitstream)
-	{
-		/*
-		ALT CODE
-			send information to decompress function
-			send out decompressed data
-		*/
-		bitstream.Read(scale[0]);
-		bitstream.Read(scale[1]);
-		bitstream.Read(scale[2]);
-		bitstream.Read(rotate[0]);
-		bitstream.Read(rotate[1]);
-		bitstream.Read(rotate[2]);
-		bitstream.Read(translate[0]);
-		bitstream.Read(translate[1]);
-		bitstream.Read(translate[2]);
-		return bitstream;
+	void cRakNetManager::SetCapture(cTraceWriter* const trace)
+	{
+		capture = trace;
 	}
 
-	// write to stream
-	RakNet::BitStream& Write(RakNet::BitStream& bitstream) const
+	void cRakNetManager::SetSpans(cSpanRecorder* const recorder, bool const tracedOnly)
 	{
-		/*
-		ALT CODE
-			send information into compressions function
-			send compressed data to the bitstream
-		*/
-
-		// Example line of call
-		bitstream.Write(CompressData(scale[0]));
-
-		bitstream.Write(scale[1]);
-		bitstream.Write(scale[2]);
-		bitstream.Write(rotate[0]);
-		bitstream.Write(rotate[1]);
-		bitstream.Write(rotate[2]);
-		bitstream.Write(translate[0]);
-		bitstream.Write(translate[1]);
-		bitstream.Write(translate[2]);
-		return bitstream;
+		spans = recorder;
+		spansTracedOnly = tracedOnly;
 	}
-};
-
-
-/* QUICK CODE UNDER THE ASSUMPTION THAT THESE FLOATS WORK FROM ABOUT -1 TO 1 IN USAGE */
-
-// uniform compression size for formula on how to compress and decompress data
-int compressionSize = ...;
 
-// compress into ints for a smaller data type than floats
-int CompressData(float data)
-{
-	return (int)(data * compressionSize);
-}
+	unsigned int cRakNetManager::BeginTrace()
+	{
+		if (!spans)
+			return 0;
+		traceContext.trace = spans->NewID();
+		traceContext.span = spans->NewID();
+		traceStart = cSpanRecorder::GetTime();
+		return traceContext.trace;
+	}
 
-float DecompressData(int data)
-{
-	return (float) data / compressionSize;
-}
+	void cRakNetManager::EndTrace()
+	{
+		if (spans && traceContext.trace)
+		{
+			sSpan const span = { traceStart, (unsigned int)(cSpanRecorder::GetTime() - traceStart),
+				traceContext.trace, traceContext.span, 0, SPAN_INTERACTION, 0, 0, 0 };
+			spans->Record(span);
+		}
+		traceContext.trace = traceContext.span = 0;
+	}
 
-// This above method can be done with smaller data types like chars
-// Smaller data types means less precision though and more data lost in compression
+	int cRakNetManager::Replay(cTraceReader& trace, bool const realTime)
+	{
+		int count = 0;
+		sTraceRecord const* record = 0;
+		unsigned char const* data = 0;
+		unsigned char* copy = 0;
+		unsigned int capacity = 0;
+		RakNet::Time tFirst = 0, tStart = 0;
 
+		while (trace.Next(record, data))
+		{
+			// hold packet until same time has passed since first packet
+			if (realTime)
+			{
+				if (!tStart)
+				{
+					tFirst = record->tReceive;
+					tStart = RakNet::GetTime();
+				}
+				while (RakNet::GetTime() - tStart < record->tReceive - tFirst)
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			// handlers may read in place, so work on a copy of mapped data
+			if (record->length > capacity)
+			{
+				delete[] copy;
+				copy = new unsigned char[capacity = record->length];
+			}
+			memcpy(copy, data, record->length);
+
+			// process with original receive time so latency is preserved
+			if (ProcessPacket(copy, record->length, cTraceReader::GetSender(*record), record->tReceive))
+				++count;
+		}
+		delete[] copy;
 
-/* ANOTHER OPTION */
+		// done
+		return count;
+	}
 
-// if this spatial data being taken in is based off of player inputs, we can track those instead
+	cTaskScheduler& cRakNetManager::GetTasks()
+	{
+		return tasks;
+	}
 
-struct Inputs {
-	bool w;
-	bool a;
-	bool s;
-	bool d;
-	bool space;
-	bool shoot;
-};
+	cMetrics const& cRakNetManager::GetMetrics() const
+	{
+		return metrics;
+	}
 
-// Go on with usual processing, but instead, server and clients take in other inputs and process them as movement on their screens
-// Bools would waaaay lower data that's being sent back and forth
-// This could put a lot more processing on each player and the server than just simply sending data
\ No newline at end of file
+	sMessagePolicy const& cRakNetManager::GetMessagePolicy(RakNet::MessageID const msgID) const
+	{
+		return policy.Get(msgID);
+	}
+}
\ No newline at end of file
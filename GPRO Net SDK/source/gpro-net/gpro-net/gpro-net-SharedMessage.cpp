@@ -0,0 +1,59 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-SharedMessage.cpp
+	Source for immutable serialized messages shared between sends.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-SharedMessage.hpp"
+
+
+namespace gproNet
+{
+	cSharedMessage::cSharedMessage()
+	{
+	}
+
+	cSharedMessage::cSharedMessage(RakNet::BitStream const& bitstream)
+		: data(std::make_shared<std::vector<unsigned char> const>(bitstream.GetData(), bitstream.GetData() + bitstream.GetNumberOfBytesUsed()))
+	{
+	}
+
+	cSharedMessage::cSharedMessage(unsigned char const data[], unsigned int const length)
+		: data(std::make_shared<std::vector<unsigned char> const>(data, data + length))
+	{
+	}
+
+	bool cSharedMessage::IsEmpty() const
+	{
+		return (!data || data->empty());
+	}
+
+	unsigned char const* cSharedMessage::GetData() const
+	{
+		return (data ? data->data() : 0);
+	}
+
+	unsigned int cSharedMessage::GetLength() const
+	{
+		return (data ? (unsigned int)data->size() : 0);
+	}
+}
\ No newline at end of file
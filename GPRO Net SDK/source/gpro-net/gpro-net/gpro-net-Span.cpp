@@ -0,0 +1,222 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Span.cpp
+	Source for trace spans and Chrome trace export.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Span.hpp"
+#include "gpro-net/gpro-net/gpro-net-Metrics.hpp"
+
+#include <chrono>
+#include <random>
+#include <thread>
+#include <string.h>
+
+
+namespace gproNet
+{
+	// span stored as whole words so snapshots never read a torn field
+	enum { SPAN_WORDS = sizeof(sSpan) / sizeof(unsigned long long) };
+	static_assert(sizeof(sSpan) == SPAN_WORDS * sizeof(unsigned long long), "span must be whole words");
+	static_assert((SPAN_RING & (SPAN_RING - 1)) == 0, "span ring must be power of 2");
+
+	// spans written by one thread; entry n is in slot n % SPAN_RING
+	struct alignas(64) sSpanRing
+	{
+		std::atomic<unsigned long long> written;
+		unsigned short thread;
+		std::thread::id owner;
+		std::atomic<unsigned long long> slot[SPAN_RING][SPAN_WORDS];
+	};
+
+
+	// names of span kinds in exported trace
+	static char const* const spanKindName[] = {
+		"loop",
+		"transit",
+		"handle",
+		"send",
+		"interaction",
+	};
+
+
+	cSpanRecorder::cSpanRecorder(char const name[], unsigned int const process)
+		: process(process), salt((unsigned int)std::random_device()()), nextID(0)
+	{
+		unsigned int i;
+		for (i = 0; i < SPAN_THREADS; ++i)
+			threadRing[i].store(0, std::memory_order_relaxed);
+		strncpy(this->name, name, sizeof(this->name) - 1);
+		this->name[sizeof(this->name) - 1] = 0;
+	}
+
+	cSpanRecorder::~cSpanRecorder()
+	{
+		size_t i;
+		for (i = 0; i < rings.size(); ++i)
+			delete rings[i];
+	}
+
+	sSpanRing& cSpanRecorder::GetRing()
+	{
+		// steady state: one load, no lock; thread reusing slot of exited
+		//	thread continues its ring (single writer either way)
+		unsigned int const slot = GetThreadSlot();
+		sSpanRing* ring = slot < SPAN_THREADS ? threadRing[slot].load(std::memory_order_acquire) : 0;
+		if (ring)
+			return *ring;
+
+		// first span from this thread, or more threads than table
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			std::thread::id const owner = std::this_thread::get_id();
+			size_t i;
+			if (slot >= SPAN_THREADS)
+				for (i = 0; i < rings.size() && !ring; ++i)
+					if (rings[i]->owner == owner)
+						ring = rings[i];
+			if (!ring)
+			{
+				ring = new sSpanRing();
+				ring->thread = (unsigned short)rings.size();
+				rings.push_back(ring);
+				if (slot < SPAN_THREADS)
+					threadRing[slot].store(ring, std::memory_order_release);
+				else
+					ring->owner = owner;
+			}
+			return *ring;
+		}
+	}
+
+	unsigned long long cSpanRecorder::GetTime()
+	{
+		return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	unsigned int cSpanRecorder::NewID()
+	{
+		unsigned int result;
+		while (!(result = salt + nextID.fetch_add(1, std::memory_order_relaxed)));
+		return result;
+	}
+
+	void cSpanRecorder::Record(sSpan const& span)
+	{
+		sSpanRing& ring = GetRing();
+		unsigned long long const n = ring.written.load(std::memory_order_relaxed);
+		unsigned long long word[SPAN_WORDS];
+		unsigned int i;
+		sSpan copy = span;
+		copy.thread = ring.thread;
+		memcpy(word, &copy, sizeof(word));
+		for (i = 0; i < SPAN_WORDS; ++i)
+			ring.slot[n & (SPAN_RING - 1)][i].store(word[i], std::memory_order_relaxed);
+		ring.written.store(n + 1, std::memory_order_release);
+	}
+
+	unsigned int cSpanRecorder::Snapshot(std::vector<sSpan>& spans_out) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		unsigned long long word[SPAN_WORDS];
+		unsigned long long begin, end, n, overwritten;
+		size_t r, first;
+		unsigned int i;
+		spans_out.clear();
+		for (r = 0; r < rings.size(); ++r)
+		{
+			sSpanRing const& ring = *rings[r];
+			end = ring.written.load(std::memory_order_acquire);
+			begin = end > SPAN_RING ? end - SPAN_RING : 0;
+			first = spans_out.size();
+			for (n = begin; n < end; ++n)
+			{
+				for (i = 0; i < SPAN_WORDS; ++i)
+					word[i] = ring.slot[n & (SPAN_RING - 1)][i].load(std::memory_order_relaxed);
+				spans_out.resize(spans_out.size() + 1);
+				memcpy(&spans_out.back(), word, sizeof(word));
+			}
+
+			// writer may have started on entries up to its count since;
+			//	each of those replaces the entry one ring earlier
+			std::atomic_thread_fence(std::memory_order_acquire);
+			overwritten = ring.written.load(std::memory_order_relaxed) + 1;
+			overwritten = overwritten > SPAN_RING ? overwritten - SPAN_RING : 0;
+			if (overwritten > begin)
+				spans_out.erase(spans_out.begin() + first,
+					spans_out.begin() + first + (size_t)((overwritten < end ? overwritten : end) - begin));
+		}
+		return (unsigned int)spans_out.size();
+	}
+
+	unsigned int cSpanRecorder::WriteChrome(FILE* const file, bool& first) const
+	{
+		std::vector<sSpan> spans;
+		unsigned int const count = Snapshot(spans);
+		unsigned int i, threads = 0;
+		char const* separator = first ? "\n" : ",\n";
+
+		// process and thread names
+		fprintf(file, "%s{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%u,\"tid\":0,\"args\":{\"name\":\"%s\"}}", separator, process, name);
+		separator = ",\n";
+		first = false;
+		for (i = 0; i < count; ++i)
+			if (spans[i].thread >= threads)
+				threads = spans[i].thread + 1u;
+		for (i = 0; i < threads; ++i)
+			fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}", separator, process, i, i);
+
+		// complete events; messages flow from sender's span to handler
+		for (i = 0; i < count; ++i)
+		{
+			sSpan const& span = spans[i];
+			char const* const kind = span.kind < sizeof(spanKindName) / sizeof(*spanKindName) ? spanKindName[span.kind] : "span";
+			if (span.kind == SPAN_LOOP || span.kind == SPAN_INTERACTION)
+				fprintf(file, "%s{\"ph\":\"X\",\"name\":\"%s\",\"cat\":\"%s\"", separator, kind, kind);
+			else
+				fprintf(file, "%s{\"ph\":\"X\",\"name\":\"%s %u\",\"cat\":\"%s\"", separator, kind, span.msgID, kind);
+			fprintf(file, ",\"ts\":%llu,\"dur\":%u,\"pid\":%u,\"tid\":%u,\"args\":{\"trace\":\"%08x\",\"span\":\"%08x\",\"parent\":\"%08x\",\"msg\":%u,\"bytes\":%u}}",
+				span.tStart, span.duration, process, span.thread, span.trace, span.id, span.parent, span.msgID, span.bytes);
+			if (span.trace && span.parent && (span.kind == SPAN_SEND || span.kind == SPAN_HANDLE))
+				fprintf(file, "%s{\"ph\":\"%s\",\"name\":\"message\",\"cat\":\"flow\",\"id\":\"%08x\",\"ts\":%llu,\"pid\":%u,\"tid\":%u%s}",
+					separator, span.kind == SPAN_SEND ? "s" : "f", span.parent, span.tStart, process, span.thread,
+					span.kind == SPAN_SEND ? "" : ",\"bp\":\"e\"");
+		}
+		return count;
+	}
+
+	int cSpanRecorder::ExportChrome(char const path[], cSpanRecorder const* const recorders[], unsigned int const count)
+	{
+		FILE* const file = fopen(path, "w");
+		unsigned int spans = 0, i;
+		bool first = true;
+		if (!file)
+			return -1;
+		fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+		for (i = 0; i < count; ++i)
+			if (recorders[i])
+				spans += recorders[i]->WriteChrome(file, first);
+		fprintf(file, "\n]}\n");
+		fclose(file);
+		return (int)spans;
+	}
+}
\ No newline at end of file
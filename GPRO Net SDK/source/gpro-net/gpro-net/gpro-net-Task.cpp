@@ -0,0 +1,387 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Task.cpp
+	Source for coroutine session tasks resumed by the message loop.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Task.hpp"
+
+#include <exception>
+#include <new>
+
+#include "RakNet/GetTime.h"
+
+
+namespace gproNet
+{
+	std::atomic<unsigned long long> cTaskFramePool::totalAllocations(0);
+
+
+	cTaskFramePool::cTaskFramePool()
+		: allocations(0)
+	{
+	}
+
+	cTaskFramePool::~cTaskFramePool()
+	{
+		unsigned int c, i;
+		for (c = 0; c < TASK_FRAME_CLASS_COUNT; ++c)
+			for (i = 0; i < freeList[c].size(); ++i)
+				::operator delete(freeList[c][i]);
+	}
+
+	unsigned int cTaskFramePool::GetClass(size_t const bytes)
+	{
+		unsigned int c = 0;
+		while (c < TASK_FRAME_CLASS_COUNT && ((size_t)TASK_FRAME_CLASS_MIN << c) < bytes)
+			++c;
+		return c;
+	}
+
+	void* cTaskFramePool::Allocate(size_t const bytes)
+	{
+		unsigned int const c = GetClass(bytes);
+		void* frame;
+		if (c < TASK_FRAME_CLASS_COUNT && !freeList[c].empty())
+		{
+			frame = freeList[c].back();
+			freeList[c].pop_back();
+			return frame;
+		}
+		++allocations;
+		++totalAllocations;
+		return ::operator new(c < TASK_FRAME_CLASS_COUNT ? ((size_t)TASK_FRAME_CLASS_MIN << c) : bytes);
+	}
+
+	void cTaskFramePool::Release(void* const frame, size_t const bytes)
+	{
+		unsigned int const c = GetClass(bytes);
+		if (c < TASK_FRAME_CLASS_COUNT)
+			freeList[c].push_back(frame);
+		else
+			::operator delete(frame);
+	}
+
+	unsigned long long cTaskFramePool::GetAllocationCount() const
+	{
+		return allocations;
+	}
+
+	cTaskFramePool& cTaskFramePool::GetLocal()
+	{
+		static thread_local cTaskFramePool pool;
+		return pool;
+	}
+
+	unsigned long long cTaskFramePool::GetTotalAllocationCount()
+	{
+		return totalAllocations.load(std::memory_order_relaxed);
+	}
+
+
+	cTask cTask::promise_type::get_return_object()
+	{
+		return cTask(std::coroutine_handle<promise_type>::from_promise(*this));
+	}
+
+	std::suspend_always cTask::promise_type::initial_suspend() noexcept
+	{
+		return std::suspend_always();
+	}
+
+	std::suspend_always cTask::promise_type::final_suspend() noexcept
+	{
+		// scheduler destroys finished tasks
+		return std::suspend_always();
+	}
+
+	void cTask::promise_type::return_void()
+	{
+	}
+
+	void cTask::promise_type::unhandled_exception()
+	{
+		std::terminate();
+	}
+
+	void* cTask::promise_type::operator new(size_t const bytes)
+	{
+		return cTaskFramePool::GetLocal().Allocate(bytes);
+	}
+
+	void cTask::promise_type::operator delete(void* const frame, size_t const bytes)
+	{
+		cTaskFramePool::GetLocal().Release(frame, bytes);
+	}
+
+
+	cTask::cTask(std::coroutine_handle<promise_type> const handle)
+		: handle(handle)
+	{
+	}
+
+	cTask::cTask(cTask&& task)
+		: handle(task.handle)
+	{
+		task.handle = nullptr;
+	}
+
+	cTask::~cTask()
+	{
+		if (handle)
+			handle.destroy();
+	}
+
+	std::coroutine_handle<> cTask::Release()
+	{
+		std::coroutine_handle<> const task = handle;
+		handle = nullptr;
+		return task;
+	}
+
+
+	bool sTaskWait::await_ready() const noexcept
+	{
+		return false;
+	}
+
+	void sTaskWait::await_suspend(std::coroutine_handle<> const handle)
+	{
+		task = handle;
+		scheduler->Link(*this);
+	}
+
+	sTaskMessage sTaskWait::await_resume() const noexcept
+	{
+		return result;
+	}
+
+
+	cTaskScheduler::cTaskScheduler()
+		: bucket(), timed(0), ticking(0), waiting(0)
+	{
+	}
+
+	cTaskScheduler::~cTaskScheduler()
+	{
+		sTaskWait* wait;
+		sTaskWait* next;
+		unsigned int i;
+
+		// timer list first, while message waits it links through still exist
+		for (wait = timed; wait; wait = next)
+		{
+			next = wait->next[1];
+			if (wait->kind == TASK_WAIT_TIME)
+				wait->task.destroy();
+		}
+		for (i = 0; i < TASK_WAIT_BUCKETS; ++i)
+			for (wait = bucket[i]; wait; wait = next)
+			{
+				next = wait->next[0];
+				wait->task.destroy();
+			}
+		for (wait = ticking; wait; wait = next)
+		{
+			next = wait->next[0];
+			wait->task.destroy();
+		}
+	}
+
+	unsigned int cTaskScheduler::GetBucket(RakNet::SystemAddress const& sender, RakNet::MessageID const msgID)
+	{
+		// multiplicative mix: addresses often differ only in a few bits
+		unsigned int const key = (unsigned int)RakNet::SystemAddress::ToInteger(sender) * 31u + msgID;
+		return ((key * 2654435761u) >> 16) % TASK_WAIT_BUCKETS;
+	}
+
+	void cTaskScheduler::Link(sTaskWait& wait)
+	{
+		sTaskWait** const head = (wait.kind == TASK_WAIT_MESSAGE) ? &bucket[GetBucket(wait.sender, wait.msgID)] :
+			(wait.kind == TASK_WAIT_TICK) ? &ticking : 0;
+		wait.next[0] = wait.prev[0] = wait.next[1] = wait.prev[1] = 0;
+		if (head)
+		{
+			if ((wait.next[0] = *head) != 0)
+				(*head)->prev[0] = &wait;
+			*head = &wait;
+		}
+		if (wait.kind == TASK_WAIT_TIME || wait.deadline)
+		{
+			if ((wait.next[1] = timed) != 0)
+				timed->prev[1] = &wait;
+			timed = &wait;
+		}
+		++waiting;
+	}
+
+	void cTaskScheduler::Unlink(sTaskWait& wait)
+	{
+		sTaskWait** const head = (wait.kind == TASK_WAIT_MESSAGE) ? &bucket[GetBucket(wait.sender, wait.msgID)] :
+			(wait.kind == TASK_WAIT_TICK) ? &ticking : 0;
+		if (head)
+		{
+			if (wait.prev[0])
+				wait.prev[0]->next[0] = wait.next[0];
+			else
+				*head = wait.next[0];
+			if (wait.next[0])
+				wait.next[0]->prev[0] = wait.prev[0];
+		}
+		if (wait.kind == TASK_WAIT_TIME || wait.deadline)
+		{
+			if (wait.prev[1])
+				wait.prev[1]->next[1] = wait.next[1];
+			else
+				timed = wait.next[1];
+			if (wait.next[1])
+				wait.next[1]->prev[1] = wait.prev[1];
+		}
+		wait.next[0] = wait.prev[0] = wait.next[1] = wait.prev[1] = 0;
+		--waiting;
+	}
+
+	unsigned int cTaskScheduler::ResumeList(sTaskWait* chain)
+	{
+		sTaskWait* next;
+		unsigned int count = 0;
+		for (; chain; chain = next, ++count)
+		{
+			// wait is part of the frame, which may be gone after resuming
+			next = chain->next[0];
+			Resume(chain->task);
+		}
+		return count;
+	}
+
+	void cTaskScheduler::Resume(std::coroutine_handle<> const task)
+	{
+		task.resume();
+		if (task.done())
+			task.destroy();
+	}
+
+	bool cTaskScheduler::Start(cTask task)
+	{
+		std::coroutine_handle<> const handle = task.Release();
+		handle.resume();
+		if (handle.done())
+		{
+			handle.destroy();
+			return false;
+		}
+		return true;
+	}
+
+	sTaskWait cTaskScheduler::Receive(RakNet::MessageID const msgID, RakNet::SystemAddress const sender, RakNet::Time const timeout)
+	{
+		sTaskWait const wait = { this, nullptr, TASK_WAIT_MESSAGE, msgID, sender, timeout ? RakNet::GetTime() + timeout : 0,
+			{ 0, 0 }, { 0, 0 }, { 0, RakNet::UNASSIGNED_SYSTEM_ADDRESS, 0 } };
+		return wait;
+	}
+
+	sTaskWait cTaskScheduler::Delay(RakNet::Time const duration)
+	{
+		sTaskWait const wait = { this, nullptr, TASK_WAIT_TIME, 0, RakNet::UNASSIGNED_SYSTEM_ADDRESS, RakNet::GetTime() + duration,
+			{ 0, 0 }, { 0, 0 }, { 0, RakNet::UNASSIGNED_SYSTEM_ADDRESS, 0 } };
+		return wait;
+	}
+
+	sTaskWait cTaskScheduler::NextTick()
+	{
+		sTaskWait const wait = { this, nullptr, TASK_WAIT_TICK, 0, RakNet::UNASSIGNED_SYSTEM_ADDRESS, 0,
+			{ 0, 0 }, { 0, 0 }, { 0, RakNet::UNASSIGNED_SYSTEM_ADDRESS, 0 } };
+		return wait;
+	}
+
+	unsigned int cTaskScheduler::Dispatch(RakNet::BitStream& bitstream, RakNet::SystemAddress const sender, RakNet::Time const dtSendToReceive, RakNet::MessageID const msgID)
+	{
+		RakNet::BitSize_t const offset = bitstream.GetReadOffset();
+		sTaskWait* chain = 0;
+		sTaskWait* wait;
+		sTaskWait* next;
+		unsigned int pass, count = 0;
+
+		// waits for this sender, then waits for any sender; all are taken
+		//	off their lists before any runs, so tasks may wait again
+		for (pass = 0; pass < 2; ++pass)
+		{
+			RakNet::SystemAddress const& waitSender = pass ? RakNet::UNASSIGNED_SYSTEM_ADDRESS : sender;
+			if (pass && sender == RakNet::UNASSIGNED_SYSTEM_ADDRESS)
+				break;
+			for (wait = bucket[GetBucket(waitSender, msgID)]; wait; wait = next)
+			{
+				next = wait->next[0];
+				if (wait->msgID == msgID && wait->sender == waitSender)
+				{
+					Unlink(*wait);
+					wait->result.bitstream = &bitstream;
+					wait->result.sender = sender;
+					wait->result.dtSendToReceive = dtSendToReceive;
+					wait->next[0] = chain;
+					chain = wait;
+				}
+			}
+		}
+
+		// each task reads the message from the start of its content
+		for (; chain; chain = next, ++count)
+		{
+			next = chain->next[0];
+			bitstream.SetReadOffset(offset);
+			Resume(chain->task);
+		}
+		return count;
+	}
+
+	unsigned int cTaskScheduler::Update(RakNet::Time const time)
+	{
+		sTaskWait* chain = 0;
+		sTaskWait* wait;
+		sTaskWait* next;
+
+		for (wait = ticking; wait; wait = next)
+		{
+			next = wait->next[0];
+			Unlink(*wait);
+			wait->next[0] = chain;
+			chain = wait;
+		}
+		for (wait = timed; wait; wait = next)
+		{
+			next = wait->next[1];
+			if (wait->deadline <= time)
+			{
+				Unlink(*wait);
+				wait->result.bitstream = 0;
+				wait->next[0] = chain;
+				chain = wait;
+			}
+		}
+		return ResumeList(chain);
+	}
+
+	unsigned int cTaskScheduler::GetWaitingCount() const
+	{
+		return waiting;
+	}
+}
\ No newline at end of file
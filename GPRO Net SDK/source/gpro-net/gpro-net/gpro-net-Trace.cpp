@@ -0,0 +1,213 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Trace.cpp
+	Source for packet capture and replay trace files.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Trace.hpp"
+
+#include <atomic>
+#include <string.h>
+
+
+namespace gproNet
+{
+	// trace file identification
+	static char const traceMagic[4] = { 'G', 'P', 'T', 'R' };
+	enum { TRACE_VERSION = 1 };
+
+	// record size including padded data
+	inline unsigned long long TraceRecordSize(unsigned int const length)
+	{
+		return (sizeof(sTraceRecord) + length + 7) & ~7ull;
+	}
+
+	// header identifies a trace whose committed records lie within file
+	inline bool TraceHeaderValid(sTraceHeader const& header, unsigned long long const size)
+	{
+		return (size >= sizeof(sTraceHeader) &&
+			memcmp(header.magic, traceMagic, sizeof(traceMagic)) == 0 && header.version == TRACE_VERSION &&
+			header.used <= size - sizeof(sTraceHeader));
+	}
+
+
+	cTraceWriter::cTraceWriter()
+		: filemap()
+	{
+	}
+
+	cTraceWriter::~cTraceWriter()
+	{
+		Close();
+	}
+
+	bool cTraceWriter::Open(char const path[], unsigned long long const capacity)
+	{
+		sTraceHeader const blank = { { 0 }, 0, 0, 0 };
+		bool usable;
+
+		// existing file must be a trace (or blank) before it is extended or
+		//	written; any other file is left exactly as it was
+		if (gpro_filemapOpen(&filemap, path, 0, 1) == 0)
+		{
+			sTraceHeader const* const header = (sTraceHeader const*)filemap.data;
+			usable = filemap.size >= sizeof(sTraceHeader) &&
+				(memcmp(header, &blank, sizeof(blank)) == 0 || TraceHeaderValid(*header, filemap.size));
+			gpro_filemapClose(&filemap);
+			if (!usable)
+				return false;
+		}
+
+		if (gpro_filemapOpen(&filemap, path, sizeof(sTraceHeader) + capacity, 0) == 0)
+		{
+			sTraceHeader* const header = (sTraceHeader*)filemap.data;
+			if (memcmp(header, &blank, sizeof(blank)) == 0)
+			{
+				// new file, mapping is zero-filled
+				memcpy(header->magic, traceMagic, sizeof(traceMagic));
+				header->version = TRACE_VERSION;
+			}
+
+			// appending continues after the committed records
+			if (TraceHeaderValid(*header, filemap.size))
+				return true;
+			gpro_filemapClose(&filemap);
+		}
+		return false;
+	}
+
+	void cTraceWriter::Close()
+	{
+		if (filemap.data)
+			gpro_filemapFlush(&filemap, 0, 0, 1);
+		gpro_filemapClose(&filemap);
+	}
+
+	bool cTraceWriter::Append(RakNet::Packet const* const packet, RakNet::Time const tReceive)
+	{
+		if (filemap.data && packet)
+		{
+			unsigned long long const size = TraceRecordSize(packet->length);
+			sTraceHeader* header = (sTraceHeader*)filemap.data;
+			unsigned long long const end = sizeof(sTraceHeader) + header->used + size;
+			sTraceRecord* record;
+
+			// grow by doubling when full
+			if (end > filemap.size)
+			{
+				unsigned long long const grow = filemap.size * 2;
+				if (gpro_filemapResize(&filemap, end > grow ? end : grow) != 0)
+					return false;
+				header = (sTraceHeader*)filemap.data;
+			}
+
+			// write record past the committed end
+			record = (sTraceRecord*)((char*)filemap.data + sizeof(sTraceHeader) + header->used);
+			record->tReceive = tReceive;
+			record->host = packet->systemAddress.address.addr4.sin_addr.s_addr;
+			record->port = packet->systemAddress.GetPort();
+			record->reserved = 0;
+			record->length = packet->length;
+			record->reserved2 = 0;
+			memcpy(record + 1, packet->data, packet->length);
+
+			// commit: a reader or a crash never sees a partial record
+			std::atomic_thread_fence(std::memory_order_release);
+			header->used += size;
+			++header->count;
+			return true;
+		}
+		return false;
+	}
+
+
+	cTraceReader::cTraceReader()
+		: filemap(), cursor(0)
+	{
+	}
+
+	cTraceReader::~cTraceReader()
+	{
+		Close();
+	}
+
+	bool cTraceReader::Open(char const path[])
+	{
+		if (gpro_filemapOpen(&filemap, path, 0, 1) == 0)
+		{
+			if (TraceHeaderValid(*(sTraceHeader const*)filemap.data, filemap.size))
+			{
+				cursor = 0;
+				return true;
+			}
+			gpro_filemapClose(&filemap);
+		}
+		return false;
+	}
+
+	void cTraceReader::Close()
+	{
+		gpro_filemapClose(&filemap);
+		cursor = 0;
+	}
+
+	void cTraceReader::Rewind()
+	{
+		cursor = 0;
+	}
+
+	unsigned long long cTraceReader::GetCount() const
+	{
+		return filemap.data ? ((sTraceHeader const*)filemap.data)->count : 0;
+	}
+
+	bool cTraceReader::Next(sTraceRecord const*& record_out, unsigned char const*& data_out)
+	{
+		if (filemap.data)
+		{
+			// header and every record must lie within the mapping; a
+			//	truncated or corrupt file ends the trace early
+			sTraceHeader const* const header = (sTraceHeader const*)filemap.data;
+			unsigned long long const used = header->used;
+			if (used <= filemap.size - sizeof(sTraceHeader) && cursor < used && sizeof(sTraceRecord) <= used - cursor)
+			{
+				sTraceRecord const* const record = (sTraceRecord const*)((char const*)filemap.data + sizeof(sTraceHeader) + cursor);
+				if (TraceRecordSize(record->length) <= used - cursor)
+				{
+					record_out = record;
+					data_out = (unsigned char const*)(record + 1);
+					cursor += TraceRecordSize(record->length);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	RakNet::SystemAddress cTraceReader::GetSender(sTraceRecord const& record)
+	{
+		RakNet::SystemAddress sender;
+		sender.address.addr4.sin_family = AF_INET;
+		sender.address.addr4.sin_addr.s_addr = record.host;
+		sender.SetPortHostOrder(record.port);
+		return sender;
+	}
+}
\ No newline at end of file
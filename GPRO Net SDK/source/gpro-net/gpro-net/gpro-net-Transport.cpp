@@ -0,0 +1,134 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-Transport.cpp
+	Source for packet transport interface and RakNet implementation.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-Transport.hpp"
+
+
+namespace gproNet
+{
+	cTransport::~cTransport()
+	{
+	}
+
+	bool cTransport::GetStatistics(RakNet::SystemAddress const /*address*/, sLinkStatistics& /*stats_out*/)
+	{
+		return false;
+	}
+
+	RakNet::Time cTransport::GetClockDifferential(RakNet::SystemAddress const /*address*/)
+	{
+		return 0;
+	}
+
+
+	cTransportRakNet::cTransportRakNet()
+		: peer(RakNet::RakPeerInterface::GetInstance())
+	{
+	}
+
+	cTransportRakNet::~cTransportRakNet()
+	{
+		RakNet::RakPeerInterface::DestroyInstance(peer);
+	}
+
+	bool cTransportRakNet::Startup(unsigned short const maxConnections, unsigned short const maxIncoming, unsigned short const port)
+	{
+		RakNet::SocketDescriptor sd(port, 0);
+		if (peer->Startup(maxConnections, &sd, 1) == RakNet::RAKNET_STARTED)
+		{
+			peer->SetMaximumIncomingConnections(maxIncoming);
+			return true;
+		}
+		return false;
+	}
+
+	bool cTransportRakNet::Connect(char const host[], unsigned short const port)
+	{
+		return (peer->Connect(host, port, 0, 0) == RakNet::CONNECTION_ATTEMPT_STARTED);
+	}
+
+	void cTransportRakNet::Disconnect(RakNet::SystemAddress const address)
+	{
+		peer->CloseConnection(address, true);
+	}
+
+	void cTransportRakNet::Shutdown()
+	{
+		peer->Shutdown(0);
+	}
+
+	RakNet::Packet* cTransportRakNet::Receive()
+	{
+		return peer->Receive();
+	}
+
+	void cTransportRakNet::DeallocatePacket(RakNet::Packet* packet)
+	{
+		peer->DeallocatePacket(packet);
+	}
+
+	unsigned int cTransportRakNet::Send(RakNet::BitStream const* bitstream, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::AddressOrGUID const recipient, bool const broadcast)
+	{
+		return peer->Send(bitstream, priority, reliability, orderingChannel, recipient, broadcast);
+	}
+
+	unsigned int cTransportRakNet::Send(unsigned char const data[], unsigned int const length, PacketPriority const priority, PacketReliability const reliability, char const orderingChannel, RakNet::AddressOrGUID const recipient, bool const broadcast)
+	{
+		return peer->Send((char const*)data, (int)length, priority, reliability, orderingChannel, recipient, broadcast);
+	}
+
+	unsigned short cTransportRakNet::GetConnections(RakNet::SystemAddress list_out[], unsigned short const max)
+	{
+		unsigned short count = max;
+		return (peer->GetConnectionList(list_out, &count) ? count : 0);
+	}
+
+	unsigned long long cTransportRakNet::GetGUID(RakNet::SystemAddress const address)
+	{
+		RakNet::RakNetGUID const guid = peer->GetGuidFromSystemAddress(address);
+		return (guid != RakNet::UNASSIGNED_RAKNET_GUID ? guid.g : 0);
+	}
+
+	bool cTransportRakNet::GetStatistics(RakNet::SystemAddress const address, sLinkStatistics& stats_out)
+	{
+		RakNet::RakNetStatistics rns;
+		double buffered = 0.0;
+		int ping, i;
+		ping = peer->GetAveragePing(address);
+		if (ping < 0 || !peer->GetStatistics(address, &rns))
+			return false;
+		for (i = 0; i < NUMBER_OF_PRIORITIES; ++i)
+			buffered += rns.bytesInSendBuffer[i];
+		stats_out.ping = (unsigned int)ping;
+		stats_out.packetLoss = rns.packetlossLastSecond;
+		stats_out.bytesInSendBuffer = (unsigned int)buffered + (unsigned int)rns.bytesInResendBuffer;
+		stats_out.bytesPerSecond = (unsigned int)rns.valueOverLastSecond[RakNet::ACTUAL_BYTES_SENT];
+		return true;
+	}
+
+	RakNet::Time cTransportRakNet::GetClockDifferential(RakNet::SystemAddress const address)
+	{
+		return peer->GetClockDifferential(address);
+	}
+}
\ No newline at end of file
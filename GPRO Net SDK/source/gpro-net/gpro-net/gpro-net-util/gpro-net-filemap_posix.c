@@ -0,0 +1,174 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-filemap_posix.c
+	Memory-mapped file source for POSIX systems.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-filemap.h"
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+//-----------------------------------------------------------------------------
+
+// file descriptor stored in handle, offset so that 0 means not open
+#define gpro_filemapInternalFile(filemap)	((int)((intptr_t)(filemap)->handle[0] - 1))
+
+// extend file if needed and map view of open file at size
+static inline int gpro_filemapInternalMap(gpro_filemap* const filemap, unsigned long long const size)
+{
+	int const file = gpro_filemapInternalFile(filemap);
+	int const protect = filemap->readOnly ? PROT_READ : (PROT_READ | PROT_WRITE);
+	struct stat info;
+	void* data;
+
+	// unlike a Windows mapping, mmap does not grow the file
+	if (fstat(file, &info) == 0 &&
+		(filemap->readOnly || (unsigned long long)info.st_size >= size || ftruncate(file, (off_t)size) == 0))
+	{
+		data = mmap(NULL, (size_t)size, protect, MAP_SHARED, file, 0);
+		if (data != MAP_FAILED)
+		{
+			filemap->data = data;
+			filemap->size = size;
+			return 0;
+		}
+	}
+	return -2;
+}
+
+// release view, keep file
+static inline void gpro_filemapInternalUnmap(gpro_filemap* const filemap)
+{
+	if (filemap->data)
+		munmap(filemap->data, (size_t)filemap->size);
+	filemap->data = 0;
+	filemap->size = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+
+int gpro_filemapOpen(gpro_filemap* const filemap, char const* const path, unsigned long long const size, int const readOnly)
+{
+	if (filemap && path)
+	{
+		if (!filemap->handle[0])
+		{
+			struct stat info;
+			unsigned long long mapSize = size;
+			int const file = readOnly ?
+				open(path, O_RDONLY) :
+				open(path, O_RDWR | O_CREAT, 0644);
+			if (file >= 0)
+			{
+				// never map less than what is already there
+				if (fstat(file, &info) == 0 && (unsigned long long)info.st_size > mapSize)
+					mapSize = (unsigned long long)info.st_size;
+				if (mapSize)
+				{
+					filemap->handle[0] = (void*)((intptr_t)file + 1);
+					filemap->handle[1] = 0;
+					filemap->readOnly = readOnly;
+					if (gpro_filemapInternalMap(filemap, mapSize) == 0)
+					{
+						// done
+						return 0;
+					}
+					filemap->handle[0] = 0;
+				}
+				close(file);
+			}
+			return -2;
+		}
+		return +1;
+	}
+	return -1;
+}
+
+
+int gpro_filemapResize(gpro_filemap* const filemap, unsigned long long const size)
+{
+	if (filemap && filemap->handle[0] && !filemap->readOnly && size > filemap->size)
+	{
+		// flush and remap larger
+		msync(filemap->data, (size_t)filemap->size, MS_ASYNC);
+		gpro_filemapInternalUnmap(filemap);
+		if (gpro_filemapInternalMap(filemap, size) == 0)
+		{
+			// done
+			return 0;
+		}
+		gpro_filemapClose(filemap);
+		return -2;
+	}
+	return -1;
+}
+
+
+int gpro_filemapFlush(gpro_filemap const* const filemap, unsigned long long const offset, unsigned long long const size, int const wait)
+{
+	if (filemap && filemap->data && offset <= filemap->size)
+	{
+		// msync needs a page-aligned start
+		unsigned long long const page = (unsigned long long)sysconf(_SC_PAGESIZE);
+		unsigned long long const start = offset - offset % page;
+		unsigned long long const end = size ? offset + size : filemap->size;
+		if (msync((char*)filemap->data + start, (size_t)((end < filemap->size ? end : filemap->size) - start), wait ? MS_SYNC : MS_ASYNC) == 0)
+		{
+			// done
+			return 0;
+		}
+		return -2;
+	}
+	return -1;
+}
+
+
+int gpro_filemapClose(gpro_filemap* const filemap)
+{
+	if (filemap)
+	{
+		if (filemap->handle[0])
+		{
+			gpro_filemapInternalUnmap(filemap);
+			close(gpro_filemapInternalFile(filemap));
+			filemap->handle[0] = 0;
+
+			// done
+			return 0;
+		}
+		return +1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !_WIN32
\ No newline at end of file
@@ -0,0 +1,164 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-filemap_win.c
+	Memory-mapped file source for Windows.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-filemap.h"
+#ifdef _WIN32
+
+#include <Windows.h>
+
+
+//-----------------------------------------------------------------------------
+
+// create mapping and view of open file at size
+inline int gpro_filemapInternalMap(gpro_filemap* const filemap, unsigned long long const size)
+{
+	DWORD const protect = filemap->readOnly ? PAGE_READONLY : PAGE_READWRITE;
+	DWORD const access = filemap->readOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS;
+
+	// mapping extends file if it is too small
+	filemap->handle[1] = CreateFileMappingA(filemap->handle[0], NULL, protect, (DWORD)(size >> 32), (DWORD)(size), NULL);
+	if (filemap->handle[1])
+	{
+		filemap->data = MapViewOfFile(filemap->handle[1], access, 0, 0, (SIZE_T)size);
+		if (filemap->data)
+		{
+			filemap->size = size;
+			return 0;
+		}
+		CloseHandle(filemap->handle[1]);
+		filemap->handle[1] = 0;
+	}
+	return -2;
+}
+
+// release view and mapping, keep file
+inline void gpro_filemapInternalUnmap(gpro_filemap* const filemap)
+{
+	if (filemap->data)
+		UnmapViewOfFile(filemap->data);
+	if (filemap->handle[1])
+		CloseHandle(filemap->handle[1]);
+	filemap->data = filemap->handle[1] = 0;
+	filemap->size = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+
+int gpro_filemapOpen(gpro_filemap* const filemap, char const* const path, unsigned long long const size, int const readOnly)
+{
+	if (filemap && path)
+	{
+		if (!filemap->handle[0])
+		{
+			LARGE_INTEGER fileSize;
+			unsigned long long mapSize = size;
+			HANDLE const file = readOnly ?
+				CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL) :
+				CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file != INVALID_HANDLE_VALUE)
+			{
+				// never map less than what is already there
+				if (GetFileSizeEx(file, &fileSize) && (unsigned long long)fileSize.QuadPart > mapSize)
+					mapSize = (unsigned long long)fileSize.QuadPart;
+				if (mapSize)
+				{
+					filemap->handle[0] = file;
+					filemap->readOnly = readOnly;
+					if (gpro_filemapInternalMap(filemap, mapSize) == 0)
+					{
+						// done
+						return 0;
+					}
+					filemap->handle[0] = 0;
+				}
+				CloseHandle(file);
+			}
+			return -2;
+		}
+		return +1;
+	}
+	return -1;
+}
+
+
+int gpro_filemapResize(gpro_filemap* const filemap, unsigned long long const size)
+{
+	if (filemap && filemap->handle[0] && !filemap->readOnly && size > filemap->size)
+	{
+		// flush and remap larger
+		FlushViewOfFile(filemap->data, 0);
+		gpro_filemapInternalUnmap(filemap);
+		if (gpro_filemapInternalMap(filemap, size) == 0)
+		{
+			// done
+			return 0;
+		}
+		gpro_filemapClose(filemap);
+		return -2;
+	}
+	return -1;
+}
+
+
+int gpro_filemapFlush(gpro_filemap const* const filemap, unsigned long long const offset, unsigned long long const size, int const wait)
+{
+	if (filemap && filemap->data && offset <= filemap->size)
+	{
+		SIZE_T const count = (SIZE_T)(size ? size : (filemap->size - offset));
+		if (FlushViewOfFile((char const*)filemap->data + offset, count) &&
+			(!wait || filemap->readOnly || FlushFileBuffers(filemap->handle[0])))
+		{
+			// done
+			return 0;
+		}
+		return -2;
+	}
+	return -1;
+}
+
+
+int gpro_filemapClose(gpro_filemap* const filemap)
+{
+	if (filemap)
+	{
+		if (filemap->handle[0])
+		{
+			gpro_filemapInternalUnmap(filemap);
+			CloseHandle(filemap->handle[0]);
+			filemap->handle[0] = 0;
+
+			// done
+			return 0;
+		}
+		return +1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// _WIN32
\ No newline at end of file
@@ -0,0 +1,311 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-gamerules.c
+	Source for deterministic mini-game move rules.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-gamerules.h"
+
+
+//-----------------------------------------------------------------------------
+
+// checkers cells are packed; full column alternates with row
+#define gpro_checkers_x(row, col)	((int)(col) * 2 + ((int)(row) & 1))
+#define gpro_checkers_inside(row, x)	((row) >= 0 && (row) < 8 && (x) >= 0 && (x) < 8)
+
+// can piece at cell move by row step (player 1 forward is +row)
+static int gpro_checkers_forward(unsigned char const piece, int const dr)
+{
+	return gpro_flag_check(piece, gpro_checkers_stack) ||
+		(gpro_flag_check(piece, gpro_checkers_player1) ? (dr > 0) : (dr < 0));
+}
+
+int gpro_checkers_canJump(gpro_checkers const gs, unsigned char const row, unsigned char const col)
+{
+	if (gs && row < 8 && col < 4)
+	{
+		unsigned char const piece = gs[row][col];
+		unsigned char const opponent = gpro_flag_check(piece, gpro_checkers_player1) ? gpro_checkers_player2 : gpro_checkers_player1;
+		int const x = gpro_checkers_x(row, col);
+		int dr, dx, r1, x1;
+		if (!gpro_flag_check(piece, (gpro_checkers_player1 | gpro_checkers_player2)))
+			return 0;
+		for (dr = -1; dr <= 1; dr += 2)
+		{
+			if (!gpro_checkers_forward(piece, dr))
+				continue;
+			for (dx = -1; dx <= 1; dx += 2)
+			{
+				r1 = row + dr * 2;
+				x1 = x + dx * 2;
+				if (gpro_checkers_inside(r1, x1) &&
+					gpro_flag_check(gs[row + dr][(x + dx) / 2], opponent) &&
+					gs[r1][x1 / 2] == gpro_checkers_open)
+					return 1;
+			}
+		}
+		return 0;
+	}
+	return -1;
+}
+
+int gpro_checkers_canMove(gpro_checkers const gs, unsigned char const row, unsigned char const col)
+{
+	if (gs && row < 8 && col < 4)
+	{
+		unsigned char const piece = gs[row][col];
+		int const x = gpro_checkers_x(row, col);
+		int dr, dx;
+		if (!gpro_flag_check(piece, (gpro_checkers_player1 | gpro_checkers_player2)))
+			return 0;
+		for (dr = -1; dr <= 1; dr += 2)
+		{
+			if (!gpro_checkers_forward(piece, dr))
+				continue;
+			for (dx = -1; dx <= 1; dx += 2)
+				if (gpro_checkers_inside(row + dr, x + dx) &&
+					gs[row + dr][(x + dx) / 2] == gpro_checkers_open)
+					return 1;
+		}
+		return gpro_checkers_canJump(gs, row, col);
+	}
+	return -1;
+}
+
+int gpro_checkers_move(gpro_checkers gs, unsigned char const player, unsigned char const row0, unsigned char const col0, unsigned char const row1, unsigned char const col1)
+{
+	if (gs && (player == gpro_checkers_player1 || player == gpro_checkers_player2) &&
+		row0 < 8 && col0 < 4 && row1 < 8 && col1 < 4)
+	{
+		unsigned char const piece = gs[row0][col0];
+		unsigned char const opponent = player ^ (gpro_checkers_player1 | gpro_checkers_player2);
+		int const dr = (int)row1 - (int)row0;
+		int const dx = gpro_checkers_x(row1, col1) - gpro_checkers_x(row0, col0);
+		unsigned char const farRow = player == gpro_checkers_player1 ? 7 : 0;
+		int jump = 0;
+
+		// own piece moving diagonally into open cell
+		if (!gpro_flag_check(piece, player) || gs[row1][col1] != gpro_checkers_open ||
+			!gpro_checkers_forward(piece, dr) || (dx != dr && dx != -dr))
+			return -2;
+		if (dr == 2 || dr == -2)
+		{
+			unsigned char* const jumped = &gs[row0 + dr / 2][(gpro_checkers_x(row0, col0) + dx / 2) / 2];
+			if (!gpro_flag_check(*jumped, opponent))
+				return -2;
+			*jumped = gpro_checkers_open;
+			jump = 1;
+		}
+		else if (dr != 1 && dr != -1)
+			return -2;
+
+		// move and promote; promotion ends the turn
+		gs[row0][col0] = gpro_checkers_open;
+		if (row1 == farRow && !gpro_flag_check(piece, gpro_checkers_stack))
+		{
+			gs[row1][col1] = gpro_flag_raise(piece, gpro_checkers_stack);
+			return 0;
+		}
+		gs[row1][col1] = piece;
+		return (jump && gpro_checkers_canJump(gs, row1, col1) == 1) ? +1 : 0;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+int gpro_mancala_move(gpro_mancala gs, unsigned char const player, unsigned char const cup)
+{
+	if (gs && player < 2 && cup >= gpro_mancala_cup1 && cup <= gpro_mancala_cup6)
+	{
+		unsigned int stones = gs[player][cup], side = player, index = cup, i, s;
+		if (!stones)
+			return -2;
+
+		// sow toward own score, skipping opponent's score
+		gs[player][cup] = 0;
+		while (stones)
+		{
+			if (--index == gpro_mancala_score)
+			{
+				if (side == player)
+				{
+					++gs[side][gpro_mancala_score];
+					if (!--stones)
+						break;
+				}
+				side ^= 1;
+				index = gpro_mancala_onside;
+				continue;
+			}
+			++gs[side][index];
+			--stones;
+		}
+
+		// capture when last stone lands in own empty cup
+		if (index != gpro_mancala_score && side == player && gs[side][index] == 1 && gs[side ^ 1][gpro_mancala_onside - index])
+		{
+			gs[side][gpro_mancala_score] += gs[side][index] + gs[side ^ 1][gpro_mancala_onside - index];
+			gs[side][index] = gs[side ^ 1][gpro_mancala_onside - index] = 0;
+		}
+
+		// update totals; game ends when either side is empty
+		for (s = 0; s < 2; ++s)
+			for (gs[s][gpro_mancala_onside] = 0, i = gpro_mancala_cup1; i <= gpro_mancala_cup6; ++i)
+				gs[s][gpro_mancala_onside] += gs[s][i];
+		if (!gs[0][gpro_mancala_onside] || !gs[1][gpro_mancala_onside])
+		{
+			for (s = 0; s < 2; ++s)
+			{
+				gs[s][gpro_mancala_score] += gs[s][gpro_mancala_onside];
+				for (gs[s][gpro_mancala_onside] = 0, i = gpro_mancala_cup1; i <= gpro_mancala_cup6; ++i)
+					gs[s][i] = 0;
+			}
+			return 0;
+		}
+		return (index == gpro_mancala_score) ? +1 : 0;
+	}
+	return -1;
+}
+
+int gpro_mancala_over(gpro_mancala const gs)
+{
+	if (gs)
+		return (!gs[0][gpro_mancala_onside] || !gs[1][gpro_mancala_onside]);
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// length of ship by flag; zero if not a single ship
+static int gpro_battleship_length(unsigned char const ship)
+{
+	switch (ship)
+	{
+	case gpro_battleship_ship_p2: return 2;
+	case gpro_battleship_ship_s3: return 3;
+	case gpro_battleship_ship_d3: return 3;
+	case gpro_battleship_ship_b4: return 4;
+	case gpro_battleship_ship_c5: return 5;
+	}
+	return 0;
+}
+
+int gpro_battleship_place(gpro_battleship gs, unsigned char const ship, unsigned char const row, unsigned char const col, int const horizontal)
+{
+	int const length = gpro_battleship_length(ship);
+	if (gs && length && row < 10 && col < 10)
+	{
+		int const dr = horizontal ? 0 : 1, dc = horizontal ? 1 : 0;
+		int i, r, c;
+		if ((horizontal ? col : row) + length > 10)
+			return -2;
+		for (r = 0; r < 10; ++r)
+			for (c = 0; c < 10; ++c)
+				if (gpro_flag_check(gs[r][c], ship))
+					return -2;
+		for (i = 0; i < length; ++i)
+			if (gpro_flag_check(gs[row + dr * i][col + dc * i], gpro_battleship_ship))
+				return -2;
+		for (i = 0; i < length; ++i)
+			gs[row + dr * i][col + dc * i] |= ship;
+		return 0;
+	}
+	return -1;
+}
+
+int gpro_battleship_validate(gpro_battleship const gs)
+{
+	if (gs)
+	{
+		unsigned char ship;
+		int r, c, count, length, r0, c0, r1, c1;
+		for (ship = gpro_battleship_ship_p2; ship; ship <<= 1)
+		{
+			// every cell of ship inside its bounding line
+			length = gpro_battleship_length(ship);
+			count = 0;
+			r0 = c0 = 10;
+			r1 = c1 = -1;
+			for (r = 0; r < 10; ++r)
+				for (c = 0; c < 10; ++c)
+					if (gpro_flag_check(gs[r][c], ship))
+					{
+						// more than one ship per cell is never valid
+						if (gpro_flag_check(gs[r][c], (gpro_battleship_ship & ~ship)))
+							return -2;
+						r0 = r < r0 ? r : r0;
+						c0 = c < c0 ? c : c0;
+						r1 = r > r1 ? r : r1;
+						c1 = c > c1 ? c : c1;
+						++count;
+					}
+			if (count != length || !((r0 == r1 && c1 - c0 + 1 == length) || (c0 == c1 && r1 - r0 + 1 == length)))
+				return -2;
+		}
+		return 0;
+	}
+	return -1;
+}
+
+int gpro_battleship_defend(gpro_battleship gs, unsigned char const row, unsigned char const col, unsigned char* const result_out)
+{
+	if (gs && row < 10 && col < 10 && result_out)
+	{
+		if (gpro_flag_check(gs[row][col], gpro_battleship_damage))
+			return -2;
+		gs[row][col] |= gpro_battleship_damage;
+		*result_out = gpro_flag_check(gs[row][col], gpro_battleship_ship) ? gpro_battleship_hit : gpro_battleship_miss;
+		return 0;
+	}
+	return -1;
+}
+
+int gpro_battleship_record(gpro_battleship gs, unsigned char const row, unsigned char const col, unsigned char const result)
+{
+	if (gs && row < 10 && col < 10 && (result == gpro_battleship_hit || result == gpro_battleship_miss))
+	{
+		if (gpro_flag_check(gs[row][col], gpro_battleship_attack_rec))
+			return -2;
+		gs[row][col] |= result;
+		return 0;
+	}
+	return -1;
+}
+
+int gpro_battleship_lost(gpro_battleship const gs)
+{
+	if (gs)
+	{
+		int r, c;
+		for (r = 0; r < 10; ++r)
+			for (c = 0; c < 10; ++c)
+				if (gpro_flag_check(gs[r][c], gpro_battleship_ship) && !gpro_flag_check(gs[r][c], gpro_battleship_damage))
+					return 0;
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
\ No newline at end of file
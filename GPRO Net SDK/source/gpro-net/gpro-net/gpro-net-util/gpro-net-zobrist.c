@@ -0,0 +1,196 @@
+/*
+   Copyright 2021 Daniel S. Buckstein
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	GPRO Net SDK: Networking framework.
+	By Daniel S. Buckstein
+
+	gpro-net-zobrist.c
+	Source for Zobrist hashing of mini-game states.
+*/
+
+#include "gpro-net/gpro-net/gpro-net-util/gpro-net-zobrist.h"
+
+
+//-----------------------------------------------------------------------------
+
+// key of each bit of each cell; constant so every peer hashes the same
+//	(splitmix64 sequence seeded with 0x6770726f6e6574)
+static unsigned long long const gpro_zobrist_key[gpro_zobrist_cells][8] = {
+	{ 0xe952b0bf708a1d2eull, 0x412e5378f8040d8cull, 0x71a26c6646b423d8ull, 0x3dfeb4c173fa4c91ull, 0x77c783fd42931a79ull, 0x9e2c57b825aacc05ull, 0x4c96af1f1e667681ull, 0x67a2792e91b0c169ull },
+	{ 0x8a6d1a58cb879d50ull, 0x616b2e01c24be67aull, 0x36f7b1da3ec82e11ull, 0x3fc85ca749065392ull, 0xccf28cdffae401d8ull, 0x9630cc8276d63f7dull, 0xae46193678acdf12ull, 0x88cd95627067685cull },
+	{ 0x0b8e7a67f4d9a3d0ull, 0x83b9c1e9673bffe6ull, 0x3478ea334671cd74ull, 0x450979ace9f0f498ull, 0x371ef6a77d5d47caull, 0xa088917f563760d0ull, 0x28f55eac9687c59cull, 0x9636596359d338d2ull },
+	{ 0xbaa04abbbf40e247ull, 0x7d0b2fa456f72085ull, 0x32a1b5b1120eacc1ull, 0xfb6f8403fb006f58ull, 0x0477851b01136359ull, 0x313b3094edd79420ull, 0x1cded2591587af32ull, 0xbee64181ebc621f2ull },
+	{ 0x3c21cf0d56da7458ull, 0xd6dac819241f0049ull, 0x1040b666156072abull, 0x2ebb2cdf87481b67ull, 0xee2a5d10fc0268e2ull, 0xda293bcbbd0e740full, 0x0c33982999ee1287ull, 0x27391aa3765a60bfull },
+	{ 0xfeda6bfd5c8957ebull, 0xefb56d84f6631963ull, 0x2cfb97b834ae988eull, 0xef814d6d68c88b77ull, 0xe8f371ee5d4de771ull, 0x514a2c1615571429ull, 0x76a72470fe3823a6ull, 0x0d2151b370d88ba7ull },
+	{ 0xae9bec1c2904f788ull, 0xe42dc15cabc356c1ull, 0x05fffed7c7393c0dull, 0x948822cdf049062dull, 0x00cd3795b37225c1ull, 0x35073bdf39ec2158ull, 0x2f58c0f972e95dd6ull, 0x0754caa2c3911f23ull },
+	{ 0xb87fc3ed0cb9d023ull, 0x4d2c37db7d737579ull, 0x0bd71bb12ff2de9full, 0x57df0fc6ed9c7338ull, 0xb62a7b6cdef2fdefull, 0x5cc0bd467a2528c2ull, 0x51dae0ac6b322b67ull, 0x7bdb9530617ccdefull },
+	{ 0x7c6bd9e55f4fc8feull, 0x4a797cb779360247ull, 0xcd6a7076bc98d703ull, 0x657c971306724945ull, 0xd2eb2ac3c1c20325ull, 0xf4de237758d7d818ull, 0x26808b2f516e6306ull, 0xed89a2894c55ec48ull },
+	{ 0x2fde179251b43042ull, 0x1543f9b6b2ab1b06ull, 0x5a9b2ae08fa2200cull, 0x416946defc45d26aull, 0xae51a13639a1486dull, 0x42153797ed7b4f93ull, 0x5f81f528208a20e6ull, 0x9e3b804a93eec81cull },
+	{ 0xe2af62ec6f797ca1ull, 0x6cc170a6fcd5ed93ull, 0xd42ab88925fcd3e7ull, 0xfdb2bd60d7265649ull, 0x377590d7d12de9e2ull, 0x7dd7a2bd6d1aee03ull, 0x51e5d5b5fb61915eull, 0x40e5a565d76ca558ull },
+	{ 0x9e31539bb49a12ebull, 0x105bb1126f929535ull, 0x97dd607e861055baull, 0x504bf2f8b9ba1061ull, 0xa8132acba83694dcull, 0x835f3bf4e13bf140ull, 0x64966131cedc3c38ull, 0xe60ad67afacc1049ull },
+	{ 0x5234e4b6d05e6e6eull, 0x682d5edd73a7e848ull, 0xaa83d42b6fc54885ull, 0xba840dbf58c1a6cfull, 0x77d707dd11087957ull, 0x2f88e8d82cc5fd17ull, 0x3ed0b7d931c37b2dull, 0x80a6689d5eea8298ull },
+	{ 0x8de2c109621dac6aull, 0xe876ffec73e52880ull, 0x10dacdfa87b432d1ull, 0x8fbbc73d775e195cull, 0xed837e3c4511115eull, 0xd4596485f5e56bd5ull, 0x99ba964f8a88b898ull, 0x0d96a6d4351c821cull },
+	{ 0x5828c2d83530c5b6ull, 0xf7f5c0930c158f0cull, 0x9cff32b0afb164e1ull, 0xf7b8251e421005c0ull, 0x57b65c8fa24ba1e4ull, 0x11d73d5876c01506ull, 0x0515f16ed5772b80ull, 0xb15565f846ebc632ull },
+	{ 0x0dd62cca403b9e61ull, 0xa94f757c51ffd52aull, 0x02247909a223309full, 0x2b28bfff3a8d7f8dull, 0xfdf2c9e542ca6eb7ull, 0x1994b80ec1cb2580ull, 0x65e0ea413c1a5adfull, 0x3b395637aef20047ull },
+	{ 0xdb60364637c21d61ull, 0x2af26dd036169061ull, 0xad483fbea8be5f7eull, 0xe67af9cc20a49269ull, 0x25bcf39fab48bf8full, 0x500717e500d84be4ull, 0x5b5e1a88ee9d8c1cull, 0xaf83d3476625f869ull },
+	{ 0xaec9ea76eaadf2cdull, 0x9a3ee75a538b86d3ull, 0x49f8c611d4b17d1dull, 0xd3aaf04b71ab2bb2ull, 0x7a5458f70837b246ull, 0x55bba7ad87afce28ull, 0xc7c74b81fd021f5dull, 0xa6d21f4ff74ca19eull },
+	{ 0x59b0d59b4d9eb2e5ull, 0x6c358effb3ebd457ull, 0xe1b71e7574db1f9cull, 0x683d0c719864dc6eull, 0xbb0c429a2fa61b1dull, 0x95039e7c8e893d92ull, 0x965445a86141c8aaull, 0x04863504aa2374e2ull },
+	{ 0x7712dca66e3c974eull, 0x11f6de9ae91136ccull, 0xee70485305913537ull, 0x0ef3df90682990c8ull, 0x41a485ad87676c0cull, 0x424b23d1ae9d2fffull, 0x480438fdf6141078ull, 0x0ba4b3482a56c1cfull },
+	{ 0x595052ae5a031ee9ull, 0xbaefa41e5470083dull, 0xf6506a30ea3bf456ull, 0xb4a99440a59f89b3ull, 0xba317502390b0674ull, 0x37f7bfd487966b07ull, 0x4a17892f47c10078ull, 0x25ca2b143b53c695ull },
+	{ 0x76171647e39d6072ull, 0x0e5ceefe026d7136ull, 0x33466a4920c9121dull, 0x780fda432156ec39ull, 0x46aa72c4d3616851ull, 0x224479d05e34935bull, 0x0b3344571243447dull, 0x617381fa4b532c81ull },
+	{ 0x31008cce2276807bull, 0x9e4568ffd361dbb8ull, 0xb1fede2938d81266ull, 0xc4c6734dfd27ed5dull, 0x118c5e75fee787a4ull, 0x45d95de0bc7bf65dull, 0xb29ac7a31f83bce9ull, 0x6cf9e3a8b0f3eacfull },
+	{ 0x662db5fb793fd958ull, 0xc5fbb090cf17bf88ull, 0x359d0083ea1854c6ull, 0x32173ae242a35454ull, 0x078301cde9d9530bull, 0x9f12842528fc87a3ull, 0xdfd7a1040f605991ull, 0x52972ba3e01adc0aull },
+	{ 0xe786e9d59075bbe9ull, 0x2d579bd19a78d70cull, 0x139ec9f3f5f80c2eull, 0x817038ea10042df5ull, 0xbd637ccc62ac56f3ull, 0x0d7fc64c2e6a890eull, 0x59cfed4e418c7189ull, 0x7ddad7ee53623297ull },
+	{ 0x8d33cca0d4d3cd9cull, 0x6d0b8a04ffffc7dcull, 0x7eb4c166070f65a9ull, 0x9e172630538aff4eull, 0x1b3d14194a2d0e26ull, 0xe2dec71076e3b846ull, 0x5d4cd09bd4bff6f2ull, 0x0b51863ff08eaad1ull },
+	{ 0x669a041e6246210dull, 0x1ee6be643e24ec7eull, 0xcae0237f594ebb99ull, 0xa4ab995541c95ce8ull, 0x8de9aa9f8032b472ull, 0xd60a0081d36e8a6cull, 0x64ba024e3af9fd75ull, 0xf0e9c447fbfc5269ull },
+	{ 0x9ea258948a23574bull, 0xf31178d43f914ad4ull, 0x3714d739f1f90d28ull, 0xf27fe9ebb1ae708full, 0x9795f9892c0dc78bull, 0x2ad3a7ac9a21904cull, 0x2d997a347c88bee2ull, 0x369515d7917bcd4aull },
+	{ 0xe9f859c310c5744bull, 0x8765e6412748ec1eull, 0x318c9cbd646e0c2cull, 0xe4b41d20eece8179ull, 0x645da89dd006e02bull, 0xd33f90e584fc2939ull, 0x76af8811bade0177ull, 0x4a90d467f394b0daull },
+	{ 0x5cc2a122465e15e2ull, 0xb75013417ccafd58ull, 0xf6865842e9990644ull, 0x7b776015f4aa2a54ull, 0x823aff3017fcacadull, 0x7877175b18e27429ull, 0x56215e3d533ddb16ull, 0xa7d5337428d43a94ull },
+	{ 0x03ecbec8629f4d52ull, 0x3f6e6948d646957eull, 0x1ad6bc296ba9573full, 0xa6f083709cae2812ull, 0xed295bb4a472781aull, 0x2a7850dba54476afull, 0x171ed5c9dae9cd4dull, 0x16351e3ef21d2aa6ull },
+	{ 0x2e4c0d43049210d7ull, 0x0b239e09ab3092b2ull, 0x857ce0f43ffc0550ull, 0xc1423ba47e89f0e4ull, 0xd4322b97c78af6d6ull, 0xc671855137ba8f69ull, 0xd1b0ae343dac797aull, 0xace9b9281bc76c79ull },
+	{ 0x13032d6cd652cad7ull, 0x968a95e69da0886bull, 0x052275a4afb9647aull, 0xf68723e89965f1b6ull, 0xc8fc9845790877c2ull, 0xae4fdd44be65d1f4ull, 0xbf0dd7b8086c0e8dull, 0xa1809e477f2c0b11ull },
+	{ 0x476911c70a565355ull, 0x13c3d08cc1a19f21ull, 0x39e90457508b9b55ull, 0x3b9977de0422d756ull, 0xf804c7422ce72668ull, 0x58fdaba5f781ba8full, 0x0d72c5ec6a08225full, 0xc65d43ba8a3dc6f3ull },
+	{ 0x054fb06f12fbac05ull, 0xeb74233aa703f0e5ull, 0xdf11d2ba0066ae70ull, 0xe5ff1a695a24faacull, 0x0dd2bea96c12f43full, 0xc3fd716fe8aee853ull, 0x62d157ec8281d64eull, 0x6f35da1c9cef13b7ull },
+	{ 0xade65bd32fe159e2ull, 0xf63c435caad5a234ull, 0x62a62d4696779f93ull, 0x5d57a177b64db5f6ull, 0x6e7e105c191a0985ull, 0xcead94fecfccfdb1ull, 0x11205ff446721c59ull, 0x540fe2732cb8e733ull },
+	{ 0xfcfcfcd50f210c03ull, 0xc82605b073b28a58ull, 0x1f9e76e2156c0826ull, 0x5bf15d81bfa88fe7ull, 0x181b219ed19b84e0ull, 0x95ecf2f436f94050ull, 0x61d5d3fe8591bfedull, 0x00076cfc5dca2da0ull },
+	{ 0x354a0feaa359e1b0ull, 0x8eb2c13d2ef2a6ddull, 0xcd45ff5a0a1b7f38ull, 0xefd2fea8b5e6f760ull, 0xbd102de8cd5c4521ull, 0xbdba3cfe5b097858ull, 0x59d21bb601a84edaull, 0x6992fc74e58fc74full },
+	{ 0x8d858f2e9faad0c2ull, 0xcb2f0c750f9fbae3ull, 0x793d28e4a36bf3a1ull, 0xc569d7a01d2eaa0dull, 0x8d603487449b427dull, 0xfc2ed7b026cffea9ull, 0x6b8fa1d7d80c20a0ull, 0x1e7825e160e075ccull },
+	{ 0x1bef9c20820bf049ull, 0xde1cfbc870f4e8fcull, 0x04685a1c319a7a26ull, 0x5d9b9a8a7770685full, 0x29efb24b1db424d9ull, 0xfae3571dc1cc38faull, 0x37d734799d00777eull, 0x0cae25d05230532cull },
+	{ 0x859daecdefe867f7ull, 0x4537e361f32b13bdull, 0xd5af9923619581f2ull, 0x6457b5ec5c63a16eull, 0x709ec3f6d028a628ull, 0xce20cf80a64ce563ull, 0x22f3d76e6e18eb1cull, 0x7df1ca9a6418d7a5ull },
+	{ 0x596e8be1ec547cbaull, 0xc74908a0e9a254e5ull, 0x28e794ffab73d49full, 0x223cd01563e497e3ull, 0xf1c5947aeed22b53ull, 0x4503b28c60840c1aull, 0x28afa041bd683cc1ull, 0xeac83f0f88c70931ull },
+	{ 0x1e16d01debdc6707ull, 0x99400eaeeb489048ull, 0x901e5ea5073b626full, 0x7b8a3d44e82b01c2ull, 0x70ac6fff70b946aeull, 0xe3ab784e1448d46cull, 0xe8c233b079634349ull, 0x068416e4312deb5eull },
+	{ 0xf425a784a360f849ull, 0x1efd8943606ba664ull, 0x0935e9148ace7a4aull, 0x48bfc3c02f099400ull, 0xb8760fde864143bdull, 0x7068c1e8d119f3d1ull, 0xd4956dd00767fd48ull, 0x5522a272ab76665cull },
+	{ 0x06a976acd2244836ull, 0xcc5aacb925c11058ull, 0x9a4bc619ed270ed4ull, 0xb1e9232310ae7032ull, 0xff091b5f114ead0aull, 0x0980a3a8c5879fcfull, 0x82ed68feb038a296ull, 0x6eff3a9e40013348ull },
+	{ 0x52fb41ff909af136ull, 0x5a778f87acb48e43ull, 0xfe9ead10e2ed0220ull, 0x8120298f2194ed36ull, 0xb68abec419bc44faull, 0xcbe5e51d38acaabaull, 0xa6a3d610fb62591full, 0x7f63b841d1c901b3ull },
+	{ 0x8941c9653de2a343ull, 0xa2c91f30ed3ab541ull, 0x5d5065cdb1ad4840ull, 0x23ef651a61cdcca5ull, 0xb60aa3032867579dull, 0x03ce47c73c83cdd9ull, 0x85c65d0e7e93cd6eull, 0xd58b507dce46f0b9ull },
+	{ 0x5820ad4ba9637368ull, 0x368f024c638d914dull, 0xa6159dc8b267cfbbull, 0xb8d231ea3c29d437ull, 0x0bacfc725fe6d0f4ull, 0x1db7502db4b1172cull, 0x0917150ec597539dull, 0x8c9a6196a17a6348ull },
+	{ 0x67ed3e0205711224ull, 0xc32ce3f3935f0204ull, 0xdd7dee3e3af9e241ull, 0xeaf0e9329920c07cull, 0xc8b829d671dc0722ull, 0x2f61d2969d3838c1ull, 0x922dd4f799359e06ull, 0x89925600b7c6bbb9ull },
+	{ 0x48813e171ef2a2ebull, 0xcf6c08555a4382deull, 0xeda414087fd9ae87ull, 0xf5376e60c5974d5eull, 0xb8db678e001d6470ull, 0xf1df851763eb9148ull, 0xe8467f76ed8eb928ull, 0x33a82e04eb26b227ull },
+	{ 0x9ad380d473d3114cull, 0x45a417a3030c7d64ull, 0xb65e16abdd51cb22ull, 0xbb6557eca7a607f8ull, 0x54b9e70a2a2aed19ull, 0x9dd9396ecc73fbcfull, 0xddf015f985838db1ull, 0x6f82f98c21cc6240ull },
+	{ 0x527200564dca949bull, 0x82a6753c7cb133d8ull, 0x1a9ad4e88682e562ull, 0xda71d432370a0357ull, 0x618fd34c454520faull, 0x18146efca69fc1c4ull, 0xa6daaf44457ca5d4ull, 0xd0b4a80c55866e90ull },
+	{ 0x5b187ac203ea1869ull, 0x351015ad9ead1540ull, 0x1a543d93841525e3ull, 0xc9657fc995ada20full, 0x5f90d7720af3b38dull, 0x24a9be97986d042cull, 0x7b7d232462c3ae67ull, 0x0eaacd89ea181272ull },
+	{ 0xbada32db5bb03938ull, 0x87e2a0c867916308ull, 0x8221be08254b0574ull, 0x4bfb3875611b7465ull, 0x056b0129977c9a8cull, 0x937d52e3e653b9f1ull, 0xc48d5a1e08986b32ull, 0x71774837e0af3df0ull },
+	{ 0xbf18e64078185730ull, 0xfa42cc90e3ecc632ull, 0x114c682a7405c9b2ull, 0xed6de9d573778f61ull, 0x174b963b1cbf2c5cull, 0x728b6857888d02a5ull, 0x7386fdbfb0932e10ull, 0x00a2e2e2ad2ae4e3ull },
+	{ 0x4968df8836d79a48ull, 0x45d047172983a680ull, 0x9a84f5cad695bcffull, 0x0ebcf7a14db5bafbull, 0x781f7f9fae5762d8ull, 0x03196497fb05bce0ull, 0x384684d23e6d58ecull, 0xb9d8b7c938f46acdull },
+	{ 0x296f90928dc10856ull, 0xc78eb6d941f6b7baull, 0x7b9b1c1342f459a3ull, 0x136b706012e4dbceull, 0xbfbfb5f9ad28e879ull, 0x9f9917e05d539b21ull, 0x8ea443373d0cb818ull, 0x5979b3632b34c1abull },
+	{ 0x193e0b9da529171cull, 0xb907ebe2ba13bd81ull, 0xd7c1b63db03e5b83ull, 0x0e581937475a9a3dull, 0x7c775fcfe68468d2ull, 0xb82d5daddbd1759full, 0x13c1140215a6603cull, 0x8908dd976bcb5855ull },
+	{ 0xe0f15cc91d86c66eull, 0xf2d67d5e2445c99eull, 0x7b2d4895fae60cb4ull, 0xa5cb9511b895e789ull, 0x86a92b7df40a4e39ull, 0xbbd662892c2e29c3ull, 0x1701f26bf9067a37ull, 0xcca7ccb6b55f5799ull },
+	{ 0x6c55efb2a4c12230ull, 0x25aee1ca8f506414ull, 0x12feffee2621de5dull, 0x7f9e2d076720038aull, 0x8a40a61e973f0aa6ull, 0x159ca9f486285025ull, 0x27c667b7cc83c2f1ull, 0xbfe6443dbdef3b5dull },
+	{ 0x3bc64c651e65468eull, 0x39e51a2730a028f7ull, 0x884ee936e36aec2full, 0x09faf105fe9dd629ull, 0x355a8dbfd11ab641ull, 0xa89795f24fc745a1ull, 0x9d4e1ee4934c6109ull, 0x17c017f253bd0abaull },
+	{ 0x46af065b231f71f6ull, 0x17dacf95436f8f4bull, 0xd1dc8e66d97635b5ull, 0x9ebc97b97700a330ull, 0x418970c5c946da4dull, 0xf1f703314fe45654ull, 0x218d1d18837a8a22ull, 0x7186e465420cfe5eull },
+	{ 0xc4f998d3db4d039aull, 0x53b9bd25060bdcccull, 0xc2ecad394aeceb95ull, 0xdeb9298144a72011ull, 0xcd178d3c118d153bull, 0xb4d7e82eec5e5effull, 0xcf38365c9981174dull, 0xc0a00918b23894afull },
+	{ 0x757ed3430fb696e1ull, 0xc5237230d6fc3139ull, 0xad962f0c20974b15ull, 0xdd1ac9dacce62d27ull, 0xc96c54483000de4bull, 0xad6f7073181a58edull, 0xca1a37aef5ec321cull, 0x1c32f2bea2ef606dull },
+	{ 0xf1fda7fae0b00406ull, 0xb9ae804ba3069ab6ull, 0x1280496e74440441ull, 0xa9f91e6288c35c57ull, 0x9422e468093fc206ull, 0x379c7886e4b597a6ull, 0xda78e1de01d00626ull, 0xbd2ea52f1bf9e65bull },
+	{ 0x7f5b441464eab726ull, 0x3f9d5094fb24c8ccull, 0x37f61d9c21a935cfull, 0x1aee355c38b32e89ull, 0xbcf542c7e31bb3aeull, 0xc4a2631ab5df68dbull, 0x0d1ee765201e4d77ull, 0x63895cd85d557212ull },
+	{ 0x9ead0150e559873dull, 0xb091c97efef27d98ull, 0x986fcf30b9e614a8ull, 0xe1bde9af0adbebbcull, 0x8fbd9c185170ab14ull, 0x34f89fbd1a08fb99ull, 0x7f443150ea1d570aull, 0x1c737cc599bd2f0aull },
+	{ 0xfa51e121d6896954ull, 0x5aa24f01072cf13cull, 0x55e1deadf7016137ull, 0x8d5ccdcf47542fedull, 0x2de5b38b22d3f025ull, 0x9ca6986cec7ac4afull, 0x10f3bde47fc4c3dcull, 0x86e851c804d30011ull },
+	{ 0x2128eb9dd52dc1ebull, 0xc07c178ce0fe9aa7ull, 0x2beb2bc2db3eb090ull, 0xd0c18311fa54d4f5ull, 0xde386074f2f408e2ull, 0x7ce7bf89ae0fc1f0ull, 0x0bd8878febe856fbull, 0xd28dfc444a2214afull },
+	{ 0x636767fcc0950760ull, 0x59f88e682cb88102ull, 0xf648898fd0a631edull, 0xa4cb5b78e8594631ull, 0x9e63322d0514f968ull, 0xeeb4154dc8b7994full, 0x8f6219db60977d97ull, 0xaf1e382c3b6bf446ull },
+	{ 0x11925197dff91375ull, 0xd886e44e35b32455ull, 0x1be432fe5c31624eull, 0x446932e22995f8d4ull, 0xfaa61acff0dcb542ull, 0x6380ba5bb9c1a82eull, 0x1b0c92831ed4247full, 0x0437b0f578c1f4e7ull },
+	{ 0xeb2685fcde769b9dull, 0xf3f7fa129af2c560ull, 0x5ad6a0630cc96d0eull, 0xe71e3284b68cb578ull, 0x463467ff7b250614ull, 0xf74b78e28841702full, 0x9838820fc5be7232ull, 0x1322784f5106c109ull },
+	{ 0x4d0f2287a5ae1e36ull, 0xb6899fbf029eb959ull, 0x2d74b2c7a42a6facull, 0x535f4cae6cbbcd5cull, 0x7f47e6b41ce30766ull, 0xe1afa2e445661070ull, 0x4e9438cebaa3c71aull, 0x2ae08a825058f1d1ull },
+	{ 0x5c4480d9bd1d0853ull, 0x1e511f9615e0397full, 0x821ea1d597e41ce8ull, 0xf6e753e7c7162253ull, 0x598ff5b0c015f564ull, 0xde400cf054b756aeull, 0x377b46274a67e566ull, 0x016e4cd0b9dd746cull },
+	{ 0x6f62ce13a919d680ull, 0xfdae32ce89a4e6baull, 0xb933768960c4f2f7ull, 0xb26b6be6cae5b36eull, 0xbe0dc8064da55e0full, 0xffb11e8b46fa846dull, 0x3c1c8fb2bf3bddb4ull, 0x52dcab2c953988d8ull },
+	{ 0x62dfe1992f2b25e2ull, 0x1ca959ffd7834890ull, 0x1d305054da56ee1dull, 0x0644b578e0d91aceull, 0x6fb7f58b7a175c5bull, 0xae1a54c0ceb7bfe7ull, 0xc7f62c8fd1cbda72ull, 0x05aa834cffd45088ull },
+	{ 0x790c2bde7bd4fe18ull, 0x44064475a0da80d1ull, 0x4bace8f9ddfeaf09ull, 0x1510a231cf822e27ull, 0xf7d5d7c8bf06b0faull, 0x149d690ebd84674cull, 0x6fd626686e6a2a39ull, 0xde7cb4e5f0fc1828ull },
+	{ 0x5792f00e86a56cf0ull, 0xdb1a51a92350bf13ull, 0xe9117ded61228255ull, 0x11bbc030089828feull, 0x791182c410000ebcull, 0x9964758a8f8c5007ull, 0xa1bf5af3df26eb7aull, 0x46989204a0f49a8eull },
+	{ 0x94d8cb1fc4109419ull, 0xdaaa48a12e44e2b6ull, 0x2ff73796294a54d9ull, 0x3c6fa0f737839bffull, 0x3504744b98d054b1ull, 0xe46f1a44791442cdull, 0x591ccb267897a855ull, 0xd9ff09c0213ef74bull },
+	{ 0x95ca485958afebedull, 0xaa839871a4b07ad9ull, 0xaf1c812e7ea00afcull, 0x532b30602ed583dbull, 0x638eca67f9f1e6b4ull, 0xf2ec1433ab7decd6ull, 0xf09b451f508415e4ull, 0xf0914d9d7335b472ull },
+	{ 0x4302cdd4bc956f7full, 0x1d15d1cb598e63bcull, 0xdbb91df18077f8a1ull, 0xb90a7b469594028cull, 0x88ec89a44027599aull, 0x781f0adc6b384eafull, 0x1173bcd2ad71cc2full, 0x425fba6d3dc64b1dull },
+	{ 0x7e84b157f4a2002full, 0xa11e14aa5d9063eaull, 0x44f76ba85e12193bull, 0x82e46dc0671836b5ull, 0xd873fe46fcae78e3ull, 0x13be89d6e2afbc00ull, 0x6ad05cba980bbaebull, 0xd5b8c2fdf3ee8851ull },
+	{ 0xd908e352b674766dull, 0xb83a0da61e989a7bull, 0x204fdcf56954a56cull, 0x1deeeabcc29d7ae7ull, 0xa345e3267e65b1d9ull, 0xaf872940cc8fa189ull, 0x9526b0a60fd0b7feull, 0x6c3952000594642bull },
+	{ 0x5a86f27d8c74837cull, 0x0c53657cb943685eull, 0x019f42c779e58e3bull, 0xf6535a601cc34d0dull, 0x576af5570d8894b5ull, 0xb444a95960dd8304ull, 0xadceff8a8c6a8481ull, 0x313f3f3442801fe5ull },
+	{ 0x5b86462b50506331ull, 0xa8a64c175d2d6bcdull, 0xd52e4a8c0c685150ull, 0xf03738086c4caba3ull, 0xa465e6abc7f29872ull, 0x9505cc63ede52e8aull, 0x1e9234aa749d8f70ull, 0xf687529cef247c40ull },
+	{ 0x4d8e96fc91ab2686ull, 0x384fe66c2a9fd18bull, 0xed54e4ee8431ad6dull, 0x82cb6ddaec047a3eull, 0x9d3c640674940936ull, 0x45563409a2962d96ull, 0x9110b654f27a580full, 0x49a4671b0fe453d0ull },
+	{ 0xd8c70c7d449a891full, 0x2c123b533679f0bfull, 0x417156955efb5fd9ull, 0x6a45971c9e30ac34ull, 0x8d82ea1a302c4ed5ull, 0x9643072de5d3df6bull, 0x989269b464c83232ull, 0x1ed17a7aa56b81fdull },
+	{ 0xbf7fe20dad97d7fbull, 0x72a10473d39cf4ffull, 0x56f3c366b6bbdb17ull, 0x01f039992aef7e23ull, 0x80559f8f666cf662ull, 0xd24d07b3ddceb6b7ull, 0xb077cbc7786e8d79ull, 0xf71216d699585e49ull },
+	{ 0x2108f99cf67fae30ull, 0x0efc0af4bc9c05ddull, 0x7a38533fe617c19bull, 0x99771a922f4f9438ull, 0xf24c5c8a3307e887ull, 0xb548edac8e5d29f6ull, 0xc085156b00ec81efull, 0xdf4836cc6e25a1e4ull },
+	{ 0x25d9c1aa66a37a84ull, 0xac1c16477b05373dull, 0x9d0d3fa3e0c7d979ull, 0x2d2969a5435f222eull, 0x0925a6a6235fc6c1ull, 0x24a2064f66cdea06ull, 0x6d8625f1cadd08e5ull, 0x61e21253196b0cbaull },
+	{ 0x3681967d1d4bfe8bull, 0xf43aa13bb1ae6d86ull, 0x4ab5603ab803eb28ull, 0x97dafc108cfce6a3ull, 0xc76f0a3e6c033a62ull, 0x10f358eb897f9f26ull, 0xb1016a645d89d55bull, 0x930fd2fd7e9580a3ull },
+	{ 0x8fc5c26297f1fcd0ull, 0x2a91aacb29d37907ull, 0x88c7c80be0771017ull, 0x0505d6cad1ef528cull, 0xb48c830220d914caull, 0x5a74b42029dcf6e3ull, 0x9e69fe47f6a00104ull, 0x23856341f66af292ull },
+	{ 0x776f69b9210b9f00ull, 0xaf8273536f1e9295ull, 0x8abb690519fc20d9ull, 0x1737c2587bd420caull, 0xf01d83327c62e972ull, 0xdcd671d5df54bfb2ull, 0xdc04d381278c978dull, 0x06805b5fda96a9c1ull },
+	{ 0x95ce20ed6bf0eb2bull, 0x1c1d7856c68645bfull, 0xc23d1aa275d86c0aull, 0xf634d088f22ab769ull, 0xc705cdee636ce37cull, 0x60bbb0f75969a046ull, 0x923f37d47f0ba491ull, 0xf71ff35c798d7b47ull },
+	{ 0x5bfefd48ca53fbc9ull, 0x62d2d2cbc51e244full, 0x7482ddcf08c5f211ull, 0x6ec73f0f4d7fcf38ull, 0x86133748b035f5a1ull, 0xcbf6fff8b27d822full, 0x516c68e68564f913ull, 0x31357b85134b85aaull },
+	{ 0x334f93c18abee43eull, 0xdfbef8563f79b894ull, 0xde90c07b3560f242ull, 0x99caad52c576fd95ull, 0xc34f1ea85b7a6d22ull, 0xc5775e24efaac51dull, 0x04751e10a4fcce13ull, 0x8712c219f628b76eull },
+	{ 0xa7d6eab96b17335cull, 0x0b79f0f4facdb6faull, 0x113e748c586a5bd9ull, 0x0fb901632bbe45fdull, 0xef149b0284c86d1cull, 0x490b4f17d1106d18ull, 0xe5d93b3c8c8ac2bfull, 0x5c66523aa96754afull },
+	{ 0x09bd01103a3f2adbull, 0x26133da17a4995e5ull, 0xebcb6027ef410a39ull, 0x141c210d390527ecull, 0x273f08e5619729a5ull, 0xe0913a72110e11eaull, 0x7fa88412fdf67cfaull, 0x9d640b7c5f72100full },
+	{ 0xac8b9d122ae366daull, 0xcb2320f772947a6dull, 0xb7ceaf4b1064d5aeull, 0xf68d138e89a2057aull, 0x941ca6798c46f0dfull, 0xea4d481f4aede7bcull, 0x96986ac8c544721bull, 0x59ecb21fd3433a89ull },
+	{ 0xdbe949c592fe0b97ull, 0x075a83e9f5d0acbbull, 0xed03805fa3d75ff6ull, 0xcf7d0a9176c1406full, 0x0558a2fc3c938cbcull, 0x4d4e7b3239247712ull, 0x79d3e4f847d63c4bull, 0x001d533ed32f08a6ull },
+};
+
+// combined key of raised bits in value
+static unsigned long long gpro_zobrist_bits(unsigned long long const key[8], unsigned int value)
+{
+	unsigned long long hash = 0;
+	unsigned int bit;
+	for (bit = 0; value; ++bit, value >>= 1)
+		if (value & 1)
+			hash ^= key[bit];
+	return hash;
+}
+
+
+//-----------------------------------------------------------------------------
+
+int gpro_zobrist_board(void const* const cells, unsigned int const count, unsigned long long* const hash_out)
+{
+	if (cells && count <= gpro_zobrist_cells && hash_out)
+	{
+		unsigned char const* const value = (unsigned char const*)cells;
+		unsigned long long hash = 0;
+		unsigned int i;
+		for (i = 0; i < count; ++i)
+			hash ^= gpro_zobrist_bits(gpro_zobrist_key[i], value[i]);
+		*hash_out = hash;
+		return 0;
+	}
+	return -1;
+}
+
+int gpro_zobrist_cell(unsigned long long* const hash, unsigned int const cell, unsigned char const before, unsigned char const after)
+{
+	if (hash && cell < gpro_zobrist_cells)
+	{
+		*hash ^= gpro_zobrist_bits(gpro_zobrist_key[cell], before ^ after);
+		return 0;
+	}
+	return -1;
+}
+
+int gpro_zobrist_range(unsigned long long* const hash, unsigned int const cell, unsigned char const* const before, unsigned char const* const after, unsigned int const count)
+{
+	if (hash && before && after && cell <= gpro_zobrist_cells && count <= gpro_zobrist_cells - cell)
+	{
+		unsigned int i;
+		for (i = 0; i < count; ++i)
+			if (before[i] != after[i])
+				*hash ^= gpro_zobrist_bits(gpro_zobrist_key[cell + i], before[i] ^ after[i]);
+		return 0;
+	}
+	return -1;
+}
+
+int gpro_zobrist_verify(void const* const cells, unsigned int const count, unsigned long long const hash)
+{
+	unsigned long long full;
+	if (gpro_zobrist_board(cells, count, &full) == 0)
+		return (full == hash) ? 0 : -2;
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
\ No newline at end of file